@@ -850,6 +850,88 @@ int mbedtls_mpi_exp_mod( mbedtls_mpi *X, const mbedtls_mpi *A,
                          const mbedtls_mpi *E, const mbedtls_mpi *N,
                          mbedtls_mpi *_RR );
 
+#if defined(MBEDTLS_DHM_FIXED_BASE)
+/**
+ * \brief          Precomputed powers of a fixed base modulo a fixed odd
+ *                 modulus, for mbedtls_mpi_exp_mod_table().
+ *
+ *                 Once set up, a table is only read, so it can be used by
+ *                 several threads at the same time.
+ */
+typedef struct mbedtls_mpi_exp_table
+{
+    mbedtls_mpi N;              /*!< The modulus. */
+    mbedtls_mpi G;              /*!< The base, reduced modulo \c N. */
+    mbedtls_mpi_uint mm;        /*!< The Montgomery constant for \c N. */
+    size_t w;                   /*!< The comb width. */
+    size_t d;                   /*!< The number of comb columns. */
+    mbedtls_mpi_uint *T;        /*!< The \c 2^w entries of \c N->n limbs. */
+}
+mbedtls_mpi_exp_table;
+
+/**
+ * \brief          Initialize a fixed-base exponentiation table.
+ *
+ * \param table    The table to initialize. This must not be \c NULL.
+ */
+void mbedtls_mpi_exp_table_init( mbedtls_mpi_exp_table *table );
+
+/**
+ * \brief          Precompute the powers of \p G modulo \p N needed to
+ *                 compute G^E mod N with mbedtls_mpi_exp_mod_table()
+ *                 for any exponent \c E of at most \p ebits bits.
+ *
+ * \note           The table takes 64 times the size of \p N. Computing it
+ *                 costs about as much as one call to mbedtls_mpi_exp_mod(),
+ *                 and each call to mbedtls_mpi_exp_mod_table() is then
+ *                 about twice as fast.
+ *
+ * \param table    The table to set up. This must be initialized.
+ *                 Any previous content is freed.
+ * \param G        The base. This must point to an initialized MPI.
+ * \param N        The modulus. This must point to an initialized MPI.
+ * \param ebits    The maximum size of the exponents, in bits.
+ *
+ * \return         \c 0 if successful.
+ * \return         #MBEDTLS_ERR_MPI_ALLOC_FAILED if a memory allocation failed.
+ * \return         #MBEDTLS_ERR_MPI_BAD_INPUT_DATA if \p N is negative or
+ *                 even, if \p G is negative or if \p ebits is \c 0 or
+ *                 larger than #MBEDTLS_MPI_MAX_BITS.
+ */
+int mbedtls_mpi_exp_table_setup( mbedtls_mpi_exp_table *table,
+                                 const mbedtls_mpi *G, const mbedtls_mpi *N,
+                                 size_t ebits );
+
+/**
+ * \brief          Perform a fixed-base exponentiation: X = G^E mod N,
+ *                 where \c G and \c N are those of \p table.
+ *
+ *                 Unlike mbedtls_mpi_exp_mod(), the sequence of operations
+ *                 and the memory access pattern only depend on the size of
+ *                 \p E in limbs, not on its value.
+ *
+ * \param X        The destination MPI. This must point to an initialized MPI.
+ * \param E        The exponent MPI. This must point to an initialized MPI.
+ * \param table    A table set up with mbedtls_mpi_exp_table_setup().
+ *
+ * \return         \c 0 if successful.
+ * \return         #MBEDTLS_ERR_MPI_ALLOC_FAILED if a memory allocation failed.
+ * \return         #MBEDTLS_ERR_MPI_BAD_INPUT_DATA if \p table is not set up,
+ *                 if \p E is negative or if it is larger than the table
+ *                 allows.
+ */
+int mbedtls_mpi_exp_mod_table( mbedtls_mpi *X, const mbedtls_mpi *E,
+                               const mbedtls_mpi_exp_table *table );
+
+/**
+ * \brief          Free the content of a fixed-base exponentiation table.
+ *
+ * \param table    The table to free. This may be \c NULL, in which case
+ *                 this function does nothing.
+ */
+void mbedtls_mpi_exp_table_free( mbedtls_mpi_exp_table *table );
+#endif /* MBEDTLS_DHM_FIXED_BASE */
+
 /**
  * \brief          Fill an MPI with a number of random bytes.
  *
@@ -904,6 +986,31 @@ int mbedtls_mpi_gcd( mbedtls_mpi *G, const mbedtls_mpi *A,
 int mbedtls_mpi_inv_mod( mbedtls_mpi *X, const mbedtls_mpi *A,
                          const mbedtls_mpi *N );
 
+/**
+ * \brief          Compute the modular inverse X = A^-1 mod N for an odd
+ *                 modulus, in constant time.
+ *
+ *                 The running time and memory access pattern only depend
+ *                 on the size of \p N, not on the value of \p A, as long
+ *                 as \p A is in the range [0, N). Inputs outside this
+ *                 range are reduced first, which is not constant time.
+ *
+ * \param X        The destination MPI. This must point to an initialized MPI.
+ * \param A        The MPI to calculate the modular inverse of. This must point
+ *                 to an initialized MPI.
+ * \param N        The base of the modular inversion. This must point to an
+ *                 initialized MPI.
+ *
+ * \return         \c 0 if successful.
+ * \return         #MBEDTLS_ERR_MPI_ALLOC_FAILED if a memory allocation failed.
+ * \return         #MBEDTLS_ERR_MPI_BAD_INPUT_DATA if \p N is even, or less
+ *                 than or equal to one.
+ * \return         #MBEDTLS_ERR_MPI_NOT_ACCEPTABLE if \p A has no modular
+ *                 inverse with respect to \p N.
+ */
+int mbedtls_mpi_inv_mod_ct( mbedtls_mpi *X, const mbedtls_mpi *A,
+                            const mbedtls_mpi *N );
+
 #if !defined(MBEDTLS_DEPRECATED_REMOVED)
 #if defined(MBEDTLS_DEPRECATED_WARNING)
 #define MBEDTLS_DEPRECATED      __attribute__((deprecated))
@@ -974,6 +1081,7 @@ int mbedtls_mpi_is_prime_ext( const mbedtls_mpi *X, int rounds,
 typedef enum {
     MBEDTLS_MPI_GEN_PRIME_FLAG_DH =      0x0001, /**< (X-1)/2 is prime too */
     MBEDTLS_MPI_GEN_PRIME_FLAG_LOW_ERR = 0x0002, /**< lower error rate from 2<sup>-80</sup> to 2<sup>-128</sup> */
+    MBEDTLS_MPI_GEN_PRIME_FLAG_SINGLE =  0x0004, /**< search from a single random starting point */
 } mbedtls_mpi_gen_prime_flag_t;
 
 /**
@@ -994,6 +1102,15 @@ typedef enum {
  * \return         #MBEDTLS_ERR_MPI_ALLOC_FAILED if a memory allocation failed.
  * \return         #MBEDTLS_ERR_MPI_BAD_INPUT_DATA if `nbits` is not between
  *                 \c 3 and #MBEDTLS_MPI_MAX_BITS.
+ * \return         #MBEDTLS_ERR_MPI_NOT_ACCEPTABLE if
+ *                 #MBEDTLS_MPI_GEN_PRIME_FLAG_SINGLE is set and no prime was
+ *                 found close enough to the random starting point. The
+ *                 search is then to be retried with fresh randomness.
+ *
+ * \note           With #MBEDTLS_MPI_GEN_PRIME_FLAG_SINGLE, the result only
+ *                 depends on the first random starting point drawn from
+ *                 \p f_rng. This lets callers spread a search across
+ *                 several independent calls, for example one per thread.
  */
 int mbedtls_mpi_gen_prime( mbedtls_mpi *X, size_t nbits, int flags,
                    int (*f_rng)(void *, unsigned char *, size_t),
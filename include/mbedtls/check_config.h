@@ -73,6 +73,10 @@
 #error "MBEDTLS_AESNI_C defined, but not all prerequisites"
 #endif
 
+#if defined(MBEDTLS_BIGNUM_ADX) && !defined(MBEDTLS_HAVE_ASM)
+#error "MBEDTLS_BIGNUM_ADX defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_CTR_DRBG_C) && !defined(MBEDTLS_AES_C)
 #error "MBEDTLS_CTR_DRBG_C defined, but not all prerequisites"
 #endif
@@ -173,6 +177,54 @@
 #error "MBEDTLS_ECP_C requires a DRBG module unless MBEDTLS_ECP_NO_INTERNAL_RNG is defined or an alternative implementation is used"
 #endif
 
+#if defined(MBEDTLS_DHM_FIXED_BASE) && \
+    ( !defined(MBEDTLS_DHM_C) || defined(MBEDTLS_DHM_ALT) )
+#error "MBEDTLS_DHM_FIXED_BASE defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_ECDSA_BATCH_SIGN) && \
+    ( !defined(MBEDTLS_ECDSA_C) || defined(MBEDTLS_ECDSA_SIGN_ALT) )
+#error "MBEDTLS_ECDSA_BATCH_SIGN defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_ECDSA_BATCH_VERIFY) && \
+    ( !defined(MBEDTLS_ECDSA_C) || defined(MBEDTLS_ECDSA_VERIFY_ALT) )
+#error "MBEDTLS_ECDSA_BATCH_VERIFY defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_ECDSA_NONCE_POOL) && \
+    ( !defined(MBEDTLS_ECDSA_C) || defined(MBEDTLS_ECDSA_SIGN_ALT) )
+#error "MBEDTLS_ECDSA_NONCE_POOL defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_ECP_GLV_OPTIM) && \
+    ( !defined(MBEDTLS_ECP_C) || defined(MBEDTLS_ECP_ALT) )
+#error "MBEDTLS_ECP_GLV_OPTIM defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_ECP_MONT_FIELD_OPTIM) && \
+    ( !defined(MBEDTLS_ECP_C) || defined(MBEDTLS_ECP_ALT) || \
+      defined(MBEDTLS_ECP_INTERNAL_ALT) )
+#error "MBEDTLS_ECP_MONT_FIELD_OPTIM defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_ECP_FIXED_FIELD_OPTIM) && \
+    ( !defined(MBEDTLS_ECP_C) || !defined(MBEDTLS_ECP_NIST_OPTIM) || \
+      defined(MBEDTLS_ECP_ALT) )
+#error "MBEDTLS_ECP_FIXED_FIELD_OPTIM defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_ECP_SHARED_GROUPS) && \
+    ( !defined(MBEDTLS_ECP_C) || defined(MBEDTLS_ECP_ALT) )
+#error "MBEDTLS_ECP_SHARED_GROUPS defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_ECP_KEY_PRECOMP) && \
+    ( !defined(MBEDTLS_ECP_C) || defined(MBEDTLS_ECP_ALT) || \
+      defined(MBEDTLS_ECDSA_VERIFY_ALT) )
+#error "MBEDTLS_ECP_KEY_PRECOMP defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_PK_PARSE_C) && !defined(MBEDTLS_ASN1_PARSE_C)
 #error "MBEDTLS_PK_PARSE_C defined, but not all prerequesites"
 #endif
@@ -619,6 +671,13 @@
 #error "MBEDTLS_RSA_C defined, but none of the PKCS1 versions enabled"
 #endif
 
+#if defined(MBEDTLS_RSA_GEN_KEY_PARALLEL) &&                           \
+    ( !defined(MBEDTLS_RSA_C) || !defined(MBEDTLS_GENPRIME) ||          \
+      !defined(MBEDTLS_HMAC_DRBG_C) || !defined(MBEDTLS_SHA256_C) ||    \
+      !defined(MBEDTLS_THREADING_PTHREAD) )
+#error "MBEDTLS_RSA_GEN_KEY_PARALLEL defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_X509_RSASSA_PSS_SUPPORT) &&                        \
     ( !defined(MBEDTLS_RSA_C) || !defined(MBEDTLS_PKCS1_V21) )
 #error "MBEDTLS_X509_RSASSA_PSS_SUPPORT defined, but not all prerequisites"
@@ -822,10 +881,44 @@
 #error "MBEDTLS_X509_CRT_PARSE_C defined, but not all prerequisites"
 #endif
 
+#if defined(MBEDTLS_X509_CA_INDEX) && !defined(MBEDTLS_X509_CRT_PARSE_C)
+#error "MBEDTLS_X509_CA_INDEX defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_X509_CRT_FRAME_PARSING) && !defined(MBEDTLS_X509_CRT_PARSE_C)
+#error "MBEDTLS_X509_CRT_FRAME_PARSING defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_X509_CRT_PARSE_PATH_DEDUP) && \
+    ( !defined(MBEDTLS_X509_CRT_PARSE_C) || !defined(MBEDTLS_FS_IO) )
+#error "MBEDTLS_X509_CRT_PARSE_PATH_DEDUP defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_OID_HASH_LOOKUP) && !defined(MBEDTLS_OID_C)
+#error "MBEDTLS_OID_HASH_LOOKUP defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_X509_CRT_STORE) && !defined(MBEDTLS_X509_CRT_PARSE_C)
+#error "MBEDTLS_X509_CRT_STORE defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_X509_CRT_WRITE_TEMPLATE) && !defined(MBEDTLS_X509_CRT_WRITE_C)
+#error "MBEDTLS_X509_CRT_WRITE_TEMPLATE defined, but not all prerequisites"
+#endif
+
+#if defined(MBEDTLS_X509_CRT_CACHE_C) && ( !defined(MBEDTLS_X509_CRT_PARSE_C) || \
+    !defined(MBEDTLS_SHA256_C) )
+#error "MBEDTLS_X509_CRT_CACHE_C defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_X509_CRL_PARSE_C) && ( !defined(MBEDTLS_X509_USE_C) )
 #error "MBEDTLS_X509_CRL_PARSE_C defined, but not all prerequisites"
 #endif
 
+#if defined(MBEDTLS_X509_CRL_SERIAL_INDEX) && !defined(MBEDTLS_X509_CRL_PARSE_C)
+#error "MBEDTLS_X509_CRL_SERIAL_INDEX defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_X509_CSR_PARSE_C) && ( !defined(MBEDTLS_X509_USE_C) )
 #error "MBEDTLS_X509_CSR_PARSE_C defined, but not all prerequisites"
 #endif
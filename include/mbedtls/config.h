@@ -47,11 +47,13 @@
  *
  * Used in:
  *      library/aria.c
+ *      library/bignum.c
  *      library/timing.c
  *      include/mbedtls/bn_mul.h
  *
  * Required by:
  *      MBEDTLS_AESNI_C
+ *      MBEDTLS_BIGNUM_ADX
  *      MBEDTLS_PADLOCK_C
  *
  * Comment to disable the use of assembly code.
@@ -117,6 +119,25 @@
  */
 //#define MBEDTLS_HAVE_SSE2
 
+/**
+ * \def MBEDTLS_BIGNUM_ADX
+ *
+ * Use the MULX, ADCX and ADOX instructions (BMI2 and ADX extensions) for
+ * multi-precision multiplication on x86-64 CPUs that support them. Support
+ * is detected at runtime, so the library still works on older CPUs.
+ *
+ * This speeds up mbedtls_mpi_exp_mod(), and hence RSA and DHM private key
+ * operations, on recent Intel and AMD processors. The assembler must know
+ * these instructions (GNU binutils 2.22 or later, or a recent clang).
+ *
+ * This option has no effect on other platforms.
+ *
+ * Requires: MBEDTLS_HAVE_ASM
+ *
+ * Uncomment to enable the use of MULX, ADCX and ADOX.
+ */
+//#define MBEDTLS_BIGNUM_ADX
+
 /**
  * \def MBEDTLS_HAVE_TIME
  *
@@ -781,6 +802,64 @@
  */
 #define MBEDTLS_ECP_NIST_OPTIM
 
+/**
+ * \def MBEDTLS_ECP_GLV_OPTIM
+ *
+ * Use the efficiently computable endomorphism of secp256k1 to speed up
+ * mbedtls_ecp_muladd() on that curve (GLV method). Both scalars are split
+ * into two halves of about 128 bits, and the result is computed as a single
+ * interleaved multiplication over four points, with half as many point
+ * doublings. This speeds up ECDSA verification.
+ *
+ * The split is not constant-time, so this does not apply to
+ * mbedtls_ecp_mul(), whose scalar may be secret. It has no effect on other
+ * curves, or if MBEDTLS_ECP_DP_SECP256K1_ENABLED is not defined.
+ *
+ * Requires: MBEDTLS_ECP_C
+ *
+ * Uncomment this macro to enable the GLV method for secp256k1.
+ */
+//#define MBEDTLS_ECP_GLV_OPTIM
+
+/**
+ * \def MBEDTLS_ECP_MONT_FIELD_OPTIM
+ *
+ * Keep field elements in Montgomery form during computations on the curves
+ * that have no specific 'modulo p' routine: the Brainpool curves, and the
+ * NIST curves if MBEDTLS_ECP_NIST_OPTIM is disabled. Without this option,
+ * every multiplication modulo p on these curves is followed by a full
+ * division by p; with it, by a Montgomery reduction, which makes operations
+ * on these curves 5 to 8 times faster.
+ *
+ * Points are converted to and from Montgomery form inside the ECP module,
+ * so this does not change the results of any public function. It adds four
+ * field elements of precomputed constants to each of these groups.
+ *
+ * Requires: MBEDTLS_ECP_C
+ *
+ * Uncomment this macro to use Montgomery arithmetic for these curves.
+ */
+//#define MBEDTLS_ECP_MONT_FIELD_OPTIM
+
+/**
+ * \def MBEDTLS_ECP_FIXED_FIELD_OPTIM
+ *
+ * Use fixed-size field arithmetic for secp384r1 and secp521r1: each
+ * multiplication modulo p is done on a fixed number of limbs on the stack
+ * and immediately followed by the specific reduction for that prime,
+ * instead of going through the generic bignum functions. The reduction
+ * ends with a masked subtraction rather than with a data-dependent number
+ * of corrections.
+ *
+ * This needs a double-width integer type for the limbs (see
+ * MBEDTLS_HAVE_UDBL in bignum.h); without one, the generic code is used.
+ *
+ * Requires: MBEDTLS_ECP_C, MBEDTLS_ECP_NIST_OPTIM
+ *
+ * Uncomment this macro to use fixed-size arithmetic for these curves.
+ */
+//#define MBEDTLS_ECP_FIXED_FIELD_OPTIM
+
 /**
  * \def MBEDTLS_ECP_NO_INTERNAL_RNG
  *
@@ -828,6 +907,48 @@
  */
 //#define MBEDTLS_ECP_RESTARTABLE
 
+/**
+ * \def MBEDTLS_ECP_SHARED_GROUPS
+ *
+ * Enable a process-wide registry of ECP groups whose table of precomputed
+ * multiples of the base point is computed once and then shared, read-only,
+ * by every group loaded with mbedtls_ecp_group_load_shared().
+ *
+ * Without this option, every ECDH or ECDSA context computes its own table
+ * the first time it multiplies the base point. With it, contexts only hold
+ * a reference to the shared table, which saves time and memory per context
+ * and allows contexts on different threads to use the same table
+ * concurrently. The ECDH, ECDSA and PK modules use the registry
+ * automatically when this option is enabled.
+ *
+ * Call mbedtls_ecp_shared_groups_free() at the end of the program to
+ * release the registry.
+ *
+ * Requires: MBEDTLS_ECP_C
+ *
+ * Uncomment this macro to share base point tables between ECP groups.
+ */
+//#define MBEDTLS_ECP_SHARED_GROUPS
+
+/**
+ * \def MBEDTLS_ECP_KEY_PRECOMP
+ *
+ * Enable precomputed public keys (::mbedtls_ecp_precomp): a table of
+ * multiples of a point that is used for many scalar multiplications, such
+ * as the public key of a CA or of a peer that signs many messages, so that
+ * multiplying it costs the same as multiplying the base point.
+ *
+ * A precomputed key is used explicitly, with mbedtls_ecdsa_verify_precomp()
+ * or mbedtls_ecdsa_read_signature_with_precomp(). The PSA crypto
+ * implementation also builds one for an ECC key slot the second time it is
+ * used with psa_verify_hash(), and keeps it until the key is destroyed.
+ *
+ * Requires: MBEDTLS_ECP_C
+ *
+ * Uncomment this macro to enable precomputed public keys.
+ */
+//#define MBEDTLS_ECP_KEY_PRECOMP
+
 /**
  * \def MBEDTLS_ECDH_LEGACY_CONTEXT
  *
@@ -856,6 +977,36 @@
  */
 #define MBEDTLS_ECDH_LEGACY_CONTEXT
 
+/**
+ * \def MBEDTLS_ECDSA_BATCH_SIGN
+ *
+ * Enable mbedtls_ecdsa_sign_batch(), which makes many ECDSA signatures with
+ * the same key at once, sharing the modular inversions of the nonces and of
+ * the coordinates of the nonce points between all of them. This is useful
+ * for services that sign a large number of hashes, such as timestamping
+ * authorities. This also enables mbedtls_ecp_mul_batch().
+ *
+ * Requires: MBEDTLS_ECDSA_C
+ *
+ * Uncomment this macro to enable batch signing with ECDSA.
+ */
+//#define MBEDTLS_ECDSA_BATCH_SIGN
+
+/**
+ * \def MBEDTLS_ECDSA_BATCH_VERIFY
+ *
+ * Enable mbedtls_ecdsa_verify_batch(), which verifies many ECDSA signatures
+ * together, with a shared multi-scalar multiplication for each group of
+ * signatures instead of one double scalar multiplication per signature.
+ * This is useful for servers that check a large number of signatures.
+ * This also enables mbedtls_ecp_muladd_multi().
+ *
+ * Requires: MBEDTLS_ECDSA_C
+ *
+ * Uncomment this macro to enable batch verification of ECDSA signatures.
+ */
+//#define MBEDTLS_ECDSA_BATCH_VERIFY
+
 /**
  * \def MBEDTLS_ECDSA_DETERMINISTIC
  *
@@ -870,6 +1021,25 @@
  */
 #define MBEDTLS_ECDSA_DETERMINISTIC
 
+/**
+ * \def MBEDTLS_ECDSA_NONCE_POOL
+ *
+ * Enable pools of precomputed ECDSA nonces: see
+ * mbedtls_ecdsa_nonce_pool_fill() and mbedtls_ecdsa_sign_with_pool().
+ * A pool entry holds r = x(kG) mod n and 1/k mod n for a random k, so
+ * signing with it only takes a few operations modulo n instead of a scalar
+ * multiplication. Entries are computed ahead of time, for example on an
+ * idle or background thread, and each one is wiped once used.
+ *
+ * Signatures made from a pool are randomized, even if
+ * MBEDTLS_ECDSA_DETERMINISTIC is enabled.
+ *
+ * Requires: MBEDTLS_ECDSA_C
+ *
+ * Uncomment this macro to enable ECDSA nonce pools.
+ */
+//#define MBEDTLS_ECDSA_NONCE_POOL
+
 /**
  * \def MBEDTLS_KEY_EXCHANGE_PSK_ENABLED
  *
@@ -1174,6 +1344,25 @@
  */
 #define MBEDTLS_ERROR_STRERROR_DUMMY
 
+/**
+ * \def MBEDTLS_DHM_FIXED_BASE
+ *
+ * Enable fixed-base tables for Diffie-Hellman-Merkle groups: see
+ * mbedtls_dhm_fixed_base_setup() and mbedtls_ssl_conf_dh_fixed_base().
+ * A table holds 64 precomputed powers of the generator, which makes the
+ * computation of G^X in mbedtls_dhm_make_params() and
+ * mbedtls_dhm_make_public() about twice as fast. Since it is read-only,
+ * one table can serve all the connections using the same group.
+ *
+ * Module:  library/bignum.c
+ *          library/dhm.c
+ *
+ * Requires: MBEDTLS_DHM_C
+ *
+ * Uncomment this macro to enable fixed-base DHM tables.
+ */
+//#define MBEDTLS_DHM_FIXED_BASE
+
 /**
  * \def MBEDTLS_GENPRIME
  *
@@ -1214,6 +1403,24 @@
  */
 //#define MBEDTLS_NO_PLATFORM_ENTROPY
 
+/**
+ * \def MBEDTLS_OID_HASH_LOOKUP
+ *
+ * Look up OIDs in the tables of oid.c through the minimal perfect hashes of
+ * library/oid_hash.h instead of scanning the tables, so that each lookup
+ * compares a single entry. Certificate and CRL parsing look up every
+ * attribute type, extension and algorithm identifier.
+ *
+ * library/oid_hash.h is generated from the tables of oid.c by
+ * scripts/generate_oid_hash.py, which must be run again whenever an entry is
+ * added to one of these tables.
+ *
+ * Requires: MBEDTLS_OID_C
+ *
+ * Uncomment to enable the hashed OID lookups.
+ */
+//#define MBEDTLS_OID_HASH_LOOKUP
+
 /**
  * \def MBEDTLS_ENTROPY_FORCE_SHA256
  *
@@ -1375,6 +1582,23 @@
  */
 //#define MBEDTLS_RSA_NO_CRT
 
+/**
+ * \def MBEDTLS_RSA_GEN_KEY_PARALLEL
+ *
+ * Enable mbedtls_rsa_gen_key_parallel(), which searches for the primes of an
+ * RSA key on several threads. Each search uses its own HMAC_DRBG instance
+ * derived from a seed drawn from the caller's RNG, so the generated key
+ * only depends on that seed, whatever the number of threads.
+ *
+ * Module:  library/rsa.c
+ *
+ * Requires: MBEDTLS_RSA_C, MBEDTLS_GENPRIME, MBEDTLS_HMAC_DRBG_C,
+ *           MBEDTLS_SHA256_C, MBEDTLS_THREADING_PTHREAD
+ *
+ * Uncomment this macro to enable multi-threaded RSA key generation.
+ */
+//#define MBEDTLS_RSA_GEN_KEY_PARALLEL
+
 /**
  * \def MBEDTLS_SELF_TEST
  *
@@ -2073,6 +2297,116 @@
  */
 //#define MBEDTLS_X509_TRUSTED_CERTIFICATE_CALLBACK
 
+/**
+ * \def MBEDTLS_X509_CA_INDEX
+ *
+ * Enable the X.509 API `mbedtls_x509_crt_build_index()`, which builds a
+ * hash index over a list of trusted certificates so that chain building
+ * finds candidate parents by subject name (and subjectKeyIdentifier)
+ * instead of scanning the whole list. `mbedtls_ssl_conf_ca_chain()` builds
+ * the index automatically.
+ *
+ * This is useful with large trust stores. It costs a small allocation per
+ * indexed chain, and records the key identifier extensions of every parsed
+ * certificate.
+ *
+ * Requires: MBEDTLS_X509_CRT_PARSE_C
+ *
+ * Uncomment to enable the trusted CA index.
+ */
+//#define MBEDTLS_X509_CA_INDEX
+
+/**
+ * \def MBEDTLS_X509_CRL_SERIAL_INDEX
+ *
+ * Keep the revoked serial numbers of each parsed CRL in a sorted array, so
+ * that `mbedtls_x509_crt_is_revoked()` does a binary search instead of
+ * walking the list of entries. Also enable
+ * `mbedtls_x509_crl_parse_der_compact()` and
+ * `mbedtls_x509_crl_parse_file_compact()`, which only keep that array and
+ * skip the per-entry allocations of the list.
+ *
+ * This is useful with CRLs that revoke many certificates. It costs 8 bytes
+ * per revoked certificate.
+ *
+ * Requires: MBEDTLS_X509_CRL_PARSE_C
+ *
+ * Uncomment to enable the CRL serial number index.
+ */
+//#define MBEDTLS_X509_CRL_SERIAL_INDEX
+
+/**
+ * \def MBEDTLS_X509_CRT_FRAME_PARSING
+ *
+ * Enable `mbedtls_x509_crt_parse_der_frame()`, which parses only the frame
+ * of a certificate (validity, public key, signature and the location of
+ * everything else) and leaves the issuer and subject names and the
+ * extensions to be decoded on first use. Trusted certificates that are never
+ * considered as a parent are never decoded, which saves both parse time and
+ * the allocations of the name and extension lists.
+ *
+ * With MBEDTLS_THREADING_C, decoding is serialized by a global mutex.
+ *
+ * Requires: MBEDTLS_X509_CRT_PARSE_C
+ *
+ * Uncomment to enable frame parsing of certificates.
+ */
+//#define MBEDTLS_X509_CRT_FRAME_PARSING
+
+/**
+ * \def MBEDTLS_X509_CRT_PARSE_PATH_DEDUP
+ *
+ * Enable `mbedtls_x509_crt_parse_path_dedup()`, which loads a directory of
+ * certificate files like `mbedtls_x509_crt_parse_path()` but reads each file
+ * once even if several links point to it, drops certificates that are
+ * already in the chain, and with MBEDTLS_THREADING_PTHREAD parses the files
+ * on a pool of threads.
+ *
+ * This is useful with large c_rehash style trust store directories.
+ *
+ * Requires: MBEDTLS_X509_CRT_PARSE_C, MBEDTLS_FS_IO
+ *
+ * Uncomment to enable the de-duplicating directory loader.
+ */
+//#define MBEDTLS_X509_CRT_PARSE_PATH_DEDUP
+
+/**
+ * \def MBEDTLS_X509_CRT_STORE
+ *
+ * Enable the binary trust store format of x509_crt.h: DER certificates
+ * stored with their offsets, subject name hashes and key metadata, written
+ * by `mbedtls_x509_crt_store_write()` (see programs/x509/cert_store.c) and
+ * loaded without copying by `mbedtls_x509_crt_parse_store()`, typically
+ * from a read-only memory mapping shared by several processes.
+ *
+ * Combined with MBEDTLS_X509_CRT_FRAME_PARSING and MBEDTLS_X509_CA_INDEX,
+ * loading a store decodes no PEM, no name and no extension.
+ *
+ * Requires: MBEDTLS_X509_CRT_PARSE_C
+ *
+ * Uncomment to enable the binary trust store format.
+ */
+//#define MBEDTLS_X509_CRT_STORE
+
+/**
+ * \def MBEDTLS_X509_CRT_WRITE_TEMPLATE
+ *
+ * Enable certificate issuance templates (mbedtls_x509write_crt_template):
+ * the version, issuer, signature algorithm and extensions of a certificate
+ * write context are encoded once, and mbedtls_x509write_crt_issue_batch()
+ * issues many certificates from them, given only their serial numbers,
+ * validity periods, subject names and keys.
+ *
+ * With MBEDTLS_ECDSA_BATCH_SIGN, the certificates of a batch issued with
+ * an ECDSA key are signed together. With MBEDTLS_THREADING_PTHREAD, a
+ * batch can be divided between several threads.
+ *
+ * Requires: MBEDTLS_X509_CRT_WRITE_C
+ *
+ * Uncomment to enable certificate issuance templates.
+ */
+//#define MBEDTLS_X509_CRT_WRITE_TEMPLATE
+
 /**
  * \def MBEDTLS_X509_CHECK_KEY_USAGE
  *
@@ -3363,6 +3697,23 @@
  */
 #define MBEDTLS_X509_CRT_PARSE_C
 
+/**
+ * \def MBEDTLS_X509_CRT_CACHE_C
+ *
+ * Enable a cache of certificate chain verification results, which lets
+ * servers and clients skip the signature checks for chains they have
+ * recently verified with the same parameters. Use it with
+ * `mbedtls_x509_crt_verify_cached()` or `mbedtls_ssl_conf_verify_cache()`.
+ *
+ * Module:  library/x509_crt_cache.c
+ * Caller:  library/ssl_tls.c
+ *
+ * Requires: MBEDTLS_X509_CRT_PARSE_C, MBEDTLS_SHA256_C
+ *
+ * Uncomment to enable the verification cache.
+ */
+//#define MBEDTLS_X509_CRT_CACHE_C
+
 /**
  * \def MBEDTLS_X509_CRL_PARSE_C
  *
@@ -3720,6 +4071,8 @@
 /* X509 options */
 //#define MBEDTLS_X509_MAX_INTERMEDIATE_CA   8   /**< Maximum number of intermediate CAs in a verification chain. */
 //#define MBEDTLS_X509_MAX_FILE_PATH_LEN     512 /**< Maximum length of a path/filename string in bytes including the null terminator character ('\0'). */
+//#define MBEDTLS_X509_CRT_CACHE_DEFAULT_TIMEOUT      300 /**< Verification cache entry timeout in seconds (5 minutes). */
+//#define MBEDTLS_X509_CRT_CACHE_DEFAULT_MAX_ENTRIES  128 /**< Maximum entries in the verification cache. */
 
 /**
  * Allow SHA-1 in the default TLS configuration for certificate signing.
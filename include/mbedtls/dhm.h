@@ -94,6 +94,18 @@ extern "C" {
 
 #if !defined(MBEDTLS_DHM_ALT)
 
+#if defined(MBEDTLS_DHM_FIXED_BASE)
+/**
+ * \brief          Precomputed powers of the generator of a DHM group,
+ *                 see mbedtls_dhm_fixed_base_setup().
+ */
+typedef struct mbedtls_dhm_fixed_base
+{
+    mbedtls_mpi_exp_table table;    /*!<  The powers of \c G modulo \c P. */
+}
+mbedtls_dhm_fixed_base;
+#endif /* MBEDTLS_DHM_FIXED_BASE */
+
 /**
  * \brief          The DHM context structure.
  */
@@ -110,6 +122,9 @@ typedef struct mbedtls_dhm_context
     mbedtls_mpi Vi;     /*!<  The blinding value. */
     mbedtls_mpi Vf;     /*!<  The unblinding value. */
     mbedtls_mpi pX;     /*!<  The previous \c X. */
+#if defined(MBEDTLS_DHM_FIXED_BASE)
+    const mbedtls_dhm_fixed_base *fb; /*!<  The powers of \c G, or \c NULL. */
+#endif
 }
 mbedtls_dhm_context;
 
@@ -295,6 +310,66 @@ int mbedtls_dhm_calc_secret( mbedtls_dhm_context *ctx,
  */
 void mbedtls_dhm_free( mbedtls_dhm_context *ctx );
 
+#if defined(MBEDTLS_DHM_FIXED_BASE)
+/**
+ * \brief          This function initializes a DHM fixed-base table.
+ *
+ * \param fb       The table to initialize. This must not be \c NULL.
+ */
+void mbedtls_dhm_fixed_base_init( mbedtls_dhm_fixed_base *fb );
+
+/**
+ * \brief          This function precomputes the powers of the generator
+ *                 \p G modulo \p P that speed up the computation of
+ *                 \c G^X mod \c P in mbedtls_dhm_make_params() and
+ *                 mbedtls_dhm_make_public().
+ *
+ *                 The table is only read once it is set up, so it can be
+ *                 attached with mbedtls_dhm_set_fixed_base() to any number
+ *                 of contexts using the same group, including contexts used
+ *                 by different threads, e.g. with
+ *                 mbedtls_ssl_conf_dh_fixed_base().
+ *
+ * \note           The table takes 64 times the size of \p P.
+ *
+ * \param fb       The table to set up. This must be initialized.
+ * \param P        The prime modulus. This must point to an initialized MPI.
+ * \param G        The generator. This must point to an initialized MPI.
+ *
+ * \return         \c 0 on success.
+ * \return         An \c MBEDTLS_ERR_DHM_XXX error code on failure.
+ */
+int mbedtls_dhm_fixed_base_setup( mbedtls_dhm_fixed_base *fb,
+                                  const mbedtls_mpi *P,
+                                  const mbedtls_mpi *G );
+
+/**
+ * \brief          This function attaches a fixed-base table to a DHM
+ *                 context.
+ *
+ *                 The table is only used while the group of the context is
+ *                 the one the table was set up for. Otherwise,
+ *                 mbedtls_dhm_make_params() and mbedtls_dhm_make_public()
+ *                 fall back to a generic exponentiation.
+ *
+ * \param ctx      The DHM context. This must be initialized.
+ * \param fb       The table to use, set up with
+ *                 mbedtls_dhm_fixed_base_setup(), or \c NULL to stop using
+ *                 a table. The table is not copied: it must remain valid
+ *                 until the context is freed or another table is attached.
+ */
+void mbedtls_dhm_set_fixed_base( mbedtls_dhm_context *ctx,
+                                 const mbedtls_dhm_fixed_base *fb );
+
+/**
+ * \brief          This function frees a DHM fixed-base table.
+ *
+ * \param fb       The table to free. This may be \c NULL, in which case
+ *                 this function is a no-op.
+ */
+void mbedtls_dhm_fixed_base_free( mbedtls_dhm_fixed_base *fb );
+#endif /* MBEDTLS_DHM_FIXED_BASE */
+
 #if defined(MBEDTLS_ASN1_PARSE_C)
 /**
  * \brief             This function parses DHM parameters in PEM or DER format.
@@ -39,6 +39,10 @@
 #include "mbedtls/ecp.h"
 #include "mbedtls/md.h"
 
+#if defined(MBEDTLS_ECDSA_NONCE_POOL) && defined(MBEDTLS_THREADING_C)
+#include "mbedtls/threading.h"
+#endif
+
 /**
  * \brief           Maximum ECDSA signature size for a given curve bit size
  *
@@ -77,6 +81,52 @@ extern "C" {
  */
 typedef mbedtls_ecp_keypair mbedtls_ecdsa_context;
 
+#if defined(MBEDTLS_ECDSA_NONCE_POOL)
+/**
+ * \brief           A pool of precomputed nonces for ECDSA signatures on
+ *                  one curve.
+ *
+ *                  Each entry holds r = x(kG) mod n and 1/k mod n for a
+ *                  random k, which is all a signature needs that depends
+ *                  neither on the message nor on the key. Entries are
+ *                  removed from the pool when they are used.
+ *
+ * \note            If #MBEDTLS_THREADING_C is enabled, entries can be
+ *                  taken from a pool by several threads while another
+ *                  thread fills it.
+ */
+typedef struct mbedtls_ecdsa_nonce_pool
+{
+    mbedtls_ecp_group grp;      /*!< The curve of the nonces. */
+    size_t size;                /*!< The maximum number of entries. */
+    size_t count;               /*!< The number of unused entries. */
+    mbedtls_mpi *r;             /*!< The values of r for each entry. */
+    mbedtls_mpi *kinv;          /*!< The values of 1/k for each entry. */
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_threading_mutex_t mutex;    /*!< Protects count and the entries. */
+#endif
+}
+mbedtls_ecdsa_nonce_pool;
+#endif /* MBEDTLS_ECDSA_NONCE_POOL */
+
+#if defined(MBEDTLS_ECDSA_BATCH_VERIFY)
+/**
+ * \brief           One signature to check with mbedtls_ecdsa_verify_batch().
+ */
+typedef struct mbedtls_ecdsa_batch_item
+{
+    const unsigned char *buf;   /*!< The hashed message. */
+    size_t blen;                /*!< The length of \c buf in Bytes. */
+    const mbedtls_ecp_point *Q; /*!< The public key. */
+    const mbedtls_mpi *r;       /*!< The first integer of the signature. */
+    const mbedtls_mpi *s;       /*!< The second integer of the signature. */
+    int result;                 /*!< Output: \c 0 if the signature is valid,
+                                     otherwise the error code that
+                                     mbedtls_ecdsa_verify() returns for it. */
+}
+mbedtls_ecdsa_batch_item;
+#endif /* MBEDTLS_ECDSA_BATCH_VERIFY */
+
 #if defined(MBEDTLS_ECP_RESTARTABLE)
 
 /**
@@ -173,6 +223,50 @@ int mbedtls_ecdsa_sign( mbedtls_ecp_group *grp, mbedtls_mpi *r, mbedtls_mpi *s,
                 const mbedtls_mpi *d, const unsigned char *buf, size_t blen,
                 int (*f_rng)(void *, unsigned char *, size_t), void *p_rng );
 
+#if defined(MBEDTLS_ECDSA_BATCH_SIGN)
+/**
+ * \brief           This function computes the ECDSA signatures of several
+ *                  previously-hashed messages with the same key.
+ *
+ *                  The result is the same as calling mbedtls_ecdsa_sign()
+ *                  for each message, but the nonce points are computed with
+ *                  mbedtls_ecp_mul_batch() and the nonces are inverted all
+ *                  at once, so that the batch needs only one inversion
+ *                  modulo the order of the group and one modulo its prime.
+ *
+ * \note            The nonces are always random, even if
+ *                  MBEDTLS_ECDSA_DETERMINISTIC is enabled.
+ *
+ * \param grp       The context for the elliptic curve to use.
+ *                  This must be initialized and have group parameters
+ *                  set, for example through mbedtls_ecp_group_load().
+ * \param r         The array of \p count MPIs in which to store the first
+ *                  part of each signature. Each one must be initialized.
+ * \param s         The array of \p count MPIs in which to store the second
+ *                  part of each signature. Each one must be initialized.
+ * \param d         The private signing key. This must be initialized.
+ * \param buf       The hashes to sign, one after the other. This must be a
+ *                  readable buffer of length \p count * \p blen Bytes. It
+ *                  may be \c NULL if \p count or \p blen is zero.
+ * \param blen      The length of each hash in \p buf in Bytes.
+ * \param count     The number of hashes to sign.
+ * \param f_rng     The RNG function. This must not be \c NULL.
+ * \param p_rng     The RNG context to be passed to \p f_rng. This may be
+ *                  \c NULL if \p f_rng doesn't need a context parameter.
+ *
+ * \return          \c 0 on success.
+ * \return          An \c MBEDTLS_ERR_ECP_XXX
+ *                  or \c MBEDTLS_MPI_XXX error code on failure.
+ */
+int mbedtls_ecdsa_sign_batch( mbedtls_ecp_group *grp,
+                              mbedtls_mpi *r, mbedtls_mpi *s,
+                              const mbedtls_mpi *d,
+                              const unsigned char *buf, size_t blen,
+                              size_t count,
+                              int (*f_rng)(void *, unsigned char *, size_t),
+                              void *p_rng );
+#endif /* MBEDTLS_ECDSA_BATCH_SIGN */
+
 #if defined(MBEDTLS_ECDSA_DETERMINISTIC)
 #if ! defined(MBEDTLS_DEPRECATED_REMOVED)
 #if defined(MBEDTLS_DEPRECATED_WARNING)
@@ -319,6 +413,86 @@ int mbedtls_ecdsa_verify( mbedtls_ecp_group *grp,
                           const mbedtls_ecp_point *Q, const mbedtls_mpi *r,
                           const mbedtls_mpi *s);
 
+#if defined(MBEDTLS_ECDSA_BATCH_VERIFY)
+/**
+ * \brief           This function verifies a batch of ECDSA signatures,
+ *                  possibly made with different keys, on the same curve.
+ *
+ *                  Signatures are checked together in small groups, with a
+ *                  single multi-scalar multiplication for each group, see
+ *                  mbedtls_ecp_muladd_multi(). If a group does not pass, its
+ *                  signatures are verified one by one to find out which
+ *                  ones are invalid, so the result of each signature is the
+ *                  same as with mbedtls_ecdsa_verify().
+ *
+ * \note            The group check is probabilistic: a group containing an
+ *                  invalid signature passes with probability less than
+ *                  2^-120. It relies on \p f_rng, which must be a
+ *                  cryptographically secure random generator that the
+ *                  signers cannot predict.
+ *
+ * \note            On curves where p is not 3 mod 4 (such as secp224r1),
+ *                  and for groups where it fails, the signatures are
+ *                  verified one by one. A batch with many invalid
+ *                  signatures is thus slower than individual verification.
+ *
+ * \param grp       The ECP group to use.
+ *                  This must be initialized and have group parameters
+ *                  set, for example through mbedtls_ecp_group_load().
+ * \param items     The array of \p count signatures to verify. The
+ *                  \c result field of each item is set on return, unless
+ *                  an error other than #MBEDTLS_ERR_ECP_VERIFY_FAILED
+ *                  is returned.
+ * \param count     The number of signatures in \p items.
+ * \param f_rng     The RNG function. This must not be \c NULL.
+ * \param p_rng     The RNG context to be passed to \p f_rng. This may be
+ *                  \c NULL if \p f_rng doesn't need a context parameter.
+ *
+ * \return          \c 0 if all the signatures are valid.
+ * \return          #MBEDTLS_ERR_ECP_VERIFY_FAILED if at least one signature
+ *                  is invalid: see the \c result field of the items.
+ * \return          An \c MBEDTLS_ERR_ECP_XXX or \c MBEDTLS_MPI_XXX
+ *                  error code on failure for any other reason.
+ */
+int mbedtls_ecdsa_verify_batch( mbedtls_ecp_group *grp,
+                                mbedtls_ecdsa_batch_item *items, size_t count,
+                                int (*f_rng)(void *, unsigned char *, size_t),
+                                void *p_rng );
+#endif /* MBEDTLS_ECDSA_BATCH_VERIFY */
+
+#if defined(MBEDTLS_ECP_KEY_PRECOMP)
+/**
+ * \brief           This function verifies the ECDSA signature of a
+ *                  previously-hashed message with a precomputed public key.
+ *
+ *                  This gives the same result as mbedtls_ecdsa_verify() with
+ *                  the group and the point of \p pre, but is faster because
+ *                  both scalar multiplications use precomputed tables.
+ *
+ * \see             mbedtls_ecp_precomp_setup()
+ *
+ * \param pre       The precomputed public key to use for verification. This
+ *                  must have been set up with mbedtls_ecp_precomp_setup().
+ * \param buf       The hashed content that was signed. This must be a readable
+ *                  buffer of length \p blen Bytes. It may be \c NULL if
+ *                  \p blen is zero.
+ * \param blen      The length of \p buf in Bytes.
+ * \param r         The first integer of the signature.
+ *                  This must be initialized.
+ * \param s         The second integer of the signature.
+ *                  This must be initialized.
+ *
+ * \return          \c 0 on success.
+ * \return          #MBEDTLS_ERR_ECP_VERIFY_FAILED if the signature
+ *                  is invalid.
+ * \return          An \c MBEDTLS_ERR_ECP_XXX or \c MBEDTLS_MPI_XXX
+ *                  error code on failure for any other reason.
+ */
+int mbedtls_ecdsa_verify_precomp( mbedtls_ecp_precomp *pre,
+                                  const unsigned char *buf, size_t blen,
+                                  const mbedtls_mpi *r, const mbedtls_mpi *s );
+#endif /* MBEDTLS_ECP_KEY_PRECOMP */
+
 /**
  * \brief           This function computes the ECDSA signature and writes it
  *                  to a buffer, serialized as defined in <em>RFC-4492:
@@ -546,6 +720,39 @@ int mbedtls_ecdsa_read_signature_restartable( mbedtls_ecdsa_context *ctx,
                           const unsigned char *sig, size_t slen,
                           mbedtls_ecdsa_restart_ctx *rs_ctx );
 
+#if defined(MBEDTLS_ECP_KEY_PRECOMP)
+/**
+ * \brief           This function reads and verifies an ECDSA signature
+ *                  with a precomputed public key.
+ *
+ *                  This gives the same result as
+ *                  mbedtls_ecdsa_read_signature() with the group and the
+ *                  point of \p pre, but uses mbedtls_ecdsa_verify_precomp()
+ *                  for the verification.
+ *
+ * \see             mbedtls_ecdsa_verify_precomp()
+ *
+ * \param pre       The precomputed public key to use for verification. This
+ *                  must have been set up with mbedtls_ecp_precomp_setup().
+ * \param hash      The message hash that was signed. This must be a readable
+ *                  buffer of length \p hlen Bytes.
+ * \param hlen      The size of the hash \p hash.
+ * \param sig       The signature to read and verify. This must be a readable
+ *                  buffer of length \p slen Bytes.
+ * \param slen      The size of \p sig in Bytes.
+ *
+ * \return          \c 0 on success.
+ * \return          #MBEDTLS_ERR_ECP_BAD_INPUT_DATA if signature is invalid.
+ * \return          #MBEDTLS_ERR_ECP_SIG_LEN_MISMATCH if there is a valid
+ *                  signature in \p sig, but its length is less than \p slen.
+ * \return          An \c MBEDTLS_ERR_ECP_XXX or \c MBEDTLS_ERR_MPI_XXX
+ *                  error code on failure for any other reason.
+ */
+int mbedtls_ecdsa_read_signature_with_precomp( mbedtls_ecp_precomp *pre,
+                          const unsigned char *hash, size_t hlen,
+                          const unsigned char *sig, size_t slen );
+#endif /* MBEDTLS_ECP_KEY_PRECOMP */
+
 /**
  * \brief          This function generates an ECDSA keypair on the given curve.
  *
@@ -600,6 +807,170 @@ void mbedtls_ecdsa_init( mbedtls_ecdsa_context *ctx );
  */
 void mbedtls_ecdsa_free( mbedtls_ecdsa_context *ctx );
 
+#if defined(MBEDTLS_ECDSA_NONCE_POOL)
+/**
+ * \brief           This function initializes an ECDSA nonce pool.
+ *
+ * \param pool      The pool to initialize. This must not be \c NULL.
+ */
+void mbedtls_ecdsa_nonce_pool_init( mbedtls_ecdsa_nonce_pool *pool );
+
+/**
+ * \brief           This function sets up an empty ECDSA nonce pool.
+ *
+ * \param pool      The pool to set up. This must be initialized.
+ * \param gid       The curve that the nonces will be used with.
+ * \param size      The maximum number of entries in the pool.
+ *                  This must not be \c 0.
+ *
+ * \return          \c 0 on success.
+ * \return          #MBEDTLS_ERR_ECP_ALLOC_FAILED on allocation failure.
+ * \return          #MBEDTLS_ERR_ECP_BAD_INPUT_DATA if \p size is \c 0 or
+ *                  if \p gid can't be used for ECDSA.
+ * \return          Another \c MBEDTLS_ERR_ECP_XXX error code on failure.
+ */
+int mbedtls_ecdsa_nonce_pool_setup( mbedtls_ecdsa_nonce_pool *pool,
+                                    mbedtls_ecp_group_id gid, size_t size );
+
+/**
+ * \brief           This function computes new entries for an ECDSA nonce
+ *                  pool, until it holds \p count more entries or it is
+ *                  full.
+ *
+ *                  This does the expensive part of signing, so it is meant
+ *                  to be called when the application is idle, or from a
+ *                  background thread.
+ *
+ * \note            The pool is only locked while an entry is added, so
+ *                  entries can be taken from it while it is being filled.
+ *                  However, two threads must not fill the same pool at the
+ *                  same time.
+ *
+ * \param pool      The pool to fill. This must be set up.
+ * \param count     The maximum number of entries to add.
+ * \param f_rng     The RNG function used to generate the nonces.
+ *                  This must not be \c NULL.
+ * \param p_rng     The RNG context to be passed to \p f_rng. This may be
+ *                  \c NULL if \p f_rng doesn't need a context parameter.
+ *
+ * \return          \c 0 on success.
+ * \return          An \c MBEDTLS_ERR_ECP_XXX, \c MBEDTLS_ERR_MPI_XXX or
+ *                  \c MBEDTLS_ERR_THREADING_XXX error code on failure.
+ */
+int mbedtls_ecdsa_nonce_pool_fill( mbedtls_ecdsa_nonce_pool *pool,
+                                   size_t count,
+                                   int (*f_rng)(void *, unsigned char *, size_t),
+                                   void *p_rng );
+
+/**
+ * \brief           This function queries the number of unused entries of
+ *                  an ECDSA nonce pool.
+ *
+ * \param pool      The pool to query. This must be set up.
+ * \param count     The address at which to store the number of entries
+ *                  left in the pool. This must not be \c NULL.
+ *
+ * \return          \c 0 on success.
+ * \return          #MBEDTLS_ERR_THREADING_MUTEX_ERROR if the pool can't be
+ *                  locked or unlocked.
+ */
+int mbedtls_ecdsa_nonce_pool_count( mbedtls_ecdsa_nonce_pool *pool,
+                                    size_t *count );
+
+/**
+ * \brief           This function frees an ECDSA nonce pool, wiping the
+ *                  entries that were not used.
+ *
+ * \param pool      The pool to free. This may be \c NULL, in which case
+ *                  this function does nothing.
+ */
+void mbedtls_ecdsa_nonce_pool_free( mbedtls_ecdsa_nonce_pool *pool );
+
+/**
+ * \brief           This function computes the ECDSA signature of a
+ *                  previously-hashed message, with a nonce taken from a
+ *                  pool.
+ *
+ *                  If \p pool is empty or is for another curve than \p grp,
+ *                  this function behaves like mbedtls_ecdsa_sign().
+ *
+ * \param grp       The context for the elliptic curve to use.
+ *                  This must be initialized and have group parameters
+ *                  set, for example through mbedtls_ecp_group_load().
+ * \param r         The MPI context in which to store the first part
+ *                  the signature. This must be initialized.
+ * \param s         The MPI context in which to store the second part
+ *                  the signature. This must be initialized.
+ * \param d         The private signing key. This must be initialized.
+ * \param buf       The hashed content to be signed. This must be a readable
+ *                  buffer of length \p blen Bytes. It may be \c NULL if
+ *                  \p blen is zero.
+ * \param blen      The length of \p buf in Bytes.
+ * \param pool      The nonce pool. This must be set up.
+ * \param f_rng     The RNG function, used if \p pool can't be used.
+ *                  This must not be \c NULL.
+ * \param p_rng     The RNG context to be passed to \p f_rng. This may be
+ *                  \c NULL if \p f_rng doesn't need a context parameter.
+ *
+ * \return          \c 0 on success.
+ * \return          An \c MBEDTLS_ERR_ECP_XXX, \c MBEDTLS_MPI_XXX
+ *                  or \c MBEDTLS_ERR_THREADING_XXX error code on failure.
+ */
+int mbedtls_ecdsa_sign_with_pool( mbedtls_ecp_group *grp,
+                                  mbedtls_mpi *r, mbedtls_mpi *s,
+                                  const mbedtls_mpi *d,
+                                  const unsigned char *buf, size_t blen,
+                                  mbedtls_ecdsa_nonce_pool *pool,
+                                  int (*f_rng)(void *, unsigned char *, size_t),
+                                  void *p_rng );
+
+/**
+ * \brief           This function computes the ECDSA signature and writes it
+ *                  to a buffer, in the same format as
+ *                  mbedtls_ecdsa_write_signature(), with a nonce taken from
+ *                  a pool.
+ *
+ *                  If \p pool is empty or is for another curve than \p ctx,
+ *                  this function behaves like mbedtls_ecdsa_write_signature().
+ *
+ * \note            Several contexts with keys on the same curve can use the
+ *                  same pool.
+ *
+ * \param ctx       The ECDSA context to use. This must be initialized
+ *                  and have a group and private key bound to it, for example
+ *                  via mbedtls_ecdsa_genkey() or mbedtls_ecdsa_from_keypair().
+ * \param md_alg    The message digest that was used to hash the message.
+ * \param hash      The message hash to be signed. This must be a readable
+ *                  buffer of length \p blen Bytes.
+ * \param hlen      The length of the hash \p hash in Bytes.
+ * \param sig       The buffer to which to write the signature. This must be a
+ *                  writable buffer of length at least twice as large as the
+ *                  size of the curve used, plus 9. For example, 73 Bytes if
+ *                  a 256-bit curve is used. A buffer length of
+ *                  #MBEDTLS_ECDSA_MAX_LEN is always safe.
+ * \param slen      The address at which to store the actual length of
+ *                  the signature written. Must not be \c NULL.
+ * \param pool      The nonce pool. This must be set up.
+ * \param f_rng     The RNG function, used if \p pool can't be used.
+ *                  This must not be \c NULL if
+ *                  #MBEDTLS_ECDSA_DETERMINISTIC is unset.
+ * \param p_rng     The RNG context to be passed to \p f_rng. This may be
+ *                  \c NULL if \p f_rng is \c NULL or doesn't use a context.
+ *
+ * \return          \c 0 on success.
+ * \return          An \c MBEDTLS_ERR_ECP_XXX, \c MBEDTLS_ERR_MPI_XXX,
+ *                  \c MBEDTLS_ERR_ASN1_XXX or \c MBEDTLS_ERR_THREADING_XXX
+ *                  error code on failure.
+ */
+int mbedtls_ecdsa_write_signature_with_pool( mbedtls_ecdsa_context *ctx,
+                                 mbedtls_md_type_t md_alg,
+                                 const unsigned char *hash, size_t hlen,
+                                 unsigned char *sig, size_t *slen,
+                                 mbedtls_ecdsa_nonce_pool *pool,
+                                 int (*f_rng)(void *, unsigned char *, size_t),
+                                 void *p_rng );
+#endif /* MBEDTLS_ECDSA_NONCE_POOL */
+
 #if defined(MBEDTLS_ECP_RESTARTABLE)
 /**
  * \brief           Initialize a restart context.
@@ -207,6 +207,16 @@ mbedtls_ecp_point;
  * additions or subtractions. Therefore, it is only an approximative modular
  * reduction. It must return 0 on success and non-zero on failure.
  *
+ * If #MBEDTLS_ECP_MONT_FIELD_OPTIM is enabled, the Short Weierstrass groups
+ * loaded with mbedtls_ecp_group_load() that have no \p modp function keep
+ * the coordinates of their points in Montgomery form during computations.
+ * This is invisible to the callers of the public functions.
+ *
+ * If #MBEDTLS_ECP_FIXED_FIELD_OPTIM is enabled, \p modmul may point to a
+ * function that computes the product of two integers in the range
+ * <code>0..P-1</code> modulo \p P, fully reduced. It must return 0 on success
+ * and non-zero on failure.
+ *
  * \note        Alternative implementations must keep the group IDs distinct. If
  *              two group structures have the same ID, then they must be
  *              identical.
@@ -233,7 +243,23 @@ typedef struct mbedtls_ecp_group
     int (*t_post)(mbedtls_ecp_point *, void *); /*!< Unused. */
     void *t_data;               /*!< Unused. */
     mbedtls_ecp_point *T;       /*!< Pre-computed points for ecp_mul_comb(). */
-    size_t T_size;              /*!< The number of pre-computed points. */
+    size_t T_size;              /*!< The number of pre-computed points, or
+                                     0 if \p T is not owned by the group. */
+#if defined(MBEDTLS_ECP_MONT_FIELD_OPTIM)
+    mbedtls_mpi_uint mont_mm;   /*!< \internal The Montgomery constant for
+                                     \p P if the internal arithmetic keeps
+                                     field elements in Montgomery form,
+                                     or 0. */
+    mbedtls_mpi mont_RR;        /*!< \internal R^2 mod \p P. */
+    mbedtls_mpi mont_one;       /*!< \internal 1 in Montgomery form. */
+    mbedtls_mpi mont_A;         /*!< \internal \p A in Montgomery form. */
+    mbedtls_mpi mont_B;         /*!< \internal \p B in Montgomery form. */
+#endif
+#if defined(MBEDTLS_ECP_FIXED_FIELD_OPTIM)
+    int (*modmul)(mbedtls_mpi *, const mbedtls_mpi *, const mbedtls_mpi *);
+                                /*!< \internal The function for fixed-size
+                                     multiplication mod \p P, or NULL. */
+#endif
 }
 mbedtls_ecp_group;
 
@@ -324,6 +350,13 @@ typedef struct
     unsigned depth;                     /*!<  call depth (0 = top-level)    */
     mbedtls_ecp_restart_mul_ctx *rsm;   /*!<  ecp_mul_comb() sub-context    */
     mbedtls_ecp_restart_muladd_ctx *ma; /*!<  ecp_muladd() sub-context      */
+    uint64_t time_start;                /*!<  start of the current call     */
+    uint64_t time_last;                 /*!<  duration of the last call, in
+                                              microseconds                  */
+    uint64_t time_max;                  /*!<  longest call, in microseconds */
+    uint64_t time_total;                /*!<  total of all calls, in
+                                              microseconds                  */
+    unsigned calls;                     /*!<  number of top-level calls     */
 } mbedtls_ecp_restart_ctx;
 
 /*
@@ -349,6 +382,24 @@ int mbedtls_ecp_check_budget( const mbedtls_ecp_group *grp,
                               mbedtls_ecp_restart_ctx *rs_ctx,
                               unsigned ops );
 
+/**
+ * \brief           Internal; for restartable functions in other modules.
+ *                  Enter a function that may yield. For a top-level call,
+ *                  reset the ops count and record the start time.
+ *
+ * \param rs_ctx    Restart context, or NULL (no-op).
+ */
+void mbedtls_ecp_restart_enter( mbedtls_ecp_restart_ctx *rs_ctx );
+
+/**
+ * \brief           Internal; for restartable functions in other modules.
+ *                  Leave a function entered with mbedtls_ecp_restart_enter().
+ *                  For a top-level call, update the time statistics.
+ *
+ * \param rs_ctx    Restart context, or NULL (no-op).
+ */
+void mbedtls_ecp_restart_leave( mbedtls_ecp_restart_ctx *rs_ctx );
+
 /* Utility macro for checking and updating ops budget */
 #define MBEDTLS_ECP_BUDGET( ops )   \
     MBEDTLS_MPI_CHK( mbedtls_ecp_check_budget( grp, rs_ctx, \
@@ -363,6 +414,27 @@ typedef void mbedtls_ecp_restart_ctx;
 
 #endif /* MBEDTLS_ECP_RESTARTABLE */
 
+#if defined(MBEDTLS_ECP_KEY_PRECOMP)
+/**
+ * \brief    A precomputed point, such as a long-term public key.
+ *
+ * It holds a copy of the point with a table of its multiples, next to a
+ * group whose table for the base point is filled, so that computing
+ * m * G + n * Q takes two fixed-base multiplications. It is not modified
+ * by mbedtls_ecp_muladd_precomp(), so once set up it may be used by
+ * several threads at the same time.
+ */
+typedef struct mbedtls_ecp_precomp
+{
+    mbedtls_ecp_group grp;      /*!<  The group, with its base point table */
+    mbedtls_ecp_point Q;        /*!<  The precomputed point             */
+    unsigned char w;            /*!<  The window size of \c T           */
+    unsigned char T_size;       /*!<  The number of points in \c T      */
+    mbedtls_ecp_point *T;       /*!<  The multiples of \c Q             */
+}
+mbedtls_ecp_precomp;
+#endif /* MBEDTLS_ECP_KEY_PRECOMP */
+
 /**
  * \brief    The ECP key-pair structure.
  *
@@ -451,9 +523,47 @@ mbedtls_ecp_keypair;
 void mbedtls_ecp_set_max_ops( unsigned max_ops );
 
 /**
- * \brief           Check if restart is enabled (max_ops != 0)
+ * \brief           Set the maximum time spent in a row in restartable
+ *                  functions, and the clock used to measure it.
+ *
+ *                  This works like mbedtls_ecp_set_max_ops(), with a budget
+ *                  in microseconds instead of basic operations. Within each
+ *                  call, the time taken by a basic operation is measured as
+ *                  the computation goes, and the function returns
+ *                  #MBEDTLS_ERR_ECP_IN_PROGRESS before a step that would be
+ *                  expected to exceed the budget. If both budgets are set,
+ *                  the first one to run out applies.
+ *
+ *                  When \p f_clock is set, the duration of each call is also
+ *                  recorded in the restart context: see \c time_last,
+ *                  \c time_max, \c time_total and \c calls in
+ *                  ::mbedtls_ecp_restart_ctx. These are reset by
+ *                  mbedtls_ecp_restart_init() and mbedtls_ecp_restart_free().
+ *
+ * \param max_us    Maximum time spent in a row, in microseconds.
+ *                  Default: 0 (unlimited).
+ * \param f_clock   A function returning a monotonic time in microseconds,
+ *                  or NULL to disable the time budget and statistics.
+ * \param p_clock   The context passed to \p f_clock.
+ *
+ * \note            As with mbedtls_ecp_set_max_ops(), at least one step is
+ *                  always performed per call, and each step has a minimum
+ *                  size that depends on the curve, so very low values are
+ *                  not always respected. The time spent outside the ECP and
+ *                  ECDSA modules, for example hashing in the caller, is not
+ *                  counted.
+ *
+ * \note            This setting is currently ignored by Curve25519.
+ */
+void mbedtls_ecp_set_max_time( uint64_t max_us,
+                               uint64_t (*f_clock)( void * ),
+                               void *p_clock );
+
+/**
+ * \brief           Check if restart is enabled (max_ops != 0, or a time
+ *                  budget is set)
  *
- * \return          \c 0 if \c max_ops == 0 (restart disabled)
+ * \return          \c 0 if neither budget is set (restart disabled)
  * \return          \c 1 otherwise (restart enabled)
  */
 int mbedtls_ecp_restart_is_enabled( void );
@@ -614,6 +724,10 @@ int mbedtls_ecp_copy( mbedtls_ecp_point *P, const mbedtls_ecp_point *Q );
  * \brief           This function copies the contents of group \p src into
  *                  group \p dst.
  *
+ * \note            If \p src references a shared table of precomputed
+ *                  points (see mbedtls_ecp_group_load_shared()), so
+ *                  does \p dst.
+ *
  * \param dst       The destination group. This must be initialized.
  * \param src       The source group. This must be initialized.
  *
@@ -800,6 +914,46 @@ int mbedtls_ecp_tls_write_point( const mbedtls_ecp_group *grp,
  */
 int mbedtls_ecp_group_load( mbedtls_ecp_group *grp, mbedtls_ecp_group_id id );
 
+#if defined(MBEDTLS_ECP_SHARED_GROUPS)
+/**
+ * \brief           This function sets up an ECP group context
+ *                  from a standardized set of domain parameters, and
+ *                  attaches the process-wide precomputed table for
+ *                  multiples of the base point.
+ *
+ *                  The table for a given curve is computed by the first
+ *                  call for this curve and kept until
+ *                  mbedtls_ecp_shared_groups_free() is called. Groups set
+ *                  up this way are not modified by mbedtls_ecp_mul() or
+ *                  mbedtls_ecp_muladd(), so that contexts on different
+ *                  threads may use the shared table at the same time.
+ *
+ * \note            For curves without a table (Montgomery curves, or when
+ *                  #MBEDTLS_ECP_FIXED_POINT_OPTIM is 0), this function is
+ *                  equivalent to mbedtls_ecp_group_load().
+ *
+ * \param grp       The group context to setup. This must be initialized.
+ * \param id        The identifier of the domain parameter set to load.
+ *
+ * \return          \c 0 on success.
+ * \return          #MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE if \p id doesn't
+ *                  correspond to a known group.
+ * \return          Another negative error code on other kinds of failure.
+ */
+int mbedtls_ecp_group_load_shared( mbedtls_ecp_group *grp,
+                                   mbedtls_ecp_group_id id );
+
+/**
+ * \brief           This function frees the tables held by the process-wide
+ *                  registry of shared groups.
+ *
+ * \warning         No group set up by mbedtls_ecp_group_load_shared() may
+ *                  be used after this call. Such groups may still be freed
+ *                  with mbedtls_ecp_group_free().
+ */
+void mbedtls_ecp_shared_groups_free( void );
+#endif /* MBEDTLS_ECP_SHARED_GROUPS */
+
 /**
  * \brief           This function sets up an ECP group context from a TLS
  *                  ECParameters record as defined in RFC 4492, Section 5.4.
@@ -1023,6 +1177,185 @@ int mbedtls_ecp_muladd_restartable(
              const mbedtls_mpi *m, const mbedtls_ecp_point *P,
              const mbedtls_mpi *n, const mbedtls_ecp_point *Q,
              mbedtls_ecp_restart_ctx *rs_ctx );
+
+#if defined(MBEDTLS_ECDSA_BATCH_VERIFY)
+/**
+ * \brief           This function performs a multi-scalar multiplication:
+ *                  \p R = \p m[0] * \p P[0] + ... +
+ *                  \p m[count-1] * \p P[count-1]
+ *
+ *                  All the terms share a single chain of point doublings
+ *                  (Straus' method with interleaved width-w NAFs), so that
+ *                  computing a sum of \p count products costs much less than
+ *                  \p count calls to mbedtls_ecp_mul() or
+ *                  mbedtls_ecp_muladd(). This is the building block of
+ *                  mbedtls_ecdsa_verify_batch().
+ *
+ * \note            This function only reads \p grp: it doesn't use or fill
+ *                  the table for the base point. Several threads may call
+ *                  it with the same \p grp at the same time if no other
+ *                  thread writes to \p grp, for example with a group set up
+ *                  by mbedtls_ecp_group_load_shared() that is only used with
+ *                  mbedtls_ecp_mul(), mbedtls_ecp_muladd() and this
+ *                  function.
+ *
+ * \note            If #MBEDTLS_ECP_INTERNAL_ALT is enabled, this function
+ *                  may write to \p grp, so \p grp must not be used
+ *                  concurrently by other threads. This includes groups set
+ *                  up by mbedtls_ecp_group_load_shared().
+ *
+ * \note            In contrast to mbedtls_ecp_mul(), this function does not
+ *                  guarantee a constant execution flow and timing. It must
+ *                  only be used with public scalars, such as the ones in
+ *                  signature verification.
+ *
+ * \note            This function is only defined for short Weierstrass curves.
+ *                  It may not be included in builds without any short
+ *                  Weierstrass curve.
+ *
+ * \param grp       The ECP group to use.
+ *                  This must be initialized and have group parameters
+ *                  set, for example through mbedtls_ecp_group_load().
+ * \param R         The point in which to store the result of the calculation.
+ *                  This must be initialized. It may alias one of the points
+ *                  in \p P.
+ * \param m         The array of \p count integers by which to multiply the
+ *                  points in \p P. They may be negative, and need not be
+ *                  reduced modulo the order of the group. Terms with a zero
+ *                  integer are skipped.
+ * \param P         The array of \p count points to multiply. Each point
+ *                  with a non-zero integer must be a valid public key.
+ * \param count     The number of terms. If this is \c 0, \p R is set to
+ *                  zero.
+ *
+ * \return          \c 0 on success.
+ * \return          #MBEDTLS_ERR_ECP_INVALID_KEY if one of the points in \p P
+ *                  is not a valid public key.
+ * \return          #MBEDTLS_ERR_ECP_ALLOC_FAILED or
+ *                  #MBEDTLS_ERR_MPI_ALLOC_FAILED on memory-allocation failure.
+ * \return          #MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE if \p grp does not
+ *                  designate a short Weierstrass curve.
+ * \return          Another negative error code on other kinds of failure.
+ */
+int mbedtls_ecp_muladd_multi( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+                              const mbedtls_mpi *m, const mbedtls_ecp_point *P,
+                              size_t count );
+#endif /* MBEDTLS_ECDSA_BATCH_VERIFY */
+
+#if defined(MBEDTLS_ECDSA_BATCH_SIGN)
+/**
+ * \brief           This function multiplies the base point of a group by
+ *                  several integers: \p R[i] = \p m[i] * G.
+ *
+ *                  Each multiplication is done as in mbedtls_ecp_mul(), with
+ *                  the same protections against side channels, but the
+ *                  coordinates of all the results are normalized together,
+ *                  which saves one modular inversion per result.
+ *
+ * \note            This function is only defined for short Weierstrass curves.
+ *
+ * \param grp       The ECP group to use.
+ *                  This must be initialized and have group parameters
+ *                  set, for example through mbedtls_ecp_group_load().
+ * \param R         The array of \p count points in which to store the
+ *                  results. Each one must be initialized.
+ * \param m         The array of \p count integers by which to multiply the
+ *                  base point. Each one must be a valid private key.
+ * \param count     The number of multiplications.
+ * \param f_rng     The RNG function used for blinding. This must not be
+ *                  \c NULL.
+ * \param p_rng     The RNG context to be passed to \p f_rng. This may be
+ *                  \c NULL if \p f_rng doesn't need a context.
+ *
+ * \return          \c 0 on success.
+ * \return          #MBEDTLS_ERR_ECP_INVALID_KEY if one of the integers in
+ *                  \p m is not a valid private key.
+ * \return          #MBEDTLS_ERR_ECP_ALLOC_FAILED or
+ *                  #MBEDTLS_ERR_MPI_ALLOC_FAILED on memory-allocation failure.
+ * \return          #MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE if \p grp does not
+ *                  designate a short Weierstrass curve.
+ * \return          Another negative error code on other kinds of failure.
+ */
+int mbedtls_ecp_mul_batch( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+                           const mbedtls_mpi *m, size_t count,
+                           int (*f_rng)(void *, unsigned char *, size_t),
+                           void *p_rng );
+#endif /* MBEDTLS_ECDSA_BATCH_SIGN */
+
+#if defined(MBEDTLS_ECP_KEY_PRECOMP)
+/**
+ * \brief           This function initializes a precomputed point.
+ *
+ * \param pre       The precomputed point to initialize.
+ *                  This must not be \c NULL.
+ */
+void mbedtls_ecp_precomp_init( mbedtls_ecp_precomp *pre );
+
+/**
+ * \brief           This function computes the tables of a precomputed point:
+ *                  the table of the base point of the group \p id (unless it
+ *                  is shared, see mbedtls_ecp_group_load_shared()) and a
+ *                  table of the multiples of \p Q of the same size.
+ *
+ * \note            This costs about as much as two scalar multiplications,
+ *                  and is only worth it for a point that is multiplied
+ *                  several times, such as the public key of a CA.
+ *
+ * \note            This function is only defined for short Weierstrass curves.
+ *
+ * \param pre       The precomputed point to set up. This must be initialized.
+ *                  Any previous content is freed.
+ * \param id        The group of \p Q.
+ * \param Q         The point to precompute. This must be a valid public key
+ *                  for the group \p id.
+ *
+ * \return          \c 0 on success.
+ * \return          #MBEDTLS_ERR_ECP_INVALID_KEY if \p Q is not a valid public
+ *                  key.
+ * \return          #MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE if \p id does not
+ *                  designate a short Weierstrass curve.
+ * \return          #MBEDTLS_ERR_ECP_ALLOC_FAILED or
+ *                  #MBEDTLS_ERR_MPI_ALLOC_FAILED on memory-allocation failure.
+ * \return          Another negative error code on other kinds of failure.
+ */
+int mbedtls_ecp_precomp_setup( mbedtls_ecp_precomp *pre,
+                               mbedtls_ecp_group_id id,
+                               const mbedtls_ecp_point *Q );
+
+/**
+ * \brief           This function performs multiplication and addition of two
+ *                  points using the tables of a precomputed point:
+ *                  \p R = \p m * \p pre->grp.G + \p n * \p pre->Q.
+ *
+ * \note            As mbedtls_ecp_muladd(), this function does not guarantee
+ *                  a constant execution flow and timing, and must only be
+ *                  used with public scalars.
+ *
+ * \param pre       The precomputed point to use. This must have been set up
+ *                  with mbedtls_ecp_precomp_setup().
+ * \param R         The point in which to store the result of the calculation.
+ *                  This must be initialized.
+ * \param m         The integer by which to multiply the base point.
+ * \param n         The integer by which to multiply \p pre->Q.
+ *
+ * \return          \c 0 on success.
+ * \return          #MBEDTLS_ERR_ECP_INVALID_KEY if \p m or \p n are not
+ *                  valid private keys.
+ * \return          #MBEDTLS_ERR_ECP_BAD_INPUT_DATA if \p pre is not set up.
+ * \return          #MBEDTLS_ERR_MPI_ALLOC_FAILED on memory-allocation failure.
+ * \return          Another negative error code on other kinds of failure.
+ */
+int mbedtls_ecp_muladd_precomp( mbedtls_ecp_precomp *pre, mbedtls_ecp_point *R,
+                                const mbedtls_mpi *m, const mbedtls_mpi *n );
+
+/**
+ * \brief           This function frees the components of a precomputed point.
+ *
+ * \param pre       The precomputed point to free. This may be \c NULL, in
+ *                  which case this function does nothing.
+ */
+void mbedtls_ecp_precomp_free( mbedtls_ecp_precomp *pre );
+#endif /* MBEDTLS_ECP_KEY_PRECOMP */
 #endif /* MBEDTLS_ECP_SHORT_WEIERSTRASS_ENABLED */
 
 /**
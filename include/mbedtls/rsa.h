@@ -441,6 +441,44 @@ int mbedtls_rsa_gen_key( mbedtls_rsa_context *ctx,
                          void *p_rng,
                          unsigned int nbits, int exponent );
 
+#if defined(MBEDTLS_RSA_GEN_KEY_PARALLEL)
+/**
+ * \brief          This function generates an RSA keypair, searching for
+ *                 its primes on several threads.
+ *
+ *                 A seed is drawn from \p f_rng, and each prime search uses
+ *                 its own HMAC_DRBG instance derived from that seed. The
+ *                 generated key only depends on the seed: it is the same for
+ *                 any number of workers.
+ *
+ * \note           mbedtls_rsa_init() must be called before this function,
+ *                 to set up the RSA context.
+ *
+ * \note           The key is not the one mbedtls_rsa_gen_key() would
+ *                 generate with the same RNG.
+ *
+ * \param ctx      The initialized RSA context used to hold the key.
+ * \param f_rng    The RNG function to be used to seed the key generation.
+ *                 This must not be \c NULL.
+ * \param p_rng    The RNG context to be passed to \p f_rng.
+ *                 This may be \c NULL if \p f_rng doesn't need a context.
+ * \param nbits    The size of the public key in bits.
+ * \param exponent The public exponent to use. For example, \c 65537.
+ *                 This must be odd and greater than \c 1.
+ * \param workers  The number of prime searches to run at the same time,
+ *                 including one on the calling thread. This must be at
+ *                 least \c 1.
+ *
+ * \return         \c 0 on success.
+ * \return         An \c MBEDTLS_ERR_RSA_XXX error code on failure.
+ */
+int mbedtls_rsa_gen_key_parallel( mbedtls_rsa_context *ctx,
+                                  int (*f_rng)(void *, unsigned char *, size_t),
+                                  void *p_rng,
+                                  unsigned int nbits, int exponent,
+                                  unsigned int workers );
+#endif /* MBEDTLS_RSA_GEN_KEY_PARALLEL */
+
 /**
  * \brief          This function checks if a context contains at least an RSA
  *                 public key.
@@ -541,6 +579,13 @@ int mbedtls_rsa_public( mbedtls_rsa_context *ctx,
  *                 and the exponent are blinded, providing protection
  *                 against some side-channel attacks.
  *
+ * \note           With #MBEDTLS_THREADING_C, several threads may perform
+ *                 private key operations on the same context concurrently.
+ *                 The context mutex is only held while deriving a blinding
+ *                 pair for the operation, not during the exponentiation.
+ *                 In this case \p f_rng and \p p_rng are called with the
+ *                 mutex held.
+ *
  * \warning        It is deprecated and a security risk to not provide
  *                 a PRNG here and thereby prevent the use of blinding.
  *                 Future versions of the library may enforce the presence
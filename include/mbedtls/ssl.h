@@ -38,6 +38,10 @@
 #include "mbedtls/x509_crl.h"
 #endif
 
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+#include "mbedtls/x509_crt_cache.h"
+#endif
+
 #if defined(MBEDTLS_DHM_C)
 #include "mbedtls/dhm.h"
 #endif
@@ -995,6 +999,9 @@ struct mbedtls_ssl_config
     mbedtls_x509_crt_ca_cb_t f_ca_cb;
     void *p_ca_cb;
 #endif /* MBEDTLS_X509_TRUSTED_CERTIFICATE_CALLBACK */
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+    mbedtls_x509_crt_cache *verify_cache; /*!< peer chain verification cache */
+#endif
 #endif /* MBEDTLS_X509_CRT_PARSE_C */
 
 #if defined(MBEDTLS_SSL_ASYNC_PRIVATE)
@@ -1020,6 +1027,10 @@ struct mbedtls_ssl_config
     mbedtls_mpi dhm_G;              /*!< generator for DHM                  */
 #endif
 
+#if defined(MBEDTLS_DHM_FIXED_BASE)
+    const mbedtls_dhm_fixed_base *dhm_fb; /*!< powers of dhm_G (shared)     */
+#endif
+
 #if defined(MBEDTLS_KEY_EXCHANGE_SOME_PSK_ENABLED)
 
 #if defined(MBEDTLS_USE_PSA_CRYPTO)
@@ -2575,6 +2586,10 @@ void mbedtls_ssl_conf_cert_profile( mbedtls_ssl_config *conf,
  *                 parameters ca_chain (maps to trust_ca for that function)
  *                 and ca_crl.
  *
+ * \note           If MBEDTLS_X509_CA_INDEX is enabled, this builds a lookup
+ *                 index over \p ca_chain with
+ *                 \c mbedtls_x509_crt_build_index().
+ *
  * \param conf     SSL configuration
  * \param ca_chain trusted CA chain (meaning all fully trusted top-level CAs)
  * \param ca_crl   trusted CA CRLs
@@ -2640,6 +2655,34 @@ void mbedtls_ssl_conf_ca_cb( mbedtls_ssl_config *conf,
                              void *p_ca_cb );
 #endif /* MBEDTLS_X509_TRUSTED_CERTIFICATE_CALLBACK */
 
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+/**
+ * \brief          Set a cache of peer certificate chain verification
+ *                 results.
+ *
+ *                 When a peer presents a chain that was verified less than
+ *                 the cache timeout ago against the same trusted CAs, CRLs,
+ *                 profile and hostname, the cached result is used instead
+ *                 of verifying the signatures again. The checks on the
+ *                 peer's key curve and key usage are always done.
+ *
+ * \note           The cache is not used when a verification callback is set
+ *                 (see mbedtls_ssl_conf_verify() and mbedtls_ssl_set_verify()),
+ *                 since the callback must see every certificate, nor with
+ *                 mbedtls_ssl_conf_ca_cb().
+ *
+ * \note           A cached result may be up to the cache timeout old, see
+ *                 mbedtls_x509_crt_verify_cached().
+ *
+ * \param conf     SSL configuration
+ * \param cache    The verification cache, or \c NULL to disable caching.
+ *                 The cache may be shared by several configurations and
+ *                 threads (with MBEDTLS_THREADING_C).
+ */
+void mbedtls_ssl_conf_verify_cache( mbedtls_ssl_config *conf,
+                                    mbedtls_x509_crt_cache *cache );
+#endif /* MBEDTLS_X509_CRT_CACHE_C */
+
 /**
  * \brief          Set own certificate chain and private key
  *
@@ -2904,6 +2947,25 @@ int mbedtls_ssl_conf_dh_param_bin( mbedtls_ssl_config *conf,
  * \return         0 if successful
  */
 int mbedtls_ssl_conf_dh_param_ctx( mbedtls_ssl_config *conf, mbedtls_dhm_context *dhm_ctx );
+
+#if defined(MBEDTLS_DHM_FIXED_BASE)
+/**
+ * \brief          Set a table of precomputed powers of the Diffie-Hellman
+ *                 generator, to speed up the ServerKeyExchange of the
+ *                 DHE key exchanges (server-side only).
+ *
+ * \note           The table is only used when it was set up with
+ *                 mbedtls_dhm_fixed_base_setup() for the same P and G as
+ *                 those of \p conf. It is not copied and must remain valid
+ *                 as long as \p conf is used. As it is only read, the same
+ *                 table may be set on several configurations.
+ *
+ * \param conf     SSL configuration
+ * \param fb       Fixed-base table, or \c NULL to stop using one
+ */
+void mbedtls_ssl_conf_dh_fixed_base( mbedtls_ssl_config *conf,
+                                     const mbedtls_dhm_fixed_base *fb );
+#endif /* MBEDTLS_DHM_FIXED_BASE */
 #endif /* MBEDTLS_DHM_C && defined(MBEDTLS_SSL_SRV_C) */
 
 #if defined(MBEDTLS_DHM_C) && defined(MBEDTLS_SSL_CLI_C)
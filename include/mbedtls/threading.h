@@ -111,6 +111,16 @@ extern mbedtls_threading_mutex_t mbedtls_threading_readdir_mutex;
 extern mbedtls_threading_mutex_t mbedtls_threading_gmtime_mutex;
 #endif /* MBEDTLS_HAVE_TIME_DATE && !MBEDTLS_PLATFORM_GMTIME_R_ALT */
 
+#if defined(MBEDTLS_ECP_SHARED_GROUPS)
+/* Protects the registry of mbedtls_ecp_group_load_shared(). */
+extern mbedtls_threading_mutex_t mbedtls_threading_ecp_shared_groups_mutex;
+#endif
+
+#if defined(MBEDTLS_X509_CRT_FRAME_PARSING)
+/* Serializes the decoding of frame-parsed X.509 certificates. */
+extern mbedtls_threading_mutex_t mbedtls_threading_x509_crt_frame_mutex;
+#endif
+
 #endif /* MBEDTLS_THREADING_C */
 
 #ifdef __cplusplus
@@ -327,6 +327,10 @@ int mbedtls_x509_get_serial( unsigned char **p, const unsigned char *end,
                      mbedtls_x509_buf *serial );
 int mbedtls_x509_get_ext( unsigned char **p, const unsigned char *end,
                   mbedtls_x509_buf *ext, int tag );
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+int mbedtls_x509_chain_digest_update( unsigned char *digest,
+                                      const mbedtls_x509_buf *raw );
+#endif
 int mbedtls_x509_sig_alg_gets( char *buf, size_t size, const mbedtls_x509_buf *sig_oid,
                        mbedtls_pk_type_t pk_alg, mbedtls_md_type_t md_alg,
                        const void *sig_opts );
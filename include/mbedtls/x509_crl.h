@@ -61,6 +61,18 @@ typedef struct mbedtls_x509_crl_entry
 }
 mbedtls_x509_crl_entry;
 
+#if defined(MBEDTLS_X509_CRL_SERIAL_INDEX)
+/**
+ * Position of a revoked serial number in the raw data of its CRL.
+ */
+typedef struct mbedtls_x509_crl_serial
+{
+    uint32_t offset;        /**< Offset of the serial number in \c raw. */
+    uint32_t len;           /**< Length of the serial number. */
+}
+mbedtls_x509_crl_serial;
+#endif /* MBEDTLS_X509_CRL_SERIAL_INDEX */
+
 /**
  * Certificate revocation list structure.
  * Every CRL may have multiple entries.
@@ -80,7 +92,7 @@ typedef struct mbedtls_x509_crl
     mbedtls_x509_time this_update;
     mbedtls_x509_time next_update;
 
-    mbedtls_x509_crl_entry entry;   /**< The CRL entries containing the certificate revocation times for this CA. */
+    mbedtls_x509_crl_entry entry;   /**< The CRL entries containing the certificate revocation times for this CA. Empty for CRLs parsed with mbedtls_x509_crl_parse_der_compact(). */
 
     mbedtls_x509_buf crl_ext;
 
@@ -90,6 +102,15 @@ typedef struct mbedtls_x509_crl
     mbedtls_pk_type_t sig_pk;           /**< Internal representation of the Public Key algorithm of the signature algorithm, e.g. MBEDTLS_PK_RSA */
     void *sig_opts;             /**< Signature options to be passed to mbedtls_pk_verify_ext(), e.g. for RSASSA-PSS */
 
+#if defined(MBEDTLS_X509_CRL_SERIAL_INDEX)
+    mbedtls_x509_crl_serial *serials;   /**< The revoked serial numbers, sorted for binary search, or NULL. */
+    size_t serial_count;                /**< The number of elements of \c serials. */
+#endif
+
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+    unsigned char chain_digest[32];     /**< Digest of the DER of all CRLs parsed into this chain, only set on the first CRL (see x509_crt_cache.h). */
+#endif
+
     struct mbedtls_x509_crl *next;
 }
 mbedtls_x509_crl;
@@ -106,6 +127,31 @@ mbedtls_x509_crl;
  */
 int mbedtls_x509_crl_parse_der( mbedtls_x509_crl *chain,
                         const unsigned char *buf, size_t buflen );
+
+#if defined(MBEDTLS_X509_CRL_SERIAL_INDEX)
+/**
+ * \brief          Parse a DER-encoded CRL and append it to the chained list,
+ *                 keeping only the sorted index of revoked serial numbers.
+ *
+ *                 This behaves like mbedtls_x509_crl_parse_der(), but does
+ *                 not build the linked list of \c entry: the CRL takes one
+ *                 allocation for its raw data and one for the index,
+ *                 whatever the number of revoked certificates. Revocation
+ *                 checks are the same as for a CRL parsed normally.
+ *
+ * \note           \c entry is left empty. mbedtls_x509_crl_info() still
+ *                 lists the revoked certificates, in serial number order.
+ *
+ * \param chain    points to the start of the chain
+ * \param buf      buffer holding the CRL data in DER format
+ * \param buflen   size of the buffer
+ *
+ * \return         0 if successful, or a specific X509 or PEM error code
+ */
+int mbedtls_x509_crl_parse_der_compact( mbedtls_x509_crl *chain,
+                                        const unsigned char *buf,
+                                        size_t buflen );
+#endif /* MBEDTLS_X509_CRL_SERIAL_INDEX */
 /**
  * \brief          Parse one or more CRLs and append them to the chained list
  *
@@ -132,6 +178,22 @@ int mbedtls_x509_crl_parse( mbedtls_x509_crl *chain, const unsigned char *buf, s
  * \return         0 if successful, or a specific X509 or PEM error code
  */
 int mbedtls_x509_crl_parse_file( mbedtls_x509_crl *chain, const char *path );
+
+#if defined(MBEDTLS_X509_CRL_SERIAL_INDEX)
+/**
+ * \brief          Load one or more CRLs and append them to the chained list,
+ *                 like mbedtls_x509_crl_parse_file(), but without building
+ *                 their list of entries
+ *                 (see mbedtls_x509_crl_parse_der_compact()).
+ *
+ * \param chain    points to the start of the chain
+ * \param path     filename to read the CRLs from (in PEM or DER encoding)
+ *
+ * \return         0 if successful, or a specific X509 or PEM error code
+ */
+int mbedtls_x509_crl_parse_file_compact( mbedtls_x509_crl *chain,
+                                         const char *path );
+#endif /* MBEDTLS_X509_CRL_SERIAL_INDEX */
 #endif /* MBEDTLS_FS_IO */
 
 /**
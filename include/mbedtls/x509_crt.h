@@ -46,6 +46,14 @@ extern "C" {
  * \{
  */
 
+#if defined(MBEDTLS_X509_CA_INDEX)
+/**
+ * Opaque lookup index over a chain of trusted certificates,
+ * see mbedtls_x509_crt_build_index().
+ */
+typedef struct mbedtls_x509_crt_index mbedtls_x509_crt_index;
+#endif
+
 /**
  * Container for an X.509 certificate. The certificate may be chained.
  */
@@ -94,6 +102,21 @@ typedef struct mbedtls_x509_crt
     mbedtls_pk_type_t sig_pk;           /**< Internal representation of the Public Key algorithm of the signature algorithm, e.g. MBEDTLS_PK_RSA */
     void *sig_opts;             /**< Signature options to be passed to mbedtls_pk_verify_ext(), e.g. for RSASSA-PSS */
 
+#if defined(MBEDTLS_X509_CA_INDEX)
+    mbedtls_x509_buf subject_key_id;    /**< Optional subjectKeyIdentifier extension value. */
+    mbedtls_x509_buf authority_key_id;  /**< Optional keyIdentifier field of the authorityKeyIdentifier extension. */
+    mbedtls_x509_crt_index *ca_index;   /**< Lookup index over this chain, only set on the first certificate (see mbedtls_x509_crt_build_index()). */
+#endif
+
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+    unsigned char chain_digest[32];     /**< Digest of the DER of all certificates parsed into this chain, only set on the first certificate (see x509_crt_cache.h). */
+#endif
+
+#if defined(MBEDTLS_X509_CRT_FRAME_PARSING)
+    int frame;                          /**< Internal: 1 if parsed by mbedtls_x509_crt_parse_der_frame(), 0 otherwise. */
+    int frame_state;                    /**< Internal: for frame-parsed certificates, 1 until the names and extensions are decoded, then 0 or the error that decoding them returned. */
+#endif
+
     struct mbedtls_x509_crt *next;     /**< Next certificate in the CA-chain. */
 }
 mbedtls_x509_crt;
@@ -194,6 +217,47 @@ typedef struct mbedtls_x509write_cert
 }
 mbedtls_x509write_cert;
 
+#if defined(MBEDTLS_X509_CRT_WRITE_TEMPLATE)
+/**
+ * Certificate issuance template: the parts of a certificate that are the
+ * same for all the certificates issued with it, encoded once
+ */
+typedef struct mbedtls_x509write_crt_template
+{
+    int version;                        /*!< certificate version        */
+    mbedtls_md_type_t md_alg;           /*!< hash of the signature      */
+    mbedtls_pk_context *issuer_key;     /*!< signing key                */
+    const char *sig_oid;                /*!< signature algorithm OID    */
+    size_t sig_oid_len;                 /*!< length of sig_oid          */
+    unsigned char *issuer;              /*!< signature AlgorithmIdentifier
+                                             and issuer Name, DER       */
+    size_t issuer_len;                  /*!< length of issuer           */
+    unsigned char *extensions;          /*!< extensions, DER, or NULL   */
+    size_t extensions_len;              /*!< length of extensions       */
+}
+mbedtls_x509write_crt_template;
+
+/**
+ * A certificate to issue from a template: the parts of the certificate
+ * that are specific to it, and the result
+ */
+typedef struct mbedtls_x509write_crt_item
+{
+    const mbedtls_mpi *serial;          /*!< serial number              */
+    const char *not_before;             /*!< notBefore, YYYYMMDDhhmmss  */
+    const char *not_after;              /*!< notAfter, YYYYMMDDhhmmss   */
+    const char *subject_name;           /*!< subject name, for example
+                                             "C=UK,O=ARM,CN=mbed TLS"   */
+    mbedtls_pk_context *subject_key;    /*!< subject public key         */
+    unsigned char *buf;                 /*!< output buffer              */
+    size_t size;                        /*!< size of buf                */
+    int ret;                            /*!< length of the certificate
+                                             written at the end of buf,
+                                             or a negative error code   */
+}
+mbedtls_x509write_crt_item;
+#endif /* MBEDTLS_X509_CRT_WRITE_TEMPLATE */
+
 /**
  * Item in a verification chain: cert and flags for it
  */
@@ -416,6 +480,72 @@ int mbedtls_x509_crt_parse_der_nocopy( mbedtls_x509_crt *chain,
                                        const unsigned char *buf,
                                        size_t buflen );
 
+#if defined(MBEDTLS_X509_CRT_FRAME_PARSING)
+/**
+ * \brief          Parse the frame of a single DER formatted certificate and
+ *                 add it to the end of the provided chained list.
+ *
+ *                 Only the outer structure, the serial number, the
+ *                 signature algorithms, the validity period, the public key
+ *                 and the signature are parsed. The issuer and subject names
+ *                 and the extensions are only located, and decoded by
+ *                 mbedtls_x509_crt_frame_decode() when first needed: the
+ *                 verification functions, mbedtls_x509_crt_info(),
+ *                 mbedtls_x509_crt_check_key_usage() and
+ *                 mbedtls_x509_crt_check_extended_key_usage() do so
+ *                 themselves. Trusted certificates that are never looked at
+ *                 as a potential parent are never decoded.
+ *
+ * \note           Errors in the names and extensions are only reported when
+ *                 they are decoded. Trusted certificates that fail to decode
+ *                 are ignored during verification, while a chain to be
+ *                 verified that fails to decode makes verification return
+ *                 the error.
+ *
+ * \note           Decoding modifies the certificate even when it is reached
+ *                 through a const pointer. If #MBEDTLS_THREADING_C is
+ *                 enabled it is serialized by a global mutex, otherwise call
+ *                 mbedtls_x509_crt_frame_decode() on every certificate
+ *                 before sharing the chain between threads.
+ *
+ * \param chain    The pointer to the start of the CRT chain to attach to.
+ *                 When parsing the first CRT in a chain, this should point
+ *                 to an instance of ::mbedtls_x509_crt initialized through
+ *                 mbedtls_x509_crt_init().
+ * \param buf      The buffer holding the DER encoded certificate.
+ * \param buflen   The size in Bytes of \p buf.
+ * \param make_copy When not zero this function makes an internal copy of the
+ *                 CRT buffer \p buf. In particular, \p buf may be destroyed
+ *                 or reused after this call returns.
+ *                 When zero this function avoids duplicating the CRT buffer
+ *                 by taking temporary ownership thereof until the CRT
+ *                 is destroyed (like mbedtls_x509_crt_parse_der_nocopy())
+ *
+ * \return         \c 0 if successful.
+ * \return         A negative error code on failure.
+ */
+int mbedtls_x509_crt_parse_der_frame( mbedtls_x509_crt *chain,
+                                      const unsigned char *buf,
+                                      size_t buflen,
+                                      int make_copy );
+
+/**
+ * \brief          Decode the names and extensions of a certificate parsed
+ *                 with mbedtls_x509_crt_parse_der_frame(), if not done yet.
+ *
+ *                 Call this before reading the \c issuer, \c subject or
+ *                 extension fields of such a certificate directly.
+ *
+ * \param crt      The certificate to decode. Other certificates are left
+ *                 unchanged.
+ *
+ * \return         \c 0 if the fields are decoded (now or earlier).
+ * \return         The error code of the failed decoding otherwise; it is
+ *                 returned again on every later call.
+ */
+int mbedtls_x509_crt_frame_decode( mbedtls_x509_crt *crt );
+#endif /* MBEDTLS_X509_CRT_FRAME_PARSING */
+
 /**
  * \brief          Parse one DER-encoded or one or more concatenated PEM-encoded
  *                 certificates and add them to the chained list.
@@ -479,7 +609,188 @@ int mbedtls_x509_crt_parse_file( mbedtls_x509_crt *chain, const char *path );
  */
 int mbedtls_x509_crt_parse_path( mbedtls_x509_crt *chain, const char *path );
 
+#if defined(MBEDTLS_X509_CRT_PARSE_PATH_DEDUP)
+/**
+ * \brief          Load the certificate files from a path like
+ *                 mbedtls_x509_crt_parse_path(), parsing them on up to
+ *                 \p workers threads and adding each distinct certificate
+ *                 to the chained list only once.
+ *
+ *                 A file reachable through several links (for example the
+ *                 hashed names of a c_rehash directory) is read once, and a
+ *                 certificate whose DER is identical to one already in the
+ *                 chain, or already loaded from another file, is dropped.
+ *
+ * \note           Worker threads are only used with
+ *                 MBEDTLS_THREADING_PTHREAD. Otherwise, or if they cannot
+ *                 be created, the files are parsed by the calling thread.
+ *
+ * \note           The order of the certificates added to the chain does
+ *                 not depend on \p workers.
+ *
+ * \param chain    points to the start of the chain
+ * \param path     directory / folder to read the certificate files from
+ * \param workers  maximum number of threads parsing files, including the
+ *                 calling thread
+ *
+ * \return         0 if all certificates parsed successfully, a positive number
+ *                 if partly successful or a specific X509 or PEM error code
+ */
+int mbedtls_x509_crt_parse_path_dedup( mbedtls_x509_crt *chain,
+                                       const char *path, int workers );
+#endif /* MBEDTLS_X509_CRT_PARSE_PATH_DEDUP */
+
 #endif /* MBEDTLS_FS_IO */
+
+#if defined(MBEDTLS_X509_CA_INDEX)
+/**
+ * \brief          Build a lookup index over a chain of trusted certificates.
+ *
+ *                 When \p chain is later passed as the list of trusted CAs
+ *                 to one of the verification functions, candidate parents
+ *                 are looked up by a hash of their subject name, and
+ *                 candidates whose subjectKeyIdentifier matches the
+ *                 child's authorityKeyIdentifier are tried first, instead
+ *                 of walking the whole list.
+ *
+ * \note           The index is discarded when certificates are parsed into
+ *                 the chain, or when the chain is freed. Calling this
+ *                 function on a chain that is already indexed does
+ *                 nothing, so it is safe to call it again after each
+ *                 change to the chain.
+ *
+ * \note           Building the index modifies \p chain; it must not be
+ *                 called while the chain is in use by another thread.
+ *
+ * \param chain    The first certificate of the chain to index.
+ *
+ * \return         \c 0 on success.
+ * \return         #MBEDTLS_ERR_X509_ALLOC_FAILED on allocation failure.
+ */
+int mbedtls_x509_crt_build_index( mbedtls_x509_crt *chain );
+#endif /* MBEDTLS_X509_CA_INDEX */
+
+#if defined(MBEDTLS_X509_CRT_STORE)
+/**
+ * \name Binary trust store format
+ *
+ * A trust store holds DER certificates together with what is needed to
+ * use them without decoding them first. All integers are big-endian.
+ *
+ *     header     magic "MTS1" (4 bytes), count (4), total length (4),
+ *                version (4, #MBEDTLS_X509_CRT_STORE_VERSION)
+ *     entries    count times: DER offset from the start of the store (4),
+ *                DER length (4), subject name hash (4), public key type
+ *                (1, ::mbedtls_pk_type_t), flags (1), key size in bits (2)
+ *     data       the DER certificates
+ *
+ * The subject name hash is the one used by mbedtls_x509_crt_build_index(),
+ * so a store can only be used by a build of the library that computes the
+ * same hash. The version holds the revision of the layout in its high 16
+ * bits and the revision of the subject name hash in its low 16 bits; a
+ * store with another version is rejected as #MBEDTLS_ERR_X509_INVALID_FORMAT
+ * and must be written again.
+ * \{
+ */
+#define MBEDTLS_X509_CRT_STORE_VERSION      0x00010001
+#define MBEDTLS_X509_CRT_STORE_HEADER_LEN   16
+#define MBEDTLS_X509_CRT_STORE_ENTRY_LEN    16
+#define MBEDTLS_X509_CRT_STORE_FLAG_CA      0x01    /**< basicConstraints cA is set */
+/* \} name */
+
+/**
+ * \brief          Information about a certificate of a trust store, read
+ *                 without parsing the certificate.
+ */
+typedef struct mbedtls_x509_crt_store_entry
+{
+    const unsigned char *der;   /**< The DER of the certificate, inside the store */
+    size_t der_len;             /**< The length of the DER */
+    uint32_t subject_hash;      /**< The hash of the subject name */
+    mbedtls_pk_type_t pk_type;  /**< The type of the public key */
+    size_t pk_bits;             /**< The size of the public key in bits */
+    int ca_istrue;              /**< 1 if the certificate is a CA, 0 otherwise */
+}
+mbedtls_x509_crt_store_entry;
+
+/**
+ * \brief          Write a chain of certificates as a trust store.
+ *
+ * \param chain    The certificates to store. They must have been parsed
+ *                 completely (not with mbedtls_x509_crt_parse_der_frame()).
+ * \param buf      The buffer to write the store to.
+ * \param size     The size of \p buf.
+ * \param olen     On success, the length of the store. If \p buf is too
+ *                 small, the size it needs to be.
+ *
+ * \return         \c 0 if successful.
+ * \return         #MBEDTLS_ERR_X509_BUFFER_TOO_SMALL if \p buf is too small.
+ * \return         #MBEDTLS_ERR_X509_BAD_INPUT_DATA if the chain is empty or
+ *                 too large for the format.
+ */
+int mbedtls_x509_crt_store_write( const mbedtls_x509_crt *chain,
+                                  unsigned char *buf, size_t size,
+                                  size_t *olen );
+
+/**
+ * \brief          Check the layout of a trust store and get the number of
+ *                 certificates it holds. The certificates themselves are
+ *                 only checked when they are parsed.
+ *
+ * \param buf      The trust store.
+ * \param buflen   The size of \p buf.
+ * \param count    On success, the number of certificates.
+ *
+ * \return         \c 0 if successful.
+ * \return         #MBEDTLS_ERR_X509_INVALID_FORMAT if \p buf is not a
+ *                 trust store.
+ */
+int mbedtls_x509_crt_store_check( const unsigned char *buf, size_t buflen,
+                                  size_t *count );
+
+/**
+ * \brief          Get the information about a certificate of a trust store
+ *                 checked with mbedtls_x509_crt_store_check().
+ *
+ * \param buf      The trust store.
+ * \param buflen   The size of \p buf.
+ * \param idx      The position of the certificate in the store.
+ * \param entry    On success, the information about the certificate.
+ *
+ * \return         \c 0 if successful.
+ * \return         #MBEDTLS_ERR_X509_BAD_INPUT_DATA if \p idx is out of range.
+ */
+int mbedtls_x509_crt_store_get( const unsigned char *buf, size_t buflen,
+                                size_t idx,
+                                mbedtls_x509_crt_store_entry *entry );
+
+/**
+ * \brief          Add the certificates of a trust store to a chain without
+ *                 copying them, for example from a read-only memory mapping
+ *                 of the store file shared by several processes.
+ *
+ *                 With #MBEDTLS_X509_CRT_FRAME_PARSING, the certificates
+ *                 are parsed with mbedtls_x509_crt_parse_der_frame(). With
+ *                 #MBEDTLS_X509_CA_INDEX, if the chain was empty, its index
+ *                 is built from the subject name hashes of the store, so
+ *                 that no subject name is decoded until its certificate is
+ *                 considered as a parent.
+ *
+ * \note           The store must stay available and unchanged until the
+ *                 chain is freed.
+ *
+ * \param chain    The chain to which to add the certificates.
+ * \param buf      The trust store.
+ * \param buflen   The size of \p buf.
+ *
+ * \return         \c 0 if successful.
+ * \return         A negative error code on failure, in which case the
+ *                 certificates added so far are left in the chain.
+ */
+int mbedtls_x509_crt_parse_store( mbedtls_x509_crt *chain,
+                                  const unsigned char *buf, size_t buflen );
+#endif /* MBEDTLS_X509_CRT_STORE */
+
 /**
  * \brief          This function parses an item in the SubjectAlternativeNames
  *                 extension.
@@ -1076,6 +1387,118 @@ int mbedtls_x509write_crt_pem( mbedtls_x509write_cert *ctx, unsigned char *buf,
                        int (*f_rng)(void *, unsigned char *, size_t),
                        void *p_rng );
 #endif /* MBEDTLS_PEM_WRITE_C */
+
+#if defined(MBEDTLS_X509_CRT_WRITE_TEMPLATE)
+/**
+ * \brief           Initialize a certificate issuance template
+ *
+ * \param tpl       Template to initialize
+ */
+void mbedtls_x509write_crt_template_init( mbedtls_x509write_crt_template *tpl );
+
+/**
+ * \brief           Encode the parts of a certificate write context that are
+ *                  the same for many certificates into a template: the
+ *                  version, the signature algorithm, the issuer name and
+ *                  key, and the extensions.
+ *
+ *                  The serial number, the validity, the subject name and
+ *                  the subject key of \p ctx are not used; they are given
+ *                  for each certificate to mbedtls_x509write_crt_issue() or
+ *                  mbedtls_x509write_crt_issue_batch().
+ *
+ * \note            The extensions of \p ctx are copied into every
+ *                  certificate, so they must not depend on the subject: for
+ *                  example, do not set a subject key identifier.
+ *
+ * \note            The template refers to the issuer key of \p ctx, which
+ *                  must remain valid as long as the template is used.
+ *                  \p ctx itself may be freed after this call.
+ *
+ * \param tpl       Template, initialized with
+ *                  mbedtls_x509write_crt_template_init()
+ * \param ctx       Certificate write context with at least the issuer name
+ *                  and key and the hash algorithm set
+ *
+ * \return          0 if successful, or a specific error code
+ */
+int mbedtls_x509write_crt_template_setup( mbedtls_x509write_crt_template *tpl,
+                                          const mbedtls_x509write_cert *ctx );
+
+/**
+ * \brief           Issue a certificate from a template: encode its
+ *                  specific parts around the pre-encoded parts of the
+ *                  template and sign it.
+ *                  Note: data is written at the end of \c item->buf! The
+ *                        length of the certificate is stored in
+ *                        \c item->ret.
+ *
+ * \param tpl       Template set up with mbedtls_x509write_crt_template_setup()
+ * \param item      The certificate to issue
+ * \param f_rng     RNG function (for signature, see
+ *                  mbedtls_x509write_crt_der())
+ * \param p_rng     RNG parameter
+ *
+ * \return          length of data written if successful, or a specific
+ *                  error code
+ */
+int mbedtls_x509write_crt_issue( const mbedtls_x509write_crt_template *tpl,
+                                 mbedtls_x509write_crt_item *item,
+                                 int (*f_rng)(void *, unsigned char *, size_t),
+                                 void *p_rng );
+
+/**
+ * \brief           Issue many certificates from a template, like
+ *                  mbedtls_x509write_crt_issue() for each item.
+ *
+ *                  With MBEDTLS_ECDSA_BATCH_SIGN and an ECDSA issuer key,
+ *                  the signatures are made with mbedtls_ecdsa_sign_batch(),
+ *                  so their nonces are random even if
+ *                  MBEDTLS_ECDSA_DETERMINISTIC is enabled.
+ *
+ *                  With MBEDTLS_THREADING_PTHREAD, the items are divided
+ *                  between \p workers threads, including the calling
+ *                  thread.
+ *
+ * \note            With several workers, the issuer key is used from several
+ *                  threads at once. Before starting them, this function
+ *                  computes what the key would otherwise compute and store
+ *                  on its first use, such as the table of multiples of the
+ *                  base point of an EC key, so that the threads only read
+ *                  it. The key must not be used elsewhere in the meantime.
+ *
+ * \note            With several workers, \p f_rng is called from several
+ *                  threads at once and must support it, as
+ *                  mbedtls_ctr_drbg_random() and mbedtls_hmac_drbg_random()
+ *                  do with MBEDTLS_THREADING_C.
+ *
+ * \param tpl       Template set up with mbedtls_x509write_crt_template_setup()
+ * \param items     The certificates to issue; the result for each one is
+ *                  stored in its \c ret field
+ * \param count     The number of items
+ * \param workers   The number of threads to use; ignored without
+ *                  MBEDTLS_THREADING_PTHREAD
+ * \param f_rng     RNG function (for signature, see
+ *                  mbedtls_x509write_crt_der())
+ * \param p_rng     RNG parameter
+ *
+ * \return          0 if all the certificates were issued, the error code
+ *                  of the first item that failed, or another specific
+ *                  error code.
+ */
+int mbedtls_x509write_crt_issue_batch( const mbedtls_x509write_crt_template *tpl,
+                                       mbedtls_x509write_crt_item *items,
+                                       size_t count, int workers,
+                                       int (*f_rng)(void *, unsigned char *, size_t),
+                                       void *p_rng );
+
+/**
+ * \brief           Free the contents of a certificate issuance template
+ *
+ * \param tpl       Template to free
+ */
+void mbedtls_x509write_crt_template_free( mbedtls_x509write_crt_template *tpl );
+#endif /* MBEDTLS_X509_CRT_WRITE_TEMPLATE */
 #endif /* MBEDTLS_X509_CRT_WRITE_C */
 
 #ifdef __cplusplus
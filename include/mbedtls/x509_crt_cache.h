@@ -0,0 +1,239 @@
+/**
+ * \file x509_crt_cache.h
+ *
+ * \brief Cache of X.509 certificate chain verification results
+ */
+/*
+ *  Copyright The Mbed TLS Contributors
+ *  SPDX-License-Identifier: Apache-2.0
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *  not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *  WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef MBEDTLS_X509_CRT_CACHE_H
+#define MBEDTLS_X509_CRT_CACHE_H
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include "mbedtls/x509_crt.h"
+
+#if defined(MBEDTLS_HAVE_TIME)
+#include "mbedtls/platform_time.h"
+#endif
+
+#if defined(MBEDTLS_THREADING_C)
+#include "mbedtls/threading.h"
+#endif
+
+/**
+ * \name SECTION: Module settings
+ *
+ * The configuration options you can set for this module are in this section.
+ * Either change them in config.h or define them on the compiler command line.
+ * \{
+ */
+
+#if !defined(MBEDTLS_X509_CRT_CACHE_DEFAULT_TIMEOUT)
+#define MBEDTLS_X509_CRT_CACHE_DEFAULT_TIMEOUT       300   /*!< 5 minutes */
+#endif
+
+#if !defined(MBEDTLS_X509_CRT_CACHE_DEFAULT_MAX_ENTRIES)
+#define MBEDTLS_X509_CRT_CACHE_DEFAULT_MAX_ENTRIES   128   /*!< Maximum entries in cache */
+#endif
+
+/* \} name SECTION: Module settings */
+
+#define MBEDTLS_X509_CRT_CACHE_KEY_LEN  32  /*!< Length of a cache key (SHA-256) */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct mbedtls_x509_crt_cache mbedtls_x509_crt_cache;
+typedef struct mbedtls_x509_crt_cache_entry mbedtls_x509_crt_cache_entry;
+
+/**
+ * \brief   This structure is used for storing cache entries
+ */
+struct mbedtls_x509_crt_cache_entry
+{
+#if defined(MBEDTLS_HAVE_TIME)
+    mbedtls_time_t timestamp;           /*!< entry timestamp            */
+#endif
+    unsigned char key[MBEDTLS_X509_CRT_CACHE_KEY_LEN]; /*!< entry key   */
+    int result;                         /*!< verification return value  */
+    uint32_t flags;                     /*!< verification flags         */
+    mbedtls_x509_crt_cache_entry *next; /*!< chain pointer              */
+};
+
+/**
+ * \brief Verification cache context
+ */
+struct mbedtls_x509_crt_cache
+{
+    mbedtls_x509_crt_cache_entry *chain;    /*!< start of the chain     */
+    int timeout;                /*!< cache entry timeout    */
+    int max_entries;            /*!< maximum entries        */
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_threading_mutex_t mutex;        /*!< mutex                  */
+#endif
+};
+
+/**
+ * \brief          Initialize a verification cache context
+ *
+ * \param cache    Verification cache context
+ */
+void mbedtls_x509_crt_cache_init( mbedtls_x509_crt_cache *cache );
+
+/**
+ * \brief          Compute the cache key for a verification.
+ *
+ *                 The key is a SHA-256 digest of the contents of \p crt,
+ *                 \p trust_ca and \p ca_crl, of \p profile and of \p cn.
+ *                 The contents of each list are represented by the digest
+ *                 that the parsing functions keep up to date on its first
+ *                 element, so computing the key does not depend on the
+ *                 size of the lists.
+ *
+ * \note           Each list must have been built only with the parsing
+ *                 functions, starting from its first element.
+ *
+ * \param key      Buffer of #MBEDTLS_X509_CRT_CACHE_KEY_LEN bytes to
+ *                 receive the key.
+ * \param crt      The certificate chain to be verified.
+ * \param trust_ca The list of trusted CAs.
+ * \param ca_crl   The list of CRLs, or \c NULL.
+ * \param profile  The security profile used for verification.
+ * \param cn       The expected Common Name, or \c NULL.
+ *
+ * \return         \c 0 on success, or a negative error code from the
+ *                 SHA-256 module.
+ */
+int mbedtls_x509_crt_cache_key( unsigned char *key,
+                                const mbedtls_x509_crt *crt,
+                                const mbedtls_x509_crt *trust_ca,
+                                const mbedtls_x509_crl *ca_crl,
+                                const mbedtls_x509_crt_profile *profile,
+                                const char *cn );
+
+/**
+ * \brief          Look up a verification result
+ *                 (Thread-safe if MBEDTLS_THREADING_C is enabled)
+ *
+ * \param cache    Verification cache context
+ * \param key      The key computed by mbedtls_x509_crt_cache_key()
+ * \param result   Receives the cached return value of the verification
+ * \param flags    Receives the cached verification flags
+ *
+ * \return         \c 0 if a fresh entry was found, \c 1 otherwise.
+ */
+int mbedtls_x509_crt_cache_get( mbedtls_x509_crt_cache *cache,
+                                const unsigned char *key,
+                                int *result, uint32_t *flags );
+
+/**
+ * \brief          Store a verification result
+ *                 (Thread-safe if MBEDTLS_THREADING_C is enabled)
+ *
+ *                 Only the outcome of a completed verification (\c 0 or
+ *                 #MBEDTLS_ERR_X509_CERT_VERIFY_FAILED) is stored; other
+ *                 values of \p result are ignored.
+ *
+ * \param cache    Verification cache context
+ * \param key      The key computed by mbedtls_x509_crt_cache_key()
+ * \param result   The return value of the verification
+ * \param flags    The verification flags
+ *
+ * \return         \c 0 if the entry was stored or ignored, \c 1 otherwise.
+ */
+int mbedtls_x509_crt_cache_set( mbedtls_x509_crt_cache *cache,
+                                const unsigned char *key,
+                                int result, uint32_t flags );
+
+/**
+ * \brief          Verify a chain like mbedtls_x509_crt_verify_with_profile()
+ *                 without a verification callback, reusing a cached result
+ *                 if the same chain was verified with the same parameters
+ *                 less than the cache timeout ago.
+ *
+ * \note           A cached result may be up to the cache timeout old: a
+ *                 certificate that expires, or a CRL that becomes stale,
+ *                 in the meantime is only noticed once the entry expires.
+ *
+ * \param cache    Verification cache context
+ * \param crt      The certificate chain to be verified.
+ * \param trust_ca The list of trusted CAs.
+ * \param ca_crl   The list of CRLs, or \c NULL.
+ * \param profile  The security profile used for verification.
+ * \param cn       The expected Common Name, or \c NULL.
+ * \param flags    The address at which to store the verification flags.
+ *
+ * \return         See mbedtls_x509_crt_verify_with_profile().
+ */
+int mbedtls_x509_crt_verify_cached( mbedtls_x509_crt_cache *cache,
+                                    mbedtls_x509_crt *crt,
+                                    mbedtls_x509_crt *trust_ca,
+                                    mbedtls_x509_crl *ca_crl,
+                                    const mbedtls_x509_crt_profile *profile,
+                                    const char *cn, uint32_t *flags );
+
+#if defined(MBEDTLS_HAVE_TIME)
+/**
+ * \brief          Set the cache timeout
+ *                 (Default: MBEDTLS_X509_CRT_CACHE_DEFAULT_TIMEOUT (5 minutes))
+ *
+ *                 A timeout of 0 indicates no timeout.
+ *
+ * \param cache    Verification cache context
+ * \param timeout  cache entry timeout in seconds
+ */
+void mbedtls_x509_crt_cache_set_timeout( mbedtls_x509_crt_cache *cache,
+                                         int timeout );
+#endif /* MBEDTLS_HAVE_TIME */
+
+/**
+ * \brief          Set the maximum number of cache entries
+ *                 (Default: MBEDTLS_X509_CRT_CACHE_DEFAULT_MAX_ENTRIES (128))
+ *
+ * \param cache    Verification cache context
+ * \param max      cache entry maximum
+ */
+void mbedtls_x509_crt_cache_set_max_entries( mbedtls_x509_crt_cache *cache,
+                                             int max );
+
+/**
+ * \brief          Drop all cache entries, for example to make a change to
+ *                 the current time or to a revocation status known
+ *                 immediately
+ *                 (Thread-safe if MBEDTLS_THREADING_C is enabled)
+ *
+ * \param cache    Verification cache context
+ */
+void mbedtls_x509_crt_cache_clear( mbedtls_x509_crt_cache *cache );
+
+/**
+ * \brief          Free referenced items in a cache context and clear memory
+ *
+ * \param cache    Verification cache context
+ */
+void mbedtls_x509_crt_cache_free( mbedtls_x509_crt_cache *cache );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* x509_crt_cache.h */
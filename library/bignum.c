@@ -38,6 +38,7 @@
 #if defined(MBEDTLS_BIGNUM_C)
 
 #include "mbedtls/bignum.h"
+#include "bignum_internal.h"
 #include "mbedtls/bn_mul.h"
 #include "mbedtls/platform_util.h"
 #include "mbedtls/error.h"
@@ -72,6 +73,14 @@
 #define BITS_TO_LIMBS(i)  ( (i) / biL + ( (i) % biL != 0 ) )
 #define CHARS_TO_LIMBS(i) ( (i) / ciL + ( (i) % ciL != 0 ) )
 
+/*
+ * Temporaries of up to this many limbs are kept on the stack rather than
+ * allocated on the heap when the output of an operation aliases one of its
+ * inputs. This covers the field arithmetic of all supported elliptic curves,
+ * where statements like Z = Z * T or X = P - X are very common.
+ */
+#define MPI_STACK_LIMBS  ( 2 * BITS_TO_LIMBS( 521 ) + 1 )
+
 /* Implementation that should never be optimized out by the compiler */
 static void mbedtls_mpi_zeroize( mbedtls_mpi_uint *v, size_t n )
 {
@@ -1373,8 +1382,10 @@ static mbedtls_mpi_uint mpi_sub_hlp( size_t n,
 int mbedtls_mpi_sub_abs( mbedtls_mpi *X, const mbedtls_mpi *A, const mbedtls_mpi *B )
 {
     mbedtls_mpi TB;
+    mbedtls_mpi_uint TB_buf[MPI_STACK_LIMBS];
+    const mbedtls_mpi_uint *Bp;
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
-    size_t n;
+    size_t n, nb;
     mbedtls_mpi_uint carry;
     MPI_VALIDATE_RET( X != NULL );
     MPI_VALIDATE_RET( A != NULL );
@@ -1382,10 +1393,24 @@ int mbedtls_mpi_sub_abs( mbedtls_mpi *X, const mbedtls_mpi *A, const mbedtls_mpi
 
     mbedtls_mpi_init( &TB );
 
+    for( nb = B->n; nb > 0; nb-- )
+        if( B->p[nb - 1] != 0 )
+            break;
+
+    Bp = B->p;
+
     if( X == B )
     {
-        MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &TB, B ) );
-        B = &TB;
+        if( nb <= MPI_STACK_LIMBS )
+        {
+            memcpy( TB_buf, B->p, nb * ciL );
+            Bp = TB_buf;
+        }
+        else
+        {
+            MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &TB, B ) );
+            Bp = TB.p;
+        }
     }
 
     if( X != A )
@@ -1398,11 +1423,8 @@ int mbedtls_mpi_sub_abs( mbedtls_mpi *X, const mbedtls_mpi *A, const mbedtls_mpi
 
     ret = 0;
 
-    for( n = B->n; n > 0; n-- )
-        if( B->p[n - 1] != 0 )
-            break;
-
-    carry = mpi_sub_hlp( n, X->p, B->p );
+    n = nb;
+    carry = mpi_sub_hlp( n, X->p, Bp );
     if( carry != 0 )
     {
         /* Propagate the carry to the first nonzero limb of X. */
@@ -1411,12 +1433,17 @@ int mbedtls_mpi_sub_abs( mbedtls_mpi *X, const mbedtls_mpi *A, const mbedtls_mpi
         /* If we ran out of space for the carry, it means that the result
          * is negative. */
         if( n == X->n )
-            return( MBEDTLS_ERR_MPI_NEGATIVE_VALUE );
+        {
+            ret = MBEDTLS_ERR_MPI_NEGATIVE_VALUE;
+            goto cleanup;
+        }
         --X->p[n];
     }
 
 cleanup:
 
+    if( Bp == TB_buf )
+        mbedtls_platform_zeroize( TB_buf, nb * ciL );
     mbedtls_mpi_free( &TB );
 
     return( ret );
@@ -1528,8 +1555,126 @@ int mbedtls_mpi_sub_int( mbedtls_mpi *X, const mbedtls_mpi *A, mbedtls_mpi_sint
     return( mbedtls_mpi_sub_mpi( X, A, &_B ) );
 }
 
+#if defined(MBEDTLS_BIGNUM_ADX) && defined(MBEDTLS_HAVE_ASM) &&  \
+    defined(__GNUC__) && ( defined(__amd64__) || defined(__x86_64__) )
+#define MPI_HAVE_ADX
+#endif
+
+#if defined(MPI_HAVE_ADX)
+#define MPI_CPUID7_EBX_BMI2     ( 1u << 8 )
+#define MPI_CPUID7_EBX_ADX      ( 1u << 19 )
+
+/*
+ * MULX (BMI2), ADCX and ADOX (ADX) support detection
+ *
+ * The result is cached in a single word that is accessed atomically, so
+ * concurrent first calls from several threads are safe: at worst each of
+ * them runs CPUID and stores the same value.
+ */
+#define MPI_ADX_UNKNOWN         0
+#define MPI_ADX_UNSUPPORTED     1
+#define MPI_ADX_SUPPORTED       2
+
+static int mpi_adx_has_support( void )
+{
+    static int state = MPI_ADX_UNKNOWN;
+    int cached = __atomic_load_n( &state, __ATOMIC_RELAXED );
+
+    if( cached == MPI_ADX_UNKNOWN )
+    {
+        unsigned int max_leaf, leaf = 7, subleaf = 0, ebx = 0;
+
+        asm( "cpuid"
+             : "=a" (max_leaf)
+             : "a" (0)
+             : "ebx", "ecx", "edx" );
+
+        if( max_leaf >= 7 )
+        {
+            asm( "cpuid"
+                 : "+a" (leaf), "=b" (ebx), "+c" (subleaf)
+                 :
+                 : "edx" );
+        }
+
+        cached = ( ebx & ( MPI_CPUID7_EBX_BMI2 | MPI_CPUID7_EBX_ADX ) ) ==
+                 ( MPI_CPUID7_EBX_BMI2 | MPI_CPUID7_EBX_ADX ) ?
+                 MPI_ADX_SUPPORTED : MPI_ADX_UNSUPPORTED;
+        __atomic_store_n( &state, cached, __ATOMIC_RELAXED );
+    }
+
+    return( cached == MPI_ADX_SUPPORTED );
+}
+
+/*
+ * One limb of d += s * b: MULX leaves the flags alone, so the carry of
+ * adding the previous high half (ADCX, carry flag) and that of adding into d
+ * (ADOX, overflow flag) are kept in two independent chains.
+ */
+#define MULADDC_ADX_LIMB( OFF )                                 \
+        "mulxq  " #OFF "(%%rsi), %%rax, %%r9    \n\t"           \
+        "adcxq  %%r8, %%rax                     \n\t"           \
+        "adoxq  " #OFF "(%%rdi), %%rax          \n\t"           \
+        "movq   %%rax, " #OFF "(%%rdi)          \n\t"           \
+        "movq   %%r9, %%r8                      \n\t"
+
+/*
+ * d[0..n-1] += s[0..n-1] * b, using MULX, ADCX and ADOX.
+ * Returns the carry out of d[n-1].
+ *
+ * The loops are controlled with LEA and JRCXZ, which don't touch the flags
+ * that carry the two addition chains.
+ */
+static mbedtls_mpi_uint mpi_mul_row_adx( size_t n, const mbedtls_mpi_uint *s,
+                                         mbedtls_mpi_uint *d,
+                                         mbedtls_mpi_uint b )
+{
+    size_t blocks = n / 4;
+    size_t rest = n % 4;
+    mbedtls_mpi_uint c;
+
+    asm volatile(
+        "xorl   %%r8d, %%r8d            \n\t"   /* also clears CF and OF */
+        "jrcxz  2f                      \n\t"
+        "1:                             \n\t"
+        MULADDC_ADX_LIMB( 0 )
+        MULADDC_ADX_LIMB( 8 )
+        MULADDC_ADX_LIMB( 16 )
+        MULADDC_ADX_LIMB( 24 )
+        "leaq   32(%%rsi), %%rsi        \n\t"
+        "leaq   32(%%rdi), %%rdi        \n\t"
+        "leaq   -1(%%rcx), %%rcx        \n\t"
+        "jrcxz  2f                      \n\t"
+        "jmp    1b                      \n\t"
+        "2:                             \n\t"
+        "movq   %[rest], %%rcx          \n\t"
+        "jrcxz  4f                      \n\t"
+        "3:                             \n\t"
+        MULADDC_ADX_LIMB( 0 )
+        "leaq   8(%%rsi), %%rsi         \n\t"
+        "leaq   8(%%rdi), %%rdi         \n\t"
+        "leaq   -1(%%rcx), %%rcx        \n\t"
+        "jrcxz  4f                      \n\t"
+        "jmp    3b                      \n\t"
+        "4:                             \n\t"
+        /* Fold both pending carries into the high half; this cannot
+         * overflow since d + s * b fits in n + 1 limbs. */
+        "movl   $0, %%eax               \n\t"
+        "adcxq  %%rax, %%r8             \n\t"
+        "adoxq  %%rax, %%r8             \n\t"
+        "movq   %%r8, %[c]              \n\t"
+        : [c] "=&r" (c), "+S" (s), "+D" (d), "+c" (blocks)
+        : "d" (b), [rest] "r" (rest)
+        : "rax", "r8", "r9", "cc", "memory"
+    );
+
+    return( c );
+}
+#endif /* MPI_HAVE_ADX */
+
 /*
- * Helper for mbedtls_mpi multiplication
+ * Helper for mbedtls_mpi multiplication: d[0..i-1] += s[0..i-1] * b.
+ * Returns the carry out of d[i-1], which is not propagated any further.
  */
 static
 #if defined(__APPLE__) && defined(__arm__)
@@ -1539,10 +1684,15 @@ static
  */
 __attribute__ ((noinline))
 #endif
-void mpi_mul_hlp( size_t i, mbedtls_mpi_uint *s, mbedtls_mpi_uint *d, mbedtls_mpi_uint b )
+mbedtls_mpi_uint mpi_mul_row( size_t i, mbedtls_mpi_uint *s, mbedtls_mpi_uint *d, mbedtls_mpi_uint b )
 {
     mbedtls_mpi_uint c = 0, t = 0;
 
+#if defined(MPI_HAVE_ADX)
+    if( mpi_adx_has_support() )
+        return( mpi_mul_row_adx( i, s, d, b ) );
+#endif
+
 #if defined(MULADDC_HUIT)
     for( ; i >= 8; i -= 8 )
     {
@@ -1594,12 +1744,184 @@ void mpi_mul_hlp( size_t i, mbedtls_mpi_uint *s, mbedtls_mpi_uint *d, mbedtls_mp
 
     t++;
 
+    return( c );
+}
+
+/*
+ * Helper for mbedtls_mpi multiplication: d += s[0..i-1] * b,
+ * propagating the carry as far as needed.
+ */
+static void mpi_mul_hlp( size_t i, mbedtls_mpi_uint *s, mbedtls_mpi_uint *d, mbedtls_mpi_uint b )
+{
+    mbedtls_mpi_uint c = mpi_mul_row( i, s, d, b );
+
+    d += i;
+
     do {
         *d += c; c = ( *d < c ); d++;
     }
     while( c != 0 );
 }
 
+/*
+ * Operands with at least this many limbs are multiplied with Karatsuba's
+ * method; below it, the schoolbook method is faster.
+ */
+#define MPI_KARATSUBA_THRESHOLD 40
+
+/*
+ * Helper for Karatsuba multiplication: d[0..n-1] += s[0..n-1], then adds
+ * the carry into d[n..n+k-1]. Returns the carry out of the last limb.
+ * There is no early exit, so the timing only depends on n and k.
+ */
+static mbedtls_mpi_uint mpi_kara_add( size_t n, size_t k, mbedtls_mpi_uint *d,
+                                      const mbedtls_mpi_uint *s )
+{
+    size_t i;
+    mbedtls_mpi_uint c, t;
+
+    for( i = c = 0; i < n; i++ )
+    {
+        t = d[i] + c;  c = ( t < c );
+        d[i] = t + s[i]; c += ( d[i] < t );
+    }
+
+    for( ; i < n + k; i++ )
+    {
+        d[i] += c; c = ( d[i] < c );
+    }
+
+    return( c );
+}
+
+/*
+ * Helper for Karatsuba multiplication: d[0..n-1] -= s[0..n-1], then
+ * subtracts the borrow from d[n..n+k-1]. Returns the final borrow.
+ */
+static mbedtls_mpi_uint mpi_kara_sub( size_t n, size_t k, mbedtls_mpi_uint *d,
+                                      const mbedtls_mpi_uint *s )
+{
+    size_t i;
+    mbedtls_mpi_uint c = mpi_sub_hlp( n, d, s ), z;
+
+    for( i = n; i < n + k; i++ )
+    {
+        z = ( d[i] < c ); d[i] -= c; c = z;
+    }
+
+    return( c );
+}
+
+/*
+ * Number of limbs of scratch space needed by mpi_kara_mul() for n limbs.
+ */
+static size_t mpi_kara_ws_size( size_t n )
+{
+    size_t h, ws = 0;
+
+    while( n >= MPI_KARATSUBA_THRESHOLD )
+    {
+        h = n - n / 2;
+        ws += 4 * h + 4;
+        n = h + 1;
+    }
+
+    return( ws );
+}
+
+/*
+ * Karatsuba multiplication of n-limb numbers: r[0..2n-1] = a * b.
+ *
+ * With a = a0 + a1 * W^m and b = b0 + b1 * W^m (W = 2^biL, m = n / 2),
+ * a * b = z0 + z1 * W^m + z2 * W^2m where z0 = a0 * b0, z2 = a1 * b1 and
+ * z1 = (a0 + a1) * (b0 + b1) - z0 - z2: three half-size products instead of
+ * four. The sums are kept in h + 1 limbs (h = n - m), so there are no
+ * data-dependent branches.
+ *
+ * ws must have at least mpi_kara_ws_size( n ) limbs.
+ */
+static void mpi_kara_mul( size_t n, mbedtls_mpi_uint *a, mbedtls_mpi_uint *b,
+                          mbedtls_mpi_uint *r, mbedtls_mpi_uint *ws )
+{
+    size_t i, m, h;
+    mbedtls_mpi_uint *sa, *sb, *p;
+
+    if( n < MPI_KARATSUBA_THRESHOLD )
+    {
+        memset( r, 0, 2 * n * ciL );
+
+        for( i = 0; i < n; i++ )
+            r[i + n] = mpi_mul_row( n, a, r + i, b[i] );
+
+        return;
+    }
+
+    m = n / 2;
+    h = n - m;
+
+    sa = ws;
+    sb = sa + h + 1;
+    p  = sb + h + 1;
+    ws = p + 2 * h + 2;
+
+    /* z0 and z2 go straight to their place in r */
+    mpi_kara_mul( m, a, b, r, ws );
+    mpi_kara_mul( h, a + m, b + m, r + 2 * m, ws );
+
+    /* p = (a0 + a1) * (b0 + b1) */
+    memcpy( sa, a + m, h * ciL );
+    memcpy( sb, b + m, h * ciL );
+    sa[h] = mpi_kara_add( m, h - m, sa, a );
+    sb[h] = mpi_kara_add( m, h - m, sb, b );
+    mpi_kara_mul( h + 1, sa, sb, p, ws );
+
+    /* p = z1, which is less than 2 * W^n, so it fits in n + 1 limbs */
+    (void) mpi_kara_sub( 2 * m, 2 * ( h - m ) + 2, p, r );
+    (void) mpi_kara_sub( 2 * h, 2, p, r + 2 * m );
+
+    /* r += z1 * W^m; this can't carry out since a * b fits in 2n limbs */
+    (void) mpi_kara_add( n + 1, n - m - 1, r + m, p );
+}
+
+/*
+ * X[0..i+j-1] = A[0..i-1] * B[0..j-1] with Karatsuba multiplication, for
+ * i and j both at least MPI_KARATSUBA_THRESHOLD. X must be zero on entry.
+ * Unbalanced operands are cut into pieces the size of the shorter one.
+ */
+static int mpi_mul_karatsuba( mbedtls_mpi_uint *X,
+                              mbedtls_mpi_uint *A, size_t i,
+                              mbedtls_mpi_uint *B, size_t j )
+{
+    size_t k, wsn;
+    mbedtls_mpi_uint *ws, *t;
+
+    if( i < j )
+    {
+        t = A; A = B; B = t;
+        k = i; i = j; j = k;
+    }
+
+    wsn = 2 * j + mpi_kara_ws_size( j );
+    ws = mbedtls_calloc( wsn, ciL );
+    if( ws == NULL )
+        return( MBEDTLS_ERR_MPI_ALLOC_FAILED );
+
+    for( k = 0; k + j <= i; k += j )
+    {
+        mpi_kara_mul( j, A + k, B, ws, ws + 2 * j );
+        (void) mpi_kara_add( 2 * j, i - k - j, X + k, ws );
+    }
+
+    /* Leftover piece of A, shorter than B */
+    for( ; k < i; k++ )
+        mpi_mul_hlp( j, B, X + k, A[k] );
+
+    mbedtls_platform_zeroize( ws, wsn * ciL );
+    mbedtls_free( ws );
+
+    return( 0 );
+}
+
 /*
  * Baseline multiplication: X = A * B  (HAC 14.12)
  */
@@ -1607,6 +1929,7 @@ int mbedtls_mpi_mul_mpi( mbedtls_mpi *X, const mbedtls_mpi *A, const mbedtls_mpi
 {
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
     size_t i, j;
+    int s;
     mbedtls_mpi TA, TB;
     MPI_VALIDATE_RET( X != NULL );
     MPI_VALIDATE_RET( A != NULL );
@@ -1614,9 +1937,6 @@ int mbedtls_mpi_mul_mpi( mbedtls_mpi *X, const mbedtls_mpi *A, const mbedtls_mpi
 
     mbedtls_mpi_init( &TA ); mbedtls_mpi_init( &TB );
 
-    if( X == A ) { MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &TA, A ) ); A = &TA; }
-    if( X == B ) { MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &TB, B ) ); B = &TB; }
-
     for( i = A->n; i > 0; i-- )
         if( A->p[i - 1] != 0 )
             break;
@@ -1625,13 +1945,45 @@ int mbedtls_mpi_mul_mpi( mbedtls_mpi *X, const mbedtls_mpi *A, const mbedtls_mpi
         if( B->p[j - 1] != 0 )
             break;
 
+    s = A->s * B->s;
+
+    if( ( X == A || X == B ) && i + j <= MPI_STACK_LIMBS )
+    {
+        mbedtls_mpi_uint buf[MPI_STACK_LIMBS];
+        size_t k;
+
+        memset( buf, 0, ( i + j ) * ciL );
+
+        for( k = j; k > 0; k-- )
+            mpi_mul_hlp( i, A->p, buf + k - 1, B->p[k - 1] );
+
+        MBEDTLS_MPI_CHK( mbedtls_mpi_grow( X, i + j ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_lset( X, 0 ) );
+        memcpy( X->p, buf, ( i + j ) * ciL );
+        mbedtls_platform_zeroize( buf, ( i + j ) * ciL );
+
+        X->s = s;
+        ret = 0;
+        goto cleanup;
+    }
+
+    if( X == A ) { MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &TA, A ) ); A = &TA; }
+    if( X == B ) { MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &TB, B ) ); B = &TB; }
+
     MBEDTLS_MPI_CHK( mbedtls_mpi_grow( X, i + j ) );
     MBEDTLS_MPI_CHK( mbedtls_mpi_lset( X, 0 ) );
 
-    for( ; j > 0; j-- )
-        mpi_mul_hlp( i, A->p, X->p + j - 1, B->p[j - 1] );
+    if( i >= MPI_KARATSUBA_THRESHOLD && j >= MPI_KARATSUBA_THRESHOLD )
+    {
+        MBEDTLS_MPI_CHK( mpi_mul_karatsuba( X->p, A->p, i, B->p, j ) );
+    }
+    else
+    {
+        for( ; j > 0; j-- )
+            mpi_mul_hlp( i, A->p, X->p + j - 1, B->p[j - 1] );
+    }
 
-    X->s = A->s * B->s;
+    X->s = s;
 
 cleanup:
 
@@ -2089,6 +2441,146 @@ static void mpi_montred( mbedtls_mpi *A, const mbedtls_mpi *N,
     mpi_montmul( A, &U, N, mm, T );
 }
 
+/*
+ * Below this many limbs in the modulus, the short rows computed by
+ * mpi_montsqr() cost more in call overhead than they save in multiplications,
+ * so squarings go through mpi_montmul() instead.
+ */
+#define MPI_MONTSQR_THRESHOLD   16
+
+/*
+ * Helper for mpi_montsqr(): d[0] += s[0]^2 + c.
+ * Returns the high limb; this can't overflow since the sum is at most
+ * (2^biL - 1) + (2^biL - 1)^2 + (2^biL - 1) = 2^(2*biL) - 1.
+ */
+static mbedtls_mpi_uint mpi_sqr_limb( mbedtls_mpi_uint *s, mbedtls_mpi_uint *d,
+                                      mbedtls_mpi_uint c )
+{
+    mbedtls_mpi_uint b = *s, t = 0;
+
+    MULADDC_INIT
+    MULADDC_CORE
+    MULADDC_STOP
+
+    t++;
+
+    return( c );
+}
+
+/*
+ * Montgomery squaring: A = A * A * R^-1 mod N
+ *
+ * Each cross product A[i] * A[j] (i != j) is only computed once and then
+ * doubled, which saves almost half of the limb multiplications compared to
+ * mpi_montmul( A, A, ... ). The reduction is done separately afterwards.
+ *
+ * See mpi_montmul() regarding constraints and guarantees on the parameters.
+ * A must be less than N.
+ */
+static void mpi_montsqr( mbedtls_mpi *A, const mbedtls_mpi *N,
+                         mbedtls_mpi_uint mm, const mbedtls_mpi *T )
+{
+    size_t i, n;
+    mbedtls_mpi_uint c, h, *a, *d;
+
+    if( N->n < MPI_MONTSQR_THRESHOLD )
+    {
+        mpi_montmul( A, A, N, mm, T );
+        return;
+    }
+
+    memset( T->p, 0, T->n * ciL );
+
+    a = A->p;
+    d = T->p;
+    n = N->n;
+
+    /* d = sum of A[i] * A[j] * 2^(biL*(i+j)) over i < j */
+    for( i = 0; i + 1 < n; i++ )
+        d[i + n] = mpi_mul_row( n - i - 1, a + i + 1, d + 2 * i + 1, a[i] );
+
+    /* d = 2 * d */
+    for( i = 2 * n - 1; i > 0; i-- )
+        d[i] = ( d[i] << 1 ) | ( d[i - 1] >> ( biL - 1 ) );
+    d[0] <<= 1;
+
+    /* d += sum of A[i]^2 * 2^(biL*2*i) */
+    for( i = 0, c = 0; i < n; i++ )
+    {
+        h = mpi_sqr_limb( a + i, d + 2 * i, c );
+        d[2 * i + 1] += h; c = ( d[2 * i + 1] < h );
+    }
+
+    /*
+     * d = (d + u * N) / 2^biL, n times, where each u cancels the current
+     * least significant limb. c holds the carry out of d[i + n].
+     */
+    for( i = 0, c = 0; i < n; i++ )
+    {
+        h = mpi_mul_row( n, N->p, d + i, d[i] * mm );
+        h += c; c = ( h < c );
+        d[i + n] += h; c += ( d[i + n] < h );
+    }
+
+    /* As in mpi_montmul(), d is now either the result or the result
+     * plus N, so potentially subtract N in constant time. */
+    d += n;
+    d[n] = c;
+
+    memcpy( A->p, d, n * ciL );
+    d[n] += 1;
+    d[n] -= mpi_sub_hlp( n, d, N->p );
+    mpi_safe_cond_assign( n, A->p, d, (unsigned char) d[n] );
+}
+
+/*
+ * Montgomery constant for callers that keep their operands in Montgomery form
+ */
+void mbedtls_mpi_montg_init( mbedtls_mpi_uint *mm, const mbedtls_mpi *N )
+{
+    MPI_VALIDATE( mm != NULL );
+    MPI_VALIDATE( N != NULL );
+
+    mpi_montg_init( mm, N );
+}
+
+/*
+ * Montgomery multiplication: X = A * B * R^-1 mod N
+ */
+int mbedtls_mpi_montmul( mbedtls_mpi *X, const mbedtls_mpi *A,
+                         const mbedtls_mpi *B, const mbedtls_mpi *N,
+                         mbedtls_mpi_uint mm, mbedtls_mpi *T )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    MPI_VALIDATE_RET( X != NULL );
+    MPI_VALIDATE_RET( A != NULL );
+    MPI_VALIDATE_RET( B != NULL );
+    MPI_VALIDATE_RET( N != NULL );
+    MPI_VALIDATE_RET( T != NULL );
+
+    if( N->n == 0 || ( N->p[0] & 1 ) == 0 )
+        return( MBEDTLS_ERR_MPI_BAD_INPUT_DATA );
+
+    if( A->n == 0 || B->n == 0 )
+        return( mbedtls_mpi_lset( X, 0 ) );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_grow( T, 2 * ( N->n + 1 ) ) );
+
+    /* mpi_montmul() works in place on its first operand */
+    if( X == B )
+        B = A;
+    else if( X != A )
+        MBEDTLS_MPI_CHK( mbedtls_mpi_copy( X, A ) );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_grow( X, N->n ) );
+
+    mpi_montmul( X, B, N, mm, T );
+    X->s = 1;
+
+cleanup:
+    return( ret );
+}
+
 /*
  * Sliding-window exponentiation: X = A^E mod N  (HAC 14.85)
  */
@@ -2191,7 +2683,7 @@ int mbedtls_mpi_exp_mod( mbedtls_mpi *X, const mbedtls_mpi *A,
         MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &W[j], &W[1]    ) );
 
         for( i = 0; i < wsize - 1; i++ )
-            mpi_montmul( &W[j], &W[j], N, mm, &T );
+            mpi_montsqr( &W[j], N, mm, &T );
 
         /*
          * W[i] = W[i - 1] * W[1]
@@ -2238,7 +2730,7 @@ int mbedtls_mpi_exp_mod( mbedtls_mpi *X, const mbedtls_mpi *A,
             /*
              * out of window, square X
              */
-            mpi_montmul( X, X, N, mm, &T );
+            mpi_montsqr( X, N, mm, &T );
             continue;
         }
 
@@ -2256,7 +2748,7 @@ int mbedtls_mpi_exp_mod( mbedtls_mpi *X, const mbedtls_mpi *A,
              * X = X^wsize R^-1 mod N
              */
             for( i = 0; i < wsize; i++ )
-                mpi_montmul( X, X, N, mm, &T );
+                mpi_montsqr( X, N, mm, &T );
 
             /*
              * X = X * W[wbits] R^-1 mod N
@@ -2274,7 +2766,7 @@ int mbedtls_mpi_exp_mod( mbedtls_mpi *X, const mbedtls_mpi *A,
      */
     for( i = 0; i < nbits; i++ )
     {
-        mpi_montmul( X, X, N, mm, &T );
+        mpi_montsqr( X, N, mm, &T );
 
         wbits <<= 1;
 
@@ -2306,26 +2798,253 @@ cleanup:
     return( ret );
 }
 
+#if defined(MBEDTLS_DHM_FIXED_BASE)
+
 /*
- * Greatest common divisor: G = gcd(A, B)  (HAC 14.54)
+ * Width of the comb used by mbedtls_mpi_exp_mod_table(): the table has
+ * 2^MPI_EXP_TABLE_WIDTH entries and an exponentiation costs
+ * ceil( ebits / MPI_EXP_TABLE_WIDTH ) squarings and multiplications.
+ * Each multiplication reads the whole table to keep the exponent secret,
+ * which is what limits the width.
  */
-int mbedtls_mpi_gcd( mbedtls_mpi *G, const mbedtls_mpi *A, const mbedtls_mpi *B )
+#define MPI_EXP_TABLE_WIDTH     6
+
+void mbedtls_mpi_exp_table_init( mbedtls_mpi_exp_table *table )
+{
+    MPI_VALIDATE( table != NULL );
+
+    mbedtls_mpi_init( &table->N );
+    mbedtls_mpi_init( &table->G );
+    table->mm = 0;
+    table->w = 0;
+    table->d = 0;
+    table->T = NULL;
+}
+
+void mbedtls_mpi_exp_table_free( mbedtls_mpi_exp_table *table )
+{
+    if( table == NULL )
+        return;
+
+    if( table->T != NULL )
+    {
+        mbedtls_platform_zeroize( table->T,
+                                  ( (size_t) 1 << table->w ) * table->N.n * ciL );
+        mbedtls_free( table->T );
+    }
+
+    mbedtls_mpi_free( &table->N );
+    mbedtls_mpi_free( &table->G );
+    table->mm = 0;
+    table->w = 0;
+    table->d = 0;
+    table->T = NULL;
+}
+
+/*
+ * Fixed-base comb (HAC 14.117 with h = 2): with d = ceil( ebits / w ),
+ * entry j of the table is the product of G^(2^(i*d)) over the bits i set
+ * in j, in Montgomery form. Entry 0 is 1 in Montgomery form.
+ */
+int mbedtls_mpi_exp_table_setup( mbedtls_mpi_exp_table *table,
+                                 const mbedtls_mpi *G, const mbedtls_mpi *N,
+                                 size_t ebits )
 {
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
-    size_t lz, lzt;
-    mbedtls_mpi TA, TB;
+    size_t i, j, k, n, w, d, count;
+    mbedtls_mpi RR, T, B[MPI_EXP_TABLE_WIDTH], W;
 
+    MPI_VALIDATE_RET( table != NULL );
     MPI_VALIDATE_RET( G != NULL );
-    MPI_VALIDATE_RET( A != NULL );
-    MPI_VALIDATE_RET( B != NULL );
+    MPI_VALIDATE_RET( N != NULL );
 
-    mbedtls_mpi_init( &TA ); mbedtls_mpi_init( &TB );
+    if( mbedtls_mpi_cmp_int( N, 0 ) <= 0 || ( N->p[0] & 1 ) == 0 ||
+        mbedtls_mpi_cmp_int( G, 0 ) < 0 ||
+        ebits == 0 || ebits > MBEDTLS_MPI_MAX_BITS )
+        return( MBEDTLS_ERR_MPI_BAD_INPUT_DATA );
 
-    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &TA, A ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &TB, B ) );
+    mbedtls_mpi_exp_table_free( table );
 
-    lz = mbedtls_mpi_lsb( &TA );
-    lzt = mbedtls_mpi_lsb( &TB );
+    mbedtls_mpi_init( &RR ); mbedtls_mpi_init( &T ); mbedtls_mpi_init( &W );
+    for( i = 0; i < MPI_EXP_TABLE_WIDTH; i++ )
+        mbedtls_mpi_init( &B[i] );
+
+    w = ( ebits < MPI_EXP_TABLE_WIDTH ) ? ebits : MPI_EXP_TABLE_WIDTH;
+    d = ( ebits + w - 1 ) / w;
+    count = (size_t) 1 << w;
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &table->N, N ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_shrink( &table->N, 0 ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &table->G, G, N ) );
+    n = table->N.n;
+    N = &table->N;
+
+    table->T = mbedtls_calloc( count * n, ciL );
+    if( table->T == NULL )
+    {
+        ret = MBEDTLS_ERR_MPI_ALLOC_FAILED;
+        goto cleanup;
+    }
+    table->w = w;
+    table->d = d;
+    mpi_montg_init( &table->mm, N );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_grow( &T, 2 * ( n + 1 ) ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &RR, 1 ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_shift_l( &RR, n * 2 * biL ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &RR, &RR, N ) );
+
+    /*
+     * B[i] = G^(2^(i*d)) * R mod N
+     */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &B[0], &table->G ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_grow( &B[0], n + 1 ) );
+    mpi_montmul( &B[0], &RR, N, table->mm, &T );
+
+    for( i = 1; i < w; i++ )
+    {
+        MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &B[i], &B[i - 1] ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_grow( &B[i], n + 1 ) );
+        for( k = 0; k < d; k++ )
+            mpi_montsqr( &B[i], N, table->mm, &T );
+    }
+
+    /*
+     * T[0] = R mod N, T[j] = T[j - 2^i] * B[i] with 2^i the top bit of j
+     */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &W, &RR ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_grow( &W, n + 1 ) );
+    mpi_montred( &W, N, table->mm, &T );
+    memcpy( table->T, W.p, n * ciL );
+
+    for( i = 0; i < w; i++ )
+    {
+        for( j = (size_t) 1 << i; j < (size_t) 2 << i; j++ )
+        {
+            memcpy( W.p, table->T + ( j - ( (size_t) 1 << i ) ) * n, n * ciL );
+            mpi_montmul( &W, &B[i], N, table->mm, &T );
+            memcpy( table->T + j * n, W.p, n * ciL );
+        }
+    }
+
+cleanup:
+
+    mbedtls_mpi_free( &RR ); mbedtls_mpi_free( &T ); mbedtls_mpi_free( &W );
+    for( i = 0; i < MPI_EXP_TABLE_WIDTH; i++ )
+        mbedtls_mpi_free( &B[i] );
+
+    if( ret != 0 )
+        mbedtls_mpi_exp_table_free( table );
+
+    return( ret );
+}
+
+/*
+ * dest = T[idx], reading every entry of the table so that the memory
+ * access pattern doesn't depend on idx.
+ */
+static void mpi_exp_table_select( mbedtls_mpi_uint *dest,
+                                  const mbedtls_mpi_uint *T,
+                                  size_t count, size_t n, size_t idx )
+{
+    size_t i, j;
+    mbedtls_mpi_uint diff, mask;
+
+    memset( dest, 0, n * ciL );
+
+    for( i = 0; i < count; i++, T += n )
+    {
+        /* mask is all-ones if i == idx and 0 otherwise */
+        diff = (mbedtls_mpi_uint)( i ^ idx );
+        mask = ( ( diff | ( (mbedtls_mpi_uint) 0 - diff ) ) >> ( biL - 1 ) ) - 1;
+
+        for( j = 0; j < n; j++ )
+            dest[j] |= T[j] & mask;
+    }
+}
+
+/*
+ * Fixed-base exponentiation: X = G^E mod N, with G and N from the table
+ */
+int mbedtls_mpi_exp_mod_table( mbedtls_mpi *X, const mbedtls_mpi *E,
+                               const mbedtls_mpi_exp_table *table )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t i, col, bit, idx, n;
+    mbedtls_mpi T, S, R;
+
+    MPI_VALIDATE_RET( X != NULL );
+    MPI_VALIDATE_RET( E != NULL );
+    MPI_VALIDATE_RET( table != NULL );
+
+    if( table->T == NULL || mbedtls_mpi_cmp_int( E, 0 ) < 0 ||
+        mbedtls_mpi_bitlen( E ) > table->w * table->d )
+        return( MBEDTLS_ERR_MPI_BAD_INPUT_DATA );
+
+    n = table->N.n;
+
+    mbedtls_mpi_init( &T ); mbedtls_mpi_init( &S ); mbedtls_mpi_init( &R );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_grow( &T, 2 * ( n + 1 ) ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_grow( &S, n ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_grow( &R, n + 1 ) );
+
+    memcpy( R.p, table->T, n * ciL );
+
+    for( col = table->d; col-- > 0; )
+    {
+        if( col != table->d - 1 )
+            mpi_montsqr( &R, &table->N, table->mm, &T );
+
+        /*
+         * idx gathers bits col, col + d, ..., col + (w - 1) * d of E
+         */
+        idx = 0;
+        for( i = 0, bit = col; i < table->w; i++, bit += table->d )
+        {
+            if( bit / biL < E->n )
+                idx |= (size_t)( ( E->p[bit / biL] >> ( bit % biL ) ) & 1 ) << i;
+        }
+
+        mpi_exp_table_select( S.p, table->T, (size_t) 1 << table->w, n, idx );
+        mpi_montmul( &R, &S, &table->N, table->mm, &T );
+    }
+
+    /*
+     * X = G^E * R * R^-1 mod N = G^E mod N
+     */
+    mpi_montred( &R, &table->N, table->mm, &T );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( X, &R ) );
+
+cleanup:
+
+    mbedtls_mpi_free( &T ); mbedtls_mpi_free( &S ); mbedtls_mpi_free( &R );
+
+    return( ret );
+}
+
+#endif /* MBEDTLS_DHM_FIXED_BASE */
+
+/*
+ * Greatest common divisor: G = gcd(A, B)  (HAC 14.54)
+ */
+int mbedtls_mpi_gcd( mbedtls_mpi *G, const mbedtls_mpi *A, const mbedtls_mpi *B )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t lz, lzt;
+    mbedtls_mpi TA, TB;
+
+    MPI_VALIDATE_RET( G != NULL );
+    MPI_VALIDATE_RET( A != NULL );
+    MPI_VALIDATE_RET( B != NULL );
+
+    mbedtls_mpi_init( &TA ); mbedtls_mpi_init( &TB );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &TA, A ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &TB, B ) );
+
+    lz = mbedtls_mpi_lsb( &TA );
+    lzt = mbedtls_mpi_lsb( &TB );
 
     if( lzt < lz )
         lz = lzt;
@@ -2497,6 +3216,298 @@ cleanup:
     return( ret );
 }
 
+/*
+ * Constant-time modular inverse for odd moduli
+ *
+ * This is the "safegcd" algorithm from Bernstein and Yang, "Fast
+ * constant-time gcd computation and modular inversion" (TCHES 2019), in
+ * the form used by libsecp256k1: divsteps are computed in batches of
+ * MPI_SAFEGCD_BATCH on the low limb of f and g only, which gives a 2x2
+ * transition matrix scaled by 2^MPI_SAFEGCD_BATCH that is then applied to
+ * the full-size f, g, d and e. All values are kept as fixed-size two's
+ * complement limb arrays and the number of batches only depends on the
+ * size of the modulus.
+ */
+#define MPI_SAFEGCD_BATCH   ( biL - 2 )
+#define MPI_SAFEGCD_MASK    ( ( (mbedtls_mpi_uint) 1 << MPI_SAFEGCD_BATCH ) - 1 )
+
+/*
+ * Full multiplication of two limbs: (*hi, *lo) = a * b
+ */
+static void mpi_mul_limb( mbedtls_mpi_uint a, mbedtls_mpi_uint b,
+                          mbedtls_mpi_uint *hi, mbedtls_mpi_uint *lo )
+{
+#if defined(MBEDTLS_HAVE_UDBL)
+    mbedtls_t_udbl r = (mbedtls_t_udbl) a * b;
+
+    *lo = (mbedtls_mpi_uint) r;
+    *hi = (mbedtls_mpi_uint)( r >> biL );
+#else
+    const mbedtls_mpi_uint m = ( (mbedtls_mpi_uint) 1 << biH ) - 1;
+    mbedtls_mpi_uint a0 = a & m, a1 = a >> biH;
+    mbedtls_mpi_uint b0 = b & m, b1 = b >> biH;
+    mbedtls_mpi_uint p00 = a0 * b0, p01 = a0 * b1;
+    mbedtls_mpi_uint p10 = a1 * b0, p11 = a1 * b1;
+    mbedtls_mpi_uint mid = ( p00 >> biH ) + ( p01 & m ) + ( p10 & m );
+
+    *lo = ( mid << biH ) | ( p00 & m );
+    *hi = p11 + ( p01 >> biH ) + ( p10 >> biH ) + ( mid >> biH );
+#endif
+}
+
+/*
+ * Perform MPI_SAFEGCD_BATCH divsteps on the low limbs of f and g and store
+ * the transition matrix, scaled by 2^MPI_SAFEGCD_BATCH, in t[] as signed
+ * limbs. eta is minus Bernstein and Yang's delta.
+ */
+static mbedtls_mpi_sint mpi_safegcd_divsteps( mbedtls_mpi_sint eta,
+                                              mbedtls_mpi_uint f,
+                                              mbedtls_mpi_uint g,
+                                              mbedtls_mpi_uint t[4] )
+{
+    mbedtls_mpi_uint u = 1, v = 0, q = 0, r = 1;
+    mbedtls_mpi_uint c1, c2, x, y, z;
+    size_t i;
+
+    for( i = 0; i < MPI_SAFEGCD_BATCH; i++ )
+    {
+        /* c1: delta > 0, c2: g is odd */
+        c1 = - ( (mbedtls_mpi_uint) eta >> ( biL - 1 ) );
+        c2 = - ( g & 1 );
+
+        /* (x, y, z) = c1 ? -(f, u, v) : (f, u, v) */
+        x = ( f ^ c1 ) - c1;
+        y = ( u ^ c1 ) - c1;
+        z = ( v ^ c1 ) - c1;
+
+        /* If g is odd, add (x, y, z) to (g, q, r) */
+        g += x & c2;
+        q += y & c2;
+        r += z & c2;
+
+        /* If both conditions hold, swap: (f, u, v) becomes the old
+         * (g, q, r) and eta is negated */
+        c1 &= c2;
+        eta = ( eta ^ (mbedtls_mpi_sint) c1 ) - (mbedtls_mpi_sint) c1 - 1;
+        f += g & c1;
+        u += q & c1;
+        v += r & c1;
+
+        /* Halve g; the matrix is scaled by doubling the other row */
+        g >>= 1;
+        u <<= 1;
+        v <<= 1;
+    }
+
+    t[0] = u; t[1] = v; t[2] = q; t[3] = r;
+
+    return( eta );
+}
+
+/*
+ * R += X * s mod 2^(biL * n), where X is in two's complement and s is a
+ * signed limb with |s| < 2^(biL - 1)
+ */
+static void mpi_safegcd_mul_add( mbedtls_mpi_uint *R,
+                                 const mbedtls_mpi_uint *X,
+                                 mbedtls_mpi_uint s, size_t n )
+{
+    const mbedtls_mpi_uint neg = - ( s >> ( biL - 1 ) );
+    const mbedtls_mpi_uint a = ( s ^ neg ) - neg;
+    mbedtls_mpi_uint mc = 0, nc = neg & 1, ac = 0, hi, lo, t;
+    size_t i;
+
+    for( i = 0; i < n; i++ )
+    {
+        mpi_mul_limb( X[i], a, &hi, &lo );
+        lo += mc; hi += ( lo < mc ); mc = hi;
+
+        /* Negate the product on the fly if s < 0 */
+        lo ^= neg; lo += nc; nc = ( lo < nc );
+
+        t = R[i] + lo; hi = ( t < lo );
+        t += ac; ac = hi | ( t < ac );
+        R[i] = t;
+    }
+}
+
+/*
+ * Arithmetic right shift of an n-limb two's complement value by
+ * MPI_SAFEGCD_BATCH bits
+ */
+static void mpi_safegcd_shift_r( mbedtls_mpi_uint *R, size_t n )
+{
+    const mbedtls_mpi_uint sign = - ( R[n - 1] >> ( biL - 1 ) );
+    size_t i;
+
+    for( i = 0; i + 1 < n; i++ )
+        R[i] = ( R[i] >> MPI_SAFEGCD_BATCH ) |
+               ( R[i + 1] << ( biL - MPI_SAFEGCD_BATCH ) );
+
+    R[n - 1] = ( R[n - 1] >> MPI_SAFEGCD_BATCH ) |
+               ( sign << ( biL - MPI_SAFEGCD_BATCH ) );
+}
+
+/*
+ * (X, Y) = ((t[0] X + t[1] Y + mx M) / 2^B, (t[2] X + t[3] Y + my M) / 2^B)
+ * using T as scratch space for 2 * n limbs. M may be NULL, in which case
+ * mx and my are ignored. All divisions are exact.
+ */
+static void mpi_safegcd_update( mbedtls_mpi_uint *X, mbedtls_mpi_uint *Y,
+                                const mbedtls_mpi_uint t[4],
+                                const mbedtls_mpi_uint *M,
+                                mbedtls_mpi_uint mx, mbedtls_mpi_uint my,
+                                mbedtls_mpi_uint *T, size_t n )
+{
+    mbedtls_mpi_uint *T2 = T + n;
+
+    memset( T, 0, 2 * n * ciL );
+
+    mpi_safegcd_mul_add( T,  X, t[0], n );
+    mpi_safegcd_mul_add( T,  Y, t[1], n );
+    mpi_safegcd_mul_add( T2, X, t[2], n );
+    mpi_safegcd_mul_add( T2, Y, t[3], n );
+
+    if( M != NULL )
+    {
+        mpi_safegcd_mul_add( T,  M, mx, n );
+        mpi_safegcd_mul_add( T2, M, my, n );
+    }
+
+    mpi_safegcd_shift_r( T,  n );
+    mpi_safegcd_shift_r( T2, n );
+
+    memcpy( X, T,  n * ciL );
+    memcpy( Y, T2, n * ciL );
+}
+
+/*
+ * Constant-time modular inverse: X = A^-1 mod N, N odd
+ */
+int mbedtls_mpi_inv_mod_ct( mbedtls_mpi *X, const mbedtls_mpi *A,
+                            const mbedtls_mpi *N )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t nbits, nlimbs, n = 0, i, steps;
+    mbedtls_mpi TA;
+    mbedtls_mpi_uint *buf = NULL, *f, *g, *d, *e, *M, *T;
+    mbedtls_mpi_uint t[4], ninv, sd, se, md, me, cd, ce, fm1, f1, mask;
+    mbedtls_mpi_sint eta = -1;
+    MPI_VALIDATE_RET( X != NULL );
+    MPI_VALIDATE_RET( A != NULL );
+    MPI_VALIDATE_RET( N != NULL );
+
+    if( mbedtls_mpi_cmp_int( N, 1 ) <= 0 || ( N->p[0] & 1 ) == 0 )
+        return( MBEDTLS_ERR_MPI_BAD_INPUT_DATA );
+
+    mbedtls_mpi_init( &TA );
+
+    /* A is normally already reduced, so only pay for a reduction if not */
+    if( A->s < 0 || mbedtls_mpi_cmp_mpi( A, N ) >= 0 )
+    {
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &TA, A, N ) );
+        A = &TA;
+    }
+
+    /* One spare limb for the sign and one for intermediate growth */
+    nbits = mbedtls_mpi_bitlen( N );
+    nlimbs = ( nbits + biL - 1 ) / biL;
+    n = nlimbs + 2;
+
+    buf = mbedtls_calloc( 7 * n, ciL );
+    if( buf == NULL )
+    {
+        ret = MBEDTLS_ERR_MPI_ALLOC_FAILED;
+        goto cleanup;
+    }
+
+    f = buf; g = f + n; d = g + n; e = d + n; M = e + n; T = M + n;
+
+    /* f = N, g = A, d = 0, e = 1 */
+    memcpy( M, N->p, nlimbs * ciL );
+    memcpy( f, N->p, nlimbs * ciL );
+    for( i = 0; i < A->n && i < nlimbs; i++ )
+        g[i] = A->p[i];
+    e[0] = 1;
+
+    /* -N^-1 mod 2^biL, negated to N^-1 */
+    mpi_montg_init( &ninv, N );
+    ninv = -ninv;
+
+    /* Number of divsteps that suffices for nbits-bit inputs (Bernstein and
+     * Yang, theorem 11.2) */
+    steps = ( nbits < 46 ) ? ( 49 * nbits + 80 ) / 17
+                           : ( 49 * nbits + 57 ) / 17;
+
+    for( i = 0; i < steps; i += MPI_SAFEGCD_BATCH )
+    {
+        eta = mpi_safegcd_divsteps( eta, f[0], g[0], t );
+
+        /* Choose md, me so that the low bits of t * (d, e) + (md, me) * N
+         * vanish, and add N to any negative d or e beforehand so that both
+         * stay in (-2N, N) */
+        sd = - ( d[n - 1] >> ( biL - 1 ) );
+        se = - ( e[n - 1] >> ( biL - 1 ) );
+        md = ( t[0] & sd ) + ( t[1] & se );
+        me = ( t[2] & sd ) + ( t[3] & se );
+        cd = t[0] * d[0] + t[1] * e[0];
+        ce = t[2] * d[0] + t[3] * e[0];
+        md -= ( ninv * cd + md ) & MPI_SAFEGCD_MASK;
+        me -= ( ninv * ce + me ) & MPI_SAFEGCD_MASK;
+
+        mpi_safegcd_update( d, e, t, M, md, me, T, n );
+        mpi_safegcd_update( f, g, t, NULL, 0, 0, T, n );
+    }
+
+    /* Now g = 0 and f = +-gcd(A, N) = +-d * A mod N */
+    f1 = f[0] ^ 1;
+    fm1 = ~f[0];
+    for( i = 1; i < n; i++ )
+    {
+        f1 |= f[i];
+        fm1 |= ~f[i];
+    }
+
+    if( f1 != 0 && fm1 != 0 )
+    {
+        ret = MBEDTLS_ERR_MPI_NOT_ACCEPTABLE;
+        goto cleanup;
+    }
+
+    /* d = d * f, which is in (-N, 2N) */
+    memset( T, 0, n * ciL );
+    mpi_safegcd_mul_add( T, d, f[0], n );
+
+    /* d += N if d < 0 */
+    mask = T[n - 1] >> ( biL - 1 );
+    mpi_safegcd_mul_add( T, M, mask, n );
+
+    /* d -= N if d >= N */
+    memcpy( T + n, T, n * ciL );
+    mpi_safegcd_mul_add( T + n, M, (mbedtls_mpi_uint) -1, n );
+    mask = ( T[2 * n - 1] >> ( biL - 1 ) ) - 1;
+    for( i = 0; i < n; i++ )
+        T[i] = ( T[i] & ~mask ) | ( T[n + i] & mask );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_grow( X, nlimbs ) );
+    memset( X->p, 0, X->n * ciL );
+    memcpy( X->p, T, nlimbs * ciL );
+    X->s = 1;
+
+    ret = 0;
+
+cleanup:
+
+    if( buf != NULL )
+    {
+        mbedtls_platform_zeroize( buf, 7 * n * ciL );
+        mbedtls_free( buf );
+    }
+    mbedtls_mpi_free( &TA );
+
+    return( ret );
+}
+
 #if defined(MBEDTLS_GENPRIME)
 
 static const int small_prime[] =
@@ -2595,8 +3606,10 @@ static int mpi_miller_rabin( const mbedtls_mpi *X, size_t rounds,
 
             j = mbedtls_mpi_bitlen( &A );
             k = mbedtls_mpi_bitlen( &W );
+            /* Keep k - 1 bits. Not a mask on the top limb: X may have
+             * leading zero limbs, e.g. Y = (X-1) / 2 for safe primes. */
             if (j > k) {
-                A.p[A.n - 1] &= ( (mbedtls_mpi_uint) 1 << ( k - ( A.n - 1 ) * biL - 1 ) ) - 1;
+                MBEDTLS_MPI_CHK( mbedtls_mpi_shift_r( &A, j - k + 1 ) );
             }
 
             if (count++ > 30) {
@@ -2650,6 +3663,105 @@ cleanup:
     return( ret );
 }
 
+/*
+ * Prime search sieve: each random starting point X is followed by a window of
+ * MPI_SIEVE_SIZE candidates X + step * k. The candidates having a factor
+ * below MPI_SIEVE_BOUND are crossed out using the residues of X, which are
+ * computed once per window, and only the others go through Miller-Rabin.
+ * The sieve isn't used below MPI_SIEVE_MIN_BITS, where candidates could be
+ * sieving primes themselves.
+ */
+#define MPI_SIEVE_SIZE      1024
+#define MPI_SIEVE_BOUND     32768
+#define MPI_SIEVE_MIN_BITS  64
+
+/*
+ * Bitmap of the odd integers below MPI_SIEVE_BOUND, with bit p / 2 set if p
+ * is composite. It is filled once per call to mbedtls_mpi_gen_prime() with
+ * the sieve of Eratosthenes, and then used for every window.
+ */
+#define MPI_SIEVE_PRIMES_SIZE   ( MPI_SIEVE_BOUND / 16 )
+#define MPI_SIEVE_IS_COMPOSITE( composite, p )                              \
+    ( ( composite )[( p ) / 16] & ( 1 << ( ( ( p ) / 2 ) % 8 ) ) )
+
+static void mpi_sieve_primes( unsigned char *composite )
+{
+    mbedtls_mpi_uint p, q;
+
+    memset( composite, 0, MPI_SIEVE_PRIMES_SIZE );
+
+    for( p = 3; p * p < MPI_SIEVE_BOUND; p += 2 )
+    {
+        if( MPI_SIEVE_IS_COMPOSITE( composite, p ) )
+            continue;
+
+        for( q = p * p; q < MPI_SIEVE_BOUND; q += 2 * p )
+            composite[q / 16] |= (unsigned char) ( 1 << ( ( q / 2 ) % 8 ) );
+    }
+}
+
+/*
+ * a^-1 mod p for a small odd prime p, with 0 < a < p
+ */
+static mbedtls_mpi_uint mpi_sieve_inv( mbedtls_mpi_uint a, mbedtls_mpi_uint p )
+{
+    mbedtls_mpi_sint t0 = 0, t1 = 1, t, q;
+    mbedtls_mpi_sint r0 = (mbedtls_mpi_sint) p, r1 = (mbedtls_mpi_sint) a;
+
+    while( r1 != 0 )
+    {
+        q = r0 / r1;
+        t = r0 - q * r1; r0 = r1; r1 = t;
+        t = t0 - q * t1; t0 = t1; t1 = t;
+    }
+
+    return( (mbedtls_mpi_uint) ( t0 < 0 ? t0 + (mbedtls_mpi_sint) p : t0 ) );
+}
+
+/*
+ * Cross out in sieve[] (a bitmap of MPI_SIEVE_SIZE bits) the k such that
+ * X + step * k has an odd prime factor below MPI_SIEVE_BOUND, using the
+ * bitmap filled by mpi_sieve_primes(). If dh is set,
+ * also cross out those where (X + step * k - 1) / 2 has one, which happens
+ * when X + step * k = 1 mod p.
+ *
+ * Primes dividing step are skipped: they divide either all candidates or none
+ * of them, and the caller has already chosen X accordingly.
+ */
+static int mpi_sieve_fill( unsigned char *sieve,
+                           const unsigned char *composite,
+                           const mbedtls_mpi *X, mbedtls_mpi_uint step,
+                           int dh )
+{
+    int ret = 0;
+    mbedtls_mpi_uint p, r, inv, k;
+
+    memset( sieve, 0, MPI_SIEVE_SIZE / 8 );
+
+    for( p = 3; p < MPI_SIEVE_BOUND; p += 2 )
+    {
+        if( step % p == 0 || MPI_SIEVE_IS_COMPOSITE( composite, p ) )
+            continue;
+
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mod_int( &r, X, (mbedtls_mpi_sint) p ) );
+        inv = mpi_sieve_inv( step % p, p );
+
+        /* step * k = -r mod p */
+        for( k = ( ( p - r ) % p ) * inv % p; k < MPI_SIEVE_SIZE; k += p )
+            sieve[k / 8] |= (unsigned char) ( 1 << ( k % 8 ) );
+
+        if( dh == 0 )
+            continue;
+
+        /* step * k = 1 - r mod p */
+        for( k = ( ( p + 1 - r ) % p ) * inv % p; k < MPI_SIEVE_SIZE; k += p )
+            sieve[k / 8] |= (unsigned char) ( 1 << ( k % 8 ) );
+    }
+
+cleanup:
+    return( ret );
+}
+
 /*
  * Pseudo-primality test: small factors, then Miller-Rabin
  */
@@ -2724,9 +3836,11 @@ int mbedtls_mpi_gen_prime( mbedtls_mpi *X, size_t nbits, int flags,
 #endif
     int ret = MBEDTLS_ERR_MPI_NOT_ACCEPTABLE;
     size_t k, n;
-    int rounds;
-    mbedtls_mpi_uint r;
-    mbedtls_mpi Y;
+    int rounds, dh, sieved;
+    mbedtls_mpi_uint r, step;
+    unsigned char sieve[MPI_SIEVE_SIZE / 8];
+    unsigned char *composite = NULL;
+    mbedtls_mpi Y, B;
 
     MPI_VALIDATE_RET( X     != NULL );
     MPI_VALIDATE_RET( f_rng != NULL );
@@ -2734,7 +3848,7 @@ int mbedtls_mpi_gen_prime( mbedtls_mpi *X, size_t nbits, int flags,
     if( nbits < 3 || nbits > MBEDTLS_MPI_MAX_BITS )
         return( MBEDTLS_ERR_MPI_BAD_INPUT_DATA );
 
-    mbedtls_mpi_init( &Y );
+    mbedtls_mpi_init( &Y ); mbedtls_mpi_init( &B );
 
     n = BITS_TO_LIMBS( nbits );
 
@@ -2759,6 +3873,21 @@ int mbedtls_mpi_gen_prime( mbedtls_mpi *X, size_t nbits, int flags,
                    ( nbits >=  250 ) ? 28 : ( nbits >=   150 ) ? 40 : 51 );
     }
 
+    dh = ( flags & MBEDTLS_MPI_GEN_PRIME_FLAG_DH ) != 0;
+    sieved = ( nbits >= MPI_SIEVE_MIN_BITS );
+
+    if( sieved )
+    {
+        composite = mbedtls_calloc( 1, MPI_SIEVE_PRIMES_SIZE );
+        if( composite == NULL )
+        {
+            ret = MBEDTLS_ERR_MPI_ALLOC_FAILED;
+            goto cleanup;
+        }
+
+        mpi_sieve_primes( composite );
+    }
+
     while( 1 )
     {
         MBEDTLS_MPI_CHK( mbedtls_mpi_fill_random( X, n * ciL, f_rng, p_rng ) );
@@ -2769,19 +3898,17 @@ int mbedtls_mpi_gen_prime( mbedtls_mpi *X, size_t nbits, int flags,
         if( k > nbits ) MBEDTLS_MPI_CHK( mbedtls_mpi_shift_r( X, k - nbits ) );
         X->p[0] |= 1;
 
-        if( ( flags & MBEDTLS_MPI_GEN_PRIME_FLAG_DH ) == 0 )
+        if( dh == 0 )
         {
-            ret = mbedtls_mpi_is_prime_ext( X, rounds, f_rng, p_rng );
-
-            if( ret != MBEDTLS_ERR_MPI_NOT_ACCEPTABLE )
-                goto cleanup;
+            step = 2;
         }
         else
         {
             /*
              * An necessary condition for Y and X = 2Y + 1 to be prime
              * is X = 2 mod 3 (which is equivalent to Y = 2 mod 3).
-             * Make sure it is satisfied, while keeping X = 3 mod 4
+             * Make sure it is satisfied, while keeping X = 3 mod 4.
+             * Candidates are then X + 12 * k, which preserves both.
              */
 
             X->p[0] |= 2;
@@ -2792,41 +3919,70 @@ int mbedtls_mpi_gen_prime( mbedtls_mpi *X, size_t nbits, int flags,
             else if( r == 1 )
                 MBEDTLS_MPI_CHK( mbedtls_mpi_add_int( X, X, 4 ) );
 
-            /* Set Y = (X-1) / 2, which is X / 2 because X is odd */
-            MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &Y, X ) );
-            MBEDTLS_MPI_CHK( mbedtls_mpi_shift_r( &Y, 1 ) );
+            step = 12;
+        }
+
+        if( sieved )
+            MBEDTLS_MPI_CHK( mpi_sieve_fill( sieve, composite, X, step, dh ) );
+        else
+            memset( sieve, 0, sizeof( sieve ) );
+
+        MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &B, X ) );
+
+        for( k = 0; k < MPI_SIEVE_SIZE; k++ )
+        {
+            if( sieve[k / 8] & ( 1 << ( k % 8 ) ) )
+                continue;
+
+            MBEDTLS_MPI_CHK( mbedtls_mpi_add_int( X, &B,
+                                                  (mbedtls_mpi_sint) ( step * k ) ) );
+            if( mbedtls_mpi_bitlen( X ) > nbits )
+                break;
 
-            while( 1 )
+            if( dh == 0 )
             {
-                /*
-                 * First, check small factors for X and Y
-                 * before doing Miller-Rabin on any of them
-                 */
-                if( ( ret = mpi_check_small_factors(  X         ) ) == 0 &&
-                    ( ret = mpi_check_small_factors( &Y         ) ) == 0 &&
-                    ( ret = mpi_miller_rabin(  X, rounds, f_rng, p_rng  ) )
-                                                                    == 0 &&
-                    ( ret = mpi_miller_rabin( &Y, rounds, f_rng, p_rng  ) )
-                                                                    == 0 )
-                    goto cleanup;
+                /* Sieve survivors have no factor in small_prime[] */
+                if( sieved )
+                    ret = mpi_miller_rabin( X, rounds, f_rng, p_rng );
+                else
+                    ret = mbedtls_mpi_is_prime_ext( X, rounds, f_rng, p_rng );
 
                 if( ret != MBEDTLS_ERR_MPI_NOT_ACCEPTABLE )
                     goto cleanup;
 
-                /*
-                 * Next candidates. We want to preserve Y = (X-1) / 2 and
-                 * Y = 1 mod 2 and Y = 2 mod 3 (eq X = 3 mod 4 and X = 2 mod 3)
-                 * so up Y by 6 and X by 12.
-                 */
-                MBEDTLS_MPI_CHK( mbedtls_mpi_add_int(  X,  X, 12 ) );
-                MBEDTLS_MPI_CHK( mbedtls_mpi_add_int( &Y, &Y, 6  ) );
+                continue;
             }
+
+            /* Set Y = (X-1) / 2, which is X / 2 because X is odd */
+            MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &Y, X ) );
+            MBEDTLS_MPI_CHK( mbedtls_mpi_shift_r( &Y, 1 ) );
+
+            /*
+             * First, check small factors for X and Y (unless the sieve
+             * already did) before doing Miller-Rabin on any of them
+             */
+            if( ( sieved ||
+                  ( ( ret = mpi_check_small_factors(  X ) ) == 0 &&
+                    ( ret = mpi_check_small_factors( &Y ) ) == 0 ) ) &&
+                ( ret = mpi_miller_rabin(  X, rounds, f_rng, p_rng  ) ) == 0 &&
+                ( ret = mpi_miller_rabin( &Y, rounds, f_rng, p_rng  ) ) == 0 )
+                goto cleanup;
+
+            if( ret != MBEDTLS_ERR_MPI_NOT_ACCEPTABLE )
+                goto cleanup;
+        }
+
+        if( ( flags & MBEDTLS_MPI_GEN_PRIME_FLAG_SINGLE ) != 0 )
+        {
+            ret = MBEDTLS_ERR_MPI_NOT_ACCEPTABLE;
+            goto cleanup;
         }
     }
 
 cleanup:
 
-    mbedtls_mpi_free( &Y );
+    mbedtls_mpi_free( &Y ); mbedtls_mpi_free( &B );
+    mbedtls_free( composite );
 
     return( ret );
 }
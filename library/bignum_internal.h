@@ -0,0 +1,73 @@
+/**
+ * \file bignum_internal.h
+ *
+ * \brief Multi-precision integer functions for use by other modules of
+ *        the library only. They are not part of the public API.
+ */
+/*
+ *  Copyright The Mbed TLS Contributors
+ *  SPDX-License-Identifier: Apache-2.0
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *  not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *  WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef MBEDTLS_BIGNUM_INTERNAL_H
+#define MBEDTLS_BIGNUM_INTERNAL_H
+
+#include "common.h"
+#include "mbedtls/bignum.h"
+
+/**
+ * \brief          Compute the Montgomery constant of an odd modulus,
+ *                 for use with mbedtls_mpi_montmul().
+ *
+ * \note           Internal function, used by the ECP module when
+ *                 #MBEDTLS_ECP_MONT_FIELD_OPTIM is enabled.
+ *
+ * \param mm       The address at which to store <code>-N^-1 mod 2^biL</code>.
+ *                 This must not be \c NULL.
+ * \param N        The modulus. This must point to an initialized MPI
+ *                 with at least one limb, and must be odd.
+ */
+void mbedtls_mpi_montg_init( mbedtls_mpi_uint *mm, const mbedtls_mpi *N );
+
+/**
+ * \brief          Perform a Montgomery multiplication:
+ *                 X = A * B * R^-1 mod N, with <code>R = 2^(biL * N->n)</code>.
+ *
+ *                 This is for callers that keep their operands in
+ *                 Montgomery form (x R mod N) across many multiplications,
+ *                 and so avoid a full division by \p N after each of them.
+ *                 The result is computed in constant time.
+ *
+ * \note           Internal function, used by the ECP module when
+ *                 #MBEDTLS_ECP_MONT_FIELD_OPTIM is enabled.
+ *
+ * \param X        The destination MPI. This must point to an initialized MPI.
+ *                 It may alias \p A or \p B.
+ * \param A        The first factor. This must be in the range [0, N).
+ * \param B        The second factor. This must be in the range [0, N).
+ * \param N        The modulus. This must be odd.
+ * \param mm       The value computed by mbedtls_mpi_montg_init() for \p N.
+ * \param T        An initialized MPI used as a workspace, which is grown to
+ *                 <code>2 * (N->n + 1)</code> limbs if it is smaller.
+ *                 It must not alias any of the other parameters.
+ *
+ * \return         \c 0 if successful.
+ * \return         #MBEDTLS_ERR_MPI_ALLOC_FAILED if a memory allocation failed.
+ * \return         #MBEDTLS_ERR_MPI_BAD_INPUT_DATA if \p N is even.
+ */
+int mbedtls_mpi_montmul( mbedtls_mpi *X, const mbedtls_mpi *A,
+                         const mbedtls_mpi *B, const mbedtls_mpi *N,
+                         mbedtls_mpi_uint mm, mbedtls_mpi *T );
+
+#endif /* MBEDTLS_BIGNUM_INTERNAL_H */
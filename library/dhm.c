@@ -150,6 +150,25 @@ int mbedtls_dhm_read_params( mbedtls_dhm_context *ctx,
     return( 0 );
 }
 
+/*
+ * Calculate GX = G^X mod P, with the fixed-base table if it matches
+ */
+static int dhm_make_gx( mbedtls_dhm_context *ctx )
+{
+#if defined(MBEDTLS_DHM_FIXED_BASE)
+    if( ctx->fb != NULL &&
+        mbedtls_mpi_cmp_mpi( &ctx->fb->table.N, &ctx->P ) == 0 &&
+        mbedtls_mpi_cmp_mpi( &ctx->fb->table.G, &ctx->G ) == 0 )
+    {
+        return( mbedtls_mpi_exp_mod_table( &ctx->GX, &ctx->X,
+                                           &ctx->fb->table ) );
+    }
+#endif /* MBEDTLS_DHM_FIXED_BASE */
+
+    return( mbedtls_mpi_exp_mod( &ctx->GX, &ctx->G, &ctx->X,
+                                 &ctx->P , &ctx->RP ) );
+}
+
 /*
  * Setup and write the ServerKeyExchange parameters
  */
@@ -187,8 +206,7 @@ int mbedtls_dhm_make_params( mbedtls_dhm_context *ctx, int x_size,
     /*
      * Calculate GX = G^X mod P
      */
-    MBEDTLS_MPI_CHK( mbedtls_mpi_exp_mod( &ctx->GX, &ctx->G, &ctx->X,
-                          &ctx->P , &ctx->RP ) );
+    MBEDTLS_MPI_CHK( dhm_make_gx( ctx ) );
 
     if( ( ret = dhm_check_range( &ctx->GX, &ctx->P ) ) != 0 )
         return( ret );
@@ -302,8 +320,7 @@ int mbedtls_dhm_make_public( mbedtls_dhm_context *ctx, int x_size,
     }
     while( dhm_check_range( &ctx->X, &ctx->P ) != 0 );
 
-    MBEDTLS_MPI_CHK( mbedtls_mpi_exp_mod( &ctx->GX, &ctx->G, &ctx->X,
-                          &ctx->P , &ctx->RP ) );
+    MBEDTLS_MPI_CHK( dhm_make_gx( ctx ) );
 
     if( ( ret = dhm_check_range( &ctx->GX, &ctx->P ) ) != 0 )
         return( ret );
@@ -489,6 +506,53 @@ void mbedtls_dhm_free( mbedtls_dhm_context *ctx )
     mbedtls_platform_zeroize( ctx, sizeof( mbedtls_dhm_context ) );
 }
 
+#if defined(MBEDTLS_DHM_FIXED_BASE)
+void mbedtls_dhm_fixed_base_init( mbedtls_dhm_fixed_base *fb )
+{
+    DHM_VALIDATE( fb != NULL );
+    mbedtls_mpi_exp_table_init( &fb->table );
+}
+
+/*
+ * Precompute the powers of G for exponents up to the size of P
+ */
+int mbedtls_dhm_fixed_base_setup( mbedtls_dhm_fixed_base *fb,
+                                  const mbedtls_mpi *P,
+                                  const mbedtls_mpi *G )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    DHM_VALIDATE_RET( fb != NULL );
+    DHM_VALIDATE_RET( P != NULL );
+    DHM_VALIDATE_RET( G != NULL );
+
+    if( dhm_check_range( G, P ) != 0 )
+        return( MBEDTLS_ERR_DHM_BAD_INPUT_DATA );
+
+    if( ( ret = mbedtls_mpi_exp_table_setup( &fb->table, G, P,
+                                             mbedtls_mpi_bitlen( P ) ) ) != 0 )
+    {
+        return( MBEDTLS_ERR_DHM_SET_GROUP_FAILED + ret );
+    }
+
+    return( 0 );
+}
+
+void mbedtls_dhm_set_fixed_base( mbedtls_dhm_context *ctx,
+                                 const mbedtls_dhm_fixed_base *fb )
+{
+    DHM_VALIDATE( ctx != NULL );
+    ctx->fb = fb;
+}
+
+void mbedtls_dhm_fixed_base_free( mbedtls_dhm_fixed_base *fb )
+{
+    if( fb == NULL )
+        return;
+
+    mbedtls_mpi_exp_table_free( &fb->table );
+}
+#endif /* MBEDTLS_DHM_FIXED_BASE */
+
 #if defined(MBEDTLS_ASN1_PARSE_C)
 /*
  * Parse DHM parameters
@@ -196,7 +196,11 @@ static int ecdh_setup_internal( mbedtls_ecdh_context_mbed *ctx,
 {
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
 
+#if defined(MBEDTLS_ECP_SHARED_GROUPS)
+    ret = mbedtls_ecp_group_load_shared( &ctx->grp, grp_id );
+#else
     ret = mbedtls_ecp_group_load( &ctx->grp, grp_id );
+#endif
     if( ret != 0 )
     {
         return( MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE );
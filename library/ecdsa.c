@@ -47,6 +47,10 @@
 #include "mbedtls/platform_util.h"
 #include "mbedtls/error.h"
 
+#if defined(MBEDTLS_ECDSA_NONCE_POOL) && defined(MBEDTLS_THREADING_C)
+#include "mbedtls/threading.h"
+#endif
+
 /* Parameter validation macros based on platform_util.h */
 #define ECDSA_VALIDATE_RET( cond )    \
     MBEDTLS_INTERNAL_VALIDATE_RET( cond, MBEDTLS_ERR_ECP_BAD_INPUT_DATA )
@@ -176,8 +180,7 @@ static void ecdsa_restart_det_free( mbedtls_ecdsa_restart_det_ctx *ctx )
 /* Call this when entering a function that needs its own sub-context */
 #define ECDSA_RS_ENTER( SUB )   do {                                 \
     /* reset ops count for this call if top-level */                 \
-    if( rs_ctx != NULL && rs_ctx->ecp.depth++ == 0 )                 \
-        rs_ctx->ecp.ops_done = 0;                                    \
+    mbedtls_ecp_restart_enter( ECDSA_RS_ECP );                       \
                                                                      \
     /* set up our own sub-context if needed */                       \
     if( mbedtls_ecp_restart_is_enabled() &&                          \
@@ -202,8 +205,7 @@ static void ecdsa_restart_det_free( mbedtls_ecdsa_restart_det_ctx *ctx )
         rs_ctx->SUB = NULL;                                          \
     }                                                                \
                                                                      \
-    if( rs_ctx != NULL )                                             \
-        rs_ctx->ecp.depth--;                                         \
+    mbedtls_ecp_restart_leave( ECDSA_RS_ECP );                       \
 } while( 0 )
 
 #else /* MBEDTLS_ECP_RESTARTABLE */
@@ -359,7 +361,7 @@ modn:
         MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &e, &e, &t ) );
         MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( pk, pk, &t ) );
         MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( pk, pk, &grp->N ) );
-        MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod( s, pk, &grp->N ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod_ct( s, pk, &grp->N ) );
         MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( s, s, &e ) );
         MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( s, s, &grp->N ) );
     }
@@ -411,6 +413,253 @@ int mbedtls_ecdsa_sign( mbedtls_ecp_group *grp, mbedtls_mpi *r, mbedtls_mpi *s,
     return( ecdsa_sign_restartable( grp, r, s, d, buf, blen,
                                     f_rng, p_rng, f_rng, p_rng, NULL ) );
 }
+
+#if defined(MBEDTLS_ECDSA_BATCH_SIGN)
+/*
+ * Compute ECDSA signatures of several hashed messages with the same key
+ */
+int mbedtls_ecdsa_sign_batch( mbedtls_ecp_group *grp,
+                              mbedtls_mpi *r, mbedtls_mpi *s,
+                              const mbedtls_mpi *d,
+                              const unsigned char *buf, size_t blen,
+                              size_t count,
+                              int (*f_rng)(void *, unsigned char *, size_t),
+                              void *p_rng )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t i;
+    mbedtls_ecp_point *R = NULL;
+    mbedtls_mpi *k = NULL, *c = NULL;
+    mbedtls_mpi e, t, u;
+    ECDSA_VALIDATE_RET( grp   != NULL );
+    ECDSA_VALIDATE_RET( r     != NULL || count == 0 );
+    ECDSA_VALIDATE_RET( s     != NULL || count == 0 );
+    ECDSA_VALIDATE_RET( d     != NULL );
+    ECDSA_VALIDATE_RET( f_rng != NULL );
+    ECDSA_VALIDATE_RET( buf   != NULL || count == 0 || blen == 0 );
+
+    /* Fail cleanly on curves such as Curve25519 that can't be used for ECDSA */
+    if( ! mbedtls_ecdsa_can_do( grp->id ) || grp->N.p == NULL )
+        return( MBEDTLS_ERR_ECP_BAD_INPUT_DATA );
+
+    /* Make sure d is in range 1..n-1 */
+    if( mbedtls_mpi_cmp_int( d, 1 ) < 0 || mbedtls_mpi_cmp_mpi( d, &grp->N ) >= 0 )
+        return( MBEDTLS_ERR_ECP_INVALID_KEY );
+
+    if( count == 0 )
+        return( 0 );
+
+    mbedtls_mpi_init( &e ); mbedtls_mpi_init( &t ); mbedtls_mpi_init( &u );
+
+    R = mbedtls_calloc( count, sizeof( mbedtls_ecp_point ) );
+    k = mbedtls_calloc( count, sizeof( mbedtls_mpi ) );
+    c = mbedtls_calloc( count, sizeof( mbedtls_mpi ) );
+    if( R == NULL || k == NULL || c == NULL )
+    {
+        ret = MBEDTLS_ERR_ECP_ALLOC_FAILED;
+        goto cleanup;
+    }
+
+    for( i = 0; i < count; i++ )
+    {
+        mbedtls_ecp_point_init( &R[i] );
+        mbedtls_mpi_init( &k[i] );
+        mbedtls_mpi_init( &c[i] );
+    }
+
+    /*
+     * Steps 1-3 for all messages: R_i = k_i G, with a single coordinate
+     * normalization for the whole batch
+     */
+    for( i = 0; i < count; i++ )
+        MBEDTLS_MPI_CHK( mbedtls_ecp_gen_privkey( grp, &k[i], f_rng, p_rng ) );
+
+    MBEDTLS_MPI_CHK( mbedtls_ecp_mul_batch( grp, R, k, count, f_rng, p_rng ) );
+
+    /*
+     * Invert all the k_i with Montgomery's trick, as in
+     * ecp_normalize_jac_many(): c_i = k_0 * ... * k_i, then one inversion,
+     * blinded by a random t as in ecdsa_sign_restartable():
+     * u = t / (t c_{count-1}) mod n
+     */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &c[0], &k[0] ) );
+    for( i = 1; i < count; i++ )
+    {
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &c[i], &c[i - 1], &k[i] ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &c[i], &c[i], &grp->N ) );
+    }
+
+    MBEDTLS_MPI_CHK( mbedtls_ecp_gen_privkey( grp, &t, f_rng, p_rng ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &u, &c[count - 1], &t ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &u, &u, &grp->N ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod_ct( &u, &u, &grp->N ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &u, &u, &t ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &u, &u, &grp->N ) );
+
+    /* c_i = 1 / k_i, u = 1 / (k_0 * ... * k_{i-1}) */
+    for( i = count - 1; i > 0; i-- )
+    {
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &c[i], &u, &c[i - 1] ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &c[i], &c[i], &grp->N ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &u, &u, &k[i] ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &u, &u, &grp->N ) );
+    }
+    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &c[0], &u ) );
+
+    /*
+     * Steps 5-6 for each message: s_i = (e_i + r_i d) / k_i mod n
+     */
+    for( i = 0; i < count; i++ )
+    {
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &r[i], &R[i].X, &grp->N ) );
+        MBEDTLS_MPI_CHK( derive_mpi( grp, &e, buf + i * blen, blen ) );
+
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &s[i], &r[i], d ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_add_mpi( &e, &e, &s[i] ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &s[i], &c[i], &e ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &s[i], &s[i], &grp->N ) );
+
+        /* Start over for this message in the (unlikely) case r or s is 0 */
+        if( mbedtls_mpi_cmp_int( &r[i], 0 ) == 0 ||
+            mbedtls_mpi_cmp_int( &s[i], 0 ) == 0 )
+        {
+            MBEDTLS_MPI_CHK( ecdsa_sign_restartable( grp, &r[i], &s[i], d,
+                                                     buf + i * blen, blen,
+                                                     f_rng, p_rng,
+                                                     f_rng, p_rng, NULL ) );
+        }
+    }
+
+cleanup:
+    if( R != NULL && k != NULL && c != NULL )
+    {
+        for( i = 0; i < count; i++ )
+        {
+            mbedtls_ecp_point_free( &R[i] );
+            mbedtls_mpi_free( &k[i] );
+            mbedtls_mpi_free( &c[i] );
+        }
+    }
+    mbedtls_free( R );
+    mbedtls_free( k );
+    mbedtls_free( c );
+    mbedtls_mpi_free( &e ); mbedtls_mpi_free( &t ); mbedtls_mpi_free( &u );
+
+    return( ret );
+}
+#endif /* MBEDTLS_ECDSA_BATCH_SIGN */
+
+#if defined(MBEDTLS_ECDSA_NONCE_POOL)
+/*
+ * Sign with an entry of the nonce pool: s = (e + r * d) / k mod n.
+ * Sets *done to 0 if there is no entry for this curve left, in which case
+ * the caller computes a fresh nonce instead.
+ */
+static int ecdsa_sign_pool( mbedtls_ecp_group *grp,
+                            mbedtls_mpi *r, mbedtls_mpi *s,
+                            const mbedtls_mpi *d,
+                            const unsigned char *buf, size_t blen,
+                            mbedtls_ecdsa_nonce_pool *pool, int *done )
+{
+    int ret = 0;
+    mbedtls_mpi pr, kinv, e;
+
+    *done = 0;
+
+    if( pool == NULL || pool->grp.id != grp->id ||
+        grp->id == MBEDTLS_ECP_DP_NONE )
+        return( 0 );
+
+    /* Fail cleanly on curves such as Curve25519 that can't be used for ECDSA */
+    if( ! mbedtls_ecdsa_can_do( grp->id ) || grp->N.p == NULL )
+        return( MBEDTLS_ERR_ECP_BAD_INPUT_DATA );
+
+    /* Make sure d is in range 1..n-1 */
+    if( mbedtls_mpi_cmp_int( d, 1 ) < 0 || mbedtls_mpi_cmp_mpi( d, &grp->N ) >= 0 )
+        return( MBEDTLS_ERR_ECP_INVALID_KEY );
+
+    mbedtls_mpi_init( &pr ); mbedtls_mpi_init( &kinv ); mbedtls_mpi_init( &e );
+
+    /*
+     * Take the last entry out of the pool, so that it is never used twice
+     */
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_lock( &pool->mutex ) != 0 )
+        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+#endif
+
+    if( pool->count > 0 )
+    {
+        pool->count--;
+        pr = pool->r[pool->count];
+        kinv = pool->kinv[pool->count];
+        mbedtls_mpi_init( &pool->r[pool->count] );
+        mbedtls_mpi_init( &pool->kinv[pool->count] );
+    }
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_unlock( &pool->mutex ) != 0 )
+    {
+        ret = MBEDTLS_ERR_THREADING_MUTEX_ERROR;
+        goto cleanup;
+    }
+#endif
+
+    if( pr.p == NULL )
+        goto cleanup;
+
+    MBEDTLS_MPI_CHK( derive_mpi( grp, &e, buf, blen ) );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( s, &pr, d ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_add_mpi( &e, &e, s ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( s, &kinv, &e ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( s, s, &grp->N ) );
+
+    /* Leave the (unlikely) case s == 0 to the generic code */
+    if( mbedtls_mpi_cmp_int( s, 0 ) != 0 )
+    {
+        MBEDTLS_MPI_CHK( mbedtls_mpi_copy( r, &pr ) );
+        *done = 1;
+    }
+
+cleanup:
+    mbedtls_mpi_free( &pr ); mbedtls_mpi_free( &kinv ); mbedtls_mpi_free( &e );
+
+    return( ret );
+}
+
+/*
+ * Compute ECDSA signature of a hashed message with a precomputed nonce
+ */
+int mbedtls_ecdsa_sign_with_pool( mbedtls_ecp_group *grp,
+                                  mbedtls_mpi *r, mbedtls_mpi *s,
+                                  const mbedtls_mpi *d,
+                                  const unsigned char *buf, size_t blen,
+                                  mbedtls_ecdsa_nonce_pool *pool,
+                                  int (*f_rng)(void *, unsigned char *, size_t),
+                                  void *p_rng )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    int done;
+    ECDSA_VALIDATE_RET( grp   != NULL );
+    ECDSA_VALIDATE_RET( r     != NULL );
+    ECDSA_VALIDATE_RET( s     != NULL );
+    ECDSA_VALIDATE_RET( d     != NULL );
+    ECDSA_VALIDATE_RET( pool  != NULL );
+    ECDSA_VALIDATE_RET( f_rng != NULL );
+    ECDSA_VALIDATE_RET( buf   != NULL || blen == 0 );
+
+    if( ( ret = ecdsa_sign_pool( grp, r, s, d, buf, blen, pool, &done ) ) != 0 )
+        return( ret );
+
+    if( done )
+        return( 0 );
+
+    return( ecdsa_sign_restartable( grp, r, s, d, buf, blen,
+                                    f_rng, p_rng, f_rng, p_rng, NULL ) );
+}
+#endif /* MBEDTLS_ECDSA_NONCE_POOL */
+
 #endif /* !MBEDTLS_ECDSA_SIGN_ALT */
 
 #if defined(MBEDTLS_ECDSA_DETERMINISTIC)
@@ -643,7 +892,7 @@ static int ecdsa_verify_restartable( mbedtls_ecp_group *grp,
      */
     ECDSA_BUDGET( MBEDTLS_ECP_OPS_CHK + MBEDTLS_ECP_OPS_INV + 2 );
 
-    MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod( &s_inv, s, &grp->N ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod_ct( &s_inv, s, &grp->N ) );
 
     MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( pu1, &e, &s_inv ) );
     MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( pu1, pu1, &grp->N ) );
@@ -711,100 +960,610 @@ int mbedtls_ecdsa_verify( mbedtls_ecp_group *grp,
 
     return( ecdsa_verify_restartable( grp, buf, blen, Q, r, s, NULL ) );
 }
-#endif /* !MBEDTLS_ECDSA_VERIFY_ALT */
 
+#if defined(MBEDTLS_ECP_KEY_PRECOMP)
 /*
- * Convert a signature (given by context) to ASN.1
+ * Verify ECDSA signature of hashed message with a precomputed public key,
+ * same steps as ecdsa_verify_restartable()
  */
-static int ecdsa_signature_to_asn1( const mbedtls_mpi *r, const mbedtls_mpi *s,
-                                    unsigned char *sig, size_t *slen )
+int mbedtls_ecdsa_verify_precomp( mbedtls_ecp_precomp *pre,
+                                  const unsigned char *buf, size_t blen,
+                                  const mbedtls_mpi *r, const mbedtls_mpi *s )
 {
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
-    unsigned char buf[MBEDTLS_ECDSA_MAX_LEN];
-    unsigned char *p = buf + sizeof( buf );
-    size_t len = 0;
+    mbedtls_ecp_group *grp;
+    mbedtls_mpi e, s_inv, u1, u2;
+    mbedtls_ecp_point R;
+    ECDSA_VALIDATE_RET( pre != NULL );
+    ECDSA_VALIDATE_RET( r   != NULL );
+    ECDSA_VALIDATE_RET( s   != NULL );
+    ECDSA_VALIDATE_RET( buf != NULL || blen == 0 );
 
-    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_mpi( &p, buf, s ) );
-    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_mpi( &p, buf, r ) );
+    grp = &pre->grp;
+    if( ! mbedtls_ecdsa_can_do( grp->id ) || grp->N.p == NULL )
+        return( MBEDTLS_ERR_ECP_BAD_INPUT_DATA );
 
-    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_len( &p, buf, len ) );
-    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_tag( &p, buf,
-                                       MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE ) );
+    mbedtls_ecp_point_init( &R );
+    mbedtls_mpi_init( &e ); mbedtls_mpi_init( &s_inv );
+    mbedtls_mpi_init( &u1 ); mbedtls_mpi_init( &u2 );
 
-    memcpy( sig, p, len );
-    *slen = len;
+    if( mbedtls_mpi_cmp_int( r, 1 ) < 0 || mbedtls_mpi_cmp_mpi( r, &grp->N ) >= 0 ||
+        mbedtls_mpi_cmp_int( s, 1 ) < 0 || mbedtls_mpi_cmp_mpi( s, &grp->N ) >= 0 )
+    {
+        ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+        goto cleanup;
+    }
 
-    return( 0 );
+    MBEDTLS_MPI_CHK( derive_mpi( grp, &e, buf, blen ) );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod_ct( &s_inv, s, &grp->N ) );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &u1, &e, &s_inv ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &u1, &u1, &grp->N ) );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &u2, r, &s_inv ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &u2, &u2, &grp->N ) );
+
+    /*
+     * R = u1 G + u2 Q, with the tables of pre for both points
+     */
+    MBEDTLS_MPI_CHK( mbedtls_ecp_muladd_precomp( pre, &R, &u1, &u2 ) );
+
+    if( mbedtls_ecp_is_zero( &R ) )
+    {
+        ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+        goto cleanup;
+    }
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &R.X, &R.X, &grp->N ) );
+
+    if( mbedtls_mpi_cmp_mpi( &R.X, r ) != 0 )
+    {
+        ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+        goto cleanup;
+    }
+
+cleanup:
+    mbedtls_ecp_point_free( &R );
+    mbedtls_mpi_free( &e ); mbedtls_mpi_free( &s_inv );
+    mbedtls_mpi_free( &u1 ); mbedtls_mpi_free( &u2 );
+
+    return( ret );
 }
+#endif /* MBEDTLS_ECP_KEY_PRECOMP */
 
+#if defined(MBEDTLS_ECDSA_BATCH_VERIFY)
 /*
- * Compute and write signature
+ * Batch verification, after Karati et al., "Batch Verification of ECDSA
+ * Signatures" (AFRICACRYPT 2012).
+ *
+ * With u1 = e / s and u2 = r / s mod n, a signature is valid if
+ * u1 G + u2 Q = +-R, where R is the point with x(R) = r (leaving aside the
+ * rare x(R) >= n, which the individual fallback takes care of). For random
+ * z_i, a batch of valid signatures satisfies
+ *
+ *   (sum z_i u1_i) G + sum (z_i u2_i) Q_i = sum +-(z_i R_i)
+ *
+ * while a batch with an invalid signature only does with probability
+ * about 2^(size - 8 * ECDSA_BATCH_Z_BYTES). The left-hand side is a single
+ * multi-scalar multiplication. The signs on the right-hand side are
+ * unknown, so all the combinations are tried, up to a global sign, as only
+ * x coordinates are compared: the terms are split in two halves, and
+ * each sum A of the first half is matched against each sum B of the
+ * second half with ecdsa_batch_match(). This is what bounds
+ * ECDSA_BATCH_SIZE.
  */
-int mbedtls_ecdsa_write_signature_restartable( mbedtls_ecdsa_context *ctx,
-                           mbedtls_md_type_t md_alg,
-                           const unsigned char *hash, size_t hlen,
-                           unsigned char *sig, size_t *slen,
-                           int (*f_rng)(void *, unsigned char *, size_t),
-                           void *p_rng,
-                           mbedtls_ecdsa_restart_ctx *rs_ctx )
+#define ECDSA_BATCH_SIZE        4
+#define ECDSA_BATCH_Z_BYTES     16
+
+#define ECDSA_BATCH_HALF        ( ( ECDSA_BATCH_SIZE + 1 ) / 2 )
+
+/*
+ * Recover a point R with x(R) = r, if any, for p = 3 mod 4:
+ * y = (r^3 + A r + B)^exp mod p with exp = (p + 1) / 4.
+ */
+static int ecdsa_recover_point( const mbedtls_ecp_group *grp,
+                                mbedtls_ecp_point *R, const mbedtls_mpi *r,
+                                const mbedtls_mpi *exp, mbedtls_mpi *RR )
 {
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
-    mbedtls_mpi r, s;
-    ECDSA_VALIDATE_RET( ctx  != NULL );
-    ECDSA_VALIDATE_RET( hash != NULL );
-    ECDSA_VALIDATE_RET( sig  != NULL );
-    ECDSA_VALIDATE_RET( slen != NULL );
+    mbedtls_mpi rhs, t;
 
-    mbedtls_mpi_init( &r );
-    mbedtls_mpi_init( &s );
+    if( mbedtls_mpi_cmp_mpi( r, &grp->P ) >= 0 )
+        return( MBEDTLS_ERR_ECP_VERIFY_FAILED );
 
-#if defined(MBEDTLS_ECDSA_DETERMINISTIC)
-    MBEDTLS_MPI_CHK( ecdsa_sign_det_restartable( &ctx->grp, &r, &s, &ctx->d,
-                                                 hash, hlen, md_alg, f_rng,
-                                                 p_rng, rs_ctx ) );
-#else
-    (void) md_alg;
+    mbedtls_mpi_init( &rhs ); mbedtls_mpi_init( &t );
 
-#if defined(MBEDTLS_ECDSA_SIGN_ALT)
-    MBEDTLS_MPI_CHK( mbedtls_ecdsa_sign( &ctx->grp, &r, &s, &ctx->d,
-                         hash, hlen, f_rng, p_rng ) );
-#else
-    /* Use the same RNG for both blinding and ephemeral key generation */
-    MBEDTLS_MPI_CHK( ecdsa_sign_restartable( &ctx->grp, &r, &s, &ctx->d,
-                                             hash, hlen, f_rng, p_rng, f_rng,
-                                             p_rng, rs_ctx ) );
-#endif /* MBEDTLS_ECDSA_SIGN_ALT */
-#endif /* MBEDTLS_ECDSA_DETERMINISTIC */
+    /* rhs = (r^2 + A) r + B, with A = -3 if left unset */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &rhs, r, r ) );
+    if( grp->A.p == NULL )
+        MBEDTLS_MPI_CHK( mbedtls_mpi_sub_int( &rhs, &rhs, 3 ) );
+    else
+        MBEDTLS_MPI_CHK( mbedtls_mpi_add_mpi( &rhs, &rhs, &grp->A ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &rhs, &rhs, &grp->P ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &rhs, &rhs, r ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_add_mpi( &rhs, &rhs, &grp->B ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &rhs, &rhs, &grp->P ) );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_exp_mod( &R->Y, &rhs, exp, &grp->P, RR ) );
+
+    /* rhs is not a square: no point has this x coordinate */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &t, &R->Y, &R->Y ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &t, &t, &grp->P ) );
+    if( mbedtls_mpi_cmp_mpi( &t, &rhs ) != 0 )
+    {
+        ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+        goto cleanup;
+    }
 
-    MBEDTLS_MPI_CHK( ecdsa_signature_to_asn1( &r, &s, sig, slen ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &R->X, r ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &R->Z, 1 ) );
 
 cleanup:
-    mbedtls_mpi_free( &r );
-    mbedtls_mpi_free( &s );
+    mbedtls_mpi_free( &rhs ); mbedtls_mpi_free( &t );
 
     return( ret );
 }
 
+#define MOD_MUL( X, A, B )                                              \
+    do {                                                                \
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( (X), (A), (B) ) );        \
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( (X), (X), &grp->P ) );    \
+    } while( 0 )
+
 /*
- * Compute and write signature
+ * Set *match if x is the x coordinate of A + B or A - B, without computing
+ * them: for x(A) != x(B), these are the two roots of
+ *
+ *   (xA - xB)^2 X^2 - 2((xA + xB)(xA xB + a) + 2b) X
+ *                   + (xA xB - a)^2 - 4b(xA + xB)
+ *
+ * (see for example Brier and Joye, "Weierstrass Elliptic Curves and
+ * Side-Channel Attacks", PKC 2002). The unlikely x(A) == x(B) is reported
+ * as a mismatch, which sends the batch to the individual fallback.
  */
-int mbedtls_ecdsa_write_signature( mbedtls_ecdsa_context *ctx,
-                                 mbedtls_md_type_t md_alg,
-                                 const unsigned char *hash, size_t hlen,
-                                 unsigned char *sig, size_t *slen,
-                                 int (*f_rng)(void *, unsigned char *, size_t),
-                                 void *p_rng )
+static int ecdsa_batch_match( const mbedtls_ecp_group *grp,
+                              const mbedtls_mpi *a, const mbedtls_mpi *x,
+                              const mbedtls_ecp_point *A,
+                              const mbedtls_ecp_point *B, int *match )
 {
-    ECDSA_VALIDATE_RET( ctx  != NULL );
-    ECDSA_VALIDATE_RET( hash != NULL );
-    ECDSA_VALIDATE_RET( sig  != NULL );
-    ECDSA_VALIDATE_RET( slen != NULL );
-    return( mbedtls_ecdsa_write_signature_restartable(
-                ctx, md_alg, hash, hlen, sig, slen, f_rng, p_rng, NULL ) );
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_mpi sum, prod, d, u, v;
+
+    *match = 0;
+
+    if( mbedtls_ecp_is_zero( (mbedtls_ecp_point *) A ) ||
+        mbedtls_ecp_is_zero( (mbedtls_ecp_point *) B ) ||
+        mbedtls_mpi_cmp_mpi( &A->X, &B->X ) == 0 )
+        return( 0 );
+
+    mbedtls_mpi_init( &sum ); mbedtls_mpi_init( &prod );
+    mbedtls_mpi_init( &d ); mbedtls_mpi_init( &u ); mbedtls_mpi_init( &v );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_add_mpi( &sum, &A->X, &B->X ) );
+    MOD_MUL( &prod, &A->X, &B->X );
+
+    /* d = (xA - xB)^2 x^2 */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( &d, &A->X, &B->X ) );
+    MOD_MUL( &d, &d, x );
+    MOD_MUL( &d, &d, &d );
+
+    /* u = 2((xA + xB)(xA xB + a) + 2b) x */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_add_mpi( &u, &prod, a ) );
+    MOD_MUL( &u, &u, &sum );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_add_mpi( &u, &u, &grp->B ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_add_mpi( &u, &u, &grp->B ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_shift_l( &u, 1 ) );
+    MOD_MUL( &u, &u, x );
+
+    /* v = (xA xB - a)^2 - 4b(xA + xB) */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( &v, &prod, a ) );
+    MOD_MUL( &v, &v, &v );
+    MOD_MUL( &sum, &sum, &grp->B );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_shift_l( &sum, 2 ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( &v, &v, &sum ) );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( &d, &d, &u ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_add_mpi( &d, &d, &v ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &d, &d, &grp->P ) );
+
+    *match = mbedtls_mpi_cmp_int( &d, 0 ) == 0;
+
+cleanup:
+    mbedtls_mpi_free( &sum ); mbedtls_mpi_free( &prod );
+    mbedtls_mpi_free( &d ); mbedtls_mpi_free( &u ); mbedtls_mpi_free( &v );
+
+    return( ret );
 }
 
-#if !defined(MBEDTLS_DEPRECATED_REMOVED) && \
-    defined(MBEDTLS_ECDSA_DETERMINISTIC)
+#undef MOD_MUL
+
+/*
+ * Signed sum of the points W[0..n-1], W[0] positive and the others
+ * negated according to the bits of mask
+ */
+static int ecdsa_batch_sum( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+                            const mbedtls_ecp_point *W, size_t n,
+                            unsigned int mask )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_mpi m[ECDSA_BATCH_HALF];
+    size_t i;
+
+    for( i = 0; i < ECDSA_BATCH_HALF; i++ )
+        mbedtls_mpi_init( &m[i] );
+
+    for( i = 0; i < n; i++ )
+    {
+        MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &m[i],
+                         ( i > 0 && ( ( mask >> ( i - 1 ) ) & 1 ) ) ? -1 : 1 ) );
+    }
+
+    MBEDTLS_MPI_CHK( mbedtls_ecp_muladd_multi( grp, R, m, W, n ) );
+
+cleanup:
+    for( i = 0; i < ECDSA_BATCH_HALF; i++ )
+        mbedtls_mpi_free( &m[i] );
+
+    return( ret );
+}
+
+/*
+ * Check the batch equation above for n <= ECDSA_BATCH_SIZE signatures.
+ * Returns MBEDTLS_ERR_ECP_VERIFY_FAILED (or MBEDTLS_ERR_ECP_INVALID_KEY)
+ * if it does not hold, in which case the signatures must be verified one
+ * by one to tell which ones are invalid.
+ */
+static int ecdsa_verify_batch_chunk( mbedtls_ecp_group *grp,
+                const mbedtls_ecdsa_batch_item *items, size_t n,
+                const mbedtls_mpi *exp, mbedtls_mpi *RR,
+                int (*f_rng)(void *, unsigned char *, size_t), void *p_rng )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_mpi m[ECDSA_BATCH_SIZE + 1], c[ECDSA_BATCH_SIZE];
+    mbedtls_mpi z, e, t, inv;
+    mbedtls_ecp_point P[ECDSA_BATCH_SIZE + 1], W[ECDSA_BATCH_SIZE], S, A;
+    mbedtls_ecp_point B[1 << ( ECDSA_BATCH_SIZE / 2 - 1 )];
+    size_t i, h = ( n + 1 ) / 2;
+    unsigned int mask, mask_b;
+    int match;
+
+    for( i = 0; i <= ECDSA_BATCH_SIZE; i++ )
+    {
+        mbedtls_mpi_init( &m[i] ); mbedtls_ecp_point_init( &P[i] );
+    }
+    for( i = 0; i < ECDSA_BATCH_SIZE; i++ )
+    {
+        mbedtls_mpi_init( &c[i] ); mbedtls_ecp_point_init( &W[i] );
+    }
+    mbedtls_mpi_init( &z ); mbedtls_mpi_init( &e );
+    mbedtls_mpi_init( &t ); mbedtls_mpi_init( &inv );
+    mbedtls_ecp_point_init( &S ); mbedtls_ecp_point_init( &A );
+    for( i = 0; i < sizeof( B ) / sizeof( B[0] ); i++ )
+        mbedtls_ecp_point_init( &B[i] );
+
+    /*
+     * c[i] = s_0 ... s_i mod n, so that all the 1 / s_i are obtained
+     * with a single inversion
+     */
+    for( i = 0; i < n; i++ )
+    {
+        const mbedtls_mpi *r = items[i].r, *s = items[i].s;
+
+        if( mbedtls_mpi_cmp_int( r, 1 ) < 0 || mbedtls_mpi_cmp_mpi( r, &grp->N ) >= 0 ||
+            mbedtls_mpi_cmp_int( s, 1 ) < 0 || mbedtls_mpi_cmp_mpi( s, &grp->N ) >= 0 )
+        {
+            ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+            goto cleanup;
+        }
+
+        if( i == 0 )
+        {
+            MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &c[0], s ) );
+        }
+        else
+        {
+            MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &c[i], &c[i-1], s ) );
+            MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &c[i], &c[i], &grp->N ) );
+        }
+    }
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod_ct( &inv, &c[n-1], &grp->N ) );
+
+    /*
+     * m[0] = sum z_i e_i / s_i, P[0] = G
+     * m[i+1] = z_i r_i / s_i, P[i+1] = Q_i
+     * W[i] = z_i R_i
+     */
+    for( i = n; i-- > 0; )
+    {
+        /* t = 1 / s_i, inv = 1 / (s_0 ... s_{i-1}) */
+        if( i == 0 )
+        {
+            MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &t, &inv ) );
+        }
+        else
+        {
+            MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &t, &inv, &c[i-1] ) );
+            MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &t, &t, &grp->N ) );
+            MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &inv, &inv, items[i].s ) );
+            MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &inv, &inv, &grp->N ) );
+        }
+
+        /* Random odd (hence non-zero) z_i */
+        MBEDTLS_MPI_CHK( mbedtls_mpi_fill_random( &z, ECDSA_BATCH_Z_BYTES,
+                                                  f_rng, p_rng ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_set_bit( &z, 0, 1 ) );
+
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &t, &t, &z ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &t, &t, &grp->N ) );
+
+        MBEDTLS_MPI_CHK( derive_mpi( grp, &e, items[i].buf, items[i].blen ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &e, &e, &t ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_add_mpi( &m[0], &m[0], &e ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &m[0], &m[0], &grp->N ) );
+
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &m[i+1], items[i].r, &t ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &m[i+1], &m[i+1], &grp->N ) );
+        MBEDTLS_MPI_CHK( mbedtls_ecp_copy( &P[i+1], items[i].Q ) );
+
+        MBEDTLS_MPI_CHK( ecdsa_recover_point( grp, &W[i], items[i].r, exp, RR ) );
+        MBEDTLS_MPI_CHK( mbedtls_ecp_muladd_multi( grp, &W[i], &z, &W[i], 1 ) );
+    }
+
+    MBEDTLS_MPI_CHK( mbedtls_ecp_copy( &P[0], &grp->G ) );
+    MBEDTLS_MPI_CHK( mbedtls_ecp_muladd_multi( grp, &S, m, P, n + 1 ) );
+
+    if( mbedtls_ecp_is_zero( &S ) )
+    {
+        ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+        goto cleanup;
+    }
+
+    /*
+     * Compare x(S) with x(A +- B), for A = W_0 +- ... +- W_{h-1} and
+     * B = W_h +- ... +- W_{n-1}. Reuse t as the curve parameter a.
+     */
+    if( grp->A.p == NULL )
+        MBEDTLS_MPI_CHK( mbedtls_mpi_sub_int( &t, &grp->P, 3 ) );
+    else
+        MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &t, &grp->A ) );
+
+    for( mask_b = 0; mask_b < ( 1u << ( n - h - 1 ) ); mask_b++ )
+        MBEDTLS_MPI_CHK( ecdsa_batch_sum( grp, &B[mask_b], W + h, n - h, mask_b ) );
+
+    for( mask = 0; mask < ( 1u << ( h - 1 ) ); mask++ )
+    {
+        MBEDTLS_MPI_CHK( ecdsa_batch_sum( grp, &A, W, h, mask ) );
+
+        for( mask_b = 0; mask_b < ( 1u << ( n - h - 1 ) ); mask_b++ )
+        {
+            MBEDTLS_MPI_CHK( ecdsa_batch_match( grp, &t, &S.X, &A, &B[mask_b],
+                                                &match ) );
+            if( match )
+            {
+                ret = 0;
+                goto cleanup;
+            }
+        }
+    }
+
+    ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+
+cleanup:
+    for( i = 0; i <= ECDSA_BATCH_SIZE; i++ )
+    {
+        mbedtls_mpi_free( &m[i] ); mbedtls_ecp_point_free( &P[i] );
+    }
+    for( i = 0; i < ECDSA_BATCH_SIZE; i++ )
+    {
+        mbedtls_mpi_free( &c[i] ); mbedtls_ecp_point_free( &W[i] );
+    }
+    mbedtls_mpi_free( &z ); mbedtls_mpi_free( &e );
+    mbedtls_mpi_free( &t ); mbedtls_mpi_free( &inv );
+    mbedtls_ecp_point_free( &S ); mbedtls_ecp_point_free( &A );
+    for( i = 0; i < sizeof( B ) / sizeof( B[0] ); i++ )
+        mbedtls_ecp_point_free( &B[i] );
+
+    return( ret );
+}
+
+/*
+ * Verify a batch of ECDSA signatures
+ */
+int mbedtls_ecdsa_verify_batch( mbedtls_ecp_group *grp,
+                                mbedtls_ecdsa_batch_item *items, size_t count,
+                                int (*f_rng)(void *, unsigned char *, size_t),
+                                void *p_rng )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_mpi exp, RR;
+    size_t i, j, n;
+    int batchable, failed = 0;
+
+    ECDSA_VALIDATE_RET( grp   != NULL );
+    ECDSA_VALIDATE_RET( items != NULL || count == 0 );
+    ECDSA_VALIDATE_RET( f_rng != NULL );
+
+    /* Fail cleanly on curves such as Curve25519 that can't be used for ECDSA */
+    if( ! mbedtls_ecdsa_can_do( grp->id ) || grp->N.p == NULL )
+        return( MBEDTLS_ERR_ECP_BAD_INPUT_DATA );
+
+    mbedtls_mpi_init( &exp ); mbedtls_mpi_init( &RR );
+
+    /* Recovering R needs a square root mod p: only batch if p = 3 mod 4 */
+    batchable = mbedtls_mpi_get_bit( &grp->P, 1 );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_add_int( &exp, &grp->P, 1 ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_shift_r( &exp, 2 ) );
+
+    for( i = 0; i < count; i += n )
+    {
+        n = count - i < ECDSA_BATCH_SIZE ? count - i : ECDSA_BATCH_SIZE;
+
+        ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+        if( batchable && n > 1 )
+            ret = ecdsa_verify_batch_chunk( grp, items + i, n, &exp, &RR,
+                                            f_rng, p_rng );
+
+        if( ret != 0 && ret != MBEDTLS_ERR_ECP_VERIFY_FAILED &&
+            ret != MBEDTLS_ERR_ECP_INVALID_KEY )
+            goto cleanup;
+
+        /* On failure, find out which signatures are invalid */
+        for( j = i; j < i + n; j++ )
+        {
+            items[j].result = ret == 0 ? 0 :
+                ecdsa_verify_restartable( grp, items[j].buf, items[j].blen,
+                                          items[j].Q, items[j].r, items[j].s,
+                                          NULL );
+            if( items[j].result != 0 )
+                failed = 1;
+        }
+    }
+
+    ret = failed ? MBEDTLS_ERR_ECP_VERIFY_FAILED : 0;
+
+cleanup:
+    mbedtls_mpi_free( &exp ); mbedtls_mpi_free( &RR );
+
+    return( ret );
+}
+#endif /* MBEDTLS_ECDSA_BATCH_VERIFY */
+#endif /* !MBEDTLS_ECDSA_VERIFY_ALT */
+
+/*
+ * Convert a signature (given by context) to ASN.1
+ */
+static int ecdsa_signature_to_asn1( const mbedtls_mpi *r, const mbedtls_mpi *s,
+                                    unsigned char *sig, size_t *slen )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    unsigned char buf[MBEDTLS_ECDSA_MAX_LEN];
+    unsigned char *p = buf + sizeof( buf );
+    size_t len = 0;
+
+    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_mpi( &p, buf, s ) );
+    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_mpi( &p, buf, r ) );
+
+    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_len( &p, buf, len ) );
+    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_tag( &p, buf,
+                                       MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE ) );
+
+    memcpy( sig, p, len );
+    *slen = len;
+
+    return( 0 );
+}
+
+/*
+ * Compute and write signature
+ */
+int mbedtls_ecdsa_write_signature_restartable( mbedtls_ecdsa_context *ctx,
+                           mbedtls_md_type_t md_alg,
+                           const unsigned char *hash, size_t hlen,
+                           unsigned char *sig, size_t *slen,
+                           int (*f_rng)(void *, unsigned char *, size_t),
+                           void *p_rng,
+                           mbedtls_ecdsa_restart_ctx *rs_ctx )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_mpi r, s;
+    ECDSA_VALIDATE_RET( ctx  != NULL );
+    ECDSA_VALIDATE_RET( hash != NULL );
+    ECDSA_VALIDATE_RET( sig  != NULL );
+    ECDSA_VALIDATE_RET( slen != NULL );
+
+    mbedtls_mpi_init( &r );
+    mbedtls_mpi_init( &s );
+
+#if defined(MBEDTLS_ECDSA_DETERMINISTIC)
+    MBEDTLS_MPI_CHK( ecdsa_sign_det_restartable( &ctx->grp, &r, &s, &ctx->d,
+                                                 hash, hlen, md_alg, f_rng,
+                                                 p_rng, rs_ctx ) );
+#else
+    (void) md_alg;
+
+#if defined(MBEDTLS_ECDSA_SIGN_ALT)
+    MBEDTLS_MPI_CHK( mbedtls_ecdsa_sign( &ctx->grp, &r, &s, &ctx->d,
+                         hash, hlen, f_rng, p_rng ) );
+#else
+    /* Use the same RNG for both blinding and ephemeral key generation */
+    MBEDTLS_MPI_CHK( ecdsa_sign_restartable( &ctx->grp, &r, &s, &ctx->d,
+                                             hash, hlen, f_rng, p_rng, f_rng,
+                                             p_rng, rs_ctx ) );
+#endif /* MBEDTLS_ECDSA_SIGN_ALT */
+#endif /* MBEDTLS_ECDSA_DETERMINISTIC */
+
+    MBEDTLS_MPI_CHK( ecdsa_signature_to_asn1( &r, &s, sig, slen ) );
+
+cleanup:
+    mbedtls_mpi_free( &r );
+    mbedtls_mpi_free( &s );
+
+    return( ret );
+}
+
+/*
+ * Compute and write signature
+ */
+int mbedtls_ecdsa_write_signature( mbedtls_ecdsa_context *ctx,
+                                 mbedtls_md_type_t md_alg,
+                                 const unsigned char *hash, size_t hlen,
+                                 unsigned char *sig, size_t *slen,
+                                 int (*f_rng)(void *, unsigned char *, size_t),
+                                 void *p_rng )
+{
+    ECDSA_VALIDATE_RET( ctx  != NULL );
+    ECDSA_VALIDATE_RET( hash != NULL );
+    ECDSA_VALIDATE_RET( sig  != NULL );
+    ECDSA_VALIDATE_RET( slen != NULL );
+    return( mbedtls_ecdsa_write_signature_restartable(
+                ctx, md_alg, hash, hlen, sig, slen, f_rng, p_rng, NULL ) );
+}
+
+#if defined(MBEDTLS_ECDSA_NONCE_POOL)
+/*
+ * Compute and write signature with a precomputed nonce
+ */
+int mbedtls_ecdsa_write_signature_with_pool( mbedtls_ecdsa_context *ctx,
+                                 mbedtls_md_type_t md_alg,
+                                 const unsigned char *hash, size_t hlen,
+                                 unsigned char *sig, size_t *slen,
+                                 mbedtls_ecdsa_nonce_pool *pool,
+                                 int (*f_rng)(void *, unsigned char *, size_t),
+                                 void *p_rng )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    int done;
+    mbedtls_mpi r, s;
+    ECDSA_VALIDATE_RET( ctx  != NULL );
+    ECDSA_VALIDATE_RET( hash != NULL );
+    ECDSA_VALIDATE_RET( sig  != NULL );
+    ECDSA_VALIDATE_RET( slen != NULL );
+    ECDSA_VALIDATE_RET( pool != NULL );
+
+    mbedtls_mpi_init( &r );
+    mbedtls_mpi_init( &s );
+
+    MBEDTLS_MPI_CHK( ecdsa_sign_pool( &ctx->grp, &r, &s, &ctx->d,
+                                      hash, hlen, pool, &done ) );
+
+    if( done )
+        MBEDTLS_MPI_CHK( ecdsa_signature_to_asn1( &r, &s, sig, slen ) );
+    else
+        ret = mbedtls_ecdsa_write_signature_restartable(
+                    ctx, md_alg, hash, hlen, sig, slen, f_rng, p_rng, NULL );
+
+cleanup:
+    mbedtls_mpi_free( &r );
+    mbedtls_mpi_free( &s );
+
+    return( ret );
+}
+#endif /* MBEDTLS_ECDSA_NONCE_POOL */
+
+#if !defined(MBEDTLS_DEPRECATED_REMOVED) && \
+    defined(MBEDTLS_ECDSA_DETERMINISTIC)
 int mbedtls_ecdsa_write_signature_det( mbedtls_ecdsa_context *ctx,
                                const unsigned char *hash, size_t hlen,
                                unsigned char *sig, size_t *slen,
@@ -896,6 +1655,63 @@ cleanup:
     return( ret );
 }
 
+#if defined(MBEDTLS_ECP_KEY_PRECOMP)
+/*
+ * Read and check signature with a precomputed public key,
+ * same steps as mbedtls_ecdsa_read_signature_restartable()
+ */
+int mbedtls_ecdsa_read_signature_with_precomp( mbedtls_ecp_precomp *pre,
+                          const unsigned char *hash, size_t hlen,
+                          const unsigned char *sig, size_t slen )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    unsigned char *p = (unsigned char *) sig;
+    const unsigned char *end = sig + slen;
+    size_t len;
+    mbedtls_mpi r, s;
+    ECDSA_VALIDATE_RET( pre  != NULL );
+    ECDSA_VALIDATE_RET( hash != NULL );
+    ECDSA_VALIDATE_RET( sig  != NULL );
+
+    mbedtls_mpi_init( &r );
+    mbedtls_mpi_init( &s );
+
+    if( ( ret = mbedtls_asn1_get_tag( &p, end, &len,
+                    MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE ) ) != 0 )
+    {
+        ret += MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+        goto cleanup;
+    }
+
+    if( p + len != end )
+    {
+        ret = MBEDTLS_ERR_ECP_BAD_INPUT_DATA +
+              MBEDTLS_ERR_ASN1_LENGTH_MISMATCH;
+        goto cleanup;
+    }
+
+    if( ( ret = mbedtls_asn1_get_mpi( &p, end, &r ) ) != 0 ||
+        ( ret = mbedtls_asn1_get_mpi( &p, end, &s ) ) != 0 )
+    {
+        ret += MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+        goto cleanup;
+    }
+
+    if( ( ret = mbedtls_ecdsa_verify_precomp( pre, hash, hlen,
+                                              &r, &s ) ) != 0 )
+        goto cleanup;
+
+    if( p != end )
+        ret = MBEDTLS_ERR_ECP_SIG_LEN_MISMATCH;
+
+cleanup:
+    mbedtls_mpi_free( &r );
+    mbedtls_mpi_free( &s );
+
+    return( ret );
+}
+#endif /* MBEDTLS_ECP_KEY_PRECOMP */
+
 #if !defined(MBEDTLS_ECDSA_GENKEY_ALT)
 /*
  * Generate key pair
@@ -907,7 +1723,11 @@ int mbedtls_ecdsa_genkey( mbedtls_ecdsa_context *ctx, mbedtls_ecp_group_id gid,
     ECDSA_VALIDATE_RET( ctx   != NULL );
     ECDSA_VALIDATE_RET( f_rng != NULL );
 
+#if defined(MBEDTLS_ECP_SHARED_GROUPS)
+    ret = mbedtls_ecp_group_load_shared( &ctx->grp, gid );
+#else
     ret = mbedtls_ecp_group_load( &ctx->grp, gid );
+#endif
     if( ret != 0 )
         return( ret );
 
@@ -956,6 +1776,220 @@ void mbedtls_ecdsa_free( mbedtls_ecdsa_context *ctx )
     mbedtls_ecp_keypair_free( ctx );
 }
 
+#if defined(MBEDTLS_ECDSA_NONCE_POOL)
+/*
+ * Initialize a nonce pool
+ */
+void mbedtls_ecdsa_nonce_pool_init( mbedtls_ecdsa_nonce_pool *pool )
+{
+    ECDSA_VALIDATE( pool != NULL );
+
+    mbedtls_ecp_group_init( &pool->grp );
+    pool->size = 0;
+    pool->count = 0;
+    pool->r = NULL;
+    pool->kinv = NULL;
+
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mutex_init( &pool->mutex );
+#endif
+}
+
+/*
+ * Set up an empty nonce pool for a curve
+ */
+int mbedtls_ecdsa_nonce_pool_setup( mbedtls_ecdsa_nonce_pool *pool,
+                                    mbedtls_ecp_group_id gid, size_t size )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t i;
+    ECDSA_VALIDATE_RET( pool != NULL );
+
+    if( size == 0 || pool->r != NULL || ! mbedtls_ecdsa_can_do( gid ) )
+        return( MBEDTLS_ERR_ECP_BAD_INPUT_DATA );
+
+#if defined(MBEDTLS_ECP_SHARED_GROUPS)
+    ret = mbedtls_ecp_group_load_shared( &pool->grp, gid );
+#else
+    ret = mbedtls_ecp_group_load( &pool->grp, gid );
+#endif
+    if( ret != 0 )
+        return( ret );
+
+    pool->r = mbedtls_calloc( size, sizeof( mbedtls_mpi ) );
+    pool->kinv = mbedtls_calloc( size, sizeof( mbedtls_mpi ) );
+    if( pool->r == NULL || pool->kinv == NULL )
+    {
+        mbedtls_free( pool->r );
+        mbedtls_free( pool->kinv );
+        pool->r = NULL;
+        pool->kinv = NULL;
+        mbedtls_ecp_group_free( &pool->grp );
+        return( MBEDTLS_ERR_ECP_ALLOC_FAILED );
+    }
+
+    for( i = 0; i < size; i++ )
+    {
+        mbedtls_mpi_init( &pool->r[i] );
+        mbedtls_mpi_init( &pool->kinv[i] );
+    }
+
+    pool->size = size;
+    pool->count = 0;
+
+    return( 0 );
+}
+
+/*
+ * Compute new pool entries: steps 1-3 of SEC1 4.1.3 and the inversion of k
+ */
+int mbedtls_ecdsa_nonce_pool_fill( mbedtls_ecdsa_nonce_pool *pool,
+                                   size_t count,
+                                   int (*f_rng)(void *, unsigned char *, size_t),
+                                   void *p_rng )
+{
+    int ret = 0, key_tries, full = 0;
+    size_t i;
+    mbedtls_ecp_group *grp;
+    mbedtls_ecp_point R;
+    mbedtls_mpi k, t, r, kinv;
+    ECDSA_VALIDATE_RET( pool  != NULL );
+    ECDSA_VALIDATE_RET( f_rng != NULL );
+
+    if( pool->r == NULL )
+        return( MBEDTLS_ERR_ECP_BAD_INPUT_DATA );
+
+    grp = &pool->grp;
+
+    mbedtls_ecp_point_init( &R );
+    mbedtls_mpi_init( &k ); mbedtls_mpi_init( &t );
+    mbedtls_mpi_init( &r ); mbedtls_mpi_init( &kinv );
+
+    for( i = 0; i < count && ! full; i++ )
+    {
+#if defined(MBEDTLS_THREADING_C)
+        if( ( ret = mbedtls_mutex_lock( &pool->mutex ) ) != 0 )
+            goto cleanup;
+#endif
+        full = ( pool->count >= pool->size );
+#if defined(MBEDTLS_THREADING_C)
+        if( ( ret = mbedtls_mutex_unlock( &pool->mutex ) ) != 0 )
+            goto cleanup;
+#endif
+        if( full )
+            break;
+
+        key_tries = 0;
+        do
+        {
+            if( key_tries++ > 10 )
+            {
+                ret = MBEDTLS_ERR_ECP_RANDOM_FAILED;
+                goto cleanup;
+            }
+
+            MBEDTLS_MPI_CHK( mbedtls_ecp_gen_privkey( grp, &k, f_rng, p_rng ) );
+            MBEDTLS_MPI_CHK( mbedtls_ecp_mul( grp, &R, &k, &grp->G,
+                                              f_rng, p_rng ) );
+            MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &r, &R.X, &grp->N ) );
+        }
+        while( mbedtls_mpi_cmp_int( &r, 0 ) == 0 );
+
+        /*
+         * Blind the inversion as in ecdsa_sign_restartable():
+         * 1/k = t / (kt) mod n
+         */
+        MBEDTLS_MPI_CHK( mbedtls_ecp_gen_privkey( grp, &t, f_rng, p_rng ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &k, &k, &t ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &k, &k, &grp->N ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod_ct( &kinv, &k, &grp->N ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &kinv, &kinv, &t ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &kinv, &kinv, &grp->N ) );
+
+#if defined(MBEDTLS_THREADING_C)
+        if( ( ret = mbedtls_mutex_lock( &pool->mutex ) ) != 0 )
+            goto cleanup;
+#endif
+        if( pool->count < pool->size )
+        {
+            pool->r[pool->count] = r;
+            pool->kinv[pool->count] = kinv;
+            pool->count++;
+            mbedtls_mpi_init( &r );
+            mbedtls_mpi_init( &kinv );
+        }
+        else
+            full = 1;
+#if defined(MBEDTLS_THREADING_C)
+        if( ( ret = mbedtls_mutex_unlock( &pool->mutex ) ) != 0 )
+            goto cleanup;
+#endif
+    }
+
+cleanup:
+    mbedtls_ecp_point_free( &R );
+    mbedtls_mpi_free( &k ); mbedtls_mpi_free( &t );
+    mbedtls_mpi_free( &r ); mbedtls_mpi_free( &kinv );
+
+    return( ret );
+}
+
+/*
+ * Number of unused entries
+ */
+int mbedtls_ecdsa_nonce_pool_count( mbedtls_ecdsa_nonce_pool *pool,
+                                    size_t *count )
+{
+    ECDSA_VALIDATE_RET( pool  != NULL );
+    ECDSA_VALIDATE_RET( count != NULL );
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_lock( &pool->mutex ) != 0 )
+        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+#endif
+
+    *count = pool->count;
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_unlock( &pool->mutex ) != 0 )
+        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+#endif
+
+    return( 0 );
+}
+
+/*
+ * Free a nonce pool and wipe the remaining entries
+ */
+void mbedtls_ecdsa_nonce_pool_free( mbedtls_ecdsa_nonce_pool *pool )
+{
+    size_t i;
+
+    if( pool == NULL )
+        return;
+
+    for( i = 0; i < pool->size; i++ )
+    {
+        mbedtls_mpi_free( &pool->r[i] );
+        mbedtls_mpi_free( &pool->kinv[i] );
+    }
+
+    mbedtls_free( pool->r );
+    mbedtls_free( pool->kinv );
+    mbedtls_ecp_group_free( &pool->grp );
+
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mutex_free( &pool->mutex );
+#endif
+
+    pool->size = 0;
+    pool->count = 0;
+    pool->r = NULL;
+    pool->kinv = NULL;
+}
+#endif /* MBEDTLS_ECDSA_NONCE_POOL */
+
+
 #if defined(MBEDTLS_ECP_RESTARTABLE)
 /*
  * Initialize a restart context
@@ -73,6 +73,7 @@
 #if defined(MBEDTLS_ECP_C)
 
 #include "mbedtls/ecp.h"
+#include "bignum_internal.h"
 #include "mbedtls/threading.h"
 #include "mbedtls/platform_util.h"
 #include "mbedtls/error.h"
@@ -281,12 +282,34 @@ void mbedtls_ecp_set_max_ops( unsigned max_ops )
     ecp_max_ops = max_ops;
 }
 
+/*
+ * Maximum time spent in a row, in microseconds, and the clock to measure it.
+ * The time budget applies if both ecp_max_us and ecp_f_clock are set; the
+ * clock alone is enough for the statistics in the restart context.
+ */
+static uint64_t ecp_max_us = 0;
+static uint64_t (*ecp_f_clock)( void * ) = NULL;
+static void *ecp_p_clock = NULL;
+
+/*
+ * Set ecp_max_us and the clock
+ */
+void mbedtls_ecp_set_max_time( uint64_t max_us,
+                               uint64_t (*f_clock)( void * ),
+                               void *p_clock )
+{
+    ecp_max_us = max_us;
+    ecp_f_clock = f_clock;
+    ecp_p_clock = p_clock;
+}
+
 /*
  * Check if restart is enabled
  */
 int mbedtls_ecp_restart_is_enabled( void )
 {
-    return( ecp_max_ops != 0 );
+    return( ecp_max_ops != 0 ||
+            ( ecp_max_us != 0 && ecp_f_clock != NULL ) );
 }
 
 /*
@@ -404,6 +427,11 @@ void mbedtls_ecp_restart_init( mbedtls_ecp_restart_ctx *ctx )
     ctx->depth = 0;
     ctx->rsm = NULL;
     ctx->ma = NULL;
+    ctx->time_start = 0;
+    ctx->time_last = 0;
+    ctx->time_max = 0;
+    ctx->time_total = 0;
+    ctx->calls = 0;
 }
 
 /*
@@ -423,6 +451,62 @@ void mbedtls_ecp_restart_free( mbedtls_ecp_restart_ctx *ctx )
     mbedtls_ecp_restart_init( ctx );
 }
 
+/*
+ * Enter a function that may yield
+ */
+void mbedtls_ecp_restart_enter( mbedtls_ecp_restart_ctx *rs_ctx )
+{
+    /* reset ops count and start the clock for this call if top-level */
+    if( rs_ctx != NULL && rs_ctx->depth++ == 0 )
+    {
+        rs_ctx->ops_done = 0;
+        if( ecp_f_clock != NULL )
+            rs_ctx->time_start = ecp_f_clock( ecp_p_clock );
+    }
+}
+
+/*
+ * Leave a function that may yield
+ */
+void mbedtls_ecp_restart_leave( mbedtls_ecp_restart_ctx *rs_ctx )
+{
+    uint64_t elapsed;
+
+    if( rs_ctx == NULL || --rs_ctx->depth != 0 || ecp_f_clock == NULL )
+        return;
+
+    elapsed = ecp_f_clock( ecp_p_clock ) - rs_ctx->time_start;
+
+    rs_ctx->time_last = elapsed;
+    if( elapsed > rs_ctx->time_max )
+        rs_ctx->time_max = elapsed;
+    rs_ctx->time_total += elapsed;
+    rs_ctx->calls++;
+}
+
+/*
+ * Check if the next step, of the given number of basic ops, is expected to
+ * fit in the time budget. The cost of a basic op is calibrated on the
+ * current call: it is the time elapsed so far divided by ops_done.
+ */
+static int ecp_check_time( const mbedtls_ecp_restart_ctx *rs_ctx,
+                           unsigned ops )
+{
+    uint64_t elapsed;
+
+    if( ecp_max_us == 0 || ecp_f_clock == NULL )
+        return( 0 );
+
+    elapsed = ecp_f_clock( ecp_p_clock ) - rs_ctx->time_start;
+    if( elapsed >= ecp_max_us ||
+        elapsed * ops / rs_ctx->ops_done > ecp_max_us - elapsed )
+    {
+        return( MBEDTLS_ERR_ECP_IN_PROGRESS );
+    }
+
+    return( 0 );
+}
+
 /*
  * Check if we can do the next step
  */
@@ -432,7 +516,7 @@ int mbedtls_ecp_check_budget( const mbedtls_ecp_group *grp,
 {
     ECP_VALIDATE_RET( grp != NULL );
 
-    if( rs_ctx != NULL && ecp_max_ops != 0 )
+    if( rs_ctx != NULL && mbedtls_ecp_restart_is_enabled() )
     {
         /* scale depending on curve size: the chosen reference is 256-bit,
          * and multiplication is quadratic. Round to the closest integer. */
@@ -446,8 +530,10 @@ int mbedtls_ecp_check_budget( const mbedtls_ecp_group *grp,
          * that ops_done <= ecp_max_ops, so the check
          * ops_done > ecp_max_ops below is mandatory. */
         if( ( rs_ctx->ops_done != 0 ) &&
-            ( rs_ctx->ops_done > ecp_max_ops ||
-              ops > ecp_max_ops - rs_ctx->ops_done ) )
+            ( ( ecp_max_ops != 0 &&
+                ( rs_ctx->ops_done > ecp_max_ops ||
+                  ops > ecp_max_ops - rs_ctx->ops_done ) ) ||
+              ecp_check_time( rs_ctx, ops ) != 0 ) )
         {
             return( MBEDTLS_ERR_ECP_IN_PROGRESS );
         }
@@ -462,8 +548,7 @@ int mbedtls_ecp_check_budget( const mbedtls_ecp_group *grp,
 /* Call this when entering a function that needs its own sub-context */
 #define ECP_RS_ENTER( SUB )   do {                                      \
     /* reset ops count for this call if top-level */                    \
-    if( rs_ctx != NULL && rs_ctx->depth++ == 0 )                        \
-        rs_ctx->ops_done = 0;                                           \
+    mbedtls_ecp_restart_enter( rs_ctx );                                \
                                                                         \
     /* set up our own sub-context if needed */                          \
     if( mbedtls_ecp_restart_is_enabled() &&                             \
@@ -488,8 +573,7 @@ int mbedtls_ecp_check_budget( const mbedtls_ecp_group *grp,
         rs_ctx->SUB = NULL;                                             \
     }                                                                   \
                                                                         \
-    if( rs_ctx != NULL )                                                \
-        rs_ctx->depth--;                                                \
+    mbedtls_ecp_restart_leave( rs_ctx );                                \
 } while( 0 )
 
 #else /* MBEDTLS_ECP_RESTARTABLE */
@@ -696,6 +780,16 @@ void mbedtls_ecp_group_init( mbedtls_ecp_group *grp )
     grp->t_data = NULL;
     grp->T = NULL;
     grp->T_size = 0;
+#if defined(MBEDTLS_ECP_MONT_FIELD_OPTIM)
+    grp->mont_mm = 0;
+    mbedtls_mpi_init( &grp->mont_RR );
+    mbedtls_mpi_init( &grp->mont_one );
+    mbedtls_mpi_init( &grp->mont_A );
+    mbedtls_mpi_init( &grp->mont_B );
+#endif
+#if defined(MBEDTLS_ECP_FIXED_FIELD_OPTIM)
+    grp->modmul = NULL;
+#endif
 }
 
 /*
@@ -742,13 +836,21 @@ void mbedtls_ecp_group_free( mbedtls_ecp_group *grp )
         mbedtls_mpi_free( &grp->N );
     }
 
-    if( grp->T != NULL )
+    /* T_size == 0 means T belongs to someone else (see group_load_shared) */
+    if( grp->T != NULL && grp->T_size != 0 )
     {
         for( i = 0; i < grp->T_size; i++ )
             mbedtls_ecp_point_free( &grp->T[i] );
         mbedtls_free( grp->T );
     }
 
+#if defined(MBEDTLS_ECP_MONT_FIELD_OPTIM)
+    mbedtls_mpi_free( &grp->mont_RR );
+    mbedtls_mpi_free( &grp->mont_one );
+    mbedtls_mpi_free( &grp->mont_A );
+    mbedtls_mpi_free( &grp->mont_B );
+#endif
+
     mbedtls_platform_zeroize( grp, sizeof( mbedtls_ecp_group ) );
 }
 
@@ -790,6 +892,11 @@ int mbedtls_ecp_group_copy( mbedtls_ecp_group *dst, const mbedtls_ecp_group *src
     ECP_VALIDATE_RET( dst != NULL );
     ECP_VALIDATE_RET( src != NULL );
 
+#if defined(MBEDTLS_ECP_SHARED_GROUPS)
+    if( src->T != NULL && src->T_size == 0 )
+        return( mbedtls_ecp_group_load_shared( dst, src->id ) );
+#endif
+
     return( mbedtls_ecp_group_load( dst, src->id ) );
 }
 
@@ -1082,7 +1189,11 @@ int mbedtls_ecp_tls_read_group( mbedtls_ecp_group *grp,
     if( ( ret = mbedtls_ecp_tls_read_group_id( &grp_id, buf, len ) ) != 0 )
         return( ret );
 
+#if defined(MBEDTLS_ECP_SHARED_GROUPS)
+    return( mbedtls_ecp_group_load_shared( grp, grp_id ) );
+#else
     return( mbedtls_ecp_group_load( grp, grp_id ) );
+#endif
 }
 
 /*
@@ -1220,14 +1331,65 @@ cleanup:
         INC_MUL_COUNT                                                   \
     } while( 0 )
 
+#if defined(MBEDTLS_ECP_MONT_FIELD_OPTIM)
+/*
+ * Groups with grp->mont_mm != 0 (see ecp_mont_setup() in ecp_curves.c) store
+ * every field element x as x R mod P, with R = 2^(biL * P.n), while they are
+ * being computed with. Products are then reduced by a Montgomery reduction
+ * rather than by a division by P. Additions, subtractions and negations are
+ * the same in both representations; the constants 1, A and B, inversions and
+ * multiplications are not, and are handled by the helpers below.
+ *
+ * The public functions convert the points they take and return, so that
+ * their callers only ever see the usual representation.
+ */
+#define ECP_MONT_MAX_LIMBS  ( ( MBEDTLS_ECP_MAX_BYTES +                     \
+                                sizeof( mbedtls_mpi_uint ) - 1 ) /          \
+                              sizeof( mbedtls_mpi_uint ) )
+
+/*
+ * X = A * B * R^-1 mod P, with a workspace on the stack
+ */
+static int ecp_mont_mul( const mbedtls_ecp_group *grp, mbedtls_mpi *X,
+                         const mbedtls_mpi *A, const mbedtls_mpi *B )
+{
+    mbedtls_mpi_uint t[2 * ( ECP_MONT_MAX_LIMBS + 1 )];
+    mbedtls_mpi T;
+
+    T.s = 1;
+    T.n = 2 * ( grp->P.n + 1 );
+    T.p = t;
+
+    return( mbedtls_mpi_montmul( X, A, B, &grp->P, grp->mont_mm, &T ) );
+}
+#endif /* MBEDTLS_ECP_MONT_FIELD_OPTIM */
+
 static inline int mbedtls_mpi_mul_mod( const mbedtls_ecp_group *grp,
                                        mbedtls_mpi *X,
                                        const mbedtls_mpi *A,
                                        const mbedtls_mpi *B )
 {
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( X, A, B ) );
-    MOD_MUL( *X );
+#if defined(MBEDTLS_ECP_FIXED_FIELD_OPTIM)
+    if( grp->modmul != NULL )
+    {
+        MBEDTLS_MPI_CHK( grp->modmul( X, A, B ) );
+        INC_MUL_COUNT
+    }
+    else
+#endif
+#if defined(MBEDTLS_ECP_MONT_FIELD_OPTIM)
+    if( grp->mont_mm != 0 )
+    {
+        MBEDTLS_MPI_CHK( ecp_mont_mul( grp, X, A, B ) );
+        INC_MUL_COUNT
+    }
+    else
+#endif
+    {
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( X, A, B ) );
+        MOD_MUL( *X );
+    }
 cleanup:
     return( ret );
 }
@@ -1284,6 +1446,48 @@ cleanup:
     return( ret );
 }
 
+/*
+ * Scratch space for the point arithmetic below.
+ *
+ * ecp_double_jac(), ecp_add_mixed() and ecp_double_add_mxz() are called in
+ * the inner loop of every scalar multiplication. Rather than having each call
+ * initialise and free its own temporaries (several heap allocations per
+ * call), the multiplication routines set up ECP_TMP_COUNT temporaries once
+ * and pass them down. They are grown upfront to hold an unreduced product,
+ * so that the loops run without reallocating. They must not be grown any
+ * further: the fast reduction functions size their work on N->n.
+ */
+#define ECP_TMP_COUNT   4
+
+static void ecp_tmp_init( mbedtls_mpi tmp[ECP_TMP_COUNT] )
+{
+    size_t i;
+
+    for( i = 0; i < ECP_TMP_COUNT; i++ )
+        mbedtls_mpi_init( &tmp[i] );
+}
+
+static int ecp_tmp_grow( const mbedtls_ecp_group *grp,
+                         mbedtls_mpi tmp[ECP_TMP_COUNT] )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t i;
+
+    for( i = 0; i < ECP_TMP_COUNT; i++ )
+        MBEDTLS_MPI_CHK( mbedtls_mpi_grow( &tmp[i], 2 * grp->P.n ) );
+
+cleanup:
+    return( ret );
+}
+
+static void ecp_tmp_free( mbedtls_mpi tmp[ECP_TMP_COUNT] )
+{
+    size_t i;
+
+    for( i = 0; i < ECP_TMP_COUNT; i++ )
+        mbedtls_mpi_free( &tmp[i] );
+}
+
 #if defined(MBEDTLS_ECP_SHORT_WEIERSTRASS_ENABLED)
 /*
  * For curves in short Weierstrass form, we do all the internal operations in
@@ -1293,6 +1497,128 @@ cleanup:
  * SPA, hence timing attacks.
  */
 
+/*
+ * Field constants and conversions, in the representation used by grp
+ * (see mbedtls_mpi_mul_mod() above): these are plain values, and the
+ * conversions do nothing, unless grp keeps field elements in Montgomery form.
+ */
+static int ecp_set_one( const mbedtls_ecp_group *grp, mbedtls_mpi *X )
+{
+#if defined(MBEDTLS_ECP_MONT_FIELD_OPTIM)
+    if( grp->mont_mm != 0 )
+        return( mbedtls_mpi_copy( X, &grp->mont_one ) );
+#else
+    (void) grp;
+#endif
+    return( mbedtls_mpi_lset( X, 1 ) );
+}
+
+static int ecp_cmp_one( const mbedtls_ecp_group *grp, const mbedtls_mpi *X )
+{
+#if defined(MBEDTLS_ECP_MONT_FIELD_OPTIM)
+    if( grp->mont_mm != 0 )
+        return( mbedtls_mpi_cmp_mpi( X, &grp->mont_one ) );
+#else
+    (void) grp;
+#endif
+    return( mbedtls_mpi_cmp_int( X, 1 ) );
+}
+
+static const mbedtls_mpi *ecp_coef_a( const mbedtls_ecp_group *grp )
+{
+#if defined(MBEDTLS_ECP_MONT_FIELD_OPTIM)
+    if( grp->mont_mm != 0 )
+        return( &grp->mont_A );
+#endif
+    return( &grp->A );
+}
+
+static const mbedtls_mpi *ecp_coef_b( const mbedtls_ecp_group *grp )
+{
+#if defined(MBEDTLS_ECP_MONT_FIELD_OPTIM)
+    if( grp->mont_mm != 0 )
+        return( &grp->mont_B );
+#endif
+    return( &grp->B );
+}
+
+/*
+ * X = A^-1 mod P
+ */
+static int ecp_inv_mod( const mbedtls_ecp_group *grp, mbedtls_mpi *X,
+                        const mbedtls_mpi *A )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod_ct( X, A, &grp->P ) );
+
+#if defined(MBEDTLS_ECP_MONT_FIELD_OPTIM)
+    /* (a R)^-1 * R^2 * R^-1 * R^2 * R^-1 = a^-1 R */
+    if( grp->mont_mm != 0 )
+    {
+        MBEDTLS_MPI_CHK( ecp_mont_mul( grp, X, X, &grp->mont_RR ) );
+        MBEDTLS_MPI_CHK( ecp_mont_mul( grp, X, X, &grp->mont_RR ) );
+    }
+#endif
+
+cleanup:
+    return( ret );
+}
+
+/*
+ * Convert the coordinates of a point (in place) to the representation used
+ * by grp, or back
+ */
+static int ecp_point_to_mont( const mbedtls_ecp_group *grp,
+                              mbedtls_ecp_point *pt )
+{
+#if defined(MBEDTLS_ECP_MONT_FIELD_OPTIM)
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+
+    if( grp->mont_mm == 0 )
+        return( 0 );
+
+    MBEDTLS_MPI_CHK( ecp_mont_mul( grp, &pt->X, &pt->X, &grp->mont_RR ) );
+    MBEDTLS_MPI_CHK( ecp_mont_mul( grp, &pt->Y, &pt->Y, &grp->mont_RR ) );
+    MBEDTLS_MPI_CHK( ecp_mont_mul( grp, &pt->Z, &pt->Z, &grp->mont_RR ) );
+
+cleanup:
+    return( ret );
+#else
+    (void) grp;
+    (void) pt;
+    return( 0 );
+#endif
+}
+
+static int ecp_point_from_mont( const mbedtls_ecp_group *grp,
+                                mbedtls_ecp_point *pt )
+{
+#if defined(MBEDTLS_ECP_MONT_FIELD_OPTIM)
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_mpi_uint one = 1;
+    mbedtls_mpi U;
+
+    if( grp->mont_mm == 0 )
+        return( 0 );
+
+    U.s = 1;
+    U.n = 1;
+    U.p = &one;
+
+    MBEDTLS_MPI_CHK( ecp_mont_mul( grp, &pt->X, &pt->X, &U ) );
+    MBEDTLS_MPI_CHK( ecp_mont_mul( grp, &pt->Y, &pt->Y, &U ) );
+    MBEDTLS_MPI_CHK( ecp_mont_mul( grp, &pt->Z, &pt->Z, &U ) );
+
+cleanup:
+    return( ret );
+#else
+    (void) grp;
+    (void) pt;
+    return( 0 );
+#endif
+}
+
 /*
  * Normalize jacobian coordinates so that Z == 0 || Z == 1  (GECC 3.2.1)
  * Cost: 1N := 1I + 3M + 1S
@@ -1315,7 +1641,7 @@ static int ecp_normalize_jac( const mbedtls_ecp_group *grp, mbedtls_ecp_point *p
     /*
      * X = X / Z^2  mod p
      */
-    MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod( &Zi,      &pt->Z,     &grp->P ) );
+    MBEDTLS_MPI_CHK( ecp_inv_mod( grp, &Zi,      &pt->Z                  ) );
     MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &ZZi,     &Zi,        &Zi     ) );
     MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &pt->X,   &pt->X,     &ZZi    ) );
 
@@ -1328,7 +1654,7 @@ static int ecp_normalize_jac( const mbedtls_ecp_group *grp, mbedtls_ecp_point *p
     /*
      * Z = 1
      */
-    MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &pt->Z, 1 ) );
+    MBEDTLS_MPI_CHK( ecp_set_one( grp, &pt->Z ) );
 
 cleanup:
 
@@ -1383,7 +1709,7 @@ static int ecp_normalize_jac_many( const mbedtls_ecp_group *grp,
     /*
      * u = 1 / (Z_0 * ... * Z_n) mod P
      */
-    MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod( &u, &c[T_size-1], &grp->P ) );
+    MBEDTLS_MPI_CHK( ecp_inv_mod( grp, &u, &c[T_size-1] ) );
 
     for( i = T_size - 1; ; i-- )
     {
@@ -1467,15 +1793,21 @@ cleanup:
  *
  * Standard optimizations are applied when curve parameter A is one of { 0, -3 }.
  *
+ * tmp[0..3] hold M, S, T and U respectively; R may alias P.
+ *
  * Cost: 1D := 3M + 4S          (A ==  0)
  *             4M + 4S          (A == -3)
  *             3M + 6S + 1a     otherwise
  */
 static int ecp_double_jac( const mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
-                           const mbedtls_ecp_point *P )
+                           const mbedtls_ecp_point *P,
+                           mbedtls_mpi tmp[ECP_TMP_COUNT] )
 {
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
-    mbedtls_mpi M, S, T, U;
+    mbedtls_mpi * const M = &tmp[0];
+    mbedtls_mpi * const S = &tmp[1];
+    mbedtls_mpi * const T = &tmp[2];
+    mbedtls_mpi * const U = &tmp[3];
 
 #if defined(MBEDTLS_SELF_TEST)
     dbl_count++;
@@ -1486,66 +1818,62 @@ static int ecp_double_jac( const mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
         return( mbedtls_internal_ecp_double_jac( grp, R, P ) );
 #endif /* MBEDTLS_ECP_DOUBLE_JAC_ALT */
 
-    mbedtls_mpi_init( &M ); mbedtls_mpi_init( &S ); mbedtls_mpi_init( &T ); mbedtls_mpi_init( &U );
-
     /* Special case for A = -3 */
     if( grp->A.p == NULL )
     {
         /* M = 3(X + Z^2)(X - Z^2) */
-        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &S,  &P->Z,  &P->Z   ) );
-        MBEDTLS_MPI_CHK( mbedtls_mpi_add_mod( grp, &T,  &P->X,  &S      ) );
-        MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, &U,  &P->X,  &S      ) );
-        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &S,  &T,     &U      ) );
-        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_int( &M,  &S,     3       ) ); MOD_ADD( M );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, S,  &P->Z,  &P->Z   ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_add_mod( grp, T,  &P->X,  S       ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, U,  &P->X,  S       ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, S,  T,      U       ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_int( M,  S,      3       ) ); MOD_ADD( *M );
     }
     else
     {
         /* M = 3.X^2 */
-        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &S,  &P->X,  &P->X   ) );
-        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_int( &M,  &S,     3       ) ); MOD_ADD( M );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, S,  &P->X,  &P->X   ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_int( M,  S,      3       ) ); MOD_ADD( *M );
 
         /* Optimize away for "koblitz" curves with A = 0 */
         if( mbedtls_mpi_cmp_int( &grp->A, 0 ) != 0 )
         {
             /* M += A.Z^4 */
-            MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &S,  &P->Z,  &P->Z   ) );
-            MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &T,  &S,     &S      ) );
-            MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &S,  &T,     &grp->A ) );
-            MBEDTLS_MPI_CHK( mbedtls_mpi_add_mod( grp, &M,  &M,     &S      ) );
+            MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, S,  &P->Z,  &P->Z   ) );
+            MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, T,  S,      S       ) );
+            MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, S,  T,      ecp_coef_a( grp ) ) );
+            MBEDTLS_MPI_CHK( mbedtls_mpi_add_mod( grp, M,  M,      S       ) );
         }
     }
 
     /* S = 4.X.Y^2 */
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &T,  &P->Y,  &P->Y   ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_shift_l_mod( grp, &T,  1               ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &S,  &P->X,  &T      ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_shift_l_mod( grp, &S,  1               ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, T,  &P->Y,  &P->Y   ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_shift_l_mod( grp, T,  1               ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, S,  &P->X,  T       ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_shift_l_mod( grp, S,  1               ) );
 
     /* U = 8.Y^4 */
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &U,  &T,     &T      ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_shift_l_mod( grp, &U,  1               ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, U,  T,      T       ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_shift_l_mod( grp, U,  1               ) );
 
     /* T = M^2 - 2.S */
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &T,  &M,     &M      ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, &T,  &T,     &S      ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, &T,  &T,     &S      ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, T,  M,      M       ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, T,  T,      S       ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, T,  T,      S       ) );
 
     /* S = M(S - T) - U */
-    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, &S,  &S,     &T      ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &S,  &S,     &M      ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, &S,  &S,     &U      ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, S,  S,      T       ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, S,  S,      M       ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, S,  S,      U       ) );
 
     /* U = 2.Y.Z */
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &U,  &P->Y,  &P->Z   ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_shift_l_mod( grp, &U,  1               ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, U,  &P->Y,  &P->Z   ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_shift_l_mod( grp, U,  1               ) );
 
-    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &R->X, &T ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &R->Y, &S ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &R->Z, &U ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &R->X, T ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &R->Y, S ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &R->Z, U ) );
 
 cleanup:
-    mbedtls_mpi_free( &M ); mbedtls_mpi_free( &S ); mbedtls_mpi_free( &T ); mbedtls_mpi_free( &U );
-
     return( ret );
 }
 
@@ -1565,13 +1893,20 @@ cleanup:
  *
  * We accept Q->Z being unset (saving memory in tables) as meaning 1.
  *
+ * R may alias P or Q: the coordinates of R are only written once the
+ * corresponding coordinates of P and Q are no longer needed.
+ *
  * Cost: 1A := 8M + 3S
  */
 static int ecp_add_mixed( const mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
-                          const mbedtls_ecp_point *P, const mbedtls_ecp_point *Q )
+                          const mbedtls_ecp_point *P, const mbedtls_ecp_point *Q,
+                          mbedtls_mpi tmp[ECP_TMP_COUNT] )
 {
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
-    mbedtls_mpi T1, T2, T3, T4, X, Y, Z;
+    mbedtls_mpi * const T1 = &tmp[0];
+    mbedtls_mpi * const T2 = &tmp[1];
+    mbedtls_mpi * const T3 = &tmp[2];
+    mbedtls_mpi * const T4 = &tmp[3];
 
 #if defined(MBEDTLS_SELF_TEST)
     add_count++;
@@ -1594,25 +1929,22 @@ static int ecp_add_mixed( const mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
     /*
      * Make sure Q coordinates are normalized
      */
-    if( Q->Z.p != NULL && mbedtls_mpi_cmp_int( &Q->Z, 1 ) != 0 )
+    if( Q->Z.p != NULL && ecp_cmp_one( grp, &Q->Z ) != 0 )
         return( MBEDTLS_ERR_ECP_BAD_INPUT_DATA );
 
-    mbedtls_mpi_init( &T1 ); mbedtls_mpi_init( &T2 ); mbedtls_mpi_init( &T3 ); mbedtls_mpi_init( &T4 );
-    mbedtls_mpi_init( &X ); mbedtls_mpi_init( &Y ); mbedtls_mpi_init( &Z );
-
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &T1,  &P->Z,  &P->Z ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &T2,  &T1,    &P->Z ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &T1,  &T1,    &Q->X ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &T2,  &T2,    &Q->Y ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, &T1,  &T1,    &P->X ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, &T2,  &T2,    &P->Y ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, T1,  &P->Z,  &P->Z ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, T2,  T1,     &P->Z ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, T1,  T1,     &Q->X ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, T2,  T2,     &Q->Y ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, T1,  T1,     &P->X ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, T2,  T2,     &P->Y ) );
 
     /* Special cases (2) and (3) */
-    if( mbedtls_mpi_cmp_int( &T1, 0 ) == 0 )
+    if( mbedtls_mpi_cmp_int( T1, 0 ) == 0 )
     {
-        if( mbedtls_mpi_cmp_int( &T2, 0 ) == 0 )
+        if( mbedtls_mpi_cmp_int( T2, 0 ) == 0 )
         {
-            ret = ecp_double_jac( grp, R, P );
+            ret = ecp_double_jac( grp, R, P, tmp );
             goto cleanup;
         }
         else
@@ -1622,29 +1954,24 @@ static int ecp_add_mixed( const mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
         }
     }
 
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &Z,   &P->Z,  &T1   ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &T3,  &T1,    &T1   ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &T4,  &T3,    &T1   ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &T3,  &T3,    &P->X ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &T1, &T3 ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_shift_l_mod( grp, &T1,  1     ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &X,   &T2,    &T2   ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, &X,   &X,     &T1   ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, &X,   &X,     &T4   ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, &T3,  &T3,    &X    ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &T3,  &T3,    &T2   ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &T4,  &T4,    &P->Y ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, &Y,   &T3,    &T4   ) );
-
-    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &R->X, &X ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &R->Y, &Y ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &R->Z, &Z ) );
+    /* P->Z and Q are no longer read from: R->Z may be written */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &R->Z, &P->Z, T1   ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, T3,  T1,     T1    ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, T4,  T3,     T1    ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, T3,  T3,     &P->X ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( T1, T3 ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_shift_l_mod( grp, T1,  1     ) );
+    /* P->X is no longer read from: R->X may be written */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &R->X, T2,   T2    ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, &R->X, &R->X, T1   ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, &R->X, &R->X, T4   ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, T3,  T3,     &R->X ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, T3,  T3,     T2    ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, T4,  T4,     &P->Y ) );
+    /* P->Y is no longer read from: R->Y may be written */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, &R->Y, T3,   T4    ) );
 
 cleanup:
-
-    mbedtls_mpi_free( &T1 ); mbedtls_mpi_free( &T2 ); mbedtls_mpi_free( &T3 ); mbedtls_mpi_free( &T4 );
-    mbedtls_mpi_free( &X ); mbedtls_mpi_free( &Y ); mbedtls_mpi_free( &Z );
-
     return( ret );
 }
 
@@ -1838,6 +2165,10 @@ static int ecp_precompute_comb( const mbedtls_ecp_group *grp,
     size_t j = 0;
     const unsigned char T_size = 1U << ( w - 1 );
     mbedtls_ecp_point *cur, *TT[COMB_MAX_PRE - 1];
+    mbedtls_mpi tmp[ECP_TMP_COUNT];
+
+    ecp_tmp_init( tmp );
+    MBEDTLS_MPI_CHK( ecp_tmp_grow( grp, tmp ) );
 
 #if defined(MBEDTLS_ECP_RESTARTABLE)
     if( rs_ctx != NULL && rs_ctx->rsm != NULL )
@@ -1869,8 +2200,12 @@ dbl:
     /*
      * Set T[0] = P and
      * T[2^{l-1}] = 2^{dl} P for l = 1 .. w-1 (this is not the final value)
+     *
+     * P comes from the caller in the usual representation, while the table
+     * is in the one used by grp.
      */
     MBEDTLS_MPI_CHK( mbedtls_ecp_copy( &T[0], P ) );
+    MBEDTLS_MPI_CHK( ecp_point_to_mont( grp, &T[0] ) );
 
 #if defined(MBEDTLS_ECP_RESTARTABLE)
     if( rs_ctx != NULL && rs_ctx->rsm != NULL && rs_ctx->rsm->i != 0 )
@@ -1889,7 +2224,7 @@ dbl:
         if( j % d == 0 )
             MBEDTLS_MPI_CHK( mbedtls_ecp_copy( cur, T + ( i >> 1 ) ) );
 
-        MBEDTLS_MPI_CHK( ecp_double_jac( grp, cur, cur ) );
+        MBEDTLS_MPI_CHK( ecp_double_jac( grp, cur, cur, tmp ) );
     }
 
 #if defined(MBEDTLS_ECP_RESTARTABLE)
@@ -1926,7 +2261,7 @@ add:
     {
         j = i;
         while( j-- )
-            MBEDTLS_MPI_CHK( ecp_add_mixed( grp, &T[i + j], &T[j], &T[i] ) );
+            MBEDTLS_MPI_CHK( ecp_add_mixed( grp, &T[i + j], &T[j], &T[i], tmp ) );
     }
 
 #if defined(MBEDTLS_ECP_RESTARTABLE)
@@ -1948,6 +2283,9 @@ norm_add:
     MBEDTLS_MPI_CHK( ecp_normalize_jac_many( grp, TT, j ) );
 
 cleanup:
+
+    ecp_tmp_free( tmp );
+
 #if defined(MBEDTLS_ECP_RESTARTABLE)
     if( rs_ctx != NULL && rs_ctx->rsm != NULL &&
         ret == MBEDTLS_ERR_ECP_IN_PROGRESS )
@@ -2004,9 +2342,11 @@ static int ecp_mul_comb_core( const mbedtls_ecp_group *grp, mbedtls_ecp_point *R
 {
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
     mbedtls_ecp_point Txi;
+    mbedtls_mpi tmp[ECP_TMP_COUNT];
     size_t i;
 
     mbedtls_ecp_point_init( &Txi );
+    ecp_tmp_init( tmp );
 
 #if !defined(MBEDTLS_ECP_RESTARTABLE)
     (void) rs_ctx;
@@ -2032,26 +2372,29 @@ static int ecp_mul_comb_core( const mbedtls_ecp_group *grp, mbedtls_ecp_point *R
         /* Start with a non-zero point and randomize its coordinates */
         i = d;
         MBEDTLS_MPI_CHK( ecp_select_comb( grp, R, T, T_size, x[i] ) );
-        MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &R->Z, 1 ) );
+        MBEDTLS_MPI_CHK( ecp_set_one( grp, &R->Z ) );
 #if defined(MBEDTLS_ECP_NO_INTERNAL_RNG)
         if( f_rng != 0 )
 #endif
             MBEDTLS_MPI_CHK( ecp_randomize_jac( grp, R, f_rng, p_rng ) );
     }
 
+    MBEDTLS_MPI_CHK( ecp_tmp_grow( grp, tmp ) );
+
     while( i != 0 )
     {
         MBEDTLS_ECP_BUDGET( MBEDTLS_ECP_OPS_DBL + MBEDTLS_ECP_OPS_ADD );
         --i;
 
-        MBEDTLS_MPI_CHK( ecp_double_jac( grp, R, R ) );
+        MBEDTLS_MPI_CHK( ecp_double_jac( grp, R, R, tmp ) );
         MBEDTLS_MPI_CHK( ecp_select_comb( grp, &Txi, T, T_size, x[i] ) );
-        MBEDTLS_MPI_CHK( ecp_add_mixed( grp, R, R, &Txi ) );
+        MBEDTLS_MPI_CHK( ecp_add_mixed( grp, R, R, &Txi, tmp ) );
     }
 
 cleanup:
 
     mbedtls_ecp_point_free( &Txi );
+    ecp_tmp_free( tmp );
 
 #if defined(MBEDTLS_ECP_RESTARTABLE)
     if( rs_ctx != NULL && rs_ctx->rsm != NULL &&
@@ -2175,6 +2518,7 @@ final_norm:
         MBEDTLS_MPI_CHK( ecp_randomize_jac( grp, RR, f_rng, p_rng ) );
 
     MBEDTLS_MPI_CHK( ecp_normalize_jac( grp, RR ) );
+    MBEDTLS_MPI_CHK( ecp_point_from_mont( grp, RR ) );
 
 #if defined(MBEDTLS_ECP_RESTARTABLE)
     if( rs_ctx != NULL && rs_ctx->rsm != NULL )
@@ -2222,6 +2566,140 @@ static unsigned char ecp_pick_window_size( const mbedtls_ecp_group *grp,
     return( w );
 }
 
+#if defined(MBEDTLS_ECP_GLV_OPTIM) && defined(MBEDTLS_ECP_DP_SECP256K1_ENABLED)
+#define ECP_GLV_ENABLED
+
+/*
+ * GLV method for secp256k1 (Gallant, Lambert and Vanstone, "Faster point
+ * multiplication on elliptic curves with efficient endomorphisms", CRYPTO
+ * 2001, see also GECC 3.5).
+ *
+ * The map phi(x, y) = (beta x, y) sends every point P to lambda P, where
+ * beta and lambda are cube roots of unity modulo P and N respectively.
+ * A scalar k is split as k = k1 + k2 lambda mod N with |k1|, |k2| < 2^128
+ * using a short basis (a1, b1), (a2, b2) of the lattice of vectors with
+ * a + b lambda = 0 mod N:
+ *
+ *   c1 = round( b2 k / N ), c2 = round( -b1 k / N )
+ *   k1 = k - c1 a1 - c2 a2, k2 = -c1 b1 - c2 b2
+ *
+ * where the divisions by N are approximated by multiplications by
+ * g1 = round( 2^384 b2 / N ) and g2 = round( 2^384 (-b1) / N ).
+ * For secp256k1, b1 is negative and b2 = a1: ecp_glv_b1 holds -b1.
+ *
+ * The split uses variable-time arithmetic, so the GLV method is only used
+ * for mbedtls_ecp_muladd(), whose scalars are public, and never for
+ * mbedtls_ecp_mul(), which may be given a secret scalar.
+ */
+static const unsigned char ecp_glv_beta[] = {
+    0x7A, 0xE9, 0x6A, 0x2B, 0x65, 0x7C, 0x07, 0x10,
+    0x6E, 0x64, 0x47, 0x9E, 0xAC, 0x34, 0x34, 0xE9,
+    0x9C, 0xF0, 0x49, 0x75, 0x12, 0xF5, 0x89, 0x95,
+    0xC1, 0x39, 0x6C, 0x28, 0x71, 0x95, 0x01, 0xEE,
+};
+static const unsigned char ecp_glv_a1[] = {
+    0x30, 0x86, 0xD2, 0x21, 0xA7, 0xD4, 0x6B, 0xCD,
+    0xE8, 0x6C, 0x90, 0xE4, 0x92, 0x84, 0xEB, 0x15,
+};
+static const unsigned char ecp_glv_b1[] = {
+    0xE4, 0x43, 0x7E, 0xD6, 0x01, 0x0E, 0x88, 0x28,
+    0x6F, 0x54, 0x7F, 0xA9, 0x0A, 0xBF, 0xE4, 0xC3,
+};
+static const unsigned char ecp_glv_a2[] = {
+    0x01, 0x14, 0xCA, 0x50, 0xF7, 0xA8, 0xE2, 0xF3,
+    0xF6, 0x57, 0xC1, 0x10, 0x8D, 0x9D, 0x44, 0xCF,
+    0xD8,
+};
+static const unsigned char ecp_glv_g1[] = {
+    0x30, 0x86, 0xD2, 0x21, 0xA7, 0xD4, 0x6B, 0xCD,
+    0xE8, 0x6C, 0x90, 0xE4, 0x92, 0x84, 0xEB, 0x15,
+    0x3D, 0xAA, 0x8A, 0x14, 0x71, 0xE8, 0xCA, 0x7F,
+    0xE8, 0x93, 0x20, 0x9A, 0x45, 0xDB, 0xB0, 0x31,
+};
+static const unsigned char ecp_glv_g2[] = {
+    0xE4, 0x43, 0x7E, 0xD6, 0x01, 0x0E, 0x88, 0x28,
+    0x6F, 0x54, 0x7F, 0xA9, 0x0A, 0xBF, 0xE4, 0xC4,
+    0x22, 0x12, 0x08, 0xAC, 0x9D, 0xF5, 0x06, 0xC6,
+    0x15, 0x71, 0xB4, 0xAE, 0x8A, 0xC4, 0x7F, 0x71,
+};
+
+static int ecp_glv_is_capable( const mbedtls_ecp_group *grp )
+{
+    return( grp->id == MBEDTLS_ECP_DP_SECP256K1 );
+}
+
+/*
+ * Split k, in [0, N), as k1 + k2 lambda mod N (see above).
+ * NOT constant-time: only for public scalars.
+ */
+static int ecp_glv_split( const mbedtls_mpi *k, mbedtls_mpi *k1,
+                          mbedtls_mpi *k2 )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_mpi a1, b1, a2, g, c1, c2, t1;
+
+    mbedtls_mpi_init( &a1 ); mbedtls_mpi_init( &b1 ); mbedtls_mpi_init( &a2 );
+    mbedtls_mpi_init( &g ); mbedtls_mpi_init( &c1 ); mbedtls_mpi_init( &c2 );
+    mbedtls_mpi_init( &t1 );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_read_binary( &a1, ecp_glv_a1,
+                                              sizeof( ecp_glv_a1 ) ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_read_binary( &b1, ecp_glv_b1,
+                                              sizeof( ecp_glv_b1 ) ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_read_binary( &a2, ecp_glv_a2,
+                                              sizeof( ecp_glv_a2 ) ) );
+
+    /* c1 = round( k g1 / 2^384 ), c2 = round( k g2 / 2^384 ) */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_read_binary( &g, ecp_glv_g1,
+                                              sizeof( ecp_glv_g1 ) ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &c1, k, &g ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_shift_r( &c1, 383 ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_add_int( &c1, &c1, 1 ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_shift_r( &c1, 1 ) );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_read_binary( &g, ecp_glv_g2,
+                                              sizeof( ecp_glv_g2 ) ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &c2, k, &g ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_shift_r( &c2, 383 ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_add_int( &c2, &c2, 1 ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_shift_r( &c2, 1 ) );
+
+    /* k1 = k - c1 a1 - c2 a2 */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &t1, &c1, &a1 ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( k1, k, &t1 ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &t1, &c2, &a2 ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( k1, k1, &t1 ) );
+
+    /* k2 = c1 (-b1) - c2 a1 */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( k2, &c1, &b1 ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &t1, &c2, &a1 ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( k2, k2, &t1 ) );
+
+cleanup:
+    mbedtls_mpi_free( &a1 ); mbedtls_mpi_free( &b1 ); mbedtls_mpi_free( &a2 );
+    mbedtls_mpi_free( &g ); mbedtls_mpi_free( &c1 ); mbedtls_mpi_free( &c2 );
+    mbedtls_mpi_free( &t1 );
+
+    return( ret );
+}
+
+/*
+ * R = phi(P) = lambda P, for P in affine coordinates
+ */
+static int ecp_glv_endo( const mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+                         const mbedtls_ecp_point *P, const mbedtls_mpi *beta )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &R->X, &P->X, beta ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &R->Y, &P->Y ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &R->Z, &P->Z ) );
+
+cleanup:
+    return( ret );
+}
+#endif /* MBEDTLS_ECP_GLV_OPTIM && MBEDTLS_ECP_DP_SECP256K1_ENABLED */
+
 /*
  * Multiplication using the comb method - for curves in short Weierstrass form
  *
@@ -2417,7 +2895,7 @@ static int ecp_normalize_mxz( const mbedtls_ecp_group *grp, mbedtls_ecp_point *P
         return( mbedtls_internal_ecp_normalize_mxz( grp, P ) );
 #endif /* MBEDTLS_ECP_NORMALIZE_MXZ_ALT */
 
-    MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod( &P->Z, &P->Z, &grp->P ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod_ct( &P->Z, &P->Z, &grp->P ) );
     MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &P->X, &P->X, &P->Z ) );
     MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &P->Z, 1 ) );
 
@@ -2492,44 +2970,37 @@ cleanup:
 static int ecp_double_add_mxz( const mbedtls_ecp_group *grp,
                                mbedtls_ecp_point *R, mbedtls_ecp_point *S,
                                const mbedtls_ecp_point *P, const mbedtls_ecp_point *Q,
-                               const mbedtls_mpi *d )
+                               const mbedtls_mpi *d,
+                               mbedtls_mpi tmp[ECP_TMP_COUNT] )
 {
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
-    mbedtls_mpi A, AA, B, BB, E, C, D, DA, CB;
 
 #if defined(MBEDTLS_ECP_DOUBLE_ADD_MXZ_ALT)
     if( mbedtls_internal_ecp_grp_capable( grp ) )
         return( mbedtls_internal_ecp_double_add_mxz( grp, R, S, P, Q, d ) );
 #endif /* MBEDTLS_ECP_DOUBLE_ADD_MXZ_ALT */
 
-    mbedtls_mpi_init( &A ); mbedtls_mpi_init( &AA ); mbedtls_mpi_init( &B );
-    mbedtls_mpi_init( &BB ); mbedtls_mpi_init( &E ); mbedtls_mpi_init( &C );
-    mbedtls_mpi_init( &D ); mbedtls_mpi_init( &DA ); mbedtls_mpi_init( &CB );
-
-    MBEDTLS_MPI_CHK( mbedtls_mpi_add_mod( grp, &A,    &P->X,   &P->Z ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &AA,   &A,      &A    ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, &B,    &P->X,   &P->Z ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &BB,   &B,      &B    ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, &E,    &AA,     &BB   ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_add_mod( grp, &C,    &Q->X,   &Q->Z ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, &D,    &Q->X,   &Q->Z ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &DA,   &D,      &A    ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &CB,   &C,      &B    ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_add_mod( grp, &S->X, &DA,     &CB   ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &S->X, &S->X,   &S->X ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, &S->Z, &DA,     &CB   ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &S->Z, &S->Z,   &S->Z ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &S->Z, d,       &S->Z ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &R->X, &AA,     &BB   ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &R->Z, &grp->A, &E    ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_add_mod( grp, &R->Z, &BB,     &R->Z ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &R->Z, &E,      &R->Z ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_add_mod( grp, &tmp[0], &P->X,   &P->Z   ) ); /* A  */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, &tmp[1], &P->X,   &P->Z   ) ); /* B  */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_add_mod( grp, &tmp[2], &Q->X,   &Q->Z   ) ); /* C  */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, &tmp[3], &Q->X,   &Q->Z   ) ); /* D  */
+    /* P and Q are no longer read from, so R and S may alias them */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &tmp[3], &tmp[3], &tmp[0] ) ); /* DA */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &tmp[2], &tmp[2], &tmp[1] ) ); /* CB */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &tmp[0], &tmp[0], &tmp[0] ) ); /* AA */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &tmp[1], &tmp[1], &tmp[1] ) ); /* BB */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_add_mod( grp, &S->X,   &tmp[3], &tmp[2] ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &S->X,   &S->X,   &S->X   ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, &S->Z,   &tmp[3], &tmp[2] ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &S->Z,   &S->Z,   &S->Z   ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &S->Z,   d,       &S->Z   ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &R->X,   &tmp[0], &tmp[1] ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, &R->Z,   &tmp[0], &tmp[1] ) ); /* E  */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &tmp[2], &grp->A, &R->Z   ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_add_mod( grp, &tmp[2], &tmp[1], &tmp[2] ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &R->Z,   &R->Z,   &tmp[2] ) );
 
 cleanup:
-    mbedtls_mpi_free( &A ); mbedtls_mpi_free( &AA ); mbedtls_mpi_free( &B );
-    mbedtls_mpi_free( &BB ); mbedtls_mpi_free( &E ); mbedtls_mpi_free( &C );
-    mbedtls_mpi_free( &D ); mbedtls_mpi_free( &DA ); mbedtls_mpi_free( &CB );
-
     return( ret );
 }
 
@@ -2547,12 +3018,14 @@ static int ecp_mul_mxz( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
     unsigned char b;
     mbedtls_ecp_point RP;
     mbedtls_mpi PX;
+    mbedtls_mpi tmp[ECP_TMP_COUNT];
 #if !defined(MBEDTLS_ECP_NO_INTERNAL_RNG)
     ecp_drbg_context drbg_ctx;
 
     ecp_drbg_init( &drbg_ctx );
 #endif
     mbedtls_ecp_point_init( &RP ); mbedtls_mpi_init( &PX );
+    ecp_tmp_init( tmp );
 
 #if !defined(MBEDTLS_ECP_NO_INTERNAL_RNG)
     if( f_rng == NULL )
@@ -2582,6 +3055,8 @@ static int ecp_mul_mxz( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
 #endif
         MBEDTLS_MPI_CHK( ecp_randomize_mxz( grp, &RP, f_rng, p_rng ) );
 
+    MBEDTLS_MPI_CHK( ecp_tmp_grow( grp, tmp ) );
+
     /* Loop invariant: R = result so far, RP = R + P */
     i = mbedtls_mpi_bitlen( m ); /* one past the (zero-based) most significant bit */
     while( i-- > 0 )
@@ -2596,7 +3071,7 @@ static int ecp_mul_mxz( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
          */
         MBEDTLS_MPI_CHK( mbedtls_mpi_safe_cond_swap( &R->X, &RP.X, b ) );
         MBEDTLS_MPI_CHK( mbedtls_mpi_safe_cond_swap( &R->Z, &RP.Z, b ) );
-        MBEDTLS_MPI_CHK( ecp_double_add_mxz( grp, R, &RP, R, &RP, &PX ) );
+        MBEDTLS_MPI_CHK( ecp_double_add_mxz( grp, R, &RP, R, &RP, &PX, tmp ) );
         MBEDTLS_MPI_CHK( mbedtls_mpi_safe_cond_swap( &R->X, &RP.X, b ) );
         MBEDTLS_MPI_CHK( mbedtls_mpi_safe_cond_swap( &R->Z, &RP.Z, b ) );
     }
@@ -2625,6 +3100,7 @@ cleanup:
 #endif
 
     mbedtls_ecp_point_free( &RP ); mbedtls_mpi_free( &PX );
+    ecp_tmp_free( tmp );
 
     return( ret );
 }
@@ -2650,8 +3126,7 @@ int mbedtls_ecp_mul_restartable( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
 
 #if defined(MBEDTLS_ECP_RESTARTABLE)
     /* reset ops count for this call if top-level */
-    if( rs_ctx != NULL && rs_ctx->depth++ == 0 )
-        rs_ctx->ops_done = 0;
+    mbedtls_ecp_restart_enter( rs_ctx );
 #else
     (void) rs_ctx;
 #endif
@@ -2692,8 +3167,7 @@ cleanup:
 #endif /* MBEDTLS_ECP_INTERNAL_ALT */
 
 #if defined(MBEDTLS_ECP_RESTARTABLE)
-    if( rs_ctx != NULL )
-        rs_ctx->depth--;
+    mbedtls_ecp_restart_leave( rs_ctx );
 #endif
 
     return( ret );
@@ -2713,72 +3187,215 @@ int mbedtls_ecp_mul( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
     return( mbedtls_ecp_mul_restartable( grp, R, m, P, f_rng, p_rng, NULL ) );
 }
 
-#if defined(MBEDTLS_ECP_SHORT_WEIERSTRASS_ENABLED)
+#if defined(MBEDTLS_ECP_SHARED_GROUPS)
 /*
- * Check that an affine point is valid as a public key,
- * short weierstrass curves (SEC1 3.2.3.1)
+ * Registry of shared groups, indexed by group ID. An entry is populated
+ * (under the mutex when threading is enabled) the first time a group with
+ * this ID is loaded through mbedtls_ecp_group_load_shared(), and is only
+ * read afterwards until mbedtls_ecp_shared_groups_free().
  */
-static int ecp_check_pubkey_sw( const mbedtls_ecp_group *grp, const mbedtls_ecp_point *pt )
+static mbedtls_ecp_group ecp_shared_groups[MBEDTLS_ECP_DP_MAX + 1];
+
+#if defined(MBEDTLS_ECP_SHORT_WEIERSTRASS_ENABLED) && \
+    MBEDTLS_ECP_FIXED_POINT_OPTIM == 1
+/*
+ * Load a group in the registry and fill its table for the base point.
+ * The table is computed as a side effect of multiplying G by 1, which
+ * ecp_mul_comb() stores in grp->T for later use.
+ */
+static int ecp_shared_group_setup( mbedtls_ecp_group *grp,
+                                   mbedtls_ecp_group_id id )
 {
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
-    mbedtls_mpi YY, RHS;
-
-    /* pt coordinates must be normalized for our checks */
-    if( mbedtls_mpi_cmp_int( &pt->X, 0 ) < 0 ||
-        mbedtls_mpi_cmp_int( &pt->Y, 0 ) < 0 ||
-        mbedtls_mpi_cmp_mpi( &pt->X, &grp->P ) >= 0 ||
-        mbedtls_mpi_cmp_mpi( &pt->Y, &grp->P ) >= 0 )
-        return( MBEDTLS_ERR_ECP_INVALID_KEY );
-
-    mbedtls_mpi_init( &YY ); mbedtls_mpi_init( &RHS );
-
-    /*
-     * YY = Y^2
-     * RHS = X (X^2 + A) + B = X^3 + A X + B
-     */
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &YY,  &pt->Y,   &pt->Y  ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &RHS, &pt->X,   &pt->X  ) );
+    mbedtls_ecp_point R;
+    mbedtls_mpi one;
 
-    /* Special case for A = -3 */
-    if( grp->A.p == NULL )
-    {
-        MBEDTLS_MPI_CHK( mbedtls_mpi_sub_int( &RHS, &RHS, 3       ) );  MOD_SUB( RHS );
-    }
-    else
-    {
-        MBEDTLS_MPI_CHK( mbedtls_mpi_add_mod( grp, &RHS, &RHS, &grp->A ) );
-    }
+    mbedtls_ecp_point_init( &R );
+    mbedtls_mpi_init( &one );
 
-    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &RHS, &RHS,     &pt->X  ) );
-    MBEDTLS_MPI_CHK( mbedtls_mpi_add_mod( grp, &RHS, &RHS,     &grp->B ) );
+    mbedtls_ecp_group_init( grp );
+    MBEDTLS_MPI_CHK( mbedtls_ecp_group_load( grp, id ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &one, 1 ) );
+    MBEDTLS_MPI_CHK( mbedtls_ecp_mul( grp, &R, &one, &grp->G, NULL, NULL ) );
 
-    if( mbedtls_mpi_cmp_mpi( &YY, &RHS ) != 0 )
-        ret = MBEDTLS_ERR_ECP_INVALID_KEY;
+    if( grp->T == NULL || grp->T_size == 0 )
+        ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
 
 cleanup:
+    if( ret != 0 )
+        mbedtls_ecp_group_free( grp );
 
-    mbedtls_mpi_free( &YY ); mbedtls_mpi_free( &RHS );
+    mbedtls_ecp_point_free( &R );
+    mbedtls_mpi_free( &one );
 
     return( ret );
 }
-#endif /* MBEDTLS_ECP_SHORT_WEIERSTRASS_ENABLED */
+#endif /* MBEDTLS_ECP_SHORT_WEIERSTRASS_ENABLED && FIXED_POINT_OPTIM */
 
-#if defined(MBEDTLS_ECP_SHORT_WEIERSTRASS_ENABLED)
 /*
- * R = m * P with shortcuts for m == 1 and m == -1
- * NOT constant-time - ONLY for short Weierstrass!
+ * Load a group referencing the table in the registry
  */
-static int mbedtls_ecp_mul_shortcuts( mbedtls_ecp_group *grp,
-                                      mbedtls_ecp_point *R,
-                                      const mbedtls_mpi *m,
-                                      const mbedtls_ecp_point *P,
-                                      mbedtls_ecp_restart_ctx *rs_ctx )
+int mbedtls_ecp_group_load_shared( mbedtls_ecp_group *grp,
+                                   mbedtls_ecp_group_id id )
 {
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    ECP_VALIDATE_RET( grp != NULL );
 
-    if( mbedtls_mpi_cmp_int( m, 1 ) == 0 )
+    MBEDTLS_MPI_CHK( mbedtls_ecp_group_load( grp, id ) );
+
+#if defined(MBEDTLS_ECP_SHORT_WEIERSTRASS_ENABLED) && \
+    MBEDTLS_ECP_FIXED_POINT_OPTIM == 1
+    if( mbedtls_ecp_get_type( grp ) != MBEDTLS_ECP_TYPE_SHORT_WEIERSTRASS ||
+        (size_t) id >= sizeof( ecp_shared_groups ) /
+                       sizeof( ecp_shared_groups[0] ) )
     {
-        MBEDTLS_MPI_CHK( mbedtls_ecp_copy( R, P ) );
+        return( 0 );
+    }
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_lock( &mbedtls_threading_ecp_shared_groups_mutex ) != 0 )
+    {
+        ret = MBEDTLS_ERR_THREADING_MUTEX_ERROR;
+        goto cleanup;
+    }
+#endif
+
+    if( ecp_shared_groups[id].T == NULL )
+        ret = ecp_shared_group_setup( &ecp_shared_groups[id], id );
+
+    if( ret == 0 )
+    {
+        /* reference the table without taking ownership */
+        grp->T = ecp_shared_groups[id].T;
+        grp->T_size = 0;
+    }
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_unlock( &mbedtls_threading_ecp_shared_groups_mutex ) != 0 )
+        ret = MBEDTLS_ERR_THREADING_MUTEX_ERROR;
+#endif
+#endif /* MBEDTLS_ECP_SHORT_WEIERSTRASS_ENABLED && FIXED_POINT_OPTIM */
+
+cleanup:
+    if( ret != 0 )
+        mbedtls_ecp_group_free( grp );
+
+    return( ret );
+}
+
+/*
+ * Free all tables in the registry
+ */
+void mbedtls_ecp_shared_groups_free( void )
+{
+    size_t i;
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_lock( &mbedtls_threading_ecp_shared_groups_mutex ) != 0 )
+        return;
+#endif
+
+    for( i = 0; i < sizeof( ecp_shared_groups ) /
+                    sizeof( ecp_shared_groups[0] ); i++ )
+    {
+        if( ecp_shared_groups[i].T != NULL )
+            mbedtls_ecp_group_free( &ecp_shared_groups[i] );
+    }
+
+#if defined(MBEDTLS_THREADING_C)
+    (void) mbedtls_mutex_unlock( &mbedtls_threading_ecp_shared_groups_mutex );
+#endif
+}
+#endif /* MBEDTLS_ECP_SHARED_GROUPS */
+
+#if defined(MBEDTLS_ECP_SHORT_WEIERSTRASS_ENABLED)
+/*
+ * Check that an affine point is valid as a public key,
+ * short weierstrass curves (SEC1 3.2.3.1)
+ */
+static int ecp_check_pubkey_sw( const mbedtls_ecp_group *grp, const mbedtls_ecp_point *pt )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_mpi YY, RHS;
+    const mbedtls_ecp_point *Q = pt;
+#if defined(MBEDTLS_ECP_MONT_FIELD_OPTIM)
+    mbedtls_ecp_point Qm;
+#endif
+
+    /* pt coordinates must be normalized for our checks */
+    if( mbedtls_mpi_cmp_int( &pt->X, 0 ) < 0 ||
+        mbedtls_mpi_cmp_int( &pt->Y, 0 ) < 0 ||
+        mbedtls_mpi_cmp_mpi( &pt->X, &grp->P ) >= 0 ||
+        mbedtls_mpi_cmp_mpi( &pt->Y, &grp->P ) >= 0 )
+        return( MBEDTLS_ERR_ECP_INVALID_KEY );
+
+    mbedtls_mpi_init( &YY ); mbedtls_mpi_init( &RHS );
+
+#if defined(MBEDTLS_ECP_MONT_FIELD_OPTIM)
+    /* Q = pt, in the Montgomery representation used by grp */
+    mbedtls_ecp_point_init( &Qm );
+    if( grp->mont_mm != 0 )
+    {
+        MBEDTLS_MPI_CHK( mbedtls_ecp_copy( &Qm, pt ) );
+        MBEDTLS_MPI_CHK( ecp_point_to_mont( grp, &Qm ) );
+        Q = &Qm;
+    }
+#endif
+
+    /*
+     * YY = Y^2
+     * RHS = X (X^2 + A) + B = X^3 + A X + B
+     */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &YY,  &Q->Y,    &Q->Y   ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &RHS, &Q->X,    &Q->X   ) );
+
+    /* Special case for A = -3 */
+    if( grp->A.p == NULL )
+    {
+        /* A = -3: subtract 3 Q->Z, as Q->Z is 1 in the representation
+         * used by grp (checked by mbedtls_ecp_check_pubkey()) */
+        MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, &RHS, &RHS, &Q->Z   ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, &RHS, &RHS, &Q->Z   ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mod( grp, &RHS, &RHS, &Q->Z   ) );
+    }
+    else
+    {
+        MBEDTLS_MPI_CHK( mbedtls_mpi_add_mod( grp, &RHS, &RHS, ecp_coef_a( grp ) ) );
+    }
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mod( grp, &RHS, &RHS,    &Q->X   ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_add_mod( grp, &RHS, &RHS,     ecp_coef_b( grp ) ) );
+
+    if( mbedtls_mpi_cmp_mpi( &YY, &RHS ) != 0 )
+        ret = MBEDTLS_ERR_ECP_INVALID_KEY;
+
+cleanup:
+
+    mbedtls_mpi_free( &YY ); mbedtls_mpi_free( &RHS );
+#if defined(MBEDTLS_ECP_MONT_FIELD_OPTIM)
+    mbedtls_ecp_point_free( &Qm );
+#endif
+
+    return( ret );
+}
+#endif /* MBEDTLS_ECP_SHORT_WEIERSTRASS_ENABLED */
+
+#if defined(MBEDTLS_ECP_SHORT_WEIERSTRASS_ENABLED)
+/*
+ * R = m * P with shortcuts for m == 1 and m == -1
+ * NOT constant-time - ONLY for short Weierstrass!
+ */
+static int mbedtls_ecp_mul_shortcuts( mbedtls_ecp_group *grp,
+                                      mbedtls_ecp_point *R,
+                                      const mbedtls_mpi *m,
+                                      const mbedtls_ecp_point *P,
+                                      mbedtls_ecp_restart_ctx *rs_ctx )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+
+    if( mbedtls_mpi_cmp_int( m, 1 ) == 0 )
+    {
+        MBEDTLS_MPI_CHK( mbedtls_ecp_copy( R, P ) );
     }
     else if( mbedtls_mpi_cmp_int( m, -1 ) == 0 )
     {
@@ -2796,6 +3413,57 @@ cleanup:
     return( ret );
 }
 
+#if defined(ECP_GLV_ENABLED)
+static int ecp_muladd_multi( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+                             const mbedtls_mpi *m, const mbedtls_ecp_point *P,
+                             size_t count );
+
+/*
+ * Linear combination with the GLV method: R = m P + n Q is computed as
+ * m1 P + m2 phi(P) + n1 Q + n2 phi(Q) by ecp_muladd_multi(), with
+ * about 130 shared doublings instead of two separate multiplications.
+ * NOT constant-time
+ */
+static int ecp_muladd_glv( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+                           const mbedtls_mpi *m, const mbedtls_ecp_point *P,
+                           const mbedtls_mpi *n, const mbedtls_ecp_point *Q )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_mpi k[4], beta;
+    mbedtls_ecp_point T[4];
+    size_t i;
+
+    mbedtls_mpi_init( &beta );
+    for( i = 0; i < 4; i++ )
+    {
+        mbedtls_mpi_init( &k[i] );
+        mbedtls_ecp_point_init( &T[i] );
+    }
+
+    MBEDTLS_MPI_CHK( ecp_glv_split( m, &k[0], &k[1] ) );
+    MBEDTLS_MPI_CHK( ecp_glv_split( n, &k[2], &k[3] ) );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_read_binary( &beta, ecp_glv_beta,
+                                              sizeof( ecp_glv_beta ) ) );
+    MBEDTLS_MPI_CHK( mbedtls_ecp_copy( &T[0], P ) );
+    MBEDTLS_MPI_CHK( ecp_glv_endo( grp, &T[1], P, &beta ) );
+    MBEDTLS_MPI_CHK( mbedtls_ecp_copy( &T[2], Q ) );
+    MBEDTLS_MPI_CHK( ecp_glv_endo( grp, &T[3], Q, &beta ) );
+
+    MBEDTLS_MPI_CHK( ecp_muladd_multi( grp, R, k, T, 4 ) );
+
+cleanup:
+    mbedtls_mpi_free( &beta );
+    for( i = 0; i < 4; i++ )
+    {
+        mbedtls_mpi_free( &k[i] );
+        mbedtls_ecp_point_free( &T[i] );
+    }
+
+    return( ret );
+}
+#endif /* ECP_GLV_ENABLED */
+
 /*
  * Restartable linear combination
  * NOT constant-time
@@ -2810,6 +3478,7 @@ int mbedtls_ecp_muladd_restartable(
     mbedtls_ecp_point mP;
     mbedtls_ecp_point *pmP = &mP;
     mbedtls_ecp_point *pR = R;
+    mbedtls_mpi tmp[ECP_TMP_COUNT];
 #if defined(MBEDTLS_ECP_INTERNAL_ALT)
     char is_grp_capable = 0;
 #endif
@@ -2823,7 +3492,21 @@ int mbedtls_ecp_muladd_restartable(
     if( mbedtls_ecp_get_type( grp ) != MBEDTLS_ECP_TYPE_SHORT_WEIERSTRASS )
         return( MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE );
 
+#if defined(ECP_GLV_ENABLED)
+    /* Scalars that need the shortcuts or that are out of range (and
+     * rejected) are left to the generic code below */
+    if( ecp_glv_is_capable( grp ) && rs_ctx == NULL &&
+        mbedtls_mpi_cmp_int( m, 1 ) > 0 &&
+        mbedtls_mpi_cmp_mpi( m, &grp->N ) < 0 &&
+        mbedtls_mpi_cmp_int( n, 1 ) > 0 &&
+        mbedtls_mpi_cmp_mpi( n, &grp->N ) < 0 )
+    {
+        return( ecp_muladd_glv( grp, R, m, P, n, Q ) );
+    }
+#endif /* ECP_GLV_ENABLED */
+
     mbedtls_ecp_point_init( &mP );
+    ecp_tmp_init( tmp );
 
     ECP_RS_ENTER( ma );
 
@@ -2865,7 +3548,9 @@ mul2:
 add:
 #endif
     MBEDTLS_ECP_BUDGET( MBEDTLS_ECP_OPS_ADD );
-    MBEDTLS_MPI_CHK( ecp_add_mixed( grp, pR, pmP, pR ) );
+    MBEDTLS_MPI_CHK( ecp_point_to_mont( grp, pmP ) );
+    MBEDTLS_MPI_CHK( ecp_point_to_mont( grp, pR ) );
+    MBEDTLS_MPI_CHK( ecp_add_mixed( grp, pR, pmP, pR, tmp ) );
 #if defined(MBEDTLS_ECP_RESTARTABLE)
     if( rs_ctx != NULL && rs_ctx->ma != NULL )
         rs_ctx->ma->state = ecp_rsma_norm;
@@ -2874,6 +3559,7 @@ norm:
 #endif
     MBEDTLS_ECP_BUDGET( MBEDTLS_ECP_OPS_INV );
     MBEDTLS_MPI_CHK( ecp_normalize_jac( grp, pR ) );
+    MBEDTLS_MPI_CHK( ecp_point_from_mont( grp, pR ) );
 
 #if defined(MBEDTLS_ECP_RESTARTABLE)
     if( rs_ctx != NULL && rs_ctx->ma != NULL )
@@ -2887,6 +3573,7 @@ cleanup:
 #endif /* MBEDTLS_ECP_INTERNAL_ALT */
 
     mbedtls_ecp_point_free( &mP );
+    ecp_tmp_free( tmp );
 
     ECP_RS_LEAVE( ma );
 
@@ -2909,6 +3596,608 @@ int mbedtls_ecp_muladd( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
     ECP_VALIDATE_RET( Q   != NULL );
     return( mbedtls_ecp_muladd_restartable( grp, R, m, P, n, Q, NULL ) );
 }
+
+#if defined(MBEDTLS_ECDSA_BATCH_VERIFY) || defined(ECP_GLV_ENABLED)
+/*
+ * Width-w NAF of |m| (GECC algorithm 3.35), with the sign of m folded into
+ * the digits: m = sum( naf[i] 2^i ), every non-zero digit is odd and less
+ * than 2^(w-1) in absolute value.
+ * naf must hold (at least) mbedtls_mpi_bitlen( m ) + 1 zero-initialised
+ * digits.
+ */
+static int ecp_wnaf_recode( signed char *naf, size_t len,
+                            const mbedtls_mpi *m, unsigned char w )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_mpi k;
+    size_t i;
+    int d;
+
+    mbedtls_mpi_init( &k );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &k, m ) );
+    k.s = 1;
+
+    for( i = 0; i < len && mbedtls_mpi_cmp_int( &k, 0 ) != 0; i++ )
+    {
+        d = 0;
+        if( mbedtls_mpi_get_bit( &k, 0 ) != 0 )
+        {
+            d = (int)( k.p[0] & ( ( (mbedtls_mpi_uint) 1 << w ) - 1 ) );
+            if( d >= ( 1 << ( w - 1 ) ) )
+                d -= 1 << w;
+            MBEDTLS_MPI_CHK( mbedtls_mpi_sub_int( &k, &k, d ) );
+        }
+
+        naf[i] = (signed char)( m->s < 0 ? -d : d );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_shift_r( &k, 1 ) );
+    }
+
+cleanup:
+    mbedtls_mpi_free( &k );
+
+    return( ret );
+}
+
+/*
+ * R += Q, with Q in affine coordinates (Z unset meaning 1).
+ * Unlike ecp_add_mixed() alone, this is correct when R is zero, which
+ * happens at the start of ecp_muladd_multi() and may happen midway.
+ */
+static int ecp_add_mixed_acc( const mbedtls_ecp_group *grp,
+                              mbedtls_ecp_point *R, const mbedtls_ecp_point *Q,
+                              mbedtls_mpi tmp[ECP_TMP_COUNT] )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+
+    if( mbedtls_mpi_cmp_int( &R->Z, 0 ) != 0 )
+        return( ecp_add_mixed( grp, R, R, Q, tmp ) );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &R->X, &Q->X ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &R->Y, &Q->Y ) );
+    MBEDTLS_MPI_CHK( ecp_set_one( grp, &R->Z ) );
+
+cleanup:
+    return( ret );
+}
+
+/*
+ * Window size for ecp_muladd_multi(): each of the terms costs
+ * 2^(w-2) - 1 additions for its table of odd multiples, plus about
+ * bits / (w + 1) additions in the main loop. Normalizing the tables takes
+ * two inversions, which cost roughly ECP_MSM_INV_ADDS additions each, so
+ * that a few short scalars are best handled without tables (w = 2).
+ */
+#define ECP_MSM_INV_ADDS    10
+#define ECP_MSM_MAX_WINDOW  6
+
+static unsigned char ecp_msm_window( size_t terms, size_t bits )
+{
+    unsigned char w, best = 2;
+    size_t cost, best_cost = terms * ( bits / 3 );
+
+    for( w = 3; w <= ECP_MSM_MAX_WINDOW; w++ )
+    {
+        cost = terms * ( ( (size_t) 1 << ( w - 2 ) ) - 1 + bits / ( w + 1 ) )
+               + 2 * ECP_MSM_INV_ADDS;
+        if( cost < best_cost )
+        {
+            best = w;
+            best_cost = cost;
+        }
+    }
+
+    return( best );
+}
+
+/*
+ * Multi-scalar multiplication
+ * R = m[0] P[0] + ... + m[count-1] P[count-1]
+ *
+ * Straus' method with interleaved width-w NAFs (GECC algorithm 3.51): all
+ * the terms share a single chain of doublings, so that the cost of each
+ * additional term is only its additions.
+ *
+ * NOT constant-time
+ */
+static int ecp_muladd_multi( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+                             const mbedtls_mpi *m, const mbedtls_ecp_point *P,
+                             size_t count )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t i, j, k, bits = 0, terms = 0, len, t_len, t_num = 0;
+    unsigned char w;
+    int d;
+    signed char *naf = NULL;
+    mbedtls_ecp_point *T = NULL, *D, **TT = NULL, mQ;
+    const mbedtls_ecp_point *Q;
+    mbedtls_mpi tmp[ECP_TMP_COUNT];
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    char is_grp_capable = 0;
+#endif
+
+    if( mbedtls_ecp_get_type( grp ) != MBEDTLS_ECP_TYPE_SHORT_WEIERSTRASS )
+        return( MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE );
+
+    for( i = 0; i < count; i++ )
+    {
+        if( mbedtls_mpi_cmp_int( &m[i], 0 ) == 0 )
+            continue;
+
+        if( ( ret = mbedtls_ecp_check_pubkey( grp, &P[i] ) ) != 0 )
+            return( ret );
+
+        if( mbedtls_mpi_bitlen( &m[i] ) > bits )
+            bits = mbedtls_mpi_bitlen( &m[i] );
+        terms++;
+    }
+
+    if( bits == 0 )
+        return( mbedtls_ecp_set_zero( R ) );
+
+    w = ecp_msm_window( terms, bits );
+    len = bits + 1;
+    t_len = (size_t) 1 << ( w - 2 );
+
+    mbedtls_ecp_point_init( &mQ );
+    ecp_tmp_init( tmp );
+
+    naf = mbedtls_calloc( count, len );
+    T = mbedtls_calloc( count * ( t_len + 1 ), sizeof( mbedtls_ecp_point ) );
+    TT = mbedtls_calloc( count * t_len, sizeof( mbedtls_ecp_point * ) );
+    if( naf == NULL || T == NULL || TT == NULL )
+    {
+        ret = MBEDTLS_ERR_ECP_ALLOC_FAILED;
+        goto cleanup;
+    }
+
+    D = T + count * t_len;
+    for( i = 0; i < count * ( t_len + 1 ); i++ )
+        mbedtls_ecp_point_init( &T[i] );
+
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    if( ( is_grp_capable = mbedtls_internal_ecp_grp_capable( grp ) ) )
+        MBEDTLS_MPI_CHK( mbedtls_internal_ecp_init( grp ) );
+#endif /* MBEDTLS_ECP_INTERNAL_ALT */
+
+    MBEDTLS_MPI_CHK( ecp_tmp_grow( grp, tmp ) );
+
+    /*
+     * Recode the scalars, and compute T[i t_len + j] = (2j + 1) P[i]
+     * for j < t_len, using D[i] = 2 P[i]. Skip zero terms altogether.
+     */
+    for( i = 0; i < count; i++ )
+    {
+        if( mbedtls_mpi_cmp_int( &m[i], 0 ) == 0 )
+            continue;
+
+        MBEDTLS_MPI_CHK( ecp_wnaf_recode( naf + i * len, len, &m[i], w ) );
+        MBEDTLS_MPI_CHK( mbedtls_ecp_copy( &T[i * t_len], &P[i] ) );
+        MBEDTLS_MPI_CHK( ecp_point_to_mont( grp, &T[i * t_len] ) );
+
+        if( t_len > 1 )
+        {
+            MBEDTLS_MPI_CHK( ecp_double_jac( grp, &D[i], &T[i * t_len], tmp ) );
+            TT[t_num++] = &D[i];
+        }
+    }
+
+    if( t_len > 1 )
+    {
+        MBEDTLS_MPI_CHK( ecp_normalize_jac_many( grp, TT, t_num ) );
+
+        t_num = 0;
+        for( i = 0; i < count; i++ )
+        {
+            if( mbedtls_mpi_cmp_int( &m[i], 0 ) == 0 )
+                continue;
+
+            for( j = 1; j < t_len; j++ )
+            {
+                MBEDTLS_MPI_CHK( ecp_add_mixed( grp, &T[i * t_len + j],
+                                 &T[i * t_len + j - 1], &D[i], tmp ) );
+                TT[t_num++] = &T[i * t_len + j];
+            }
+        }
+
+        MBEDTLS_MPI_CHK( ecp_normalize_jac_many( grp, TT, t_num ) );
+    }
+
+    /*
+     * P is no longer read from: R may be written (and alias it)
+     */
+    MBEDTLS_MPI_CHK( mbedtls_ecp_set_zero( R ) );
+
+    for( k = len; k-- > 0; )
+    {
+        if( mbedtls_mpi_cmp_int( &R->Z, 0 ) != 0 )
+            MBEDTLS_MPI_CHK( ecp_double_jac( grp, R, R, tmp ) );
+
+        for( i = 0; i < count; i++ )
+        {
+            if( ( d = naf[i * len + k] ) == 0 )
+                continue;
+
+            Q = &T[i * t_len + ( ( d < 0 ? -d : d ) >> 1 )];
+            if( d < 0 )
+            {
+                MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &mQ.X, &Q->X ) );
+                MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( &mQ.Y, &grp->P, &Q->Y ) );
+                Q = &mQ;
+            }
+
+            MBEDTLS_MPI_CHK( ecp_add_mixed_acc( grp, R, Q, tmp ) );
+        }
+    }
+
+    MBEDTLS_MPI_CHK( ecp_normalize_jac( grp, R ) );
+    MBEDTLS_MPI_CHK( ecp_point_from_mont( grp, R ) );
+
+cleanup:
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    if( is_grp_capable )
+        mbedtls_internal_ecp_free( grp );
+#endif /* MBEDTLS_ECP_INTERNAL_ALT */
+
+    if( T != NULL )
+    {
+        for( i = 0; i < count * ( t_len + 1 ); i++ )
+            mbedtls_ecp_point_free( &T[i] );
+    }
+    mbedtls_free( T );
+    mbedtls_free( TT );
+    mbedtls_free( naf );
+    mbedtls_ecp_point_free( &mQ );
+    ecp_tmp_free( tmp );
+
+    return( ret );
+}
+
+#if defined(MBEDTLS_ECDSA_BATCH_VERIFY)
+/*
+ * Multi-scalar multiplication
+ * NOT constant-time
+ */
+int mbedtls_ecp_muladd_multi( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+                              const mbedtls_mpi *m, const mbedtls_ecp_point *P,
+                              size_t count )
+{
+    ECP_VALIDATE_RET( grp != NULL );
+    ECP_VALIDATE_RET( R   != NULL );
+    ECP_VALIDATE_RET( m   != NULL || count == 0 );
+    ECP_VALIDATE_RET( P   != NULL || count == 0 );
+    return( ecp_muladd_multi( grp, R, m, P, count ) );
+}
+#endif /* MBEDTLS_ECDSA_BATCH_VERIFY */
+#endif /* MBEDTLS_ECDSA_BATCH_VERIFY || ECP_GLV_ENABLED */
+
+#if defined(MBEDTLS_ECDSA_BATCH_SIGN)
+/*
+ * Multiplication of the base point by several scalars
+ * R[i] = m[i] G, for short Weierstrass curves
+ *
+ * Each multiplication is done as in ecp_mul_comb(), but the results are left
+ * in (randomized) Jacobian coordinates and normalized all at once, so that
+ * the whole batch only needs one inversion modulo P.
+ */
+int mbedtls_ecp_mul_batch( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
+                           const mbedtls_mpi *m, size_t count,
+                           int (*f_rng)(void *, unsigned char *, size_t),
+                           void *p_rng )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    unsigned char w, T_size, parity_trick;
+    unsigned char k[COMB_MAX_D + 1];
+    size_t d, i;
+    mbedtls_ecp_point *T = NULL, **RR = NULL;
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    char is_grp_capable = 0;
+#endif
+    ECP_VALIDATE_RET( grp   != NULL );
+    ECP_VALIDATE_RET( R     != NULL || count == 0 );
+    ECP_VALIDATE_RET( m     != NULL || count == 0 );
+    ECP_VALIDATE_RET( f_rng != NULL );
+
+    if( mbedtls_ecp_get_type( grp ) != MBEDTLS_ECP_TYPE_SHORT_WEIERSTRASS )
+        return( MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE );
+
+    for( i = 0; i < count; i++ )
+    {
+        if( ( ret = mbedtls_ecp_check_privkey( grp, &m[i] ) ) != 0 )
+            return( ret );
+    }
+
+    if( count == 0 )
+        return( 0 );
+
+    /* Same table as ecp_mul_comb() for the base point */
+    w = ecp_pick_window_size( grp, MBEDTLS_ECP_FIXED_POINT_OPTIM == 1 );
+    T_size = 1U << ( w - 1 );
+    d = ( grp->nbits + w - 1 ) / w;
+
+    RR = mbedtls_calloc( count, sizeof( mbedtls_ecp_point * ) );
+    if( RR == NULL )
+        return( MBEDTLS_ERR_ECP_ALLOC_FAILED );
+
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    if( ( is_grp_capable = mbedtls_internal_ecp_grp_capable( grp ) ) )
+        MBEDTLS_MPI_CHK( mbedtls_internal_ecp_init( grp ) );
+#endif /* MBEDTLS_ECP_INTERNAL_ALT */
+
+#if MBEDTLS_ECP_FIXED_POINT_OPTIM == 1
+    if( grp->T != NULL )
+        T = grp->T;
+    else
+#endif
+    {
+        T = mbedtls_calloc( T_size, sizeof( mbedtls_ecp_point ) );
+        if( T == NULL )
+        {
+            ret = MBEDTLS_ERR_ECP_ALLOC_FAILED;
+            goto cleanup;
+        }
+
+        for( i = 0; i < T_size; i++ )
+            mbedtls_ecp_point_init( &T[i] );
+
+        MBEDTLS_MPI_CHK( ecp_precompute_comb( grp, T, &grp->G, w, d, NULL ) );
+
+#if MBEDTLS_ECP_FIXED_POINT_OPTIM == 1
+        grp->T = T;
+        grp->T_size = T_size;
+#endif
+    }
+
+    for( i = 0; i < count; i++ )
+    {
+        MBEDTLS_MPI_CHK( ecp_comb_recode_scalar( grp, &m[i], k, d, w,
+                                                &parity_trick ) );
+        MBEDTLS_MPI_CHK( ecp_mul_comb_core( grp, &R[i], T, T_size, k, d,
+                                            f_rng, p_rng, NULL ) );
+        MBEDTLS_MPI_CHK( ecp_safe_invert_jac( grp, &R[i], parity_trick ) );
+
+        /* See ecp_mul_comb_after_precomp() */
+        MBEDTLS_MPI_CHK( ecp_randomize_jac( grp, &R[i], f_rng, p_rng ) );
+        RR[i] = &R[i];
+    }
+
+    MBEDTLS_MPI_CHK( ecp_normalize_jac_many( grp, RR, count ) );
+
+    for( i = 0; i < count; i++ )
+    {
+        MBEDTLS_MPI_CHK( ecp_set_one( grp, &R[i].Z ) );
+        MBEDTLS_MPI_CHK( ecp_point_from_mont( grp, &R[i] ) );
+    }
+
+cleanup:
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    if( is_grp_capable )
+        mbedtls_internal_ecp_free( grp );
+#endif /* MBEDTLS_ECP_INTERNAL_ALT */
+
+    mbedtls_platform_zeroize( k, sizeof( k ) );
+
+    if( T != NULL && T != grp->T )
+    {
+        for( i = 0; i < T_size; i++ )
+            mbedtls_ecp_point_free( &T[i] );
+        mbedtls_free( T );
+    }
+    mbedtls_free( RR );
+
+    return( ret );
+}
+#endif /* MBEDTLS_ECDSA_BATCH_SIGN */
+
+#if defined(MBEDTLS_ECP_KEY_PRECOMP)
+/*
+ * Initialize a precomputed point
+ */
+void mbedtls_ecp_precomp_init( mbedtls_ecp_precomp *pre )
+{
+    ECP_VALIDATE( pre != NULL );
+
+    mbedtls_ecp_group_init( &pre->grp );
+    mbedtls_ecp_point_init( &pre->Q );
+    pre->w = 0;
+    pre->T_size = 0;
+    pre->T = NULL;
+}
+
+/*
+ * Compute the table for the base point (by multiplying it by 1, as in
+ * ecp_shared_group_setup()) and a table of the same size for Q
+ */
+int mbedtls_ecp_precomp_setup( mbedtls_ecp_precomp *pre,
+                               mbedtls_ecp_group_id id,
+                               const mbedtls_ecp_point *Q )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    unsigned char i;
+    size_t d;
+    mbedtls_ecp_point R;
+    mbedtls_mpi one;
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    char is_grp_capable = 0;
+#endif
+    ECP_VALIDATE_RET( pre != NULL );
+    ECP_VALIDATE_RET( Q   != NULL );
+
+    mbedtls_ecp_precomp_free( pre );
+    mbedtls_ecp_point_init( &R );
+    mbedtls_mpi_init( &one );
+
+#if defined(MBEDTLS_ECP_SHARED_GROUPS)
+    MBEDTLS_MPI_CHK( mbedtls_ecp_group_load_shared( &pre->grp, id ) );
+#else
+    MBEDTLS_MPI_CHK( mbedtls_ecp_group_load( &pre->grp, id ) );
+#endif
+
+    if( mbedtls_ecp_get_type( &pre->grp ) != MBEDTLS_ECP_TYPE_SHORT_WEIERSTRASS )
+    {
+        ret = MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE;
+        goto cleanup;
+    }
+
+    MBEDTLS_MPI_CHK( mbedtls_ecp_check_pubkey( &pre->grp, Q ) );
+    MBEDTLS_MPI_CHK( mbedtls_ecp_copy( &pre->Q, Q ) );
+
+    if( pre->grp.T == NULL )
+    {
+        MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &one, 1 ) );
+        MBEDTLS_MPI_CHK( mbedtls_ecp_mul( &pre->grp, &R, &one, &pre->grp.G,
+                                          NULL, NULL ) );
+    }
+
+    pre->w = ecp_pick_window_size( &pre->grp, 1 );
+    pre->T_size = 1U << ( pre->w - 1 );
+    d = ( pre->grp.nbits + pre->w - 1 ) / pre->w;
+
+    pre->T = mbedtls_calloc( pre->T_size, sizeof( mbedtls_ecp_point ) );
+    if( pre->T == NULL )
+    {
+        ret = MBEDTLS_ERR_ECP_ALLOC_FAILED;
+        goto cleanup;
+    }
+
+    for( i = 0; i < pre->T_size; i++ )
+        mbedtls_ecp_point_init( &pre->T[i] );
+
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    if( ( is_grp_capable = mbedtls_internal_ecp_grp_capable( &pre->grp ) ) )
+        MBEDTLS_MPI_CHK( mbedtls_internal_ecp_init( &pre->grp ) );
+#endif /* MBEDTLS_ECP_INTERNAL_ALT */
+
+    MBEDTLS_MPI_CHK( ecp_precompute_comb( &pre->grp, pre->T, &pre->Q,
+                                          pre->w, d, NULL ) );
+
+cleanup:
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    if( is_grp_capable )
+        mbedtls_internal_ecp_free( &pre->grp );
+#endif /* MBEDTLS_ECP_INTERNAL_ALT */
+
+    if( ret != 0 )
+        mbedtls_ecp_precomp_free( pre );
+
+    mbedtls_ecp_point_free( &R );
+    mbedtls_mpi_free( &one );
+
+    return( ret );
+}
+
+/*
+ * R = m * Q with the table of a precomputed point
+ */
+static int ecp_mul_precomp( mbedtls_ecp_precomp *pre, mbedtls_ecp_point *R,
+                            const mbedtls_mpi *m )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t d = ( pre->grp.nbits + pre->w - 1 ) / pre->w;
+    int (*f_rng)(void *, unsigned char *, size_t) = NULL;
+    void *p_rng = NULL;
+#if !defined(MBEDTLS_ECP_NO_INTERNAL_RNG)
+    ecp_drbg_context drbg_ctx;
+
+    ecp_drbg_init( &drbg_ctx );
+#endif
+
+    MBEDTLS_MPI_CHK( mbedtls_ecp_check_privkey( &pre->grp, m ) );
+
+#if !defined(MBEDTLS_ECP_NO_INTERNAL_RNG)
+    MBEDTLS_MPI_CHK( ecp_drbg_seed( &drbg_ctx, m,
+                                    ( pre->grp.nbits + 7 ) / 8 ) );
+    f_rng = &ecp_drbg_random;
+    p_rng = &drbg_ctx;
+#endif
+
+    MBEDTLS_MPI_CHK( ecp_mul_comb_after_precomp( &pre->grp, R, m,
+                                                 pre->T, pre->T_size,
+                                                 pre->w, d,
+                                                 f_rng, p_rng, NULL ) );
+
+cleanup:
+#if !defined(MBEDTLS_ECP_NO_INTERNAL_RNG)
+    ecp_drbg_free( &drbg_ctx );
+#endif
+
+    return( ret );
+}
+
+/*
+ * Linear combination with a precomputed point
+ * NOT constant-time
+ */
+int mbedtls_ecp_muladd_precomp( mbedtls_ecp_precomp *pre, mbedtls_ecp_point *R,
+                                const mbedtls_mpi *m, const mbedtls_mpi *n )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_ecp_point mP;
+    mbedtls_mpi tmp[ECP_TMP_COUNT];
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    char is_grp_capable = 0;
+#endif
+    ECP_VALIDATE_RET( pre != NULL );
+    ECP_VALIDATE_RET( R   != NULL );
+    ECP_VALIDATE_RET( m   != NULL );
+    ECP_VALIDATE_RET( n   != NULL );
+
+    if( pre->T == NULL )
+        return( MBEDTLS_ERR_ECP_BAD_INPUT_DATA );
+
+    mbedtls_ecp_point_init( &mP );
+    ecp_tmp_init( tmp );
+
+    MBEDTLS_MPI_CHK( mbedtls_ecp_mul_shortcuts( &pre->grp, &mP, m,
+                                                &pre->grp.G, NULL ) );
+
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    if( ( is_grp_capable = mbedtls_internal_ecp_grp_capable( &pre->grp ) ) )
+        MBEDTLS_MPI_CHK( mbedtls_internal_ecp_init( &pre->grp ) );
+#endif /* MBEDTLS_ECP_INTERNAL_ALT */
+
+    MBEDTLS_MPI_CHK( ecp_mul_precomp( pre, R, n ) );
+    MBEDTLS_MPI_CHK( ecp_point_to_mont( &pre->grp, &mP ) );
+    MBEDTLS_MPI_CHK( ecp_point_to_mont( &pre->grp, R ) );
+    MBEDTLS_MPI_CHK( ecp_add_mixed( &pre->grp, R, &mP, R, tmp ) );
+    MBEDTLS_MPI_CHK( ecp_normalize_jac( &pre->grp, R ) );
+    MBEDTLS_MPI_CHK( ecp_point_from_mont( &pre->grp, R ) );
+
+cleanup:
+#if defined(MBEDTLS_ECP_INTERNAL_ALT)
+    if( is_grp_capable )
+        mbedtls_internal_ecp_free( &pre->grp );
+#endif /* MBEDTLS_ECP_INTERNAL_ALT */
+
+    mbedtls_ecp_point_free( &mP );
+    ecp_tmp_free( tmp );
+
+    return( ret );
+}
+
+/*
+ * Free a precomputed point
+ */
+void mbedtls_ecp_precomp_free( mbedtls_ecp_precomp *pre )
+{
+    unsigned char i;
+
+    if( pre == NULL )
+        return;
+
+    if( pre->T != NULL )
+    {
+        for( i = 0; i < pre->T_size; i++ )
+            mbedtls_ecp_point_free( &pre->T[i] );
+        mbedtls_free( pre->T );
+    }
+
+    mbedtls_ecp_group_free( &pre->grp );
+    mbedtls_ecp_point_free( &pre->Q );
+    pre->w = 0;
+    pre->T_size = 0;
+    pre->T = NULL;
+}
+#endif /* MBEDTLS_ECP_KEY_PRECOMP */
 #endif /* MBEDTLS_ECP_SHORT_WEIERSTRASS_ENABLED */
 
 #if defined(MBEDTLS_ECP_MONTGOMERY_ENABLED)
@@ -3133,8 +4422,13 @@ int mbedtls_ecp_gen_key( mbedtls_ecp_group_id grp_id, mbedtls_ecp_keypair *key,
     ECP_VALIDATE_RET( key   != NULL );
     ECP_VALIDATE_RET( f_rng != NULL );
 
+#if defined(MBEDTLS_ECP_SHARED_GROUPS)
+    if( ( ret = mbedtls_ecp_group_load_shared( &key->grp, grp_id ) ) != 0 )
+        return( ret );
+#else
     if( ( ret = mbedtls_ecp_group_load( &key->grp, grp_id ) ) != 0 )
         return( ret );
+#endif
 
     return( mbedtls_ecp_gen_keypair( &key->grp, &key->d, &key->Q, f_rng, p_rng ) );
 }
@@ -3151,8 +4445,13 @@ int mbedtls_ecp_read_key( mbedtls_ecp_group_id grp_id, mbedtls_ecp_keypair *key,
     ECP_VALIDATE_RET( key  != NULL );
     ECP_VALIDATE_RET( buf  != NULL );
 
+#if defined(MBEDTLS_ECP_SHARED_GROUPS)
+    if( ( ret = mbedtls_ecp_group_load_shared( &key->grp, grp_id ) ) != 0 )
+        return( ret );
+#else
     if( ( ret = mbedtls_ecp_group_load( &key->grp, grp_id ) ) != 0 )
         return( ret );
+#endif
 
     ret = MBEDTLS_ERR_ECP_FEATURE_UNAVAILABLE;
 
@@ -22,6 +22,7 @@
 #if defined(MBEDTLS_ECP_C)
 
 #include "mbedtls/ecp.h"
+#include "bignum_internal.h"
 #include "mbedtls/platform_util.h"
 #include "mbedtls/error.h"
 
@@ -589,6 +590,48 @@ static inline void ecp_mpi_set1( mbedtls_mpi *X )
     X->p = one;
 }
 
+#if defined(MBEDTLS_ECP_MONT_FIELD_OPTIM)
+/*
+ * Set up the constants needed to keep field elements in Montgomery form,
+ * for groups without a fast reduction function (see ecp_modp() in ecp.c)
+ */
+static int ecp_mont_setup( mbedtls_ecp_group *grp )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_mpi_uint mm;
+    mbedtls_mpi T;
+
+    mbedtls_mpi_init( &T );
+
+    mbedtls_mpi_montg_init( &mm, &grp->P );
+
+    /* one = R mod P, RR = R^2 mod P */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &grp->mont_one, 1 ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_shift_l( &grp->mont_one,
+                                grp->P.n * 8 * sizeof( mbedtls_mpi_uint ) ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &grp->mont_one,
+                                          &grp->mont_one, &grp->P ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &grp->mont_RR,
+                                          &grp->mont_one, &grp->mont_one ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &grp->mont_RR,
+                                          &grp->mont_RR, &grp->P ) );
+
+    /* A R = A * R^2 * R^-1 mod P, and the same for B */
+    if( grp->A.p != NULL )
+        MBEDTLS_MPI_CHK( mbedtls_mpi_montmul( &grp->mont_A, &grp->A,
+                                              &grp->mont_RR, &grp->P, mm, &T ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_montmul( &grp->mont_B, &grp->B,
+                                          &grp->mont_RR, &grp->P, mm, &T ) );
+
+    grp->mont_mm = mm;
+
+cleanup:
+    mbedtls_mpi_free( &T );
+
+    return( ret );
+}
+#endif /* MBEDTLS_ECP_MONT_FIELD_OPTIM */
+
 /*
  * Make group available from embedded constants
  */
@@ -615,6 +658,11 @@ static int ecp_group_load( mbedtls_ecp_group *grp,
 
     grp->h = 1;
 
+#if defined(MBEDTLS_ECP_MONT_FIELD_OPTIM)
+    if( grp->modp == NULL )
+        return( ecp_mont_setup( grp ) );
+#endif
+
     return( 0 );
 }
 #endif /* ECP_LOAD_GROUP */
@@ -642,6 +690,26 @@ static int ecp_mod_p521( mbedtls_mpi * );
 #define NIST_MODP( P )
 #endif /* MBEDTLS_ECP_NIST_OPTIM */
 
+/*
+ * The fixed-size arithmetic needs a double-width type for limb products
+ */
+#if defined(MBEDTLS_ECP_FIXED_FIELD_OPTIM) && defined(MBEDTLS_HAVE_UDBL)
+#define ECP_FIXED_FIELD
+
+#if defined(MBEDTLS_ECP_DP_SECP384R1_ENABLED)
+static int ecp_mul_p384( mbedtls_mpi *, const mbedtls_mpi *,
+                         const mbedtls_mpi * );
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP521R1_ENABLED)
+static int ecp_mul_p521( mbedtls_mpi *, const mbedtls_mpi *,
+                         const mbedtls_mpi * );
+#endif
+
+#define FIXED_MODMUL( P )   grp->modmul = ecp_mul_ ## P;
+#else
+#define FIXED_MODMUL( P )
+#endif /* MBEDTLS_ECP_FIXED_FIELD_OPTIM && MBEDTLS_HAVE_UDBL */
+
 /* Additional forward declarations */
 #if defined(MBEDTLS_ECP_DP_CURVE25519_ENABLED)
 static int ecp_mod_p255( mbedtls_mpi * );
@@ -795,12 +863,14 @@ int mbedtls_ecp_group_load( mbedtls_ecp_group *grp, mbedtls_ecp_group_id id )
 #if defined(MBEDTLS_ECP_DP_SECP384R1_ENABLED)
         case MBEDTLS_ECP_DP_SECP384R1:
             NIST_MODP( p384 );
+            FIXED_MODMUL( p384 );
             return( LOAD_GROUP( secp384r1 ) );
 #endif /* MBEDTLS_ECP_DP_SECP384R1_ENABLED */
 
 #if defined(MBEDTLS_ECP_DP_SECP521R1_ENABLED)
         case MBEDTLS_ECP_DP_SECP521R1:
             NIST_MODP( p521 );
+            FIXED_MODMUL( p521 );
             return( LOAD_GROUP( secp521r1 ) );
 #endif /* MBEDTLS_ECP_DP_SECP521R1_ENABLED */
 
@@ -1235,6 +1305,376 @@ cleanup:
 #undef P521_MASK
 #endif /* MBEDTLS_ECP_DP_SECP521R1_ENABLED */
 
+#if defined(ECP_FIXED_FIELD)
+/*
+ * Fixed-size field arithmetic for secp384r1 and secp521r1.
+ *
+ * mbedtls_mpi_mul_mpi() followed by the quasi-reductions above works on
+ * mbedtls_mpi of any size, which costs allocations, size checks and a final
+ * loop of additions or subtractions of P whose number of iterations depends
+ * on the data. The functions below multiply and reduce in one go on arrays
+ * of a fixed number of limbs on the stack, and end with a single masked
+ * subtraction of P, so that the sequence of operations does not depend on
+ * the values. They are used through grp->modmul (see mbedtls_mpi_mul_mod()
+ * in ecp.c).
+ */
+
+#define FIX_BITS        ( 8 * sizeof( mbedtls_mpi_uint ) )
+#define FIX_MAX_LIMBS   ( ( 521 + FIX_BITS - 1 ) / FIX_BITS )
+
+/*
+ * Load A into the n limbs of a. A must be non-negative and less than
+ * 2^bits, otherwise (which never happens for a reduced field element)
+ * return MBEDTLS_ERR_ECP_BAD_INPUT_DATA.
+ */
+static int ecp_fix_load( mbedtls_mpi_uint *a, size_t n, size_t bits,
+                         const mbedtls_mpi *A )
+{
+    size_t i;
+    mbedtls_mpi_uint extra = 0, nonzero = 0;
+
+    for( i = 0; i < n; i++ )
+    {
+        a[i] = i < A->n ? A->p[i] : 0;
+        nonzero |= a[i];
+    }
+    for( ; i < A->n; i++ )
+        extra |= A->p[i];
+    if( bits % FIX_BITS != 0 )
+        extra |= a[n - 1] >> ( bits % FIX_BITS );
+
+    if( extra != 0 || ( A->s < 0 && nonzero != 0 ) )
+        return( MBEDTLS_ERR_ECP_BAD_INPUT_DATA );
+
+    return( 0 );
+}
+
+/*
+ * X = r, with r on n limbs
+ */
+static int ecp_fix_store( mbedtls_mpi *X, const mbedtls_mpi_uint *r, size_t n )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t i;
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_grow( X, n ) );
+
+    memcpy( X->p, r, n * sizeof( mbedtls_mpi_uint ) );
+    for( i = n; i < X->n; i++ )
+        X->p[i] = 0;
+    X->s = 1;
+
+cleanup:
+    return( ret );
+}
+
+/*
+ * r = a * b, with a and b on n limbs and r on 2 n limbs
+ */
+static inline void ecp_fix_mul( mbedtls_mpi_uint *r,
+                                const mbedtls_mpi_uint *a,
+                                const mbedtls_mpi_uint *b, size_t n )
+{
+    size_t i, j;
+    mbedtls_t_udbl t;
+    mbedtls_mpi_uint c;
+
+    for( i = 0; i < n; i++ )
+        r[i] = 0;
+
+    for( i = 0; i < n; i++ )
+    {
+        c = 0;
+        for( j = 0; j < n; j++ )
+        {
+            t = (mbedtls_t_udbl) a[i] * b[j] + r[i + j] + c;
+            r[i + j] = (mbedtls_mpi_uint) t;
+            c = (mbedtls_mpi_uint)( t >> FIX_BITS );
+        }
+        r[i + n] = c;
+    }
+}
+
+/*
+ * r = a^2, with a on n limbs and r on 2 n limbs: the products a[i] a[j]
+ * with i != j are computed once and doubled.
+ */
+static inline void ecp_fix_sqr( mbedtls_mpi_uint *r,
+                                const mbedtls_mpi_uint *a, size_t n )
+{
+    size_t i, j;
+    mbedtls_t_udbl t;
+    mbedtls_mpi_uint c;
+
+    for( i = 0; i < 2 * n; i++ )
+        r[i] = 0;
+
+    for( i = 0; i < n - 1; i++ )
+    {
+        c = 0;
+        for( j = i + 1; j < n; j++ )
+        {
+            t = (mbedtls_t_udbl) a[i] * a[j] + r[i + j] + c;
+            r[i + j] = (mbedtls_mpi_uint) t;
+            c = (mbedtls_mpi_uint)( t >> FIX_BITS );
+        }
+        r[i + n] = c;
+    }
+
+    for( i = 2 * n - 1; i > 0; i-- )
+        r[i] = ( r[i] << 1 ) | ( r[i - 1] >> ( FIX_BITS - 1 ) );
+    r[0] <<= 1;
+
+    c = 0;
+    for( i = 0; i < n; i++ )
+    {
+        t = (mbedtls_t_udbl) a[i] * a[i] + r[2 * i] + c;
+        r[2 * i] = (mbedtls_mpi_uint) t;
+        t = (mbedtls_t_udbl) r[2 * i + 1] + ( t >> FIX_BITS );
+        r[2 * i + 1] = (mbedtls_mpi_uint) t;
+        c = (mbedtls_mpi_uint)( t >> FIX_BITS );
+    }
+}
+
+/*
+ * r = r - p if r >= p, for r < 2 p on n limbs, without branches
+ */
+static inline void ecp_fix_sub_p( mbedtls_mpi_uint *r,
+                                  const mbedtls_mpi_uint *p, size_t n )
+{
+    size_t i;
+    mbedtls_mpi_uint s[FIX_MAX_LIMBS], borrow = 0, d, mask;
+
+    for( i = 0; i < n; i++ )
+    {
+        d = r[i] - p[i];
+        s[i] = d - borrow;
+        borrow = ( r[i] < p[i] ) | ( d < borrow );
+    }
+
+    /* All ones if there was no borrow, that is, if r >= p */
+    mask = borrow - 1;
+    for( i = 0; i < n; i++ )
+        r[i] = ( s[i] & mask ) | ( r[i] & ~mask );
+}
+
+#if defined(MBEDTLS_ECP_DP_SECP384R1_ENABLED)
+
+#define P384_LIMBS      ( 384 / FIX_BITS )
+
+/*
+ * 32-bit chunk j of the 768-bit product t, and storage of chunk i of the
+ * result from the signed accumulator, which keeps the carry.
+ */
+#if defined(MBEDTLS_HAVE_INT32)
+#define T32( j )        ( (int64_t) t[j] )
+#else
+#define T32( j )                                                        \
+    ( (int64_t) (uint32_t)( t[(j) / 2] >> ( 32 * ( (j) % 2 ) ) ) )
+#endif
+
+#define STORE32( i )                                                    \
+    do                                                                  \
+    {                                                                   \
+        w[i] = (uint32_t) acc;                                          \
+        acc = ( acc - (int64_t) w[i] ) / ( (int64_t) 1 << 32 );         \
+    } while( 0 )
+
+/*
+ * Add c * 2^384 = c * ( 2^128 + 2^96 - 2^32 + 1 ) mod p384 to w, and return
+ * the new carry.
+ */
+static inline int64_t ecp_fix_p384_fold( uint32_t *w, int64_t c )
+{
+    int64_t acc = 0;
+    size_t i;
+
+    acc += (int64_t) w[0] + c; STORE32( 0 );
+    acc += (int64_t) w[1] - c; STORE32( 1 );
+    acc += (int64_t) w[2];     STORE32( 2 );
+    acc += (int64_t) w[3] + c; STORE32( 3 );
+    acc += (int64_t) w[4] + c; STORE32( 4 );
+    for( i = 5; i < 12; i++ )
+    {
+        acc += (int64_t) w[i];
+        STORE32( i );
+    }
+
+    return( acc );
+}
+
+/*
+ * r = t mod p384, with the same sums of chunks as ecp_mod_p384()
+ * (FIPS 186-3 D.2.4), a signed carry folded back twice, which is enough to
+ * bring the value into 0..2^384-1, and a final subtraction of p384.
+ */
+static void ecp_fix_p384_reduce( mbedtls_mpi_uint *r,
+                                 const mbedtls_mpi_uint *t )
+{
+    uint32_t w[12];
+    int64_t acc = 0;
+    size_t i;
+
+    acc += T32(  0 ) + T32( 12 ) + T32( 21 ) + T32( 20 ) - T32( 23 );
+    STORE32(  0 );
+    acc += T32(  1 ) + T32( 13 ) + T32( 22 ) + T32( 23 ) - T32( 12 ) -
+           T32( 20 );
+    STORE32(  1 );
+    acc += T32(  2 ) + T32( 14 ) + T32( 23 ) - T32( 13 ) - T32( 21 );
+    STORE32(  2 );
+    acc += T32(  3 ) + T32( 15 ) + T32( 12 ) + T32( 20 ) + T32( 21 ) -
+           T32( 14 ) - T32( 22 ) - T32( 23 );
+    STORE32(  3 );
+    acc += T32(  4 ) + 2 * T32( 21 ) + T32( 16 ) + T32( 13 ) + T32( 12 ) +
+           T32( 20 ) + T32( 22 ) - T32( 15 ) - 2 * T32( 23 );
+    STORE32(  4 );
+    acc += T32(  5 ) + 2 * T32( 22 ) + T32( 17 ) + T32( 14 ) + T32( 13 ) +
+           T32( 21 ) + T32( 23 ) - T32( 16 );
+    STORE32(  5 );
+    acc += T32(  6 ) + 2 * T32( 23 ) + T32( 18 ) + T32( 15 ) + T32( 14 ) +
+           T32( 22 ) - T32( 17 );
+    STORE32(  6 );
+    acc += T32(  7 ) + T32( 19 ) + T32( 16 ) + T32( 15 ) + T32( 23 ) -
+           T32( 18 );
+    STORE32(  7 );
+    acc += T32(  8 ) + T32( 20 ) + T32( 17 ) + T32( 16 ) - T32( 19 );
+    STORE32(  8 );
+    acc += T32(  9 ) + T32( 21 ) + T32( 18 ) + T32( 17 ) - T32( 20 );
+    STORE32(  9 );
+    acc += T32( 10 ) + T32( 22 ) + T32( 19 ) + T32( 18 ) - T32( 21 );
+    STORE32( 10 );
+    acc += T32( 11 ) + T32( 23 ) + T32( 20 ) + T32( 19 ) - T32( 22 );
+    STORE32( 11 );
+
+    /*
+     * The carry is small, so after the first fold it is -1, 0 or 1 and the
+     * 384-bit part is within about 2^133 of 0 or 2^384 in the direction that
+     * makes the second fold end with no carry.
+     */
+    acc = ecp_fix_p384_fold( w, acc );
+    (void) ecp_fix_p384_fold( w, acc );
+
+#if defined(MBEDTLS_HAVE_INT32)
+    for( i = 0; i < P384_LIMBS; i++ )
+        r[i] = w[i];
+#else
+    for( i = 0; i < P384_LIMBS; i++ )
+        r[i] = (mbedtls_mpi_uint) w[2 * i] |
+               ( (mbedtls_mpi_uint) w[2 * i + 1] << 32 );
+#endif
+
+    ecp_fix_sub_p( r, secp384r1_p, P384_LIMBS );
+}
+
+#undef T32
+#undef STORE32
+
+/*
+ * X = A * B mod p384
+ */
+static int ecp_mul_p384( mbedtls_mpi *X, const mbedtls_mpi *A,
+                         const mbedtls_mpi *B )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_mpi_uint a[P384_LIMBS], b[P384_LIMBS], t[2 * P384_LIMBS];
+
+    MBEDTLS_MPI_CHK( ecp_fix_load( a, P384_LIMBS, 384, A ) );
+    if( B == A )
+        ecp_fix_sqr( t, a, P384_LIMBS );
+    else
+    {
+        MBEDTLS_MPI_CHK( ecp_fix_load( b, P384_LIMBS, 384, B ) );
+        ecp_fix_mul( t, a, b, P384_LIMBS );
+    }
+
+    ecp_fix_p384_reduce( a, t );
+    MBEDTLS_MPI_CHK( ecp_fix_store( X, a, P384_LIMBS ) );
+
+cleanup:
+    return( ret );
+}
+
+#undef P384_LIMBS
+#endif /* MBEDTLS_ECP_DP_SECP384R1_ENABLED */
+
+#if defined(MBEDTLS_ECP_DP_SECP521R1_ENABLED)
+
+#define P521_LIMBS      ( ( 521 + FIX_BITS - 1 ) / FIX_BITS )
+#define P521_TOP        ( 521 % FIX_BITS )
+#define P521_TOP_MASK   ( ( (mbedtls_mpi_uint) 1 << P521_TOP ) - 1 )
+
+/*
+ * r = t mod p521, for t < 2^1042: with t = A0 + 2^521 A1 as in
+ * ecp_mod_p521(), A0 + A1 is less than 2^522, so folding its bit 521 back
+ * once gives a value of at most p521, and a final subtraction of p521
+ * completes the reduction.
+ */
+static void ecp_fix_p521_reduce( mbedtls_mpi_uint *r,
+                                 const mbedtls_mpi_uint *t )
+{
+    size_t i;
+    mbedtls_mpi_uint lo, hi, c = 0;
+
+    for( i = 0; i < P521_LIMBS; i++ )
+    {
+        lo = t[i];
+        if( i == P521_LIMBS - 1 )
+            lo &= P521_TOP_MASK;
+        hi = ( t[i + P521_LIMBS - 1] >> P521_TOP ) |
+             ( t[i + P521_LIMBS] << ( FIX_BITS - P521_TOP ) );
+
+        lo += c;
+        c = ( lo < c );
+        lo += hi;
+        c += ( lo < hi );
+        r[i] = lo;
+    }
+
+    c = r[P521_LIMBS - 1] >> P521_TOP;
+    r[P521_LIMBS - 1] &= P521_TOP_MASK;
+    for( i = 0; i < P521_LIMBS; i++ )
+    {
+        r[i] += c;
+        c = ( r[i] < c );
+    }
+
+    ecp_fix_sub_p( r, secp521r1_p, P521_LIMBS );
+}
+
+/*
+ * X = A * B mod p521
+ */
+static int ecp_mul_p521( mbedtls_mpi *X, const mbedtls_mpi *A,
+                         const mbedtls_mpi *B )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_mpi_uint a[P521_LIMBS], b[P521_LIMBS], t[2 * P521_LIMBS];
+
+    MBEDTLS_MPI_CHK( ecp_fix_load( a, P521_LIMBS, 521, A ) );
+    if( B == A )
+        ecp_fix_sqr( t, a, P521_LIMBS );
+    else
+    {
+        MBEDTLS_MPI_CHK( ecp_fix_load( b, P521_LIMBS, 521, B ) );
+        ecp_fix_mul( t, a, b, P521_LIMBS );
+    }
+
+    ecp_fix_p521_reduce( a, t );
+    MBEDTLS_MPI_CHK( ecp_fix_store( X, a, P521_LIMBS ) );
+
+cleanup:
+    return( ret );
+}
+
+#undef P521_LIMBS
+#undef P521_TOP
+#undef P521_TOP_MASK
+#endif /* MBEDTLS_ECP_DP_SECP521R1_ENABLED */
+
+#undef FIX_BITS
+#undef FIX_MAX_LIMBS
+#endif /* ECP_FIXED_FIELD */
+
 #endif /* MBEDTLS_ECP_NIST_OPTIM */
 
 #if defined(MBEDTLS_ECP_DP_CURVE25519_ENABLED)
@@ -41,6 +41,55 @@
  */
 #define ADD_LEN(s)      s, MBEDTLS_OID_SIZE(s)
 
+#if defined(MBEDTLS_OID_HASH_LOOKUP)
+#include "oid_hash.h"
+
+/*
+ * Find the only entry of a table that can match an OID, using the perfect
+ * hash generated for that table in oid_hash.h
+ */
+static size_t oid_hash_lookup( const mbedtls_asn1_buf *oid,
+                               const unsigned char *disp, size_t nb,
+                               const unsigned char *slot, size_t n )
+{
+    uint32_t h = 0x811c9dc5;
+    size_t i;
+
+    for( i = 0; i < oid->len; i++ )
+        h = (uint32_t)( ( h ^ oid->p[i] ) * 0x01000193 );
+
+    h = (uint32_t)( ( h ^ disp[h % nb] ) * 0x01000193 );
+
+    return( slot[( h >> 16 ) % n] );
+}
+
+/*
+ * Macro to generate an internal function for oid_XXX_from_asn1() (used by
+ * the other functions)
+ */
+#define FN_OID_TYPED_FROM_ASN1( TYPE_T, NAME, LIST )                    \
+    static const TYPE_T * oid_ ## NAME ## _from_asn1(                   \
+                                      const mbedtls_asn1_buf *oid )     \
+    {                                                                   \
+        const TYPE_T *p;                                                \
+        const mbedtls_oid_descriptor_t *cur;                            \
+        size_t i;                                                       \
+        if( oid == NULL ) return( NULL );                               \
+        i = oid_hash_lookup( oid,                                       \
+            mbedtls_ ## LIST ## _hash_disp,                             \
+            sizeof( mbedtls_ ## LIST ## _hash_disp ),                   \
+            mbedtls_ ## LIST ## _hash_slot,                             \
+            sizeof( mbedtls_ ## LIST ## _hash_slot ) );                 \
+        if( i == MBEDTLS_OID_HASH_NONE ) return( NULL );                \
+        p = (LIST) + i;                                                 \
+        cur = (const mbedtls_oid_descriptor_t *) p;                     \
+        if( cur->asn1_len == oid->len &&                                \
+            memcmp( cur->asn1, oid->p, oid->len ) == 0 ) {              \
+            return( p );                                                \
+        }                                                               \
+        return( NULL );                                                 \
+    }
+#else /* MBEDTLS_OID_HASH_LOOKUP */
 /*
  * Macro to generate an internal function for oid_XXX_from_asn1() (used by
  * the other functions)
@@ -63,6 +112,7 @@
         }                                                               \
         return( NULL );                                                 \
     }
+#endif /* MBEDTLS_OID_HASH_LOOKUP */
 
 /*
  * Macro to generate a function for retrieving a single attribute from the
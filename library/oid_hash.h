@@ -0,0 +1,580 @@
+/* Automatically generated by generate_oid_hash.py. DO NOT EDIT. */
+
+/*
+ * Perfect hash tables for the OID lookups of oid.c
+ *
+ * For a table LIST of n entries, the slot of an OID is
+ *   h    = FNV-1a( OID )
+ *   d    = mbedtls_LIST_hash_disp[h % nb]
+ *   slot = ( ( ( h XOR d ) * 0x01000193 ) >> 16 ) % n
+ * and mbedtls_LIST_hash_slot[slot] is the index of the only entry of LIST
+ * that can match, or MBEDTLS_OID_HASH_NONE.
+ */
+
+#define MBEDTLS_OID_HASH_NONE   0xFF
+
+enum
+{
+    OID_X520_ATTR_TYPE_AT_CN,
+    OID_X520_ATTR_TYPE_AT_COUNTRY,
+    OID_X520_ATTR_TYPE_AT_LOCALITY,
+    OID_X520_ATTR_TYPE_AT_STATE,
+    OID_X520_ATTR_TYPE_AT_ORGANIZATION,
+    OID_X520_ATTR_TYPE_AT_ORG_UNIT,
+    OID_X520_ATTR_TYPE_PKCS9_EMAIL,
+    OID_X520_ATTR_TYPE_AT_SERIAL_NUMBER,
+    OID_X520_ATTR_TYPE_AT_POSTAL_ADDRESS,
+    OID_X520_ATTR_TYPE_AT_POSTAL_CODE,
+    OID_X520_ATTR_TYPE_AT_SUR_NAME,
+    OID_X520_ATTR_TYPE_AT_GIVEN_NAME,
+    OID_X520_ATTR_TYPE_AT_INITIALS,
+    OID_X520_ATTR_TYPE_AT_GENERATION_QUALIFIER,
+    OID_X520_ATTR_TYPE_AT_TITLE,
+    OID_X520_ATTR_TYPE_AT_DN_QUALIFIER,
+    OID_X520_ATTR_TYPE_AT_PSEUDONYM,
+    OID_X520_ATTR_TYPE_DOMAIN_COMPONENT,
+    OID_X520_ATTR_TYPE_AT_UNIQUE_IDENTIFIER,
+    OID_X520_ATTR_TYPE_END
+};
+
+static const unsigned char mbedtls_oid_x520_attr_type_hash_disp[10] =
+{
+      0,   0,   4,  13,   2,   9,   0,   4,   1,  12,
+};
+
+static const unsigned char mbedtls_oid_x520_attr_type_hash_slot[19] =
+{
+    OID_X520_ATTR_TYPE_AT_STATE,
+    OID_X520_ATTR_TYPE_AT_GIVEN_NAME,
+    OID_X520_ATTR_TYPE_AT_GENERATION_QUALIFIER,
+    OID_X520_ATTR_TYPE_AT_SUR_NAME,
+    OID_X520_ATTR_TYPE_AT_POSTAL_ADDRESS,
+    OID_X520_ATTR_TYPE_AT_INITIALS,
+    OID_X520_ATTR_TYPE_AT_ORGANIZATION,
+    OID_X520_ATTR_TYPE_AT_LOCALITY,
+    OID_X520_ATTR_TYPE_AT_SERIAL_NUMBER,
+    OID_X520_ATTR_TYPE_DOMAIN_COMPONENT,
+    OID_X520_ATTR_TYPE_AT_COUNTRY,
+    OID_X520_ATTR_TYPE_PKCS9_EMAIL,
+    OID_X520_ATTR_TYPE_AT_UNIQUE_IDENTIFIER,
+    OID_X520_ATTR_TYPE_AT_CN,
+    OID_X520_ATTR_TYPE_AT_TITLE,
+    OID_X520_ATTR_TYPE_AT_POSTAL_CODE,
+    OID_X520_ATTR_TYPE_AT_ORG_UNIT,
+    OID_X520_ATTR_TYPE_AT_DN_QUALIFIER,
+    OID_X520_ATTR_TYPE_AT_PSEUDONYM,
+};
+
+enum
+{
+    OID_X509_EXT_BASIC_CONSTRAINTS,
+    OID_X509_EXT_KEY_USAGE,
+    OID_X509_EXT_EXTENDED_KEY_USAGE,
+    OID_X509_EXT_SUBJECT_ALT_NAME,
+    OID_X509_EXT_NS_CERT_TYPE,
+    OID_X509_EXT_CERTIFICATE_POLICIES,
+    OID_X509_EXT_END
+};
+
+static const unsigned char mbedtls_oid_x509_ext_hash_disp[3] =
+{
+      1,   0,   0,
+};
+
+static const unsigned char mbedtls_oid_x509_ext_hash_slot[6] =
+{
+    OID_X509_EXT_NS_CERT_TYPE,
+    OID_X509_EXT_BASIC_CONSTRAINTS,
+    OID_X509_EXT_SUBJECT_ALT_NAME,
+    OID_X509_EXT_EXTENDED_KEY_USAGE,
+    OID_X509_EXT_CERTIFICATE_POLICIES,
+    OID_X509_EXT_KEY_USAGE,
+};
+
+enum
+{
+    OID_EXT_KEY_USAGE_SERVER_AUTH,
+    OID_EXT_KEY_USAGE_CLIENT_AUTH,
+    OID_EXT_KEY_USAGE_CODE_SIGNING,
+    OID_EXT_KEY_USAGE_EMAIL_PROTECTION,
+    OID_EXT_KEY_USAGE_TIME_STAMPING,
+    OID_EXT_KEY_USAGE_OCSP_SIGNING,
+    OID_EXT_KEY_USAGE_WISUN_FAN,
+    OID_EXT_KEY_USAGE_END
+};
+
+static const unsigned char mbedtls_oid_ext_key_usage_hash_disp[4] =
+{
+      0,   2,   3,   0,
+};
+
+static const unsigned char mbedtls_oid_ext_key_usage_hash_slot[7] =
+{
+    OID_EXT_KEY_USAGE_OCSP_SIGNING,
+    OID_EXT_KEY_USAGE_CODE_SIGNING,
+    OID_EXT_KEY_USAGE_CLIENT_AUTH,
+    OID_EXT_KEY_USAGE_WISUN_FAN,
+    OID_EXT_KEY_USAGE_EMAIL_PROTECTION,
+    OID_EXT_KEY_USAGE_SERVER_AUTH,
+    OID_EXT_KEY_USAGE_TIME_STAMPING,
+};
+
+enum
+{
+    OID_CERTIFICATE_POLICIES_ANY_POLICY,
+    OID_CERTIFICATE_POLICIES_END
+};
+
+static const unsigned char mbedtls_oid_certificate_policies_hash_disp[1] =
+{
+      0,
+};
+
+static const unsigned char mbedtls_oid_certificate_policies_hash_slot[1] =
+{
+    OID_CERTIFICATE_POLICIES_ANY_POLICY,
+};
+
+#if defined(MBEDTLS_MD_C)
+enum
+{
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_MD2_C)
+    OID_SIG_ALG_PKCS1_MD2,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_MD4_C)
+    OID_SIG_ALG_PKCS1_MD4,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_MD5_C)
+    OID_SIG_ALG_PKCS1_MD5,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_SHA1_C)
+    OID_SIG_ALG_PKCS1_SHA1,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_SHA256_C)
+    OID_SIG_ALG_PKCS1_SHA224,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_SHA256_C)
+    OID_SIG_ALG_PKCS1_SHA256,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_SHA512_C)
+    OID_SIG_ALG_PKCS1_SHA384,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_SHA512_C)
+    OID_SIG_ALG_PKCS1_SHA512,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_SHA1_C)
+    OID_SIG_ALG_RSA_SHA_OBS,
+#endif
+#if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_SHA1_C)
+    OID_SIG_ALG_ECDSA_SHA1,
+#endif
+#if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_SHA256_C)
+    OID_SIG_ALG_ECDSA_SHA224,
+#endif
+#if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_SHA256_C)
+    OID_SIG_ALG_ECDSA_SHA256,
+#endif
+#if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_SHA512_C)
+    OID_SIG_ALG_ECDSA_SHA384,
+#endif
+#if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_SHA512_C)
+    OID_SIG_ALG_ECDSA_SHA512,
+#endif
+#if defined(MBEDTLS_RSA_C)
+    OID_SIG_ALG_RSASSA_PSS,
+#endif
+    OID_SIG_ALG_END
+};
+
+static const unsigned char mbedtls_oid_sig_alg_hash_disp[8] =
+{
+      8,   0,   8,   0,   0,  20,  18,   1,
+};
+
+static const unsigned char mbedtls_oid_sig_alg_hash_slot[15] =
+{
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_MD4_C)
+    OID_SIG_ALG_PKCS1_MD4,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_SHA1_C)
+    OID_SIG_ALG_RSA_SHA_OBS,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_MD5_C)
+    OID_SIG_ALG_PKCS1_MD5,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_SHA256_C)
+    OID_SIG_ALG_ECDSA_SHA256,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_RSA_C)
+    OID_SIG_ALG_RSASSA_PSS,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_SHA256_C)
+    OID_SIG_ALG_PKCS1_SHA256,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_SHA256_C)
+    OID_SIG_ALG_ECDSA_SHA224,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_SHA1_C)
+    OID_SIG_ALG_PKCS1_SHA1,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_SHA512_C)
+    OID_SIG_ALG_ECDSA_SHA384,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_SHA512_C)
+    OID_SIG_ALG_PKCS1_SHA384,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_SHA1_C)
+    OID_SIG_ALG_ECDSA_SHA1,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_SHA256_C)
+    OID_SIG_ALG_PKCS1_SHA224,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_MD2_C)
+    OID_SIG_ALG_PKCS1_MD2,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_SHA512_C)
+    OID_SIG_ALG_ECDSA_SHA512,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_SHA512_C)
+    OID_SIG_ALG_PKCS1_SHA512,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+};
+#endif /* defined(MBEDTLS_MD_C) */
+
+enum
+{
+    OID_PK_ALG_PKCS1_RSA,
+    OID_PK_ALG_EC_ALG_UNRESTRICTED,
+    OID_PK_ALG_EC_ALG_ECDH,
+    OID_PK_ALG_END
+};
+
+static const unsigned char mbedtls_oid_pk_alg_hash_disp[2] =
+{
+      2,   0,
+};
+
+static const unsigned char mbedtls_oid_pk_alg_hash_slot[3] =
+{
+    OID_PK_ALG_PKCS1_RSA,
+    OID_PK_ALG_EC_ALG_UNRESTRICTED,
+    OID_PK_ALG_EC_ALG_ECDH,
+};
+
+#if defined(MBEDTLS_ECP_C)
+enum
+{
+#if defined(MBEDTLS_ECP_DP_SECP192R1_ENABLED)
+    OID_ECP_GRP_EC_GRP_SECP192R1,
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP224R1_ENABLED)
+    OID_ECP_GRP_EC_GRP_SECP224R1,
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP256R1_ENABLED)
+    OID_ECP_GRP_EC_GRP_SECP256R1,
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP384R1_ENABLED)
+    OID_ECP_GRP_EC_GRP_SECP384R1,
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP521R1_ENABLED)
+    OID_ECP_GRP_EC_GRP_SECP521R1,
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP192K1_ENABLED)
+    OID_ECP_GRP_EC_GRP_SECP192K1,
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP224K1_ENABLED)
+    OID_ECP_GRP_EC_GRP_SECP224K1,
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP256K1_ENABLED)
+    OID_ECP_GRP_EC_GRP_SECP256K1,
+#endif
+#if defined(MBEDTLS_ECP_DP_BP256R1_ENABLED)
+    OID_ECP_GRP_EC_GRP_BP256R1,
+#endif
+#if defined(MBEDTLS_ECP_DP_BP384R1_ENABLED)
+    OID_ECP_GRP_EC_GRP_BP384R1,
+#endif
+#if defined(MBEDTLS_ECP_DP_BP512R1_ENABLED)
+    OID_ECP_GRP_EC_GRP_BP512R1,
+#endif
+    OID_ECP_GRP_END
+};
+
+static const unsigned char mbedtls_oid_ecp_grp_hash_disp[6] =
+{
+      0,   0,   1,   5,   5,  15,
+};
+
+static const unsigned char mbedtls_oid_ecp_grp_hash_slot[11] =
+{
+#if defined(MBEDTLS_ECP_DP_SECP192K1_ENABLED)
+    OID_ECP_GRP_EC_GRP_SECP192K1,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP256R1_ENABLED)
+    OID_ECP_GRP_EC_GRP_SECP256R1,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_ECP_DP_BP384R1_ENABLED)
+    OID_ECP_GRP_EC_GRP_BP384R1,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP224R1_ENABLED)
+    OID_ECP_GRP_EC_GRP_SECP224R1,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP224K1_ENABLED)
+    OID_ECP_GRP_EC_GRP_SECP224K1,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_ECP_DP_BP512R1_ENABLED)
+    OID_ECP_GRP_EC_GRP_BP512R1,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP521R1_ENABLED)
+    OID_ECP_GRP_EC_GRP_SECP521R1,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_ECP_DP_BP256R1_ENABLED)
+    OID_ECP_GRP_EC_GRP_BP256R1,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP256K1_ENABLED)
+    OID_ECP_GRP_EC_GRP_SECP256K1,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP192R1_ENABLED)
+    OID_ECP_GRP_EC_GRP_SECP192R1,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_ECP_DP_SECP384R1_ENABLED)
+    OID_ECP_GRP_EC_GRP_SECP384R1,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+};
+#endif /* defined(MBEDTLS_ECP_C) */
+
+#if defined(MBEDTLS_CIPHER_C)
+enum
+{
+    OID_CIPHER_ALG_DES_CBC,
+    OID_CIPHER_ALG_DES_EDE3_CBC,
+    OID_CIPHER_ALG_END
+};
+
+static const unsigned char mbedtls_oid_cipher_alg_hash_disp[1] =
+{
+     42,
+};
+
+static const unsigned char mbedtls_oid_cipher_alg_hash_slot[2] =
+{
+    OID_CIPHER_ALG_DES_EDE3_CBC,
+    OID_CIPHER_ALG_DES_CBC,
+};
+#endif /* defined(MBEDTLS_CIPHER_C) */
+
+#if defined(MBEDTLS_MD_C)
+enum
+{
+#if defined(MBEDTLS_MD2_C)
+    OID_MD_ALG_DIGEST_ALG_MD2,
+#endif
+#if defined(MBEDTLS_MD4_C)
+    OID_MD_ALG_DIGEST_ALG_MD4,
+#endif
+#if defined(MBEDTLS_MD5_C)
+    OID_MD_ALG_DIGEST_ALG_MD5,
+#endif
+#if defined(MBEDTLS_SHA1_C)
+    OID_MD_ALG_DIGEST_ALG_SHA1,
+#endif
+#if defined(MBEDTLS_SHA256_C)
+    OID_MD_ALG_DIGEST_ALG_SHA224,
+#endif
+#if defined(MBEDTLS_SHA256_C)
+    OID_MD_ALG_DIGEST_ALG_SHA256,
+#endif
+#if defined(MBEDTLS_SHA512_C)
+    OID_MD_ALG_DIGEST_ALG_SHA384,
+#endif
+#if defined(MBEDTLS_SHA512_C)
+    OID_MD_ALG_DIGEST_ALG_SHA512,
+#endif
+#if defined(MBEDTLS_RIPEMD160_C)
+    OID_MD_ALG_DIGEST_ALG_RIPEMD160,
+#endif
+    OID_MD_ALG_END
+};
+
+static const unsigned char mbedtls_oid_md_alg_hash_disp[5] =
+{
+      0,  32,   0,   4,   0,
+};
+
+static const unsigned char mbedtls_oid_md_alg_hash_slot[9] =
+{
+#if defined(MBEDTLS_SHA512_C)
+    OID_MD_ALG_DIGEST_ALG_SHA512,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_SHA1_C)
+    OID_MD_ALG_DIGEST_ALG_SHA1,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_SHA256_C)
+    OID_MD_ALG_DIGEST_ALG_SHA224,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_SHA256_C)
+    OID_MD_ALG_DIGEST_ALG_SHA256,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_MD2_C)
+    OID_MD_ALG_DIGEST_ALG_MD2,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_SHA512_C)
+    OID_MD_ALG_DIGEST_ALG_SHA384,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_MD4_C)
+    OID_MD_ALG_DIGEST_ALG_MD4,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_MD5_C)
+    OID_MD_ALG_DIGEST_ALG_MD5,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_RIPEMD160_C)
+    OID_MD_ALG_DIGEST_ALG_RIPEMD160,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+};
+#endif /* defined(MBEDTLS_MD_C) */
+
+#if defined(MBEDTLS_MD_C)
+enum
+{
+#if defined(MBEDTLS_SHA1_C)
+    OID_MD_HMAC_HMAC_SHA1,
+#endif
+#if defined(MBEDTLS_SHA256_C)
+    OID_MD_HMAC_HMAC_SHA224,
+#endif
+#if defined(MBEDTLS_SHA256_C)
+    OID_MD_HMAC_HMAC_SHA256,
+#endif
+#if defined(MBEDTLS_SHA512_C)
+    OID_MD_HMAC_HMAC_SHA384,
+#endif
+#if defined(MBEDTLS_SHA512_C)
+    OID_MD_HMAC_HMAC_SHA512,
+#endif
+    OID_MD_HMAC_END
+};
+
+static const unsigned char mbedtls_oid_md_hmac_hash_disp[3] =
+{
+      3,   0,   2,
+};
+
+static const unsigned char mbedtls_oid_md_hmac_hash_slot[5] =
+{
+#if defined(MBEDTLS_SHA256_C)
+    OID_MD_HMAC_HMAC_SHA256,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_SHA512_C)
+    OID_MD_HMAC_HMAC_SHA384,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_SHA1_C)
+    OID_MD_HMAC_HMAC_SHA1,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_SHA512_C)
+    OID_MD_HMAC_HMAC_SHA512,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+#if defined(MBEDTLS_SHA256_C)
+    OID_MD_HMAC_HMAC_SHA224,
+#else
+    MBEDTLS_OID_HASH_NONE,
+#endif
+};
+#endif /* defined(MBEDTLS_MD_C) */
+
+#if defined(MBEDTLS_PKCS12_C)
+enum
+{
+    OID_PKCS12_PBE_ALG_PKCS12_PBE_SHA1_DES3_EDE_CBC,
+    OID_PKCS12_PBE_ALG_PKCS12_PBE_SHA1_DES2_EDE_CBC,
+    OID_PKCS12_PBE_ALG_END
+};
+
+static const unsigned char mbedtls_oid_pkcs12_pbe_alg_hash_disp[1] =
+{
+      8,
+};
+
+static const unsigned char mbedtls_oid_pkcs12_pbe_alg_hash_slot[2] =
+{
+    OID_PKCS12_PBE_ALG_PKCS12_PBE_SHA1_DES2_EDE_CBC,
+    OID_PKCS12_PBE_ALG_PKCS12_PBE_SHA1_DES3_EDE_CBC,
+};
+#endif /* defined(MBEDTLS_PKCS12_C) */
@@ -479,8 +479,13 @@ static int pk_use_ecparams( const mbedtls_asn1_buf *params, mbedtls_ecp_group *g
     if( grp->id != MBEDTLS_ECP_DP_NONE && grp->id != grp_id )
         return( MBEDTLS_ERR_PK_KEY_INVALID_FORMAT );
 
+#if defined(MBEDTLS_ECP_SHARED_GROUPS)
+    if( ( ret = mbedtls_ecp_group_load_shared( grp, grp_id ) ) != 0 )
+        return( ret );
+#else
     if( ( ret = mbedtls_ecp_group_load( grp, grp_id ) ) != 0 )
         return( ret );
+#endif
 
     return( 0 );
 }
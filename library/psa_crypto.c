@@ -767,8 +767,13 @@ static psa_status_t psa_load_ecp_representation( psa_key_type_t type,
         goto exit;
     }
 
+#if defined(MBEDTLS_ECP_SHARED_GROUPS)
+    status = mbedtls_to_psa_error(
+                mbedtls_ecp_group_load_shared( &ecp->grp, grp_id ) );
+#else
     status = mbedtls_to_psa_error(
                 mbedtls_ecp_group_load( &ecp->grp, grp_id ) );
+#endif
     if( status != PSA_SUCCESS )
         goto exit;
 
@@ -1213,6 +1218,13 @@ static psa_status_t psa_remove_key_data_from_memory( psa_key_slot_t *slot )
         slot->data.key.bytes = 0;
     }
 
+#if defined(MBEDTLS_ECP_KEY_PRECOMP)
+    mbedtls_ecp_precomp_free( slot->ecp_precomp );
+    mbedtls_free( slot->ecp_precomp );
+    slot->ecp_precomp = NULL;
+    slot->ecp_verify_count = 0;
+#endif /* MBEDTLS_ECP_KEY_PRECOMP */
+
     return( PSA_SUCCESS );
 }
 
@@ -3591,7 +3603,38 @@ cleanup:
     return( mbedtls_to_psa_error( ret ) );
 }
 
-static psa_status_t psa_ecdsa_verify( mbedtls_ecp_keypair *ecp,
+#if defined(MBEDTLS_ECP_KEY_PRECOMP)
+/* Return the precomputed public key of a slot, or NULL, computing it the
+ * second time the slot is used for verification so that keys which only
+ * check one signature don't pay for it. The slot keeps working without it
+ * if it can't be computed. */
+static mbedtls_ecp_precomp *psa_ecdsa_load_precomp( psa_key_slot_t *slot,
+                                            mbedtls_ecp_keypair *ecp )
+{
+    if( slot->ecp_precomp == NULL && slot->ecp_verify_count < 2 &&
+        mbedtls_ecp_is_zero( &ecp->Q ) == 0 &&
+        ++slot->ecp_verify_count == 2 )
+    {
+        slot->ecp_precomp = mbedtls_calloc( 1, sizeof( mbedtls_ecp_precomp ) );
+        if( slot->ecp_precomp == NULL )
+            return( NULL );
+
+        mbedtls_ecp_precomp_init( slot->ecp_precomp );
+        if( mbedtls_ecp_precomp_setup( slot->ecp_precomp, ecp->grp.id,
+                                       &ecp->Q ) != 0 )
+        {
+            mbedtls_ecp_precomp_free( slot->ecp_precomp );
+            mbedtls_free( slot->ecp_precomp );
+            slot->ecp_precomp = NULL;
+        }
+    }
+
+    return( slot->ecp_precomp );
+}
+#endif /* MBEDTLS_ECP_KEY_PRECOMP */
+
+static psa_status_t psa_ecdsa_verify( psa_key_slot_t *slot,
+                                      mbedtls_ecp_keypair *ecp,
                                       const uint8_t *hash,
                                       size_t hash_length,
                                       const uint8_t *signature,
@@ -3599,6 +3642,9 @@ static psa_status_t psa_ecdsa_verify( mbedtls_ecp_keypair *ecp,
 {
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
     mbedtls_mpi r, s;
+#if defined(MBEDTLS_ECP_KEY_PRECOMP)
+    mbedtls_ecp_precomp *pre;
+#endif
     size_t curve_bytes = PSA_BITS_TO_BYTES( ecp->grp.pbits );
     mbedtls_mpi_init( &r );
     mbedtls_mpi_init( &s );
@@ -3621,14 +3667,24 @@ static psa_status_t psa_ecdsa_verify( mbedtls_ecp_keypair *ecp,
                              mbedtls_ctr_drbg_random, &global_data.ctr_drbg ) );
     }
 
-    ret = mbedtls_ecdsa_verify( &ecp->grp, hash, hash_length,
-                                &ecp->Q, &r, &s );
+#if defined(MBEDTLS_ECP_KEY_PRECOMP)
+    pre = psa_ecdsa_load_precomp( slot, ecp );
+    if( pre != NULL )
+        ret = mbedtls_ecdsa_verify_precomp( pre, hash, hash_length,
+                                            &r, &s );
+    else
+#else
+    (void) slot;
+#endif
+        ret = mbedtls_ecdsa_verify( &ecp->grp, hash, hash_length,
+                                    &ecp->Q, &r, &s );
 
 cleanup:
     mbedtls_mpi_free( &r );
     mbedtls_mpi_free( &s );
     return( mbedtls_to_psa_error( ret ) );
 }
+
 #endif /* MBEDTLS_ECDSA_C */
 
 psa_status_t psa_sign_hash( psa_key_handle_t handle,
@@ -3809,7 +3865,7 @@ psa_status_t psa_verify_hash( psa_key_handle_t handle,
                                                   &ecp );
             if( status != PSA_SUCCESS )
                 return( status );
-            status = psa_ecdsa_verify( ecp,
+            status = psa_ecdsa_verify( slot, ecp,
                                        hash, hash_length,
                                        signature, signature_length );
             mbedtls_ecp_keypair_free( ecp );
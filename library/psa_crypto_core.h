@@ -30,6 +30,10 @@
 #include "psa/crypto.h"
 #include "psa/crypto_se_driver.h"
 
+#if defined(MBEDTLS_ECP_KEY_PRECOMP)
+#include "mbedtls/ecp.h"
+#endif
+
 /** The data structure representing a key slot, containing key material
  * and metadata for one key.
  */
@@ -53,6 +57,12 @@ typedef struct
         } se;
 #endif /* MBEDTLS_PSA_CRYPTO_SE_C */
     } data;
+#if defined(MBEDTLS_ECP_KEY_PRECOMP)
+    /* Precomputed public key of an ECC key, built on its second use for
+     * signature verification, or NULL. */
+    mbedtls_ecp_precomp *ecp_precomp;
+    unsigned ecp_verify_count;
+#endif /* MBEDTLS_ECP_KEY_PRECOMP */
 } psa_key_slot_t;
 
 /* A mask of key attribute flags used only internally.
@@ -55,6 +55,12 @@
 #include <stdlib.h>
 #endif
 
+#if defined(MBEDTLS_RSA_GEN_KEY_PARALLEL)
+#include "mbedtls/hmac_drbg.h"
+#include "mbedtls/threading.h"
+#include <pthread.h>
+#endif
+
 #if defined(MBEDTLS_PLATFORM_C)
 #include "mbedtls/platform.h"
 #else
@@ -521,88 +527,78 @@ size_t mbedtls_rsa_get_len( const mbedtls_rsa_context *ctx )
 #if defined(MBEDTLS_GENPRIME)
 
 /*
- * Generate an RSA keypair
+ * Check that the primes in ctx->P and ctx->Q are suitable for an nbits-bit
+ * key with public exponent ctx->E. If they are, sort them so that P > Q and
+ * set ctx->D. Returns MBEDTLS_ERR_MPI_NOT_ACCEPTABLE if new primes are needed.
  *
- * This generation method follows the RSA key pair generation procedure of
- * FIPS 186-4 if 2^16 < exponent < 2^256 and nbits = 2048 or nbits = 3072.
+ * The primes must be such that:
+ * 1.  |P-Q| > 2^( nbits / 2 - 100 )
+ * 2.  GCD( E, (P-1)*(Q-1) ) == 1
+ * 3.  E^-1 mod LCM(P-1, Q-1) > 2^( nbits / 2 )
  */
-int mbedtls_rsa_gen_key( mbedtls_rsa_context *ctx,
-                 int (*f_rng)(void *, unsigned char *, size_t),
-                 void *p_rng,
-                 unsigned int nbits, int exponent )
+static int rsa_gen_key_check_primes( mbedtls_rsa_context *ctx,
+                                     unsigned int nbits )
 {
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    int acceptable = 0;
     mbedtls_mpi H, G, L;
-    int prime_quality = 0;
-    RSA_VALIDATE_RET( ctx != NULL );
-    RSA_VALIDATE_RET( f_rng != NULL );
-
-    if( nbits < 128 || exponent < 3 || nbits % 2 != 0 )
-        return( MBEDTLS_ERR_RSA_BAD_INPUT_DATA );
-
-    /*
-     * If the modulus is 1024 bit long or shorter, then the security strength of
-     * the RSA algorithm is less than or equal to 80 bits and therefore an error
-     * rate of 2^-80 is sufficient.
-     */
-    if( nbits > 1024 )
-        prime_quality = MBEDTLS_MPI_GEN_PRIME_FLAG_LOW_ERR;
 
     mbedtls_mpi_init( &H );
     mbedtls_mpi_init( &G );
     mbedtls_mpi_init( &L );
 
-    /*
-     * find primes P and Q with Q < P so that:
-     * 1.  |P-Q| > 2^( nbits / 2 - 100 )
-     * 2.  GCD( E, (P-1)*(Q-1) ) == 1
-     * 3.  E^-1 mod LCM(P-1, Q-1) > 2^( nbits / 2 )
-     */
-    MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &ctx->E, exponent ) );
-
-    do
+    /* make sure the difference between p and q is not too small (FIPS 186-4 §B.3.3 step 5.4) */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( &H, &ctx->P, &ctx->Q ) );
+    if( mbedtls_mpi_bitlen( &H ) <= ( ( nbits >= 200 ) ? ( ( nbits >> 1 ) - 99 ) : 0 ) )
     {
-        MBEDTLS_MPI_CHK( mbedtls_mpi_gen_prime( &ctx->P, nbits >> 1,
-                                                prime_quality, f_rng, p_rng ) );
-
-        MBEDTLS_MPI_CHK( mbedtls_mpi_gen_prime( &ctx->Q, nbits >> 1,
-                                                prime_quality, f_rng, p_rng ) );
-
-        /* make sure the difference between p and q is not too small (FIPS 186-4 §B.3.3 step 5.4) */
-        MBEDTLS_MPI_CHK( mbedtls_mpi_sub_mpi( &H, &ctx->P, &ctx->Q ) );
-        if( mbedtls_mpi_bitlen( &H ) <= ( ( nbits >= 200 ) ? ( ( nbits >> 1 ) - 99 ) : 0 ) )
-            continue;
-
-        /* not required by any standards, but some users rely on the fact that P > Q */
-        if( H.s < 0 )
-            mbedtls_mpi_swap( &ctx->P, &ctx->Q );
+        ret = MBEDTLS_ERR_MPI_NOT_ACCEPTABLE;
+        goto cleanup;
+    }
 
-        /* Temporarily replace P,Q by P-1, Q-1 */
-        MBEDTLS_MPI_CHK( mbedtls_mpi_sub_int( &ctx->P, &ctx->P, 1 ) );
-        MBEDTLS_MPI_CHK( mbedtls_mpi_sub_int( &ctx->Q, &ctx->Q, 1 ) );
-        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &H, &ctx->P, &ctx->Q ) );
+    /* not required by any standards, but some users rely on the fact that P > Q */
+    if( H.s < 0 )
+        mbedtls_mpi_swap( &ctx->P, &ctx->Q );
 
-        /* check GCD( E, (P-1)*(Q-1) ) == 1 (FIPS 186-4 §B.3.1 criterion 2(a)) */
-        MBEDTLS_MPI_CHK( mbedtls_mpi_gcd( &G, &ctx->E, &H  ) );
-        if( mbedtls_mpi_cmp_int( &G, 1 ) != 0 )
-            continue;
+    /* Temporarily replace P,Q by P-1, Q-1 */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_int( &ctx->P, &ctx->P, 1 ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_sub_int( &ctx->Q, &ctx->Q, 1 ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &H, &ctx->P, &ctx->Q ) );
 
+    /* check GCD( E, (P-1)*(Q-1) ) == 1 (FIPS 186-4 §B.3.1 criterion 2(a)) */
+    MBEDTLS_MPI_CHK( mbedtls_mpi_gcd( &G, &ctx->E, &H  ) );
+    if( mbedtls_mpi_cmp_int( &G, 1 ) == 0 )
+    {
         /* compute smallest possible D = E^-1 mod LCM(P-1, Q-1) (FIPS 186-4 §B.3.1 criterion 3(b)) */
         MBEDTLS_MPI_CHK( mbedtls_mpi_gcd( &G, &ctx->P, &ctx->Q ) );
         MBEDTLS_MPI_CHK( mbedtls_mpi_div_mpi( &L, NULL, &H, &G ) );
         MBEDTLS_MPI_CHK( mbedtls_mpi_inv_mod( &ctx->D, &ctx->E, &L ) );
 
-        if( mbedtls_mpi_bitlen( &ctx->D ) <= ( ( nbits + 1 ) / 2 ) ) // (FIPS 186-4 §B.3.1 criterion 3(a))
-            continue;
-
-        break;
+        // (FIPS 186-4 §B.3.1 criterion 3(a))
+        acceptable = mbedtls_mpi_bitlen( &ctx->D ) > ( ( nbits + 1 ) / 2 );
     }
-    while( 1 );
 
     /* Restore P,Q */
     MBEDTLS_MPI_CHK( mbedtls_mpi_add_int( &ctx->P,  &ctx->P, 1 ) );
     MBEDTLS_MPI_CHK( mbedtls_mpi_add_int( &ctx->Q,  &ctx->Q, 1 ) );
 
+    ret = acceptable ? 0 : MBEDTLS_ERR_MPI_NOT_ACCEPTABLE;
+
+cleanup:
+
+    mbedtls_mpi_free( &H );
+    mbedtls_mpi_free( &G );
+    mbedtls_mpi_free( &L );
+
+    return( ret );
+}
+
+/*
+ * Complete a key whose P, Q, E and D are set
+ */
+static int rsa_gen_key_finish( mbedtls_rsa_context *ctx )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+
     MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &ctx->N, &ctx->P, &ctx->Q ) );
 
     ctx->len = mbedtls_mpi_size( &ctx->N );
@@ -622,9 +618,58 @@ int mbedtls_rsa_gen_key( mbedtls_rsa_context *ctx,
 
 cleanup:
 
-    mbedtls_mpi_free( &H );
-    mbedtls_mpi_free( &G );
-    mbedtls_mpi_free( &L );
+    return( ret );
+}
+
+/*
+ * If the modulus is 1024 bit long or shorter, then the security strength of
+ * the RSA algorithm is less than or equal to 80 bits and therefore an error
+ * rate of 2^-80 is sufficient.
+ */
+#define RSA_GEN_KEY_PRIME_QUALITY( nbits )                                \
+    ( ( nbits ) > 1024 ? MBEDTLS_MPI_GEN_PRIME_FLAG_LOW_ERR : 0 )
+
+/*
+ * Generate an RSA keypair
+ *
+ * This generation method follows the RSA key pair generation procedure of
+ * FIPS 186-4 if 2^16 < exponent < 2^256 and nbits = 2048 or nbits = 3072.
+ */
+int mbedtls_rsa_gen_key( mbedtls_rsa_context *ctx,
+                 int (*f_rng)(void *, unsigned char *, size_t),
+                 void *p_rng,
+                 unsigned int nbits, int exponent )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    int prime_quality;
+    RSA_VALIDATE_RET( ctx != NULL );
+    RSA_VALIDATE_RET( f_rng != NULL );
+
+    if( nbits < 128 || exponent < 3 || nbits % 2 != 0 )
+        return( MBEDTLS_ERR_RSA_BAD_INPUT_DATA );
+
+    prime_quality = RSA_GEN_KEY_PRIME_QUALITY( nbits );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &ctx->E, exponent ) );
+
+    do
+    {
+        MBEDTLS_MPI_CHK( mbedtls_mpi_gen_prime( &ctx->P, nbits >> 1,
+                                                prime_quality, f_rng, p_rng ) );
+
+        MBEDTLS_MPI_CHK( mbedtls_mpi_gen_prime( &ctx->Q, nbits >> 1,
+                                                prime_quality, f_rng, p_rng ) );
+
+        ret = rsa_gen_key_check_primes( ctx, nbits );
+    }
+    while( ret == MBEDTLS_ERR_MPI_NOT_ACCEPTABLE );
+
+    if( ret != 0 )
+        goto cleanup;
+
+    MBEDTLS_MPI_CHK( rsa_gen_key_finish( ctx ) );
+
+cleanup:
 
     if( ret != 0 )
     {
@@ -635,6 +680,212 @@ cleanup:
     return( 0 );
 }
 
+#if defined(MBEDTLS_RSA_GEN_KEY_PARALLEL)
+
+#define RSA_GEN_SEED_LEN    32
+
+/*
+ * A batch of prime searches, shared by the threads of
+ * mbedtls_rsa_gen_key_parallel(). Search i of the batch is the search number
+ * base + i of the whole key generation.
+ */
+typedef struct
+{
+    mbedtls_threading_mutex_t mutex;    /*!< Protects next */
+    const unsigned char *seed;          /*!< Seed of all searches */
+    size_t nbits;                       /*!< Size of the primes */
+    int flags;                          /*!< mbedtls_mpi_gen_prime() flags */
+    uint32_t base;                      /*!< Number of the first search */
+    size_t next;                        /*!< Next search to be claimed */
+    size_t count;                       /*!< Number of searches */
+    mbedtls_mpi *X;                     /*!< Primes found */
+    int *ret;                           /*!< Result of each search */
+}
+rsa_gen_batch;
+
+/*
+ * Prime search number index, from a single random starting point drawn
+ * from an HMAC_DRBG seeded with seed || index.
+ */
+static int rsa_gen_prime_search( mbedtls_mpi *X, const unsigned char *seed,
+                                 uint32_t index, size_t nbits, int flags )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_hmac_drbg_context drbg;
+    unsigned char buf[RSA_GEN_SEED_LEN + 4];
+
+    memcpy( buf, seed, RSA_GEN_SEED_LEN );
+    buf[RSA_GEN_SEED_LEN    ] = (unsigned char)( index >> 24 );
+    buf[RSA_GEN_SEED_LEN + 1] = (unsigned char)( index >> 16 );
+    buf[RSA_GEN_SEED_LEN + 2] = (unsigned char)( index >>  8 );
+    buf[RSA_GEN_SEED_LEN + 3] = (unsigned char)( index       );
+
+    mbedtls_hmac_drbg_init( &drbg );
+
+    ret = mbedtls_hmac_drbg_seed_buf( &drbg,
+                mbedtls_md_info_from_type( MBEDTLS_MD_SHA256 ),
+                buf, sizeof( buf ) );
+    if( ret == 0 )
+        ret = mbedtls_mpi_gen_prime( X, nbits,
+                                     flags | MBEDTLS_MPI_GEN_PRIME_FLAG_SINGLE,
+                                     mbedtls_hmac_drbg_random, &drbg );
+
+    mbedtls_hmac_drbg_free( &drbg );
+    mbedtls_platform_zeroize( buf, sizeof( buf ) );
+
+    return( ret );
+}
+
+/*
+ * Run searches from the batch until there are none left
+ */
+static void *rsa_gen_worker( void *arg )
+{
+    rsa_gen_batch *batch = (rsa_gen_batch *) arg;
+    size_t i;
+
+    while( 1 )
+    {
+        if( mbedtls_mutex_lock( &batch->mutex ) != 0 )
+            return( NULL );
+
+        i = batch->next;
+        if( i < batch->count )
+            batch->next++;
+
+        if( mbedtls_mutex_unlock( &batch->mutex ) != 0 || i == batch->count )
+            return( NULL );
+
+        batch->ret[i] = rsa_gen_prime_search( &batch->X[i], batch->seed,
+                                              batch->base + (uint32_t) i,
+                                              batch->nbits, batch->flags );
+    }
+}
+
+/*
+ * Generate an RSA keypair, searching for primes on several threads
+ *
+ * Searches are numbered, and successful ones are paired in that order:
+ * the first two primes found are tried as P and Q, then the next two, and so
+ * on. The key thus only depends on the seed, and threads only change how
+ * many searches run at the same time.
+ */
+int mbedtls_rsa_gen_key_parallel( mbedtls_rsa_context *ctx,
+                                  int (*f_rng)(void *, unsigned char *, size_t),
+                                  void *p_rng,
+                                  unsigned int nbits, int exponent,
+                                  unsigned int workers )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    int have_p = 0;
+    unsigned char seed[RSA_GEN_SEED_LEN];
+    pthread_t *threads = NULL;
+    rsa_gen_batch batch;
+    size_t i, started;
+    RSA_VALIDATE_RET( ctx != NULL );
+    RSA_VALIDATE_RET( f_rng != NULL );
+
+    if( nbits < 128 || exponent < 3 || nbits % 2 != 0 || workers == 0 )
+        return( MBEDTLS_ERR_RSA_BAD_INPUT_DATA );
+
+    memset( &batch, 0, sizeof( batch ) );
+    mbedtls_mutex_init( &batch.mutex );
+
+    batch.seed = seed;
+    batch.nbits = nbits >> 1;
+    batch.flags = RSA_GEN_KEY_PRIME_QUALITY( nbits );
+    batch.count = workers;
+
+    threads = mbedtls_calloc( workers, sizeof( pthread_t ) );
+    batch.X = mbedtls_calloc( workers, sizeof( mbedtls_mpi ) );
+    batch.ret = mbedtls_calloc( workers, sizeof( int ) );
+    if( threads == NULL || batch.X == NULL || batch.ret == NULL )
+    {
+        ret = MBEDTLS_ERR_MPI_ALLOC_FAILED;
+        goto cleanup;
+    }
+
+    for( i = 0; i < workers; i++ )
+        mbedtls_mpi_init( &batch.X[i] );
+
+    if( ( ret = f_rng( p_rng, seed, sizeof( seed ) ) ) != 0 )
+        goto cleanup;
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &ctx->E, exponent ) );
+
+    while( 1 )
+    {
+        for( i = 0; i < workers; i++ )
+            batch.ret[i] = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+        batch.next = 0;
+
+        /* The calling thread is the first worker */
+        for( started = 1; started < workers; started++ )
+            if( pthread_create( &threads[started], NULL,
+                                rsa_gen_worker, &batch ) != 0 )
+                break;
+
+        rsa_gen_worker( &batch );
+
+        for( i = 1; i < started; i++ )
+            pthread_join( threads[i], NULL );
+
+        for( i = 0; i < workers; i++ )
+        {
+            if( batch.ret[i] == MBEDTLS_ERR_MPI_NOT_ACCEPTABLE )
+                continue;
+
+            if( ( ret = batch.ret[i] ) != 0 )
+                goto cleanup;
+
+            if( ! have_p )
+            {
+                mbedtls_mpi_swap( &ctx->P, &batch.X[i] );
+                have_p = 1;
+                continue;
+            }
+
+            mbedtls_mpi_swap( &ctx->Q, &batch.X[i] );
+            have_p = 0;
+
+            ret = rsa_gen_key_check_primes( ctx, nbits );
+            if( ret == 0 )
+                goto found;
+            if( ret != MBEDTLS_ERR_MPI_NOT_ACCEPTABLE )
+                goto cleanup;
+        }
+
+        batch.base += workers;
+    }
+
+found:
+    MBEDTLS_MPI_CHK( rsa_gen_key_finish( ctx ) );
+
+cleanup:
+
+    if( batch.X != NULL )
+    {
+        for( i = 0; i < workers; i++ )
+            mbedtls_mpi_free( &batch.X[i] );
+    }
+
+    mbedtls_free( batch.X );
+    mbedtls_free( batch.ret );
+    mbedtls_free( threads );
+    mbedtls_mutex_free( &batch.mutex );
+    mbedtls_platform_zeroize( seed, sizeof( seed ) );
+
+    if( ret != 0 )
+    {
+        mbedtls_rsa_free( ctx );
+        return( MBEDTLS_ERR_RSA_KEY_GEN_FAILED + ret );
+    }
+
+    return( 0 );
+}
+
+#endif /* MBEDTLS_RSA_GEN_KEY_PARALLEL */
+
 #endif /* MBEDTLS_GENPRIME */
 
 /*
@@ -716,6 +967,36 @@ int mbedtls_rsa_check_pub_priv( const mbedtls_rsa_context *pub,
     return( 0 );
 }
 
+/*
+ * Make sure RR holds R^2 mod N, exactly as mbedtls_mpi_exp_mod() would
+ * compute and cache it on first use, so that concurrent calls to
+ * mbedtls_mpi_exp_mod() only ever read it.
+ *
+ * With MBEDTLS_THREADING_C, this must be called with the context mutex held.
+ */
+static int rsa_prepare_rr( mbedtls_mpi *RR, const mbedtls_mpi *N )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_mpi T;
+
+    if( RR->p != NULL )
+        return( 0 );
+
+    mbedtls_mpi_init( &T );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &T, 1 ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_shift_l( &T, N->n * 2 * 8 * sizeof( mbedtls_mpi_uint ) ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &T, &T, N ) );
+
+    /* Only publish the value once it is complete */
+    mbedtls_mpi_swap( RR, &T );
+
+cleanup:
+    mbedtls_mpi_free( &T );
+
+    return( ret );
+}
+
 /*
  * Do an RSA public key operation
  */
@@ -733,13 +1014,25 @@ int mbedtls_rsa_public( mbedtls_rsa_context *ctx,
     if( rsa_check_context( ctx, 0 /* public */, 0 /* no blinding */ ) )
         return( MBEDTLS_ERR_RSA_BAD_INPUT_DATA );
 
-    mbedtls_mpi_init( &T );
-
+    /* The only shared state is the cached value of R^2 mod N, which is
+     * read-only once set: only hold the mutex while making sure it is. */
 #if defined(MBEDTLS_THREADING_C)
     if( ( ret = mbedtls_mutex_lock( &ctx->mutex ) ) != 0 )
         return( ret );
 #endif
 
+    ret = rsa_prepare_rr( &ctx->RN, &ctx->N );
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_unlock( &ctx->mutex ) != 0 )
+        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+#endif
+
+    if( ret != 0 )
+        return( MBEDTLS_ERR_RSA_PUBLIC_FAILED + ret );
+
+    mbedtls_mpi_init( &T );
+
     MBEDTLS_MPI_CHK( mbedtls_mpi_read_binary( &T, input, ctx->len ) );
 
     if( mbedtls_mpi_cmp_mpi( &T, &ctx->N ) >= 0 )
@@ -753,11 +1046,6 @@ int mbedtls_rsa_public( mbedtls_rsa_context *ctx,
     MBEDTLS_MPI_CHK( mbedtls_mpi_write_binary( &T, output, olen ) );
 
 cleanup:
-#if defined(MBEDTLS_THREADING_C)
-    if( mbedtls_mutex_unlock( &ctx->mutex ) != 0 )
-        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
-#endif
-
     mbedtls_mpi_free( &T );
 
     if( ret != 0 )
@@ -771,8 +1059,16 @@ cleanup:
  *  KOCHER, Paul C. Timing attacks on implementations of Diffie-Hellman, RSA,
  *  DSS, and other systems. In : Advances in Cryptology-CRYPTO'96. Springer
  *  Berlin Heidelberg, 1996. p. 104-113.
+ *
+ * The values stored in the context are refreshed, then copied to Vi and Vf
+ * for use by a single private key operation, so that the operation itself
+ * does not need to hold the context mutex. Concurrent operations on the same
+ * context each get their own, distinct pair.
+ *
+ * With MBEDTLS_THREADING_C, this must be called with the context mutex held.
  */
 static int rsa_prepare_blinding( mbedtls_rsa_context *ctx,
+                 mbedtls_mpi *Vi, mbedtls_mpi *Vf,
                  int (*f_rng)(void *, unsigned char *, size_t), void *p_rng )
 {
     int ret, count = 0;
@@ -788,7 +1084,7 @@ static int rsa_prepare_blinding( mbedtls_rsa_context *ctx,
         MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &ctx->Vf, &ctx->Vf, &ctx->Vf ) );
         MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &ctx->Vf, &ctx->Vf, &ctx->N ) );
 
-        goto cleanup;
+        goto done;
     }
 
     /* Unblinding value: Vf = random number, invertible mod N */
@@ -810,7 +1106,7 @@ static int rsa_prepare_blinding( mbedtls_rsa_context *ctx,
          * are invertible mod N. If one of them isn't, we don't need to know
          * which one, we just loop and choose new values for both of them.
          * (Each iteration succeeds with overwhelming probability.) */
-        ret = mbedtls_mpi_inv_mod( &ctx->Vi, &ctx->Vi, &ctx->N );
+        ret = mbedtls_mpi_inv_mod_ct( &ctx->Vi, &ctx->Vi, &ctx->N );
         if( ret == MBEDTLS_ERR_MPI_NOT_ACCEPTABLE )
             continue;
         if( ret != 0 )
@@ -825,6 +1121,9 @@ static int rsa_prepare_blinding( mbedtls_rsa_context *ctx,
      * (Vi already contains Vf^-1 at this point) */
     MBEDTLS_MPI_CHK( mbedtls_mpi_exp_mod( &ctx->Vi, &ctx->Vi, &ctx->E, &ctx->N, &ctx->RN ) );
 
+done:
+    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( Vi, &ctx->Vi ) );
+    MBEDTLS_MPI_CHK( mbedtls_mpi_copy( Vf, &ctx->Vf ) );
 
 cleanup:
     mbedtls_mpi_free( &R );
@@ -873,6 +1172,9 @@ int mbedtls_rsa_private( mbedtls_rsa_context *ctx,
     mbedtls_mpi P1, Q1, R;
 
 #if !defined(MBEDTLS_RSA_NO_CRT)
+    /* The exponent blinding factor for DQ; R is the one for DP. */
+    mbedtls_mpi R2;
+
     /* Temporaries holding the results mod p resp. mod q. */
     mbedtls_mpi TP, TQ;
 
@@ -897,6 +1199,9 @@ int mbedtls_rsa_private( mbedtls_rsa_context *ctx,
      * checked result; should be the same in the end. */
     mbedtls_mpi I, C;
 
+    /* This operation's own blinding and unblinding values. */
+    mbedtls_mpi Vi, Vf;
+
     RSA_VALIDATE_RET( ctx != NULL );
     RSA_VALIDATE_RET( input  != NULL );
     RSA_VALIDATE_RET( output != NULL );
@@ -907,17 +1212,63 @@ int mbedtls_rsa_private( mbedtls_rsa_context *ctx,
         return( MBEDTLS_ERR_RSA_BAD_INPUT_DATA );
     }
 
+    mbedtls_mpi_init( &Vi );
+    mbedtls_mpi_init( &Vf );
+    mbedtls_mpi_init( &R );
+#if !defined(MBEDTLS_RSA_NO_CRT)
+    mbedtls_mpi_init( &R2 );
+#endif
+
+    /*
+     * The mutex only protects the blinding values and the cached Montgomery
+     * constants in the context. Once this operation has its own blinding
+     * pair and the constants are known to be set, the context is only read
+     * from, so the exponentiations run without holding the lock and
+     * concurrent private key operations on one context scale across threads.
+     * The exponent blinding factors are drawn under the lock as well, so
+     * that f_rng is only ever called with the mutex held.
+     */
 #if defined(MBEDTLS_THREADING_C)
     if( ( ret = mbedtls_mutex_lock( &ctx->mutex ) ) != 0 )
         return( ret );
 #endif
 
+    ret = rsa_prepare_rr( &ctx->RN, &ctx->N );
+#if !defined(MBEDTLS_RSA_NO_CRT)
+    if( ret == 0 )
+        ret = rsa_prepare_rr( &ctx->RP, &ctx->P );
+    if( ret == 0 )
+        ret = rsa_prepare_rr( &ctx->RQ, &ctx->Q );
+#endif
+    if( ret == 0 && f_rng != NULL )
+        ret = rsa_prepare_blinding( ctx, &Vi, &Vf, f_rng, p_rng );
+    if( ret == 0 && f_rng != NULL )
+        ret = mbedtls_mpi_fill_random( &R, RSA_EXPONENT_BLINDING,
+                                       f_rng, p_rng );
+#if !defined(MBEDTLS_RSA_NO_CRT)
+    if( ret == 0 && f_rng != NULL )
+        ret = mbedtls_mpi_fill_random( &R2, RSA_EXPONENT_BLINDING,
+                                       f_rng, p_rng );
+#endif
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_unlock( &ctx->mutex ) != 0 )
+    {
+        mbedtls_mpi_free( &Vi );
+        mbedtls_mpi_free( &Vf );
+        mbedtls_mpi_free( &R );
+#if !defined(MBEDTLS_RSA_NO_CRT)
+        mbedtls_mpi_free( &R2 );
+#endif
+        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+    }
+#endif
+
     /* MPI Initialization */
     mbedtls_mpi_init( &T );
 
     mbedtls_mpi_init( &P1 );
     mbedtls_mpi_init( &Q1 );
-    mbedtls_mpi_init( &R );
 
     if( f_rng != NULL )
     {
@@ -938,6 +1289,9 @@ int mbedtls_rsa_private( mbedtls_rsa_context *ctx,
 
     /* End of MPI initialization */
 
+    if( ret != 0 )
+        goto cleanup;
+
     MBEDTLS_MPI_CHK( mbedtls_mpi_read_binary( &T, input, ctx->len ) );
     if( mbedtls_mpi_cmp_mpi( &T, &ctx->N ) >= 0 )
     {
@@ -953,8 +1307,7 @@ int mbedtls_rsa_private( mbedtls_rsa_context *ctx,
          * Blinding
          * T = T * Vi mod N
          */
-        MBEDTLS_MPI_CHK( rsa_prepare_blinding( ctx, f_rng, p_rng ) );
-        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &T, &T, &ctx->Vi ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &T, &T, &Vi ) );
         MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &T, &T, &ctx->N ) );
 
         /*
@@ -967,8 +1320,6 @@ int mbedtls_rsa_private( mbedtls_rsa_context *ctx,
         /*
          * D_blind = ( P - 1 ) * ( Q - 1 ) * R + D
          */
-        MBEDTLS_MPI_CHK( mbedtls_mpi_fill_random( &R, RSA_EXPONENT_BLINDING,
-                         f_rng, p_rng ) );
         MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &D_blind, &P1, &Q1 ) );
         MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &D_blind, &D_blind, &R ) );
         MBEDTLS_MPI_CHK( mbedtls_mpi_add_mpi( &D_blind, &D_blind, &ctx->D ) );
@@ -978,8 +1329,6 @@ int mbedtls_rsa_private( mbedtls_rsa_context *ctx,
         /*
          * DP_blind = ( P - 1 ) * R + DP
          */
-        MBEDTLS_MPI_CHK( mbedtls_mpi_fill_random( &R, RSA_EXPONENT_BLINDING,
-                         f_rng, p_rng ) );
         MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &DP_blind, &P1, &R ) );
         MBEDTLS_MPI_CHK( mbedtls_mpi_add_mpi( &DP_blind, &DP_blind,
                     &ctx->DP ) );
@@ -987,11 +1336,9 @@ int mbedtls_rsa_private( mbedtls_rsa_context *ctx,
         DP = &DP_blind;
 
         /*
-         * DQ_blind = ( Q - 1 ) * R + DQ
+         * DQ_blind = ( Q - 1 ) * R2 + DQ
          */
-        MBEDTLS_MPI_CHK( mbedtls_mpi_fill_random( &R, RSA_EXPONENT_BLINDING,
-                         f_rng, p_rng ) );
-        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &DQ_blind, &Q1, &R ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &DQ_blind, &Q1, &R2 ) );
         MBEDTLS_MPI_CHK( mbedtls_mpi_add_mpi( &DQ_blind, &DQ_blind,
                     &ctx->DQ ) );
 
@@ -1032,7 +1379,7 @@ int mbedtls_rsa_private( mbedtls_rsa_context *ctx,
          * Unblind
          * T = T * Vf mod N
          */
-        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &T, &T, &ctx->Vf ) );
+        MBEDTLS_MPI_CHK( mbedtls_mpi_mul_mpi( &T, &T, &Vf ) );
         MBEDTLS_MPI_CHK( mbedtls_mpi_mod_mpi( &T, &T, &ctx->N ) );
     }
 
@@ -1049,14 +1396,15 @@ int mbedtls_rsa_private( mbedtls_rsa_context *ctx,
     MBEDTLS_MPI_CHK( mbedtls_mpi_write_binary( &T, output, olen ) );
 
 cleanup:
-#if defined(MBEDTLS_THREADING_C)
-    if( mbedtls_mutex_unlock( &ctx->mutex ) != 0 )
-        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
-#endif
+    mbedtls_mpi_free( &Vi );
+    mbedtls_mpi_free( &Vf );
 
     mbedtls_mpi_free( &P1 );
     mbedtls_mpi_free( &Q1 );
     mbedtls_mpi_free( &R );
+#if !defined(MBEDTLS_RSA_NO_CRT)
+    mbedtls_mpi_free( &R2 );
+#endif
 
     if( f_rng != NULL )
     {
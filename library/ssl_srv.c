@@ -3151,6 +3151,11 @@ static int ssl_prepare_server_key_exchange( mbedtls_ssl_context *ssl,
             return( ret );
         }
 
+#if defined(MBEDTLS_DHM_FIXED_BASE)
+        mbedtls_dhm_set_fixed_base( &ssl->handshake->dhm_ctx,
+                                    ssl->conf->dhm_fb );
+#endif
+
         if( ( ret = mbedtls_dhm_make_params(
                   &ssl->handshake->dhm_ctx,
                   (int) mbedtls_mpi_size( &ssl->handshake->dhm_ctx.P ),
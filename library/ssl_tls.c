@@ -2522,6 +2522,10 @@ static int ssl_parse_certificate_verify( mbedtls_ssl_context *ssl,
     {
         mbedtls_x509_crt *ca_chain;
         mbedtls_x509_crl *ca_crl;
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+        unsigned char cache_key[MBEDTLS_X509_CRT_CACHE_KEY_LEN];
+        int use_cache;
+#endif
 
 #if defined(MBEDTLS_SSL_SERVER_NAME_INDICATION)
         if( ssl->handshake->sni_ca_chain != NULL )
@@ -2539,13 +2543,40 @@ static int ssl_parse_certificate_verify( mbedtls_ssl_context *ssl,
         if( ca_chain != NULL )
             have_ca_chain = 1;
 
-        ret = mbedtls_x509_crt_verify_restartable(
-            chain,
-            ca_chain, ca_crl,
-            ssl->conf->cert_profile,
-            ssl->hostname,
-            &ssl->session_negotiate->verify_result,
-            f_vrfy, p_vrfy, rs_ctx );
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+        /* A verification callback must see every certificate */
+        use_cache = ssl->conf->verify_cache != NULL && f_vrfy == NULL &&
+                    mbedtls_x509_crt_cache_key( cache_key, chain,
+                                                ca_chain, ca_crl,
+                                                ssl->conf->cert_profile,
+                                                ssl->hostname ) == 0;
+
+        if( use_cache &&
+            mbedtls_x509_crt_cache_get( ssl->conf->verify_cache, cache_key,
+                    &ret, &ssl->session_negotiate->verify_result ) == 0 )
+        {
+            MBEDTLS_SSL_DEBUG_MSG( 3, ( "use cached X.509 CRT verification result" ) );
+        }
+        else
+#endif /* MBEDTLS_X509_CRT_CACHE_C */
+        {
+            ret = mbedtls_x509_crt_verify_restartable(
+                chain,
+                ca_chain, ca_crl,
+                ssl->conf->cert_profile,
+                ssl->hostname,
+                &ssl->session_negotiate->verify_result,
+                f_vrfy, p_vrfy, rs_ctx );
+
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+            if( use_cache )
+            {
+                (void) mbedtls_x509_crt_cache_set( ssl->conf->verify_cache,
+                            cache_key, ret,
+                            ssl->session_negotiate->verify_result );
+            }
+#endif
+        }
     }
 
     if( ret != 0 )
@@ -4250,6 +4281,12 @@ void mbedtls_ssl_conf_ca_chain( mbedtls_ssl_config *conf,
     conf->ca_chain   = ca_chain;
     conf->ca_crl     = ca_crl;
 
+#if defined(MBEDTLS_X509_CA_INDEX)
+    /* The index is only an accelerator: on failure, verification
+     * falls back to walking the list. */
+    (void) mbedtls_x509_crt_build_index( ca_chain );
+#endif
+
 #if defined(MBEDTLS_X509_TRUSTED_CERTIFICATE_CALLBACK)
     /* mbedtls_ssl_conf_ca_chain() and mbedtls_ssl_conf_ca_cb()
      * cannot be used together. */
@@ -4272,6 +4309,14 @@ void mbedtls_ssl_conf_ca_cb( mbedtls_ssl_config *conf,
     conf->ca_crl     = NULL;
 }
 #endif /* MBEDTLS_X509_TRUSTED_CERTIFICATE_CALLBACK */
+
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+void mbedtls_ssl_conf_verify_cache( mbedtls_ssl_config *conf,
+                                    mbedtls_x509_crt_cache *cache )
+{
+    conf->verify_cache = cache;
+}
+#endif /* MBEDTLS_X509_CRT_CACHE_C */
 #endif /* MBEDTLS_X509_CRT_PARSE_C */
 
 #if defined(MBEDTLS_SSL_SERVER_NAME_INDICATION)
@@ -4559,6 +4604,14 @@ int mbedtls_ssl_conf_dh_param_ctx( mbedtls_ssl_config *conf, mbedtls_dhm_context
 
     return( 0 );
 }
+
+#if defined(MBEDTLS_DHM_FIXED_BASE)
+void mbedtls_ssl_conf_dh_fixed_base( mbedtls_ssl_config *conf,
+                                     const mbedtls_dhm_fixed_base *fb )
+{
+    conf->dhm_fb = fb;
+}
+#endif /* MBEDTLS_DHM_FIXED_BASE */
 #endif /* MBEDTLS_DHM_C && MBEDTLS_SSL_SRV_C */
 
 #if defined(MBEDTLS_DHM_C) && defined(MBEDTLS_SSL_CLI_C)
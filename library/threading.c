@@ -149,6 +149,12 @@ void mbedtls_threading_set_alt( void (*mutex_init)( mbedtls_threading_mutex_t *
 #if defined(THREADING_USE_GMTIME)
     mbedtls_mutex_init( &mbedtls_threading_gmtime_mutex );
 #endif
+#if defined(MBEDTLS_ECP_SHARED_GROUPS)
+    mbedtls_mutex_init( &mbedtls_threading_ecp_shared_groups_mutex );
+#endif
+#if defined(MBEDTLS_X509_CRT_FRAME_PARSING)
+    mbedtls_mutex_init( &mbedtls_threading_x509_crt_frame_mutex );
+#endif
 }
 
 /*
@@ -162,6 +168,12 @@ void mbedtls_threading_free_alt( void )
 #if defined(THREADING_USE_GMTIME)
     mbedtls_mutex_free( &mbedtls_threading_gmtime_mutex );
 #endif
+#if defined(MBEDTLS_ECP_SHARED_GROUPS)
+    mbedtls_mutex_free( &mbedtls_threading_ecp_shared_groups_mutex );
+#endif
+#if defined(MBEDTLS_X509_CRT_FRAME_PARSING)
+    mbedtls_mutex_free( &mbedtls_threading_x509_crt_frame_mutex );
+#endif
 }
 #endif /* MBEDTLS_THREADING_ALT */
 
@@ -177,5 +189,11 @@ mbedtls_threading_mutex_t mbedtls_threading_readdir_mutex MUTEX_INIT;
 #if defined(THREADING_USE_GMTIME)
 mbedtls_threading_mutex_t mbedtls_threading_gmtime_mutex MUTEX_INIT;
 #endif
+#if defined(MBEDTLS_ECP_SHARED_GROUPS)
+mbedtls_threading_mutex_t mbedtls_threading_ecp_shared_groups_mutex MUTEX_INIT;
+#endif
+#if defined(MBEDTLS_X509_CRT_FRAME_PARSING)
+mbedtls_threading_mutex_t mbedtls_threading_x509_crt_frame_mutex MUTEX_INIT;
+#endif
 
 #endif /* MBEDTLS_THREADING_C */
@@ -39,6 +39,9 @@ static const char * const features[] = {
 #if defined(MBEDTLS_HAVE_SSE2)
     "MBEDTLS_HAVE_SSE2",
 #endif /* MBEDTLS_HAVE_SSE2 */
+#if defined(MBEDTLS_BIGNUM_ADX)
+    "MBEDTLS_BIGNUM_ADX",
+#endif /* MBEDTLS_BIGNUM_ADX */
 #if defined(MBEDTLS_HAVE_TIME)
     "MBEDTLS_HAVE_TIME",
 #endif /* MBEDTLS_HAVE_TIME */
@@ -348,18 +351,42 @@ static const char * const features[] = {
 #if defined(MBEDTLS_ECP_NIST_OPTIM)
     "MBEDTLS_ECP_NIST_OPTIM",
 #endif /* MBEDTLS_ECP_NIST_OPTIM */
+#if defined(MBEDTLS_ECP_GLV_OPTIM)
+    "MBEDTLS_ECP_GLV_OPTIM",
+#endif /* MBEDTLS_ECP_GLV_OPTIM */
+#if defined(MBEDTLS_ECP_MONT_FIELD_OPTIM)
+    "MBEDTLS_ECP_MONT_FIELD_OPTIM",
+#endif /* MBEDTLS_ECP_MONT_FIELD_OPTIM */
+#if defined(MBEDTLS_ECP_FIXED_FIELD_OPTIM)
+    "MBEDTLS_ECP_FIXED_FIELD_OPTIM",
+#endif /* MBEDTLS_ECP_FIXED_FIELD_OPTIM */
 #if defined(MBEDTLS_ECP_NO_INTERNAL_RNG)
     "MBEDTLS_ECP_NO_INTERNAL_RNG",
 #endif /* MBEDTLS_ECP_NO_INTERNAL_RNG */
 #if defined(MBEDTLS_ECP_RESTARTABLE)
     "MBEDTLS_ECP_RESTARTABLE",
 #endif /* MBEDTLS_ECP_RESTARTABLE */
+#if defined(MBEDTLS_ECP_SHARED_GROUPS)
+    "MBEDTLS_ECP_SHARED_GROUPS",
+#endif /* MBEDTLS_ECP_SHARED_GROUPS */
+#if defined(MBEDTLS_ECP_KEY_PRECOMP)
+    "MBEDTLS_ECP_KEY_PRECOMP",
+#endif /* MBEDTLS_ECP_KEY_PRECOMP */
 #if defined(MBEDTLS_ECDH_LEGACY_CONTEXT)
     "MBEDTLS_ECDH_LEGACY_CONTEXT",
 #endif /* MBEDTLS_ECDH_LEGACY_CONTEXT */
+#if defined(MBEDTLS_ECDSA_BATCH_SIGN)
+    "MBEDTLS_ECDSA_BATCH_SIGN",
+#endif /* MBEDTLS_ECDSA_BATCH_SIGN */
+#if defined(MBEDTLS_ECDSA_BATCH_VERIFY)
+    "MBEDTLS_ECDSA_BATCH_VERIFY",
+#endif /* MBEDTLS_ECDSA_BATCH_VERIFY */
 #if defined(MBEDTLS_ECDSA_DETERMINISTIC)
     "MBEDTLS_ECDSA_DETERMINISTIC",
 #endif /* MBEDTLS_ECDSA_DETERMINISTIC */
+#if defined(MBEDTLS_ECDSA_NONCE_POOL)
+    "MBEDTLS_ECDSA_NONCE_POOL",
+#endif /* MBEDTLS_ECDSA_NONCE_POOL */
 #if defined(MBEDTLS_KEY_EXCHANGE_PSK_ENABLED)
     "MBEDTLS_KEY_EXCHANGE_PSK_ENABLED",
 #endif /* MBEDTLS_KEY_EXCHANGE_PSK_ENABLED */
@@ -399,6 +426,9 @@ static const char * const features[] = {
 #if defined(MBEDTLS_ERROR_STRERROR_DUMMY)
     "MBEDTLS_ERROR_STRERROR_DUMMY",
 #endif /* MBEDTLS_ERROR_STRERROR_DUMMY */
+#if defined(MBEDTLS_DHM_FIXED_BASE)
+    "MBEDTLS_DHM_FIXED_BASE",
+#endif /* MBEDTLS_DHM_FIXED_BASE */
 #if defined(MBEDTLS_GENPRIME)
     "MBEDTLS_GENPRIME",
 #endif /* MBEDTLS_GENPRIME */
@@ -411,6 +441,9 @@ static const char * const features[] = {
 #if defined(MBEDTLS_NO_PLATFORM_ENTROPY)
     "MBEDTLS_NO_PLATFORM_ENTROPY",
 #endif /* MBEDTLS_NO_PLATFORM_ENTROPY */
+#if defined(MBEDTLS_OID_HASH_LOOKUP)
+    "MBEDTLS_OID_HASH_LOOKUP",
+#endif /* MBEDTLS_OID_HASH_LOOKUP */
 #if defined(MBEDTLS_ENTROPY_FORCE_SHA256)
     "MBEDTLS_ENTROPY_FORCE_SHA256",
 #endif /* MBEDTLS_ENTROPY_FORCE_SHA256 */
@@ -447,6 +480,9 @@ static const char * const features[] = {
 #if defined(MBEDTLS_RSA_NO_CRT)
     "MBEDTLS_RSA_NO_CRT",
 #endif /* MBEDTLS_RSA_NO_CRT */
+#if defined(MBEDTLS_RSA_GEN_KEY_PARALLEL)
+    "MBEDTLS_RSA_GEN_KEY_PARALLEL",
+#endif /* MBEDTLS_RSA_GEN_KEY_PARALLEL */
 #if defined(MBEDTLS_SELF_TEST)
     "MBEDTLS_SELF_TEST",
 #endif /* MBEDTLS_SELF_TEST */
@@ -588,6 +624,24 @@ static const char * const features[] = {
 #if defined(MBEDTLS_X509_TRUSTED_CERTIFICATE_CALLBACK)
     "MBEDTLS_X509_TRUSTED_CERTIFICATE_CALLBACK",
 #endif /* MBEDTLS_X509_TRUSTED_CERTIFICATE_CALLBACK */
+#if defined(MBEDTLS_X509_CA_INDEX)
+    "MBEDTLS_X509_CA_INDEX",
+#endif /* MBEDTLS_X509_CA_INDEX */
+#if defined(MBEDTLS_X509_CRL_SERIAL_INDEX)
+    "MBEDTLS_X509_CRL_SERIAL_INDEX",
+#endif /* MBEDTLS_X509_CRL_SERIAL_INDEX */
+#if defined(MBEDTLS_X509_CRT_FRAME_PARSING)
+    "MBEDTLS_X509_CRT_FRAME_PARSING",
+#endif /* MBEDTLS_X509_CRT_FRAME_PARSING */
+#if defined(MBEDTLS_X509_CRT_PARSE_PATH_DEDUP)
+    "MBEDTLS_X509_CRT_PARSE_PATH_DEDUP",
+#endif /* MBEDTLS_X509_CRT_PARSE_PATH_DEDUP */
+#if defined(MBEDTLS_X509_CRT_STORE)
+    "MBEDTLS_X509_CRT_STORE",
+#endif /* MBEDTLS_X509_CRT_STORE */
+#if defined(MBEDTLS_X509_CRT_WRITE_TEMPLATE)
+    "MBEDTLS_X509_CRT_WRITE_TEMPLATE",
+#endif /* MBEDTLS_X509_CRT_WRITE_TEMPLATE */
 #if defined(MBEDTLS_X509_CHECK_KEY_USAGE)
     "MBEDTLS_X509_CHECK_KEY_USAGE",
 #endif /* MBEDTLS_X509_CHECK_KEY_USAGE */
@@ -807,6 +861,9 @@ static const char * const features[] = {
 #if defined(MBEDTLS_X509_CRT_PARSE_C)
     "MBEDTLS_X509_CRT_PARSE_C",
 #endif /* MBEDTLS_X509_CRT_PARSE_C */
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+    "MBEDTLS_X509_CRT_CACHE_C",
+#endif /* MBEDTLS_X509_CRT_CACHE_C */
 #if defined(MBEDTLS_X509_CRL_PARSE_C)
     "MBEDTLS_X509_CRL_PARSE_C",
 #endif /* MBEDTLS_X509_CRL_PARSE_C */
@@ -36,6 +36,10 @@
 #include "mbedtls/error.h"
 #include "mbedtls/oid.h"
 
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+#include "mbedtls/sha256.h"
+#endif
+
 #include <stdio.h>
 #include <string.h>
 
@@ -734,6 +738,32 @@ int mbedtls_x509_get_ext( unsigned char **p, const unsigned char *end,
     return( 0 );
 }
 
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+/*
+ * Fold the DER of a certificate or CRL appended to a chain into the running
+ * digest kept on the first element: digest = SHA-256( digest || raw )
+ */
+int mbedtls_x509_chain_digest_update( unsigned char *digest,
+                                      const mbedtls_x509_buf *raw )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_sha256_context sha;
+
+    mbedtls_sha256_init( &sha );
+
+    if( ( ret = mbedtls_sha256_starts_ret( &sha, 0 ) ) == 0 &&
+        ( ret = mbedtls_sha256_update_ret( &sha, digest, 32 ) ) == 0 &&
+        ( ret = mbedtls_sha256_update_ret( &sha, raw->p, raw->len ) ) == 0 )
+    {
+        ret = mbedtls_sha256_finish_ret( &sha, digest );
+    }
+
+    mbedtls_sha256_free( &sha );
+
+    return( ret );
+}
+#endif /* MBEDTLS_X509_CRT_CACHE_C */
+
 /*
  * Store the name in printable form into buf; no more
  * than size characters will be written
@@ -223,16 +223,138 @@ static int x509_get_crl_entry_ext( unsigned char **p,
     return( 0 );
 }
 
+#if defined(MBEDTLS_X509_CRL_SERIAL_INDEX)
+/*
+ * Append the position of a serial number to the index of a CRL
+ */
+static int x509_crl_add_serial( mbedtls_x509_crl *crl, size_t *size,
+                                const mbedtls_x509_buf *serial )
+{
+    if( crl->serial_count == *size )
+    {
+        mbedtls_x509_crl_serial *serials;
+        size_t new_size = ( *size == 0 ) ? 16 : 2 * *size;
+
+        serials = mbedtls_calloc( new_size, sizeof( mbedtls_x509_crl_serial ) );
+        if( serials == NULL )
+            return( MBEDTLS_ERR_X509_ALLOC_FAILED );
+
+        if( crl->serials != NULL )
+        {
+            memcpy( serials, crl->serials,
+                    crl->serial_count * sizeof( mbedtls_x509_crl_serial ) );
+            mbedtls_free( crl->serials );
+        }
+
+        crl->serials = serials;
+        *size = new_size;
+    }
+
+    crl->serials[crl->serial_count].offset =
+        (uint32_t) ( serial->p - crl->raw.p );
+    crl->serials[crl->serial_count].len = (uint32_t) serial->len;
+    crl->serial_count++;
+
+    return( 0 );
+}
+
+/*
+ * Order serial numbers by length, then by value. Only equality matters for
+ * revocation checks, any total order consistent with it would do.
+ */
+static int x509_crl_serial_cmp( const unsigned char *raw,
+                                const mbedtls_x509_crl_serial *a,
+                                const mbedtls_x509_crl_serial *b )
+{
+    if( a->len != b->len )
+        return( a->len < b->len ? -1 : 1 );
+
+    return( memcmp( raw + a->offset, raw + b->offset, a->len ) );
+}
+
+static void x509_crl_sift_down( const unsigned char *raw,
+                                mbedtls_x509_crl_serial *serials,
+                                size_t root, size_t n )
+{
+    size_t child;
+    mbedtls_x509_crl_serial tmp;
+
+    while( ( child = 2 * root + 1 ) < n )
+    {
+        if( child + 1 < n &&
+            x509_crl_serial_cmp( raw, &serials[child],
+                                 &serials[child + 1] ) < 0 )
+        {
+            child++;
+        }
+
+        if( x509_crl_serial_cmp( raw, &serials[root], &serials[child] ) >= 0 )
+            return;
+
+        tmp = serials[root];
+        serials[root] = serials[child];
+        serials[child] = tmp;
+        root = child;
+    }
+}
+
+/*
+ * Sort the index in place (heapsort: no extra memory and no recursion)
+ */
+static void x509_crl_sort_serials( mbedtls_x509_crl *crl )
+{
+    mbedtls_x509_crl_serial *serials = crl->serials;
+    mbedtls_x509_crl_serial tmp;
+    size_t i;
+
+    for( i = crl->serial_count / 2; i > 0; i-- )
+        x509_crl_sift_down( crl->raw.p, serials, i - 1, crl->serial_count );
+
+    for( i = crl->serial_count; i > 1; i-- )
+    {
+        tmp = serials[0];
+        serials[0] = serials[i - 1];
+        serials[i - 1] = tmp;
+
+        x509_crl_sift_down( crl->raw.p, serials, 0, i - 1 );
+    }
+}
+#endif /* MBEDTLS_X509_CRL_SERIAL_INDEX */
+
 /*
  * X.509 CRL Entries
+ *
+ * With compact set, every entry is parsed into the same scratch structure
+ * and only the index of serial numbers is kept.
  */
 static int x509_get_entries( unsigned char **p,
                              const unsigned char *end,
-                             mbedtls_x509_crl_entry *entry )
+                             mbedtls_x509_crl *crl, int compact )
 {
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
     size_t entry_len;
-    mbedtls_x509_crl_entry *cur_entry = entry;
+    mbedtls_x509_crl_entry *cur_entry = &crl->entry;
+#if defined(MBEDTLS_X509_CRL_SERIAL_INDEX)
+    mbedtls_x509_crl_entry scratch;
+    size_t serial_size = 0;
+    int index = 1;
+
+    if( compact )
+        cur_entry = &scratch;
+
+#if SIZE_MAX > 0xFFFFFFFF
+    /* The index stores 32-bit offsets */
+    if( crl->raw.len > 0xFFFFFFFF )
+    {
+        if( compact )
+            return( MBEDTLS_ERR_X509_FEATURE_UNAVAILABLE );
+
+        index = 0;
+    }
+#endif
+#else
+    ((void) compact);
+#endif /* MBEDTLS_X509_CRL_SERIAL_INDEX */
 
     if( *p == end )
         return( 0 );
@@ -275,6 +397,18 @@ static int x509_get_entries( unsigned char **p,
                                             &cur_entry->entry_ext ) ) != 0 )
             return( ret );
 
+#if defined(MBEDTLS_X509_CRL_SERIAL_INDEX)
+        if( index &&
+            ( ret = x509_crl_add_serial( crl, &serial_size,
+                                         &cur_entry->serial ) ) != 0 )
+        {
+            return( ret );
+        }
+
+        if( compact )
+            continue;
+#endif
+
         if( *p < end )
         {
             cur_entry->next = mbedtls_calloc( 1, sizeof( mbedtls_x509_crl_entry ) );
@@ -286,14 +420,19 @@ static int x509_get_entries( unsigned char **p,
         }
     }
 
+#if defined(MBEDTLS_X509_CRL_SERIAL_INDEX)
+    x509_crl_sort_serials( crl );
+#endif
+
     return( 0 );
 }
 
 /*
  * Parse one  CRLs in DER format and append it to the chained list
  */
-int mbedtls_x509_crl_parse_der( mbedtls_x509_crl *chain,
-                        const unsigned char *buf, size_t buflen )
+static int x509_crl_parse_der_internal( mbedtls_x509_crl *chain,
+                                        const unsigned char *buf,
+                                        size_t buflen, int compact )
 {
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
     size_t len;
@@ -462,7 +601,7 @@ int mbedtls_x509_crl_parse_der( mbedtls_x509_crl *chain,
      *                                   -- if present, MUST be v2
      *                        } OPTIONAL
      */
-    if( ( ret = x509_get_entries( &p, end, &crl->entry ) ) != 0 )
+    if( ( ret = x509_get_entries( &p, end, crl, compact ) ) != 0 )
     {
         mbedtls_x509_crl_free( crl );
         return( ret );
@@ -525,13 +664,40 @@ int mbedtls_x509_crl_parse_der( mbedtls_x509_crl *chain,
                 MBEDTLS_ERR_ASN1_LENGTH_MISMATCH );
     }
 
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+    /* Keep a digest of the whole chain on its first CRL */
+    if( ( ret = mbedtls_x509_chain_digest_update( chain->chain_digest,
+                                                  &crl->raw ) ) != 0 )
+    {
+        mbedtls_x509_crl_free( crl );
+        return( ret );
+    }
+#endif
+
     return( 0 );
 }
 
+int mbedtls_x509_crl_parse_der( mbedtls_x509_crl *chain,
+                        const unsigned char *buf, size_t buflen )
+{
+    return( x509_crl_parse_der_internal( chain, buf, buflen, 0 ) );
+}
+
+#if defined(MBEDTLS_X509_CRL_SERIAL_INDEX)
+int mbedtls_x509_crl_parse_der_compact( mbedtls_x509_crl *chain,
+                                        const unsigned char *buf,
+                                        size_t buflen )
+{
+    return( x509_crl_parse_der_internal( chain, buf, buflen, 1 ) );
+}
+#endif /* MBEDTLS_X509_CRL_SERIAL_INDEX */
+
 /*
  * Parse one or more CRLs and add them to the chained list
  */
-int mbedtls_x509_crl_parse( mbedtls_x509_crl *chain, const unsigned char *buf, size_t buflen )
+static int x509_crl_parse_internal( mbedtls_x509_crl *chain,
+                                    const unsigned char *buf, size_t buflen,
+                                    int compact )
 {
 #if defined(MBEDTLS_PEM_PARSE_C)
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
@@ -566,8 +732,8 @@ int mbedtls_x509_crl_parse( mbedtls_x509_crl *chain, const unsigned char *buf, s
             buflen -= use_len;
             buf += use_len;
 
-            if( ( ret = mbedtls_x509_crl_parse_der( chain,
-                                            pem.buf, pem.buflen ) ) != 0 )
+            if( ( ret = x509_crl_parse_der_internal( chain,
+                                            pem.buf, pem.buflen, compact ) ) != 0 )
             {
                 mbedtls_pem_free( &pem );
                 return( ret );
@@ -589,14 +755,20 @@ int mbedtls_x509_crl_parse( mbedtls_x509_crl *chain, const unsigned char *buf, s
         return( 0 );
     else
 #endif /* MBEDTLS_PEM_PARSE_C */
-        return( mbedtls_x509_crl_parse_der( chain, buf, buflen ) );
+        return( x509_crl_parse_der_internal( chain, buf, buflen, compact ) );
+}
+
+int mbedtls_x509_crl_parse( mbedtls_x509_crl *chain, const unsigned char *buf, size_t buflen )
+{
+    return( x509_crl_parse_internal( chain, buf, buflen, 0 ) );
 }
 
 #if defined(MBEDTLS_FS_IO)
 /*
  * Load one or more CRLs and add them to the chained list
  */
-int mbedtls_x509_crl_parse_file( mbedtls_x509_crl *chain, const char *path )
+static int x509_crl_parse_file_internal( mbedtls_x509_crl *chain,
+                                         const char *path, int compact )
 {
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
     size_t n;
@@ -605,13 +777,26 @@ int mbedtls_x509_crl_parse_file( mbedtls_x509_crl *chain, const char *path )
     if( ( ret = mbedtls_pk_load_file( path, &buf, &n ) ) != 0 )
         return( ret );
 
-    ret = mbedtls_x509_crl_parse( chain, buf, n );
+    ret = x509_crl_parse_internal( chain, buf, n, compact );
 
     mbedtls_platform_zeroize( buf, n );
     mbedtls_free( buf );
 
     return( ret );
 }
+
+int mbedtls_x509_crl_parse_file( mbedtls_x509_crl *chain, const char *path )
+{
+    return( x509_crl_parse_file_internal( chain, path, 0 ) );
+}
+
+#if defined(MBEDTLS_X509_CRL_SERIAL_INDEX)
+int mbedtls_x509_crl_parse_file_compact( mbedtls_x509_crl *chain,
+                                         const char *path )
+{
+    return( x509_crl_parse_file_internal( chain, path, 1 ) );
+}
+#endif /* MBEDTLS_X509_CRL_SERIAL_INDEX */
 #endif /* MBEDTLS_FS_IO */
 
 /*
@@ -619,6 +804,37 @@ int mbedtls_x509_crl_parse_file( mbedtls_x509_crl *chain, const char *path )
  */
 #define BEFORE_COLON    14
 #define BC              "14"
+/*
+ * Return an informational string about a CRL entry.
+ */
+static int x509_crl_entry_info( char *buf, size_t size, const char *prefix,
+                                const mbedtls_x509_buf *serial,
+                                const mbedtls_x509_time *revocation_date )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t n;
+    char *p;
+
+    p = buf;
+    n = size;
+
+    ret = mbedtls_snprintf( p, n, "\n%sserial number: ",
+                           prefix );
+    MBEDTLS_X509_SAFE_SNPRINTF;
+
+    ret = mbedtls_x509_serial_gets( p, n, serial );
+    MBEDTLS_X509_SAFE_SNPRINTF;
+
+    ret = mbedtls_snprintf( p, n, " revocation date: " \
+               "%04d-%02d-%02d %02d:%02d:%02d",
+               revocation_date->year, revocation_date->mon,
+               revocation_date->day,  revocation_date->hour,
+               revocation_date->min,  revocation_date->sec );
+    MBEDTLS_X509_SAFE_SNPRINTF;
+
+    return( (int) ( size - n ) );
+}
+
 /*
  * Return an informational string about the CRL.
  */
@@ -629,6 +845,9 @@ int mbedtls_x509_crl_info( char *buf, size_t size, const char *prefix,
     size_t n;
     char *p;
     const mbedtls_x509_crl_entry *entry;
+#if defined(MBEDTLS_X509_CRL_SERIAL_INDEX)
+    size_t i;
+#endif
 
     p = buf;
     n = size;
@@ -664,22 +883,36 @@ int mbedtls_x509_crl_info( char *buf, size_t size, const char *prefix,
 
     while( entry != NULL && entry->raw.len != 0 )
     {
-        ret = mbedtls_snprintf( p, n, "\n%sserial number: ",
-                               prefix );
+        ret = x509_crl_entry_info( p, n, prefix, &entry->serial,
+                                   &entry->revocation_date );
         MBEDTLS_X509_SAFE_SNPRINTF;
 
-        ret = mbedtls_x509_serial_gets( p, n, &entry->serial );
-        MBEDTLS_X509_SAFE_SNPRINTF;
+        entry = entry->next;
+    }
 
-        ret = mbedtls_snprintf( p, n, " revocation date: " \
-                   "%04d-%02d-%02d %02d:%02d:%02d",
-                   entry->revocation_date.year, entry->revocation_date.mon,
-                   entry->revocation_date.day,  entry->revocation_date.hour,
-                   entry->revocation_date.min,  entry->revocation_date.sec );
-        MBEDTLS_X509_SAFE_SNPRINTF;
+#if defined(MBEDTLS_X509_CRL_SERIAL_INDEX)
+    /* Compact CRLs only have the index, list them in serial number order */
+    for( i = 0; crl->entry.raw.len == 0 && i < crl->serial_count; i++ )
+    {
+        mbedtls_x509_buf serial;
+        mbedtls_x509_time revocation_date;
+        unsigned char *q;
+
+        serial.tag = MBEDTLS_ASN1_INTEGER;
+        serial.p = crl->raw.p + crl->serials[i].offset;
+        serial.len = crl->serials[i].len;
+
+        /* The revocation date follows the serial number */
+        q = serial.p + serial.len;
+        ret = mbedtls_x509_get_time( &q, crl->raw.p + crl->raw.len,
+                                     &revocation_date );
+        if( ret != 0 )
+            return( ret );
 
-        entry = entry->next;
+        ret = x509_crl_entry_info( p, n, prefix, &serial, &revocation_date );
+        MBEDTLS_X509_SAFE_SNPRINTF;
     }
+#endif /* MBEDTLS_X509_CRL_SERIAL_INDEX */
 
     ret = mbedtls_snprintf( p, n, "\n%ssigned using  : ", prefix );
     MBEDTLS_X509_SAFE_SNPRINTF;
@@ -742,6 +975,15 @@ void mbedtls_x509_crl_free( mbedtls_x509_crl *crl )
             mbedtls_free( entry_prv );
         }
 
+#if defined(MBEDTLS_X509_CRL_SERIAL_INDEX)
+        if( crl_cur->serials != NULL )
+        {
+            mbedtls_platform_zeroize( crl_cur->serials, crl_cur->serial_count *
+                                      sizeof( mbedtls_x509_crl_serial ) );
+            mbedtls_free( crl_cur->serials );
+        }
+#endif
+
         if( crl_cur->raw.p != NULL )
         {
             mbedtls_platform_zeroize( crl_cur->raw.p, crl_cur->raw.len );
@@ -76,6 +76,10 @@
 #include <sys/stat.h>
 #include <dirent.h>
 #endif /* !_WIN32 || EFIX64 || EFI32 */
+#if defined(MBEDTLS_X509_CRT_PARSE_PATH_DEDUP) && \
+    defined(MBEDTLS_THREADING_PTHREAD)
+#include <pthread.h>
+#endif
 #endif
 
 /*
@@ -357,6 +361,274 @@ static int x509_name_cmp( const mbedtls_x509_name *a, const mbedtls_x509_name *b
     return( 0 );
 }
 
+#if defined(MBEDTLS_X509_CA_INDEX) || defined(MBEDTLS_X509_CRT_STORE) || \
+    ( defined(MBEDTLS_FS_IO) && defined(MBEDTLS_X509_CRT_PARSE_PATH_DEDUP) )
+static uint32_t x509_hash_update( uint32_t h, const unsigned char *p,
+                                  size_t len, int fold )
+{
+    size_t i;
+    unsigned char c;
+
+    /* FNV-1a */
+    for( i = 0; i < len; i++ )
+    {
+        c = p[i];
+        if( fold && c >= 'A' && c <= 'Z' )
+            c |= 0x20;
+
+        h = ( h ^ c ) * 16777619u;
+    }
+
+    return( h );
+}
+#endif /* MBEDTLS_X509_CA_INDEX || MBEDTLS_X509_CRT_STORE ||
+          MBEDTLS_X509_CRT_PARSE_PATH_DEDUP */
+
+#if defined(MBEDTLS_X509_CA_INDEX) || defined(MBEDTLS_X509_CRT_STORE)
+/*
+ * Hash an X.509 Name so that names which x509_name_cmp() considers equal
+ * always have the same hash.
+ */
+static uint32_t x509_name_hash( const mbedtls_x509_name *name )
+{
+    uint32_t h = 2166136261u;
+    unsigned char hdr[3];
+    int fold;
+
+    for( ; name != NULL; name = name->next )
+    {
+        hdr[0] = (unsigned char) name->oid.tag;
+        hdr[1] = (unsigned char) name->oid.len;
+        h = x509_hash_update( h, hdr, 2, 0 );
+        h = x509_hash_update( h, name->oid.p, name->oid.len, 0 );
+
+        /* x509_string_cmp() mixes these two types case-insensitively */
+        fold = name->val.tag == MBEDTLS_ASN1_UTF8_STRING ||
+               name->val.tag == MBEDTLS_ASN1_PRINTABLE_STRING;
+
+        hdr[0] = fold ? MBEDTLS_ASN1_UTF8_STRING :
+                        (unsigned char) name->val.tag;
+        hdr[1] = (unsigned char) name->val.len;
+        hdr[2] = (unsigned char) name->next_merged;
+        h = x509_hash_update( h, hdr, 3, 0 );
+        h = x509_hash_update( h, name->val.p, name->val.len, fold );
+    }
+
+    return( h );
+}
+#endif /* MBEDTLS_X509_CA_INDEX || MBEDTLS_X509_CRT_STORE */
+
+#if defined(MBEDTLS_X509_CA_INDEX)
+#define X509_CRT_INDEX_NONE     ( (size_t) -1 )
+
+typedef struct
+{
+    uint32_t hash;              /* hash of the subject name         */
+    size_t next;                /* next entry in the same bucket    */
+    mbedtls_x509_crt *crt;
+} x509_crt_index_entry;
+
+struct mbedtls_x509_crt_index
+{
+    size_t mask;                /* number of buckets minus one      */
+    size_t *buckets;            /* first entry of each bucket       */
+    x509_crt_index_entry *entries;
+};
+
+static void x509_crt_index_free( mbedtls_x509_crt *crt )
+{
+    if( crt->ca_index == NULL )
+        return;
+
+    mbedtls_free( crt->ca_index->buckets );
+    mbedtls_free( crt->ca_index->entries );
+    mbedtls_free( crt->ca_index );
+    crt->ca_index = NULL;
+}
+
+/*
+ * Build the index of a chain. The subject name hash of the i-th certificate
+ * is hashes[i] if hashes is not NULL, otherwise it is computed.
+ */
+static int x509_crt_build_index_hashes( mbedtls_x509_crt *chain,
+                                        const uint32_t *hashes )
+{
+    mbedtls_x509_crt_index *idx;
+    mbedtls_x509_crt *cur;
+    size_t n, i, nb;
+
+    if( chain == NULL || chain->ca_index != NULL )
+        return( 0 );
+
+    for( n = 0, cur = chain; cur != NULL; cur = cur->next )
+        n++;
+
+    for( nb = 1; nb < n; nb <<= 1 )
+        ;
+
+    idx = mbedtls_calloc( 1, sizeof( mbedtls_x509_crt_index ) );
+    if( idx == NULL )
+        return( MBEDTLS_ERR_X509_ALLOC_FAILED );
+
+    idx->mask = nb - 1;
+    idx->buckets = mbedtls_calloc( nb, sizeof( size_t ) );
+    idx->entries = mbedtls_calloc( n, sizeof( x509_crt_index_entry ) );
+    if( idx->buckets == NULL || idx->entries == NULL )
+    {
+        mbedtls_free( idx->buckets );
+        mbedtls_free( idx->entries );
+        mbedtls_free( idx );
+        return( MBEDTLS_ERR_X509_ALLOC_FAILED );
+    }
+
+    for( i = 0; i < nb; i++ )
+        idx->buckets[i] = X509_CRT_INDEX_NONE;
+
+    for( i = 0, cur = chain; cur != NULL; i++, cur = cur->next )
+    {
+        if( hashes != NULL )
+        {
+            idx->entries[i].hash = hashes[i];
+        }
+        else
+        {
+#if defined(MBEDTLS_X509_CRT_FRAME_PARSING)
+            /* Entries that fail to decode are skipped by lookups */
+            (void) mbedtls_x509_crt_frame_decode( cur );
+#endif
+            idx->entries[i].hash = x509_name_hash( &cur->subject );
+        }
+        idx->entries[i].crt = cur;
+    }
+
+    /* Insert in reverse so that each bucket keeps the order of the chain */
+    for( i = n; i-- > 0; )
+    {
+        size_t b = idx->entries[i].hash & idx->mask;
+
+        idx->entries[i].next = idx->buckets[b];
+        idx->buckets[b] = i;
+    }
+
+    chain->ca_index = idx;
+
+    return( 0 );
+}
+
+int mbedtls_x509_crt_build_index( mbedtls_x509_crt *chain )
+{
+    return( x509_crt_build_index_hashes( chain, NULL ) );
+}
+
+/*
+ * Return 1 if parent's subjectKeyIdentifier matches the keyIdentifier in
+ * child's authorityKeyIdentifier, 0 otherwise (including when either is
+ * absent).
+ */
+static int x509_crt_key_id_match( const mbedtls_x509_crt *child,
+                                  const mbedtls_x509_crt *parent )
+{
+    return( child->authority_key_id.len != 0 &&
+            child->authority_key_id.len == parent->subject_key_id.len &&
+            memcmp( child->authority_key_id.p, parent->subject_key_id.p,
+                    parent->subject_key_id.len ) == 0 );
+}
+
+/*
+ * Return the indexed certificate following cur (or the first one if cur is
+ * NULL) whose subject hashes to the given value. Certificates whose key
+ * identifier matches the child's are returned first, then the others, each
+ * group in chain order.
+ *
+ * The position is recomputed from cur so that no iteration state needs to
+ * be kept, which keeps restartable verification working unchanged.
+ */
+static mbedtls_x509_crt *x509_crt_index_next(
+                        const mbedtls_x509_crt_index *idx,
+                        const mbedtls_x509_crt *child,
+                        uint32_t hash,
+                        const mbedtls_x509_crt *cur )
+{
+    const size_t head = idx->buckets[hash & idx->mask];
+    size_t i = head;
+    int want_match = 1;
+
+    if( cur != NULL )
+    {
+        while( i != X509_CRT_INDEX_NONE && idx->entries[i].crt != cur )
+            i = idx->entries[i].next;
+
+        if( i == X509_CRT_INDEX_NONE )
+            return( NULL );
+
+        want_match = x509_crt_key_id_match( child, cur );
+        i = idx->entries[i].next;
+    }
+
+    while( 1 )
+    {
+        for( ; i != X509_CRT_INDEX_NONE; i = idx->entries[i].next )
+        {
+            if( idx->entries[i].hash != hash )
+                continue;
+
+#if defined(MBEDTLS_X509_CRT_FRAME_PARSING)
+            /* The key identifier of an index built from the hashes of a
+             * trust store is only known once decoded */
+            (void) mbedtls_x509_crt_frame_decode( idx->entries[i].crt );
+#endif
+
+            if( x509_crt_key_id_match( child, idx->entries[i].crt ) ==
+                    want_match )
+            {
+                return( idx->entries[i].crt );
+            }
+        }
+
+        if( ! want_match )
+            return( NULL );
+
+        want_match = 0;
+        i = head;
+    }
+}
+#endif /* MBEDTLS_X509_CA_INDEX */
+
+/*
+ * Return the candidate parent following cur in candidates, or the first one
+ * if cur is NULL.
+ */
+static mbedtls_x509_crt *x509_crt_next_candidate(
+                        const mbedtls_x509_crt *child,
+                        mbedtls_x509_crt *candidates,
+                        uint32_t issuer_hash,
+                        mbedtls_x509_crt *cur )
+{
+#if !defined(MBEDTLS_X509_CA_INDEX)
+    (void) child;
+    (void) issuer_hash;
+#endif
+
+    do
+    {
+#if defined(MBEDTLS_X509_CA_INDEX)
+        if( candidates != NULL && candidates->ca_index != NULL )
+            cur = x509_crt_index_next( candidates->ca_index, child,
+                                       issuer_hash, cur );
+        else
+#endif
+            cur = ( cur == NULL ) ? candidates : cur->next;
+    }
+#if defined(MBEDTLS_X509_CRT_FRAME_PARSING)
+    /* Decode candidates on first use, and skip those that can't be */
+    while( cur != NULL && mbedtls_x509_crt_frame_decode( cur ) != 0 );
+#else
+    while( 0 );
+#endif
+
+    return( cur );
+}
+
 /*
  * Reset (init or clear) a verify_chain
  */
@@ -880,6 +1152,60 @@ static int x509_get_certificate_policies( unsigned char **p,
  * X.509 v3 extensions
  *
  */
+#if defined(MBEDTLS_X509_CA_INDEX)
+/*
+ * Record the key identifiers used by the trusted CA index. These extensions
+ * are otherwise ignored, so malformed values are skipped rather than changing
+ * which certificates are accepted.
+ *
+ * SubjectKeyIdentifier ::= KeyIdentifier
+ *
+ * AuthorityKeyIdentifier ::= SEQUENCE {
+ *      keyIdentifier             [0] KeyIdentifier           OPTIONAL,
+ *      authorityCertIssuer       [1] GeneralNames            OPTIONAL,
+ *      authorityCertSerialNumber [2] CertificateSerialNumber OPTIONAL  }
+ *
+ * KeyIdentifier ::= OCTET STRING
+ */
+static void x509_get_key_id( const mbedtls_x509_buf *extn_oid,
+                             unsigned char *p,
+                             const unsigned char *end,
+                             mbedtls_x509_crt *crt )
+{
+    size_t len;
+    mbedtls_x509_buf *key_id;
+
+    if( MBEDTLS_OID_CMP( MBEDTLS_OID_SUBJECT_KEY_IDENTIFIER, extn_oid ) == 0 )
+    {
+        key_id = &crt->subject_key_id;
+
+        if( mbedtls_asn1_get_tag( &p, end, &len,
+                                  MBEDTLS_ASN1_OCTET_STRING ) != 0 )
+            return;
+    }
+    else if( MBEDTLS_OID_CMP( MBEDTLS_OID_AUTHORITY_KEY_IDENTIFIER,
+                              extn_oid ) == 0 )
+    {
+        key_id = &crt->authority_key_id;
+
+        if( mbedtls_asn1_get_tag( &p, end, &len,
+                MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE ) != 0 ||
+            mbedtls_asn1_get_tag( &p, p + len, &len,
+                                  MBEDTLS_ASN1_CONTEXT_SPECIFIC | 0 ) != 0 )
+            return;
+    }
+    else
+        return;
+
+    if( len == 0 )
+        return;
+
+    key_id->tag = MBEDTLS_ASN1_OCTET_STRING;
+    key_id->len = len;
+    key_id->p = p;
+}
+#endif /* MBEDTLS_X509_CA_INDEX */
+
 static int x509_get_crt_ext( unsigned char **p,
                              const unsigned char *end,
                              mbedtls_x509_crt *crt,
@@ -948,6 +1274,10 @@ static int x509_get_crt_ext( unsigned char **p,
 
         if( ret != 0 )
         {
+#if defined(MBEDTLS_X509_CA_INDEX)
+            x509_get_key_id( &extn_oid, *p, end_ext_octet, crt );
+#endif
+
             /* Give the callback (if any) a chance to handle the extension */
             if( cb != NULL )
             {
@@ -1065,6 +1395,28 @@ static int x509_get_crt_ext( unsigned char **p,
     return( 0 );
 }
 
+#if defined(MBEDTLS_X509_CRT_FRAME_PARSING)
+/*
+ * Locate the extensions without decoding them
+ */
+static int x509_crt_skip_ext( unsigned char **p,
+                              const unsigned char *end,
+                              mbedtls_x509_crt *crt )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+
+    if( *p == end )
+        return( 0 );
+
+    if( ( ret = mbedtls_x509_get_ext( p, end, &crt->v3_ext, 3 ) ) != 0 )
+        return( ret );
+
+    *p = crt->v3_ext.p + crt->v3_ext.len;
+
+    return( 0 );
+}
+#endif /* MBEDTLS_X509_CRT_FRAME_PARSING */
+
 /*
  * Parse and fill a single X.509 certificate in DER format
  */
@@ -1072,6 +1424,7 @@ static int x509_crt_parse_der_core( mbedtls_x509_crt *crt,
                                     const unsigned char *buf,
                                     size_t buflen,
                                     int make_copy,
+                                    int frame,
                                     mbedtls_x509_crt_ext_cb_t cb,
                                     void *p_ctx )
 {
@@ -1084,6 +1437,10 @@ static int x509_crt_parse_der_core( mbedtls_x509_crt *crt,
     memset( &sig_params2, 0, sizeof( mbedtls_x509_buf ) );
     memset( &sig_oid2, 0, sizeof( mbedtls_x509_buf ) );
 
+#if !defined(MBEDTLS_X509_CRT_FRAME_PARSING)
+    (void) frame;
+#endif
+
     /*
      * Check for valid input
      */
@@ -1188,6 +1545,11 @@ static int x509_crt_parse_der_core( mbedtls_x509_crt *crt,
         return( MBEDTLS_ERR_X509_INVALID_FORMAT + ret );
     }
 
+#if defined(MBEDTLS_X509_CRT_FRAME_PARSING)
+    if( frame )
+        p += len;
+    else
+#endif
     if( ( ret = mbedtls_x509_get_name( &p, p + len, &crt->issuer ) ) != 0 )
     {
         mbedtls_x509_crt_free( crt );
@@ -1221,6 +1583,11 @@ static int x509_crt_parse_der_core( mbedtls_x509_crt *crt,
         return( MBEDTLS_ERR_X509_INVALID_FORMAT + ret );
     }
 
+#if defined(MBEDTLS_X509_CRT_FRAME_PARSING)
+    if( frame )
+        p += len;
+    else
+#endif
     if( len && ( ret = mbedtls_x509_get_name( &p, p + len, &crt->subject ) ) != 0 )
     {
         mbedtls_x509_crt_free( crt );
@@ -1272,6 +1639,11 @@ static int x509_crt_parse_der_core( mbedtls_x509_crt *crt,
     if( crt->version == 3 )
 #endif
     {
+#if defined(MBEDTLS_X509_CRT_FRAME_PARSING)
+        if( frame )
+            ret = x509_crt_skip_ext( &p, end, crt );
+        else
+#endif
         ret = x509_get_crt_ext( &p, end, crt, cb, p_ctx );
         if( ret != 0 )
         {
@@ -1328,26 +1700,125 @@ static int x509_crt_parse_der_core( mbedtls_x509_crt *crt,
     return( 0 );
 }
 
+#if defined(MBEDTLS_X509_CRT_FRAME_PARSING)
+/*
+ * Decode the names and extensions that x509_crt_parse_der_core() only
+ * located when called with frame set
+ */
+static int x509_crt_frame_decode_fields( mbedtls_x509_crt *crt )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t len;
+    unsigned char *p, *end;
+
+    /*
+     * issuer               Name
+     */
+    p = crt->issuer_raw.p;
+    end = p + crt->issuer_raw.len;
+
+    if( ( ret = mbedtls_asn1_get_tag( &p, end, &len,
+            MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE ) ) != 0 )
+        return( MBEDTLS_ERR_X509_INVALID_FORMAT + ret );
+
+    if( ( ret = mbedtls_x509_get_name( &p, end, &crt->issuer ) ) != 0 )
+        return( ret );
+
+    /*
+     * subject              Name
+     */
+    p = crt->subject_raw.p;
+    end = p + crt->subject_raw.len;
+
+    if( ( ret = mbedtls_asn1_get_tag( &p, end, &len,
+            MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE ) ) != 0 )
+        return( MBEDTLS_ERR_X509_INVALID_FORMAT + ret );
+
+    if( len && ( ret = mbedtls_x509_get_name( &p, end, &crt->subject ) ) != 0 )
+        return( ret );
+
+    /*
+     * The extensions follow the public key and the unique identifiers,
+     * which were already parsed and are just skipped again here.
+     */
+    p = crt->pk_raw.p + crt->pk_raw.len;
+    end = crt->tbs.p + crt->tbs.len;
+
+    if( crt->version == 2 || crt->version == 3 )
+    {
+        if( ( ret = x509_get_uid( &p, end, &crt->issuer_id,  1 ) ) != 0 ||
+            ( ret = x509_get_uid( &p, end, &crt->subject_id,  2 ) ) != 0 )
+            return( ret );
+    }
+
+#if !defined(MBEDTLS_X509_ALLOW_EXTENSIONS_NON_V3)
+    if( crt->version == 3 )
+#endif
+    {
+        if( ( ret = x509_get_crt_ext( &p, end, crt, NULL, NULL ) ) != 0 )
+            return( ret );
+    }
+
+    return( 0 );
+}
+
+int mbedtls_x509_crt_frame_decode( mbedtls_x509_crt *crt )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+
+    if( crt == NULL )
+        return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+
+    /* Set at parse time and never changed: safe to read without the lock */
+    if( crt->frame == 0 )
+        return( 0 );
+
+#if defined(MBEDTLS_THREADING_C)
+    if( ( ret = mbedtls_mutex_lock( &mbedtls_threading_x509_crt_frame_mutex ) ) != 0 )
+        return( ret );
+#endif
+
+    if( crt->frame_state == 1 )
+        crt->frame_state = x509_crt_frame_decode_fields( crt );
+
+    ret = crt->frame_state;
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_unlock( &mbedtls_threading_x509_crt_frame_mutex ) != 0 )
+        return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+#endif
+
+    return( ret );
+}
+#endif /* MBEDTLS_X509_CRT_FRAME_PARSING */
+
 /*
  * Parse one X.509 certificate in DER format from a buffer and add them to a
- * chained list
+ * chained list, looking for its end from the given certificate of the chain
  */
-static int mbedtls_x509_crt_parse_der_internal( mbedtls_x509_crt *chain,
-                                                const unsigned char *buf,
-                                                size_t buflen,
-                                                int make_copy,
-                                                mbedtls_x509_crt_ext_cb_t cb,
-                                                void *p_ctx )
+static int x509_crt_parse_der_from( mbedtls_x509_crt *chain,
+                                    mbedtls_x509_crt *crt,
+                                    const unsigned char *buf,
+                                    size_t buflen,
+                                    int make_copy,
+                                    int frame,
+                                    mbedtls_x509_crt_ext_cb_t cb,
+                                    void *p_ctx )
 {
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
-    mbedtls_x509_crt *crt = chain, *prev = NULL;
+    mbedtls_x509_crt *prev = NULL;
 
     /*
      * Check for valid input
      */
-    if( crt == NULL || buf == NULL )
+    if( chain == NULL || crt == NULL || buf == NULL )
         return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
 
+#if defined(MBEDTLS_X509_CA_INDEX)
+    /* The index no longer covers the whole chain */
+    x509_crt_index_free( chain );
+#endif
+
     while( crt->version != 0 && crt->next != NULL )
     {
         prev = crt;
@@ -1369,7 +1840,27 @@ static int mbedtls_x509_crt_parse_der_internal( mbedtls_x509_crt *chain,
         crt = crt->next;
     }
 
-    ret = x509_crt_parse_der_core( crt, buf, buflen, make_copy, cb, p_ctx );
+    ret = x509_crt_parse_der_core( crt, buf, buflen, make_copy, frame,
+                                   cb, p_ctx );
+
+#if defined(MBEDTLS_X509_CRT_FRAME_PARSING)
+    if( ret == 0 && frame )
+    {
+        crt->frame = 1;
+        crt->frame_state = 1;
+    }
+#endif
+
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+    /* Keep a digest of the whole chain on its first certificate */
+    if( ret == 0 &&
+        ( ret = mbedtls_x509_chain_digest_update( chain->chain_digest,
+                                                  &crt->raw ) ) != 0 )
+    {
+        mbedtls_x509_crt_free( crt );
+    }
+#endif
+
     if( ret != 0 )
     {
         if( prev )
@@ -1384,13 +1875,35 @@ static int mbedtls_x509_crt_parse_der_internal( mbedtls_x509_crt *chain,
     return( 0 );
 }
 
+static int mbedtls_x509_crt_parse_der_internal( mbedtls_x509_crt *chain,
+                                                const unsigned char *buf,
+                                                size_t buflen,
+                                                int make_copy,
+                                                int frame,
+                                                mbedtls_x509_crt_ext_cb_t cb,
+                                                void *p_ctx )
+{
+    return( x509_crt_parse_der_from( chain, chain, buf, buflen, make_copy,
+                                     frame, cb, p_ctx ) );
+}
+
 int mbedtls_x509_crt_parse_der_nocopy( mbedtls_x509_crt *chain,
                                        const unsigned char *buf,
                                        size_t buflen )
 {
-    return( mbedtls_x509_crt_parse_der_internal( chain, buf, buflen, 0, NULL, NULL ) );
+    return( mbedtls_x509_crt_parse_der_internal( chain, buf, buflen, 0, 0, NULL, NULL ) );
 }
 
+#if defined(MBEDTLS_X509_CRT_FRAME_PARSING)
+int mbedtls_x509_crt_parse_der_frame( mbedtls_x509_crt *chain,
+                                      const unsigned char *buf,
+                                      size_t buflen,
+                                      int make_copy )
+{
+    return( mbedtls_x509_crt_parse_der_internal( chain, buf, buflen, make_copy, 1, NULL, NULL ) );
+}
+#endif /* MBEDTLS_X509_CRT_FRAME_PARSING */
+
 int mbedtls_x509_crt_parse_der_with_ext_cb( mbedtls_x509_crt *chain,
                                             const unsigned char *buf,
                                             size_t buflen,
@@ -1398,15 +1911,273 @@ int mbedtls_x509_crt_parse_der_with_ext_cb( mbedtls_x509_crt *chain,
                                             mbedtls_x509_crt_ext_cb_t cb,
                                             void *p_ctx )
 {
-    return( mbedtls_x509_crt_parse_der_internal( chain, buf, buflen, make_copy, cb, p_ctx ) );
+    return( mbedtls_x509_crt_parse_der_internal( chain, buf, buflen, make_copy, 0, cb, p_ctx ) );
 }
 
 int mbedtls_x509_crt_parse_der( mbedtls_x509_crt *chain,
                                 const unsigned char *buf,
                                 size_t buflen )
 {
-    return( mbedtls_x509_crt_parse_der_internal( chain, buf, buflen, 1, NULL, NULL ) );
+    return( mbedtls_x509_crt_parse_der_internal( chain, buf, buflen, 1, 0, NULL, NULL ) );
+}
+
+#if defined(MBEDTLS_X509_CRT_STORE)
+#define X509_CRT_STORE_MAGIC    "MTS1"
+
+static uint32_t x509_crt_store_get32( const unsigned char *p )
+{
+    return( ( (uint32_t) p[0] << 24 ) | ( (uint32_t) p[1] << 16 ) |
+            ( (uint32_t) p[2] <<  8 ) | ( (uint32_t) p[3]       ) );
+}
+
+static void x509_crt_store_put32( unsigned char *p, uint32_t n )
+{
+    p[0] = (unsigned char)( n >> 24 );
+    p[1] = (unsigned char)( n >> 16 );
+    p[2] = (unsigned char)( n >>  8 );
+    p[3] = (unsigned char)( n       );
+}
+
+int mbedtls_x509_crt_store_write( const mbedtls_x509_crt *chain,
+                                  unsigned char *buf, size_t size,
+                                  size_t *olen )
+{
+#if defined(MBEDTLS_X509_CRT_FRAME_PARSING)
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+#endif
+    const mbedtls_x509_crt *cur;
+    size_t count = 0, len = MBEDTLS_X509_CRT_STORE_HEADER_LEN, off, bits;
+    unsigned char *p;
+
+    if( chain == NULL || olen == NULL )
+        return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+
+    /* Offsets and lengths are 32 bits */
+    for( cur = chain; cur != NULL; cur = cur->next )
+    {
+        if( cur->version == 0 )
+            continue;
+
+        if( cur->raw.len > 0xFFFFFFFF - MBEDTLS_X509_CRT_STORE_ENTRY_LEN ||
+            len > 0xFFFFFFFF - MBEDTLS_X509_CRT_STORE_ENTRY_LEN -
+                  cur->raw.len )
+        {
+            return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+        }
+
+        len += MBEDTLS_X509_CRT_STORE_ENTRY_LEN + cur->raw.len;
+        count++;
+    }
+
+    if( count == 0 )
+        return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+
+    *olen = len;
+    if( buf == NULL || size < len )
+        return( MBEDTLS_ERR_X509_BUFFER_TOO_SMALL );
+
+    memcpy( buf, X509_CRT_STORE_MAGIC, 4 );
+    x509_crt_store_put32( buf + 4, (uint32_t) count );
+    x509_crt_store_put32( buf + 8, (uint32_t) len );
+    x509_crt_store_put32( buf + 12, MBEDTLS_X509_CRT_STORE_VERSION );
+
+    p = buf + MBEDTLS_X509_CRT_STORE_HEADER_LEN;
+    off = MBEDTLS_X509_CRT_STORE_HEADER_LEN +
+          count * MBEDTLS_X509_CRT_STORE_ENTRY_LEN;
+
+    for( cur = chain; cur != NULL; cur = cur->next )
+    {
+        if( cur->version == 0 )
+            continue;
+
+#if defined(MBEDTLS_X509_CRT_FRAME_PARSING)
+        if( ( ret = mbedtls_x509_crt_frame_decode(
+                        (mbedtls_x509_crt *) cur ) ) != 0 )
+            return( ret );
+#endif
+
+        bits = mbedtls_pk_get_bitlen( &cur->pk );
+        if( bits > 0xFFFF )
+            bits = 0xFFFF;
+
+        x509_crt_store_put32( p, (uint32_t) off );
+        x509_crt_store_put32( p + 4, (uint32_t) cur->raw.len );
+        x509_crt_store_put32( p + 8, x509_name_hash( &cur->subject ) );
+        p[12] = (unsigned char) mbedtls_pk_get_type( &cur->pk );
+        p[13] = cur->ca_istrue ? MBEDTLS_X509_CRT_STORE_FLAG_CA : 0;
+        p[14] = (unsigned char)( bits >> 8 );
+        p[15] = (unsigned char)( bits      );
+
+        memcpy( buf + off, cur->raw.p, cur->raw.len );
+
+        p += MBEDTLS_X509_CRT_STORE_ENTRY_LEN;
+        off += cur->raw.len;
+    }
+
+    return( 0 );
+}
+
+/*
+ * Check the header of a trust store, and get its number of entries and the
+ * length that the store says it has. A store written with another layout
+ * or subject name hash is rejected.
+ */
+static int x509_crt_store_header( const unsigned char *buf, size_t buflen,
+                                  size_t *count, size_t *len )
+{
+    if( buf == NULL || buflen < MBEDTLS_X509_CRT_STORE_HEADER_LEN ||
+        memcmp( buf, X509_CRT_STORE_MAGIC, 4 ) != 0 ||
+        x509_crt_store_get32( buf + 12 ) != MBEDTLS_X509_CRT_STORE_VERSION )
+    {
+        return( MBEDTLS_ERR_X509_INVALID_FORMAT );
+    }
+
+    *count = x509_crt_store_get32( buf + 4 );
+    *len = x509_crt_store_get32( buf + 8 );
+
+    if( *len > buflen || *len < MBEDTLS_X509_CRT_STORE_HEADER_LEN ||
+        *count > ( *len - MBEDTLS_X509_CRT_STORE_HEADER_LEN ) /
+                 MBEDTLS_X509_CRT_STORE_ENTRY_LEN )
+    {
+        return( MBEDTLS_ERR_X509_INVALID_FORMAT );
+    }
+
+    return( 0 );
+}
+
+int mbedtls_x509_crt_store_get( const unsigned char *buf, size_t buflen,
+                                size_t idx,
+                                mbedtls_x509_crt_store_entry *entry )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t count, len, off, der_len;
+    const unsigned char *p;
+
+    if( entry == NULL )
+        return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+
+    if( ( ret = x509_crt_store_header( buf, buflen, &count, &len ) ) != 0 )
+        return( ret );
+
+    if( idx >= count )
+        return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+
+    p = buf + MBEDTLS_X509_CRT_STORE_HEADER_LEN +
+        idx * MBEDTLS_X509_CRT_STORE_ENTRY_LEN;
+    off = x509_crt_store_get32( p );
+    der_len = x509_crt_store_get32( p + 4 );
+
+    /* The certificates come after the table of entries */
+    if( off < MBEDTLS_X509_CRT_STORE_HEADER_LEN +
+              count * MBEDTLS_X509_CRT_STORE_ENTRY_LEN ||
+        off > len || der_len > len - off )
+    {
+        return( MBEDTLS_ERR_X509_INVALID_FORMAT );
+    }
+
+    entry->der = buf + off;
+    entry->der_len = der_len;
+    entry->subject_hash = x509_crt_store_get32( p + 8 );
+    entry->pk_type = (mbedtls_pk_type_t) p[12];
+    entry->ca_istrue = ( p[13] & MBEDTLS_X509_CRT_STORE_FLAG_CA ) != 0;
+    entry->pk_bits = ( (size_t) p[14] << 8 ) | p[15];
+
+    return( 0 );
+}
+
+int mbedtls_x509_crt_store_check( const unsigned char *buf, size_t buflen,
+                                  size_t *count )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_x509_crt_store_entry entry;
+    size_t i, n, len;
+
+    if( count == NULL )
+        return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+
+    if( ( ret = x509_crt_store_header( buf, buflen, &n, &len ) ) != 0 )
+        return( ret );
+
+    for( i = 0; i < n; i++ )
+        if( ( ret = mbedtls_x509_crt_store_get( buf, buflen, i,
+                                                &entry ) ) != 0 )
+            return( ret );
+
+    *count = n;
+
+    return( 0 );
+}
+
+int mbedtls_x509_crt_parse_store( mbedtls_x509_crt *chain,
+                                  const unsigned char *buf, size_t buflen )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_x509_crt_store_entry entry;
+    mbedtls_x509_crt *tail;
+    size_t i, count;
+#if defined(MBEDTLS_X509_CRT_FRAME_PARSING)
+    const int frame = 1;
+#else
+    const int frame = 0;
+#endif
+#if defined(MBEDTLS_X509_CA_INDEX)
+    uint32_t *hashes = NULL;
+#endif
+
+    if( chain == NULL )
+        return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+
+    if( ( ret = mbedtls_x509_crt_store_check( buf, buflen, &count ) ) != 0 )
+        return( ret );
+
+    if( count == 0 )
+        return( 0 );
+
+#if defined(MBEDTLS_X509_CA_INDEX)
+    /* Only an index of the whole chain can be built from the store */
+    if( chain->version == 0 )
+    {
+        hashes = mbedtls_calloc( count, sizeof( uint32_t ) );
+        if( hashes == NULL )
+            return( MBEDTLS_ERR_X509_ALLOC_FAILED );
+    }
+#endif
+
+    /* Append from the last certificate, not from the start every time */
+    for( tail = chain; tail->next != NULL; tail = tail->next )
+        ;
+
+    for( i = 0; i < count; i++ )
+    {
+        (void) mbedtls_x509_crt_store_get( buf, buflen, i, &entry );
+
+        if( ( ret = x509_crt_parse_der_from( chain, tail, entry.der,
+                                             entry.der_len, 0, frame,
+                                             NULL, NULL ) ) != 0 )
+            goto cleanup;
+
+        if( tail->next != NULL )
+            tail = tail->next;
+
+#if defined(MBEDTLS_X509_CA_INDEX)
+        if( hashes != NULL )
+            hashes[i] = entry.subject_hash;
+#endif
+    }
+
+#if defined(MBEDTLS_X509_CA_INDEX)
+    if( hashes != NULL )
+        ret = x509_crt_build_index_hashes( chain, hashes );
+#endif
+
+cleanup:
+#if defined(MBEDTLS_X509_CA_INDEX)
+    mbedtls_free( hashes );
+#endif
+
+    return( ret );
 }
+#endif /* MBEDTLS_X509_CRT_STORE */
 
 /*
  * Parse one or more PEM certificates from a buffer and add them to the chained
@@ -1478,75 +2249,340 @@ int mbedtls_x509_crt_parse( mbedtls_x509_crt *chain,
             {
                 mbedtls_pem_free( &pem );
 
-                /*
-                 * PEM header and footer were found
-                 */
-                buflen -= use_len;
-                buf += use_len;
+                /*
+                 * PEM header and footer were found
+                 */
+                buflen -= use_len;
+                buf += use_len;
+
+                if( first_error == 0 )
+                    first_error = ret;
+
+                total_failed++;
+                continue;
+            }
+            else
+                break;
+
+            ret = mbedtls_x509_crt_parse_der( chain, pem.buf, pem.buflen );
+
+            mbedtls_pem_free( &pem );
+
+            if( ret != 0 )
+            {
+                /*
+                 * Quit parsing on a memory error
+                 */
+                if( ret == MBEDTLS_ERR_X509_ALLOC_FAILED )
+                    return( ret );
+
+                if( first_error == 0 )
+                    first_error = ret;
+
+                total_failed++;
+                continue;
+            }
+
+            success = 1;
+        }
+    }
+
+    if( success )
+        return( total_failed );
+    else if( first_error )
+        return( first_error );
+    else
+        return( MBEDTLS_ERR_X509_CERT_UNKNOWN_FORMAT );
+#endif /* MBEDTLS_PEM_PARSE_C */
+}
+
+#if defined(MBEDTLS_FS_IO)
+/*
+ * Load one or more certificates and add them to the chained list
+ */
+int mbedtls_x509_crt_parse_file( mbedtls_x509_crt *chain, const char *path )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t n;
+    unsigned char *buf;
+
+    if( ( ret = mbedtls_pk_load_file( path, &buf, &n ) ) != 0 )
+        return( ret );
+
+    ret = mbedtls_x509_crt_parse( chain, buf, n );
+
+    mbedtls_platform_zeroize( buf, n );
+    mbedtls_free( buf );
+
+    return( ret );
+}
+
+int mbedtls_x509_crt_parse_path( mbedtls_x509_crt *chain, const char *path )
+{
+    int ret = 0;
+#if defined(_WIN32) && !defined(EFIX64) && !defined(EFI32)
+    int w_ret;
+    WCHAR szDir[MAX_PATH];
+    char filename[MAX_PATH];
+    char *p;
+    size_t len = strlen( path );
+
+    WIN32_FIND_DATAW file_data;
+    HANDLE hFind;
+
+    if( len > MAX_PATH - 3 )
+        return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+
+    memset( szDir, 0, sizeof(szDir) );
+    memset( filename, 0, MAX_PATH );
+    memcpy( filename, path, len );
+    filename[len++] = '\\';
+    p = filename + len;
+    filename[len++] = '*';
+
+    w_ret = MultiByteToWideChar( CP_ACP, 0, filename, (int)len, szDir,
+                                 MAX_PATH - 3 );
+    if( w_ret == 0 )
+        return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+
+    hFind = FindFirstFileW( szDir, &file_data );
+    if( hFind == INVALID_HANDLE_VALUE )
+        return( MBEDTLS_ERR_X509_FILE_IO_ERROR );
+
+    len = MAX_PATH - len;
+    do
+    {
+        memset( p, 0, len );
+
+        if( file_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY )
+            continue;
+
+        w_ret = WideCharToMultiByte( CP_ACP, 0, file_data.cFileName,
+                                     lstrlenW( file_data.cFileName ),
+                                     p, (int) len - 1,
+                                     NULL, NULL );
+        if( w_ret == 0 )
+        {
+            ret = MBEDTLS_ERR_X509_FILE_IO_ERROR;
+            goto cleanup;
+        }
+
+        w_ret = mbedtls_x509_crt_parse_file( chain, filename );
+        if( w_ret < 0 )
+            ret++;
+        else
+            ret += w_ret;
+    }
+    while( FindNextFileW( hFind, &file_data ) != 0 );
+
+    if( GetLastError() != ERROR_NO_MORE_FILES )
+        ret = MBEDTLS_ERR_X509_FILE_IO_ERROR;
+
+cleanup:
+    FindClose( hFind );
+#else /* _WIN32 */
+    int t_ret;
+    int snp_ret;
+    struct stat sb;
+    struct dirent *entry;
+    char entry_name[MBEDTLS_X509_MAX_FILE_PATH_LEN];
+    DIR *dir = opendir( path );
+
+    if( dir == NULL )
+        return( MBEDTLS_ERR_X509_FILE_IO_ERROR );
+
+#if defined(MBEDTLS_THREADING_C)
+    if( ( ret = mbedtls_mutex_lock( &mbedtls_threading_readdir_mutex ) ) != 0 )
+    {
+        closedir( dir );
+        return( ret );
+    }
+#endif /* MBEDTLS_THREADING_C */
+
+    while( ( entry = readdir( dir ) ) != NULL )
+    {
+        snp_ret = mbedtls_snprintf( entry_name, sizeof entry_name,
+                                    "%s/%s", path, entry->d_name );
+
+        if( snp_ret < 0 || (size_t)snp_ret >= sizeof entry_name )
+        {
+            ret = MBEDTLS_ERR_X509_BUFFER_TOO_SMALL;
+            goto cleanup;
+        }
+        else if( stat( entry_name, &sb ) == -1 )
+        {
+            ret = MBEDTLS_ERR_X509_FILE_IO_ERROR;
+            goto cleanup;
+        }
+
+        if( !S_ISREG( sb.st_mode ) )
+            continue;
+
+        // Ignore parse errors
+        //
+        t_ret = mbedtls_x509_crt_parse_file( chain, entry_name );
+        if( t_ret < 0 )
+            ret++;
+        else
+            ret += t_ret;
+    }
+
+cleanup:
+    closedir( dir );
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_unlock( &mbedtls_threading_readdir_mutex ) != 0 )
+        ret = MBEDTLS_ERR_THREADING_MUTEX_ERROR;
+#endif /* MBEDTLS_THREADING_C */
+
+#endif /* _WIN32 */
+
+    return( ret );
+}
+
+#if defined(MBEDTLS_X509_CRT_PARSE_PATH_DEDUP)
+/*
+ * A certificate file found by mbedtls_x509_crt_parse_path_dedup()
+ */
+typedef struct
+{
+    char *name;                 /* path of the file                 */
+#if !defined(_WIN32) || defined(EFIX64) || defined(EFI32)
+    dev_t dev;                  /* identity of the file, shared by  */
+    ino_t ino;                  /* all the links to it              */
+#endif
+} x509_crt_path_file;
+
+typedef struct
+{
+    x509_crt_path_file *files;
+    size_t count;
+    size_t size;                /* number of allocated files        */
+    size_t next;                /* next file to be parsed           */
+    mbedtls_x509_crt *crts;     /* certificates parsed from a file  */
+    int *rets;                  /* result of parsing each file      */
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_threading_mutex_t mutex;
+#endif
+} x509_crt_path_load;
+
+#if defined(MBEDTLS_THREADING_C)
+/*
+ * Result of a file that no worker got to parse
+ */
+#define X509_CRT_PATH_NOT_PARSED    MBEDTLS_ERR_THREADING_MUTEX_ERROR
+#endif
+
+static int x509_crt_path_add( x509_crt_path_load *load,
+                              const char *name, size_t len )
+{
+    x509_crt_path_file *files;
+    size_t size;
+
+    if( load->count == load->size )
+    {
+        size = load->size == 0 ? 16 : 2 * load->size;
+        if( size < load->size )
+            return( MBEDTLS_ERR_X509_ALLOC_FAILED );
+
+        files = mbedtls_calloc( size, sizeof( x509_crt_path_file ) );
+        if( files == NULL )
+            return( MBEDTLS_ERR_X509_ALLOC_FAILED );
+
+        if( load->count != 0 )
+            memcpy( files, load->files,
+                    load->count * sizeof( x509_crt_path_file ) );
 
-                if( first_error == 0 )
-                    first_error = ret;
+        mbedtls_free( load->files );
+        load->files = files;
+        load->size = size;
+    }
 
-                total_failed++;
-                continue;
-            }
-            else
-                break;
+    files = &load->files[load->count];
+    files->name = mbedtls_calloc( 1, len + 1 );
+    if( files->name == NULL )
+        return( MBEDTLS_ERR_X509_ALLOC_FAILED );
 
-            ret = mbedtls_x509_crt_parse_der( chain, pem.buf, pem.buflen );
+    memcpy( files->name, name, len );
+    load->count++;
 
-            mbedtls_pem_free( &pem );
+    return( 0 );
+}
 
-            if( ret != 0 )
-            {
-                /*
-                 * Quit parsing on a memory error
-                 */
-                if( ret == MBEDTLS_ERR_X509_ALLOC_FAILED )
-                    return( ret );
+#if !defined(_WIN32) || defined(EFIX64) || defined(EFI32)
+static int x509_crt_path_file_cmp( const x509_crt_path_file *a,
+                                   const x509_crt_path_file *b )
+{
+    if( a->dev != b->dev )
+        return( a->dev < b->dev ? -1 : 1 );
 
-                if( first_error == 0 )
-                    first_error = ret;
+    if( a->ino != b->ino )
+        return( a->ino < b->ino ? -1 : 1 );
 
-                total_failed++;
-                continue;
-            }
+    return( 0 );
+}
 
-            success = 1;
-        }
-    }
+static void x509_crt_path_sift_down( x509_crt_path_file *files,
+                                     size_t i, size_t n )
+{
+    size_t child;
+    x509_crt_path_file tmp;
 
-    if( success )
-        return( total_failed );
-    else if( first_error )
-        return( first_error );
-    else
-        return( MBEDTLS_ERR_X509_CERT_UNKNOWN_FORMAT );
-#endif /* MBEDTLS_PEM_PARSE_C */
+    while( ( child = 2 * i + 1 ) < n )
+    {
+        if( child + 1 < n &&
+            x509_crt_path_file_cmp( &files[child], &files[child + 1] ) < 0 )
+            child++;
+
+        if( x509_crt_path_file_cmp( &files[i], &files[child] ) >= 0 )
+            break;
+
+        tmp = files[i];
+        files[i] = files[child];
+        files[child] = tmp;
+        i = child;
+    }
 }
 
-#if defined(MBEDTLS_FS_IO)
 /*
- * Load one or more certificates and add them to the chained list
+ * Keep a single link to each file (heapsort by identity, then drop the
+ * neighbours that are the same file)
  */
-int mbedtls_x509_crt_parse_file( mbedtls_x509_crt *chain, const char *path )
+static void x509_crt_path_unique( x509_crt_path_load *load )
 {
-    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
-    size_t n;
-    unsigned char *buf;
+    x509_crt_path_file *files = load->files, tmp;
+    size_t i, n = load->count;
 
-    if( ( ret = mbedtls_pk_load_file( path, &buf, &n ) ) != 0 )
-        return( ret );
+    for( i = n / 2; i > 0; i-- )
+        x509_crt_path_sift_down( files, i - 1, n );
 
-    ret = mbedtls_x509_crt_parse( chain, buf, n );
+    for( i = n; i > 1; i-- )
+    {
+        tmp = files[0];
+        files[0] = files[i - 1];
+        files[i - 1] = tmp;
+        x509_crt_path_sift_down( files, 0, i - 1 );
+    }
 
-    mbedtls_platform_zeroize( buf, n );
-    mbedtls_free( buf );
+    for( i = 0, n = 0; i < load->count; i++ )
+    {
+        if( n > 0 && x509_crt_path_file_cmp( &files[n - 1], &files[i] ) == 0 )
+        {
+            mbedtls_free( files[i].name );
+            continue;
+        }
 
-    return( ret );
+        files[n++] = files[i];
+    }
+
+    load->count = n;
 }
+#endif /* !_WIN32 || EFIX64 || EFI32 */
 
-int mbedtls_x509_crt_parse_path( mbedtls_x509_crt *chain, const char *path )
+/*
+ * List the regular files of a directory
+ */
+static int x509_crt_path_list( x509_crt_path_load *load, const char *path )
 {
     int ret = 0;
 #if defined(_WIN32) && !defined(EFIX64) && !defined(EFI32)
@@ -1596,11 +2632,9 @@ int mbedtls_x509_crt_parse_path( mbedtls_x509_crt *chain, const char *path )
             goto cleanup;
         }
 
-        w_ret = mbedtls_x509_crt_parse_file( chain, filename );
-        if( w_ret < 0 )
-            ret++;
-        else
-            ret += w_ret;
+        if( ( ret = x509_crt_path_add( load, filename,
+                                       strlen( filename ) ) ) != 0 )
+            goto cleanup;
     }
     while( FindNextFileW( hFind, &file_data ) != 0 );
 
@@ -1610,7 +2644,6 @@ int mbedtls_x509_crt_parse_path( mbedtls_x509_crt *chain, const char *path )
 cleanup:
     FindClose( hFind );
 #else /* _WIN32 */
-    int t_ret;
     int snp_ret;
     struct stat sb;
     struct dirent *entry;
@@ -1647,13 +2680,12 @@ cleanup:
         if( !S_ISREG( sb.st_mode ) )
             continue;
 
-        // Ignore parse errors
-        //
-        t_ret = mbedtls_x509_crt_parse_file( chain, entry_name );
-        if( t_ret < 0 )
-            ret++;
-        else
-            ret += t_ret;
+        if( ( ret = x509_crt_path_add( load, entry_name,
+                                       (size_t) snp_ret ) ) != 0 )
+            goto cleanup;
+
+        load->files[load->count - 1].dev = sb.st_dev;
+        load->files[load->count - 1].ino = sb.st_ino;
     }
 
 cleanup:
@@ -1664,10 +2696,294 @@ cleanup:
         ret = MBEDTLS_ERR_THREADING_MUTEX_ERROR;
 #endif /* MBEDTLS_THREADING_C */
 
+    if( ret == 0 )
+        x509_crt_path_unique( load );
 #endif /* _WIN32 */
 
     return( ret );
 }
+
+/*
+ * Parse files until there are none left, on each thread of the pool
+ */
+static void *x509_crt_path_worker( void *arg )
+{
+    x509_crt_path_load *load = (x509_crt_path_load *) arg;
+    size_t i;
+
+    for( ;; )
+    {
+#if defined(MBEDTLS_THREADING_C)
+        if( mbedtls_mutex_lock( &load->mutex ) != 0 )
+            break;
+#endif
+
+        i = load->next;
+        if( i < load->count )
+            load->next++;
+
+#if defined(MBEDTLS_THREADING_C)
+        if( mbedtls_mutex_unlock( &load->mutex ) != 0 )
+            break;
+#endif
+
+        if( i >= load->count )
+            break;
+
+        load->rets[i] = mbedtls_x509_crt_parse_file( &load->crts[i],
+                                                     load->files[i].name );
+    }
+
+    return( NULL );
+}
+
+/*
+ * Return the slot of the table holding a certificate with the same DER as
+ * crt, or the empty slot where it belongs (linear probing)
+ */
+static mbedtls_x509_crt **x509_crt_path_slot( mbedtls_x509_crt **seen,
+                                              size_t mask,
+                                              const mbedtls_x509_crt *crt )
+{
+    size_t i = x509_hash_update( 2166136261u, crt->raw.p,
+                                 crt->raw.len, 0 ) & mask;
+
+    while( seen[i] != NULL &&
+           ( seen[i]->raw.len != crt->raw.len ||
+             memcmp( seen[i]->raw.p, crt->raw.p, crt->raw.len ) != 0 ) )
+    {
+        i = ( i + 1 ) & mask;
+    }
+
+    return( &seen[i] );
+}
+
+/*
+ * Move the certificates parsed from each file to the end of the chain, in
+ * file order, dropping those whose DER is already in it. The result is the
+ * failure count of mbedtls_x509_crt_parse_path().
+ */
+static int x509_crt_path_merge( mbedtls_x509_crt *chain,
+                                x509_crt_path_load *load )
+{
+    int ret = 0, failed = 0;
+    size_t i, n = 0, mask;
+    mbedtls_x509_crt **seen = NULL, **slot;
+    mbedtls_x509_crt *head, *cur, *next, *tail = chain;
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+    unsigned char digest[sizeof( chain->chain_digest )];
+#endif
+
+    for( cur = chain; cur != NULL; cur = cur->next )
+        n++;
+    for( i = 0; i < load->count; i++ )
+        for( cur = &load->crts[i]; cur != NULL; cur = cur->next )
+            n++;
+
+    /* At most half full */
+    mask = 1;
+    while( mask < 2 * n )
+        mask <<= 1;
+
+    seen = mbedtls_calloc( mask, sizeof( mbedtls_x509_crt * ) );
+    if( seen == NULL )
+        return( MBEDTLS_ERR_X509_ALLOC_FAILED );
+    mask--;
+
+    for( cur = chain; cur != NULL; cur = cur->next )
+    {
+        tail = cur;
+        if( cur->version == 0 )
+            continue;
+
+        slot = x509_crt_path_slot( seen, mask, cur );
+        if( *slot == NULL )
+            *slot = cur;
+    }
+
+    for( i = 0; i < load->count; i++ )
+    {
+#if defined(MBEDTLS_THREADING_C)
+        if( load->rets[i] == X509_CRT_PATH_NOT_PARSED )
+        {
+            ret = X509_CRT_PATH_NOT_PARSED;
+            goto cleanup;
+        }
+#endif
+
+        // Ignore parse errors
+        //
+        if( load->rets[i] < 0 )
+            failed++;
+        else
+            failed += load->rets[i];
+
+        head = &load->crts[i];
+        if( head->version == 0 )
+            continue;
+
+        for( cur = head; cur != NULL; cur = next )
+        {
+            next = cur->next;
+            cur->next = NULL;
+
+            slot = x509_crt_path_slot( seen, mask, cur );
+            if( *slot != NULL )
+            {
+                mbedtls_x509_crt_free( cur );
+                if( cur != head )
+                    mbedtls_free( cur );
+                continue;
+            }
+
+            if( tail->version == 0 )
+            {
+                /* Only the first certificate of a chain can be empty */
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+                memcpy( digest, tail->chain_digest, sizeof( digest ) );
+#endif
+                *tail = *cur;
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+                memcpy( tail->chain_digest, digest, sizeof( digest ) );
+#endif
+            }
+            else
+            {
+                if( cur != head )
+                    tail->next = cur;
+                else if( ( tail->next = mbedtls_calloc( 1,
+                                sizeof( mbedtls_x509_crt ) ) ) != NULL )
+                    *tail->next = *cur;
+                else
+                {
+                    /* Leave the rest of this file to the caller's cleanup */
+                    head->next = next;
+                    ret = MBEDTLS_ERR_X509_ALLOC_FAILED;
+                    goto cleanup;
+                }
+
+                tail = tail->next;
+            }
+
+            if( cur == head )
+                mbedtls_x509_crt_init( cur );
+            else if( cur != tail )
+                mbedtls_free( cur );
+
+            *slot = tail;
+
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+            if( ( ret = mbedtls_x509_chain_digest_update( chain->chain_digest,
+                                                          &tail->raw ) ) != 0 )
+            {
+                head->next = next;
+                goto cleanup;
+            }
+#endif
+        }
+    }
+
+    ret = failed;
+
+cleanup:
+    mbedtls_free( seen );
+
+    return( ret );
+}
+
+int mbedtls_x509_crt_parse_path_dedup( mbedtls_x509_crt *chain,
+                                       const char *path, int workers )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    x509_crt_path_load load;
+    size_t i;
+#if defined(MBEDTLS_THREADING_PTHREAD)
+    pthread_t *threads = NULL;
+    size_t n, started = 0;
+#endif
+
+    if( chain == NULL || path == NULL )
+        return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+
+    memset( &load, 0, sizeof( load ) );
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mutex_init( &load.mutex );
+#endif
+
+    if( ( ret = x509_crt_path_list( &load, path ) ) != 0 || load.count == 0 )
+        goto cleanup;
+
+    load.crts = mbedtls_calloc( load.count, sizeof( mbedtls_x509_crt ) );
+    load.rets = mbedtls_calloc( load.count, sizeof( int ) );
+    if( load.crts == NULL || load.rets == NULL )
+    {
+        ret = MBEDTLS_ERR_X509_ALLOC_FAILED;
+        goto cleanup;
+    }
+
+    for( i = 0; i < load.count; i++ )
+    {
+        mbedtls_x509_crt_init( &load.crts[i] );
+#if defined(MBEDTLS_THREADING_C)
+        load.rets[i] = X509_CRT_PATH_NOT_PARSED;
+#endif
+    }
+
+#if defined(MBEDTLS_THREADING_PTHREAD)
+    /* The calling thread is one of the workers */
+    n = workers > 1 ? (size_t) workers - 1 : 0;
+    if( n > load.count - 1 )
+        n = load.count - 1;
+
+    if( n > 0 )
+        threads = mbedtls_calloc( n, sizeof( pthread_t ) );
+
+    /* With fewer threads than asked for, the others just do more work */
+    while( threads != NULL && started < n &&
+           pthread_create( &threads[started], NULL,
+                           x509_crt_path_worker, &load ) == 0 )
+    {
+        started++;
+    }
+#else
+    (void) workers;
+#endif /* MBEDTLS_THREADING_PTHREAD */
+
+    (void) x509_crt_path_worker( &load );
+
+#if defined(MBEDTLS_THREADING_PTHREAD)
+    for( i = 0; i < started; i++ )
+        (void) pthread_join( threads[i], NULL );
+#endif
+
+#if defined(MBEDTLS_X509_CA_INDEX)
+    /* The index no longer covers the whole chain */
+    x509_crt_index_free( chain );
+#endif
+
+    ret = x509_crt_path_merge( chain, &load );
+
+cleanup:
+    for( i = 0; i < load.count; i++ )
+    {
+        if( load.crts != NULL )
+            mbedtls_x509_crt_free( &load.crts[i] );
+        mbedtls_free( load.files[i].name );
+    }
+
+    mbedtls_free( load.files );
+    mbedtls_free( load.crts );
+    mbedtls_free( load.rets );
+#if defined(MBEDTLS_THREADING_PTHREAD)
+    mbedtls_free( threads );
+#endif
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mutex_free( &load.mutex );
+#endif
+
+    return( ret );
+}
+#endif /* MBEDTLS_X509_CRT_PARSE_PATH_DEDUP */
 #endif /* MBEDTLS_FS_IO */
 
 /*
@@ -2071,6 +3387,11 @@ int mbedtls_x509_crt_info( char *buf, size_t size, const char *prefix,
         return( (int) ( size - n ) );
     }
 
+#if defined(MBEDTLS_X509_CRT_FRAME_PARSING)
+    if( ( ret = mbedtls_x509_crt_frame_decode( (mbedtls_x509_crt *) crt ) ) != 0 )
+        return( ret );
+#endif
+
     ret = mbedtls_snprintf( p, n, "%scert. version     : %d\n",
                                prefix, crt->version );
     MBEDTLS_X509_SAFE_SNPRINTF;
@@ -2259,6 +3580,12 @@ int mbedtls_x509_crt_check_key_usage( const mbedtls_x509_crt *crt,
     unsigned int usage_must, usage_may;
     unsigned int may_mask = MBEDTLS_X509_KU_ENCIPHER_ONLY
                           | MBEDTLS_X509_KU_DECIPHER_ONLY;
+#if defined(MBEDTLS_X509_CRT_FRAME_PARSING)
+    int ret;
+
+    if( ( ret = mbedtls_x509_crt_frame_decode( (mbedtls_x509_crt *) crt ) ) != 0 )
+        return( ret );
+#endif
 
     if( ( crt->ext_types & MBEDTLS_X509_EXT_KEY_USAGE ) == 0 )
         return( 0 );
@@ -2283,6 +3610,12 @@ int mbedtls_x509_crt_check_extended_key_usage( const mbedtls_x509_crt *crt,
                                        size_t usage_len )
 {
     const mbedtls_x509_sequence *cur;
+#if defined(MBEDTLS_X509_CRT_FRAME_PARSING)
+    int ret;
+
+    if( ( ret = mbedtls_x509_crt_frame_decode( (mbedtls_x509_crt *) crt ) ) != 0 )
+        return( ret );
+#endif
 
     /* Extension is not mandatory, absent means no restriction */
     if( ( crt->ext_types & MBEDTLS_X509_EXT_EXTENDED_KEY_USAGE ) == 0 )
@@ -2317,6 +3650,41 @@ int mbedtls_x509_crt_is_revoked( const mbedtls_x509_crt *crt, const mbedtls_x509
 {
     const mbedtls_x509_crl_entry *cur = &crl->entry;
 
+#if defined(MBEDTLS_X509_CRL_SERIAL_INDEX)
+    if( crl->serials != NULL )
+    {
+        size_t lo = 0, hi = crl->serial_count, mid;
+        const mbedtls_x509_crl_serial *serial;
+        int cmp;
+
+        /* The list walk below never matches an empty serial number */
+        if( crt->serial.len == 0 )
+            return( 0 );
+
+        while( lo < hi )
+        {
+            mid = lo + ( hi - lo ) / 2;
+            serial = &crl->serials[mid];
+
+            if( serial->len != crt->serial.len )
+                cmp = serial->len < crt->serial.len ? -1 : 1;
+            else
+                cmp = memcmp( crl->raw.p + serial->offset, crt->serial.p,
+                              crt->serial.len );
+
+            if( cmp == 0 )
+                return( 1 );
+
+            if( cmp < 0 )
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+
+        return( 0 );
+    }
+#endif /* MBEDTLS_X509_CRL_SERIAL_INDEX */
+
     while( cur != NULL && cur->serial.len != 0 )
     {
         if( crt->serial.len == cur->serial.len &&
@@ -2569,6 +3937,12 @@ static int x509_crt_find_parent_in(
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
     mbedtls_x509_crt *parent, *fallback_parent;
     int signature_is_good = 0, fallback_signature_is_good;
+    uint32_t issuer_hash = 0;
+
+#if defined(MBEDTLS_X509_CA_INDEX)
+    if( candidates != NULL && candidates->ca_index != NULL )
+        issuer_hash = x509_name_hash( &child->issuer );
+#endif
 
 #if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_ECP_RESTARTABLE)
     /* did we have something in progress? */
@@ -2592,7 +3966,11 @@ static int x509_crt_find_parent_in(
     fallback_parent = NULL;
     fallback_signature_is_good = 0;
 
-    for( parent = candidates; parent != NULL; parent = parent->next )
+    for( parent = x509_crt_next_candidate( child, candidates,
+                                           issuer_hash, NULL );
+         parent != NULL;
+         parent = x509_crt_next_candidate( child, candidates,
+                                           issuer_hash, parent ) )
     {
         /* basic parenting skills (name, CA bit, key usage) */
         if( x509_crt_check_parent( child, parent, top ) != 0 )
@@ -2751,13 +4129,21 @@ static int x509_crt_check_ee_locally_trusted(
                     mbedtls_x509_crt *trust_ca )
 {
     mbedtls_x509_crt *cur;
+    uint32_t subject_hash = 0;
 
     /* must be self-issued */
     if( x509_name_cmp( &crt->issuer, &crt->subject ) != 0 )
         return( -1 );
 
+#if defined(MBEDTLS_X509_CA_INDEX)
+    if( trust_ca != NULL && trust_ca->ca_index != NULL )
+        subject_hash = x509_name_hash( &crt->subject );
+#endif
+
     /* look for an exact match with trusted cert */
-    for( cur = trust_ca; cur != NULL; cur = cur->next )
+    for( cur = x509_crt_next_candidate( crt, trust_ca, subject_hash, NULL );
+         cur != NULL;
+         cur = x509_crt_next_candidate( crt, trust_ca, subject_hash, cur ) )
     {
         if( crt->raw.len == cur->raw.len &&
             memcmp( crt->raw.p, cur->raw.p, crt->raw.len ) == 0 )
@@ -3122,6 +4508,9 @@ static int x509_crt_verify_restartable_ca_cb( mbedtls_x509_crt *crt,
     mbedtls_pk_type_t pk_type;
     mbedtls_x509_crt_verify_chain ver_chain;
     uint32_t ee_flags;
+#if defined(MBEDTLS_X509_CRT_FRAME_PARSING)
+    mbedtls_x509_crt *cur;
+#endif
 
     *flags = 0;
     ee_flags = 0;
@@ -3133,6 +4522,16 @@ static int x509_crt_verify_restartable_ca_cb( mbedtls_x509_crt *crt,
         goto exit;
     }
 
+#if defined(MBEDTLS_X509_CRT_FRAME_PARSING)
+    /* The whole presented chain is needed; trusted CAs are decoded as they
+     * are considered as parents */
+    for( cur = crt; cur != NULL; cur = cur->next )
+    {
+        if( ( ret = mbedtls_x509_crt_frame_decode( cur ) ) != 0 )
+            goto exit;
+    }
+#endif
+
     /* check name if requested */
     if( cn != NULL )
         x509_crt_verify_name( crt, cn, &ee_flags );
@@ -3289,6 +4688,10 @@ void mbedtls_x509_crt_free( mbedtls_x509_crt *crt )
     {
         mbedtls_pk_free( &cert_cur->pk );
 
+#if defined(MBEDTLS_X509_CA_INDEX)
+        x509_crt_index_free( cert_cur );
+#endif
+
 #if defined(MBEDTLS_X509_RSASSA_PSS_SUPPORT)
         mbedtls_free( cert_cur->sig_opts );
 #endif
@@ -0,0 +1,417 @@
+/*
+ *  X.509 certificate chain verification cache
+ *
+ *  Copyright The Mbed TLS Contributors
+ *  SPDX-License-Identifier: Apache-2.0
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *  not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *  WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+/*
+ * Verification results are stored in a simple chained list, in the same way
+ * as the SSL session cache. Entries are keyed by a digest of the presented
+ * chain and of the verification parameters.
+ */
+
+#include "common.h"
+
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdlib.h>
+#define mbedtls_calloc    calloc
+#define mbedtls_free      free
+#endif
+
+#include "mbedtls/x509_crt_cache.h"
+#include "mbedtls/error.h"
+#include "mbedtls/sha256.h"
+#include "mbedtls/platform_util.h"
+
+#include <string.h>
+
+void mbedtls_x509_crt_cache_init( mbedtls_x509_crt_cache *cache )
+{
+    memset( cache, 0, sizeof( mbedtls_x509_crt_cache ) );
+
+    cache->timeout = MBEDTLS_X509_CRT_CACHE_DEFAULT_TIMEOUT;
+    cache->max_entries = MBEDTLS_X509_CRT_CACHE_DEFAULT_MAX_ENTRIES;
+
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mutex_init( &cache->mutex );
+#endif
+}
+
+static int x509_cache_hash_len( mbedtls_sha256_context *sha, size_t len )
+{
+    unsigned char buf[4];
+
+    buf[0] = (unsigned char)( len >> 24 );
+    buf[1] = (unsigned char)( len >> 16 );
+    buf[2] = (unsigned char)( len >>  8 );
+    buf[3] = (unsigned char)( len       );
+
+    return( mbedtls_sha256_update_ret( sha, buf, sizeof( buf ) ) );
+}
+
+static int x509_cache_hash_buf( mbedtls_sha256_context *sha,
+                                const unsigned char *p, size_t len )
+{
+    int ret;
+
+    if( ( ret = x509_cache_hash_len( sha, len ) ) != 0 )
+        return( ret );
+
+    return( mbedtls_sha256_update_ret( sha, p, len ) );
+}
+
+int mbedtls_x509_crt_cache_key( unsigned char *key,
+                                const mbedtls_x509_crt *crt,
+                                const mbedtls_x509_crt *trust_ca,
+                                const mbedtls_x509_crl *ca_crl,
+                                const mbedtls_x509_crt_profile *profile,
+                                const char *cn )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_sha256_context sha;
+    unsigned char buf[16];
+
+    if( crt == NULL )
+        return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+
+    mbedtls_sha256_init( &sha );
+
+    if( ( ret = mbedtls_sha256_starts_ret( &sha, 0 ) ) != 0 )
+        goto exit;
+
+    /* Presented chain, trusted CAs and CRLs, through the digests that the
+     * parsing functions maintain on the first element of each list. */
+    if( ( ret = x509_cache_hash_buf( &sha, crt->chain_digest,
+                                     sizeof( crt->chain_digest ) ) ) != 0 )
+        goto exit;
+
+    if( trust_ca != NULL )
+        ret = x509_cache_hash_buf( &sha, trust_ca->chain_digest,
+                                   sizeof( trust_ca->chain_digest ) );
+    else
+        ret = x509_cache_hash_len( &sha, 0 );
+
+    if( ret != 0 )
+        goto exit;
+
+    if( ca_crl != NULL )
+        ret = x509_cache_hash_buf( &sha, ca_crl->chain_digest,
+                                   sizeof( ca_crl->chain_digest ) );
+    else
+        ret = x509_cache_hash_len( &sha, 0 );
+
+    if( ret != 0 )
+        goto exit;
+
+    /* Profile */
+    if( profile != NULL )
+    {
+        buf[ 0] = (unsigned char)( profile->allowed_mds    >> 24 );
+        buf[ 1] = (unsigned char)( profile->allowed_mds    >> 16 );
+        buf[ 2] = (unsigned char)( profile->allowed_mds    >>  8 );
+        buf[ 3] = (unsigned char)( profile->allowed_mds          );
+        buf[ 4] = (unsigned char)( profile->allowed_pks    >> 24 );
+        buf[ 5] = (unsigned char)( profile->allowed_pks    >> 16 );
+        buf[ 6] = (unsigned char)( profile->allowed_pks    >>  8 );
+        buf[ 7] = (unsigned char)( profile->allowed_pks          );
+        buf[ 8] = (unsigned char)( profile->allowed_curves >> 24 );
+        buf[ 9] = (unsigned char)( profile->allowed_curves >> 16 );
+        buf[10] = (unsigned char)( profile->allowed_curves >>  8 );
+        buf[11] = (unsigned char)( profile->allowed_curves       );
+        buf[12] = (unsigned char)( profile->rsa_min_bitlen >> 24 );
+        buf[13] = (unsigned char)( profile->rsa_min_bitlen >> 16 );
+        buf[14] = (unsigned char)( profile->rsa_min_bitlen >>  8 );
+        buf[15] = (unsigned char)( profile->rsa_min_bitlen       );
+
+        ret = x509_cache_hash_buf( &sha, buf, sizeof( buf ) );
+    }
+    else
+        ret = x509_cache_hash_len( &sha, 0 );
+
+    if( ret != 0 )
+        goto exit;
+
+    /* Expected name, distinguishing NULL from "" */
+    if( cn != NULL )
+        ret = x509_cache_hash_buf( &sha, (const unsigned char *) cn,
+                                   strlen( cn ) + 1 );
+    else
+        ret = x509_cache_hash_len( &sha, 0 );
+
+    if( ret != 0 )
+        goto exit;
+
+    ret = mbedtls_sha256_finish_ret( &sha, key );
+
+exit:
+    mbedtls_sha256_free( &sha );
+
+    return( ret );
+}
+
+int mbedtls_x509_crt_cache_get( mbedtls_x509_crt_cache *cache,
+                                const unsigned char *key,
+                                int *result, uint32_t *flags )
+{
+    int ret = 1;
+#if defined(MBEDTLS_HAVE_TIME)
+    mbedtls_time_t t = mbedtls_time( NULL );
+#endif
+    mbedtls_x509_crt_cache_entry *cur;
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_lock( &cache->mutex ) != 0 )
+        return( 1 );
+#endif
+
+    for( cur = cache->chain; cur != NULL; cur = cur->next )
+    {
+#if defined(MBEDTLS_HAVE_TIME)
+        if( cache->timeout != 0 &&
+            (int) ( t - cur->timestamp ) > cache->timeout )
+            continue;
+#endif
+
+        if( memcmp( key, cur->key, MBEDTLS_X509_CRT_CACHE_KEY_LEN ) != 0 )
+            continue;
+
+        *result = cur->result;
+        *flags = cur->flags;
+
+        ret = 0;
+        break;
+    }
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_unlock( &cache->mutex ) != 0 )
+        ret = 1;
+#endif
+
+    return( ret );
+}
+
+int mbedtls_x509_crt_cache_set( mbedtls_x509_crt_cache *cache,
+                                const unsigned char *key,
+                                int result, uint32_t flags )
+{
+    int ret = 1;
+#if defined(MBEDTLS_HAVE_TIME)
+    mbedtls_time_t t = mbedtls_time( NULL ), oldest = 0;
+    mbedtls_x509_crt_cache_entry *old = NULL;
+#endif
+    mbedtls_x509_crt_cache_entry *cur, *prv;
+    int count = 0;
+
+    /* Anything else (allocation failure, operation in progress, error from
+     * a callback) says nothing about the chain itself. */
+    if( result != 0 && result != MBEDTLS_ERR_X509_CERT_VERIFY_FAILED )
+        return( 0 );
+
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_lock( &cache->mutex ) != 0 )
+        return( 1 );
+#endif
+
+    cur = cache->chain;
+    prv = NULL;
+
+    while( cur != NULL )
+    {
+        count++;
+
+#if defined(MBEDTLS_HAVE_TIME)
+        if( cache->timeout != 0 &&
+            (int) ( t - cur->timestamp ) > cache->timeout )
+        {
+            break; /* expired, reuse this slot */
+        }
+#endif
+
+        if( memcmp( key, cur->key, MBEDTLS_X509_CRT_CACHE_KEY_LEN ) == 0 )
+            break; /* verified concurrently, refresh */
+
+#if defined(MBEDTLS_HAVE_TIME)
+        if( oldest == 0 || cur->timestamp < oldest )
+        {
+            oldest = cur->timestamp;
+            old = cur;
+        }
+#endif
+
+        prv = cur;
+        cur = cur->next;
+    }
+
+    if( cur == NULL )
+    {
+#if defined(MBEDTLS_HAVE_TIME)
+        /*
+         * Reuse oldest entry if max_entries reached
+         */
+        if( count >= cache->max_entries )
+        {
+            if( old == NULL )
+                goto exit;
+
+            cur = old;
+        }
+#else /* MBEDTLS_HAVE_TIME */
+        /*
+         * Reuse first entry in chain if max_entries reached,
+         * but move to last place
+         */
+        if( count >= cache->max_entries )
+        {
+            if( cache->chain == NULL )
+                goto exit;
+
+            cur = cache->chain;
+            cache->chain = cur->next;
+            cur->next = NULL;
+            if( prv == cur )
+                cache->chain = cur;
+            else
+                prv->next = cur;
+        }
+#endif /* MBEDTLS_HAVE_TIME */
+        else
+        {
+            /*
+             * max_entries not reached, create new entry
+             */
+            cur = mbedtls_calloc( 1, sizeof( mbedtls_x509_crt_cache_entry ) );
+            if( cur == NULL )
+                goto exit;
+
+            if( prv == NULL )
+                cache->chain = cur;
+            else
+                prv->next = cur;
+        }
+    }
+
+#if defined(MBEDTLS_HAVE_TIME)
+    cur->timestamp = t;
+#endif
+    memcpy( cur->key, key, MBEDTLS_X509_CRT_CACHE_KEY_LEN );
+    cur->result = result;
+    cur->flags = flags;
+
+    ret = 0;
+
+exit:
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_unlock( &cache->mutex ) != 0 )
+        ret = 1;
+#endif
+
+    return( ret );
+}
+
+int mbedtls_x509_crt_verify_cached( mbedtls_x509_crt_cache *cache,
+                                    mbedtls_x509_crt *crt,
+                                    mbedtls_x509_crt *trust_ca,
+                                    mbedtls_x509_crl *ca_crl,
+                                    const mbedtls_x509_crt_profile *profile,
+                                    const char *cn, uint32_t *flags )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    unsigned char key[MBEDTLS_X509_CRT_CACHE_KEY_LEN];
+
+    if( mbedtls_x509_crt_cache_key( key, crt, trust_ca, ca_crl,
+                                    profile, cn ) != 0 )
+    {
+        /* Not fatal: just don't use the cache */
+        return( mbedtls_x509_crt_verify_with_profile( crt, trust_ca, ca_crl,
+                                                      profile, cn, flags,
+                                                      NULL, NULL ) );
+    }
+
+    if( mbedtls_x509_crt_cache_get( cache, key, &ret, flags ) == 0 )
+        return( ret );
+
+    ret = mbedtls_x509_crt_verify_with_profile( crt, trust_ca, ca_crl,
+                                                profile, cn, flags,
+                                                NULL, NULL );
+
+    (void) mbedtls_x509_crt_cache_set( cache, key, ret, *flags );
+
+    return( ret );
+}
+
+#if defined(MBEDTLS_HAVE_TIME)
+void mbedtls_x509_crt_cache_set_timeout( mbedtls_x509_crt_cache *cache,
+                                         int timeout )
+{
+    if( timeout < 0 ) timeout = 0;
+
+    cache->timeout = timeout;
+}
+#endif /* MBEDTLS_HAVE_TIME */
+
+void mbedtls_x509_crt_cache_set_max_entries( mbedtls_x509_crt_cache *cache,
+                                             int max )
+{
+    if( max < 0 ) max = 0;
+
+    cache->max_entries = max;
+}
+
+static void x509_cache_free_entries( mbedtls_x509_crt_cache *cache )
+{
+    mbedtls_x509_crt_cache_entry *cur, *prv;
+
+    cur = cache->chain;
+
+    while( cur != NULL )
+    {
+        prv = cur;
+        cur = cur->next;
+
+        mbedtls_platform_zeroize( prv, sizeof( mbedtls_x509_crt_cache_entry ) );
+        mbedtls_free( prv );
+    }
+
+    cache->chain = NULL;
+}
+
+void mbedtls_x509_crt_cache_clear( mbedtls_x509_crt_cache *cache )
+{
+#if defined(MBEDTLS_THREADING_C)
+    if( mbedtls_mutex_lock( &cache->mutex ) != 0 )
+        return;
+#endif
+
+    x509_cache_free_entries( cache );
+
+#if defined(MBEDTLS_THREADING_C)
+    (void) mbedtls_mutex_unlock( &cache->mutex );
+#endif
+}
+
+void mbedtls_x509_crt_cache_free( mbedtls_x509_crt_cache *cache )
+{
+    x509_cache_free_entries( cache );
+
+#if defined(MBEDTLS_THREADING_C)
+    mbedtls_mutex_free( &cache->mutex );
+#endif
+}
+
+#endif /* MBEDTLS_X509_CRT_CACHE_C */
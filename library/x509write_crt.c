@@ -40,6 +40,24 @@
 #include "mbedtls/pem.h"
 #endif /* MBEDTLS_PEM_WRITE_C */
 
+#if defined(MBEDTLS_X509_CRT_WRITE_TEMPLATE)
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdlib.h>
+#define mbedtls_calloc    calloc
+#define mbedtls_free      free
+#endif
+
+#if defined(MBEDTLS_ECDSA_BATCH_SIGN)
+#include "mbedtls/ecdsa.h"
+#endif
+
+#if defined(MBEDTLS_THREADING_PTHREAD)
+#include <pthread.h>
+#endif
+#endif /* MBEDTLS_X509_CRT_WRITE_TEMPLATE */
+
 void mbedtls_x509write_crt_init( mbedtls_x509write_cert *ctx )
 {
     memset( ctx, 0, sizeof( mbedtls_x509write_cert ) );
@@ -322,6 +340,73 @@ static int x509_write_time( unsigned char **p, unsigned char *start,
     return( (int) len );
 }
 
+/*
+ * Get the signature algorithm OID for an issuer key and a hash algorithm
+ */
+static int x509write_crt_sig_oid( mbedtls_pk_context *issuer_key,
+                                  mbedtls_md_type_t md_alg,
+                                  const char **sig_oid, size_t *sig_oid_len )
+{
+    mbedtls_pk_type_t pk_alg;
+
+    /* There's no direct way of extracting a signature algorithm
+     * (represented as an element of mbedtls_pk_type_t) from a PK instance. */
+    if( mbedtls_pk_can_do( issuer_key, MBEDTLS_PK_RSA ) )
+        pk_alg = MBEDTLS_PK_RSA;
+    else if( mbedtls_pk_can_do( issuer_key, MBEDTLS_PK_ECDSA ) )
+        pk_alg = MBEDTLS_PK_ECDSA;
+    else
+        return( MBEDTLS_ERR_X509_INVALID_ALG );
+
+    return( mbedtls_oid_get_oid_by_sig_alg( pk_alg, md_alg,
+                                            sig_oid, sig_oid_len ) );
+}
+
+/*
+ * Write a Certificate made of the TBSCertificate of length len at c, at the
+ * end of buf, and of its signature, at the end of buf
+ */
+static int x509write_crt_signed( unsigned char *buf, size_t size,
+                                 unsigned char *c, size_t len,
+                                 const char *sig_oid, size_t sig_oid_len,
+                                 unsigned char *sig, size_t sig_len )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    unsigned char *c2;
+    size_t sig_and_oid_len = 0;
+
+    /* Move CRT to the front of the buffer to have space
+     * for the signature. */
+    memmove( buf, c, len );
+    c = buf + len;
+
+    /* Add signature at the end of the buffer,
+     * making sure that it doesn't underflow
+     * into the CRT buffer. */
+    c2 = buf + size;
+    MBEDTLS_ASN1_CHK_ADD( sig_and_oid_len, mbedtls_x509_write_sig( &c2, c,
+                                        sig_oid, sig_oid_len, sig, sig_len ) );
+
+    /*
+     * Memory layout after this step:
+     *
+     * buf       c=buf+len                c2            buf+size
+     * [CRT0,...,CRTn, UNUSED, ..., UNUSED, SIG0, ..., SIGm]
+     */
+
+    /* Move raw CRT to just before the signature. */
+    c = c2 - len;
+    memmove( c, buf, len );
+
+    len += sig_and_oid_len;
+    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_len( &c, buf, len ) );
+    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_tag( &c, buf,
+                                                 MBEDTLS_ASN1_CONSTRUCTED |
+                                                 MBEDTLS_ASN1_SEQUENCE ) );
+
+    return( (int) len );
+}
+
 int mbedtls_x509write_crt_der( mbedtls_x509write_cert *ctx,
                                unsigned char *buf, size_t size,
                                int (*f_rng)(void *, unsigned char *, size_t),
@@ -330,12 +415,11 @@ int mbedtls_x509write_crt_der( mbedtls_x509write_cert *ctx,
     int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
     const char *sig_oid;
     size_t sig_oid_len = 0;
-    unsigned char *c, *c2;
+    unsigned char *c;
     unsigned char hash[64];
     unsigned char sig[MBEDTLS_PK_SIGNATURE_MAX_SIZE];
-    size_t sub_len = 0, pub_len = 0, sig_and_oid_len = 0, sig_len;
+    size_t sub_len = 0, pub_len = 0, sig_len;
     size_t len = 0;
-    mbedtls_pk_type_t pk_alg;
 
     /*
      * Prepare data to be signed at the end of the target buffer
@@ -344,17 +428,8 @@ int mbedtls_x509write_crt_der( mbedtls_x509write_cert *ctx,
 
     /* Signature algorithm needed in TBS, and later for actual signature */
 
-    /* There's no direct way of extracting a signature algorithm
-     * (represented as an element of mbedtls_pk_type_t) from a PK instance. */
-    if( mbedtls_pk_can_do( ctx->issuer_key, MBEDTLS_PK_RSA ) )
-        pk_alg = MBEDTLS_PK_RSA;
-    else if( mbedtls_pk_can_do( ctx->issuer_key, MBEDTLS_PK_ECDSA ) )
-        pk_alg = MBEDTLS_PK_ECDSA;
-    else
-        return( MBEDTLS_ERR_X509_INVALID_ALG );
-
-    if( ( ret = mbedtls_oid_get_oid_by_sig_alg( pk_alg, ctx->md_alg,
-                                          &sig_oid, &sig_oid_len ) ) != 0 )
+    if( ( ret = x509write_crt_sig_oid( ctx->issuer_key, ctx->md_alg,
+                                       &sig_oid, &sig_oid_len ) ) != 0 )
     {
         return( ret );
     }
@@ -480,36 +555,8 @@ int mbedtls_x509write_crt_der( mbedtls_x509write_cert *ctx,
         return( ret );
     }
 
-    /* Move CRT to the front of the buffer to have space
-     * for the signature. */
-    memmove( buf, c, len );
-    c = buf + len;
-
-    /* Add signature at the end of the buffer,
-     * making sure that it doesn't underflow
-     * into the CRT buffer. */
-    c2 = buf + size;
-    MBEDTLS_ASN1_CHK_ADD( sig_and_oid_len, mbedtls_x509_write_sig( &c2, c,
-                                        sig_oid, sig_oid_len, sig, sig_len ) );
-
-    /*
-     * Memory layout after this step:
-     *
-     * buf       c=buf+len                c2            buf+size
-     * [CRT0,...,CRTn, UNUSED, ..., UNUSED, SIG0, ..., SIGm]
-     */
-
-    /* Move raw CRT to just before the signature. */
-    c = c2 - len;
-    memmove( c, buf, len );
-
-    len += sig_and_oid_len;
-    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_len( &c, buf, len ) );
-    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_tag( &c, buf,
-                                                 MBEDTLS_ASN1_CONSTRUCTED |
-                                                 MBEDTLS_ASN1_SEQUENCE ) );
-
-    return( (int) len );
+    return( x509write_crt_signed( buf, size, c, len, sig_oid, sig_oid_len,
+                                  sig, sig_len ) );
 }
 
 #define PEM_BEGIN_CRT           "-----BEGIN CERTIFICATE-----\n"
@@ -541,4 +588,615 @@ int mbedtls_x509write_crt_pem( mbedtls_x509write_cert *crt,
 }
 #endif /* MBEDTLS_PEM_WRITE_C */
 
+#if defined(MBEDTLS_X509_CRT_WRITE_TEMPLATE)
+void mbedtls_x509write_crt_template_init( mbedtls_x509write_crt_template *tpl )
+{
+    memset( tpl, 0, sizeof( mbedtls_x509write_crt_template ) );
+}
+
+void mbedtls_x509write_crt_template_free( mbedtls_x509write_crt_template *tpl )
+{
+    if( tpl == NULL )
+        return;
+
+    mbedtls_free( tpl->issuer );
+    mbedtls_free( tpl->extensions );
+
+    mbedtls_platform_zeroize( tpl, sizeof( mbedtls_x509write_crt_template ) );
+}
+
+/*
+ * Upper bound of the DER encoding of a list of names or extensions
+ */
+static size_t x509write_crt_list_size( const mbedtls_asn1_named_data *cur )
+{
+    size_t len = 16;
+
+    for( ; cur != NULL; cur = cur->next )
+        len += cur->oid.len + cur->val.len + 32;
+
+    return( len );
+}
+
+/*
+ * Copy the len bytes at the end of buf into a new buffer
+ */
+static int x509write_crt_template_copy( unsigned char **dst, size_t *dst_len,
+                                        const unsigned char *end, size_t len )
+{
+    if( ( *dst = mbedtls_calloc( 1, len ) ) == NULL )
+        return( MBEDTLS_ERR_X509_ALLOC_FAILED );
+
+    memcpy( *dst, end - len, len );
+    *dst_len = len;
+
+    return( 0 );
+}
+
+static int x509write_crt_template_encode( mbedtls_x509write_crt_template *tpl,
+                                          const mbedtls_x509write_cert *ctx,
+                                          unsigned char *buf, size_t size )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    unsigned char *c;
+    size_t len;
+
+    /*
+     *  Extensions  ::=  SEQUENCE SIZE (1..MAX) OF Extension
+     */
+
+    /* Only for v3 */
+    if( ctx->version == MBEDTLS_X509_CRT_VERSION_3 )
+    {
+        c = buf + size;
+        len = 0;
+
+        MBEDTLS_ASN1_CHK_ADD( len,
+                              mbedtls_x509_write_extensions( &c,
+                                                      buf, ctx->extensions ) );
+        MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_len( &c, buf, len ) );
+        MBEDTLS_ASN1_CHK_ADD( len,
+                              mbedtls_asn1_write_tag( &c, buf,
+                                                      MBEDTLS_ASN1_CONSTRUCTED |
+                                                      MBEDTLS_ASN1_SEQUENCE ) );
+        MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_len( &c, buf, len ) );
+        MBEDTLS_ASN1_CHK_ADD( len,
+                              mbedtls_asn1_write_tag( &c, buf,
+                                               MBEDTLS_ASN1_CONTEXT_SPECIFIC |
+                                               MBEDTLS_ASN1_CONSTRUCTED | 3 ) );
+
+        if( ( ret = x509write_crt_template_copy( &tpl->extensions,
+                                                 &tpl->extensions_len,
+                                                 buf + size, len ) ) != 0 )
+            return( ret );
+    }
+
+    /*
+     *  Issuer  ::=  Name
+     */
+    c = buf + size;
+    len = 0;
+
+    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_x509_write_names( &c, buf,
+                                                         ctx->issuer ) );
+
+    /*
+     *  Signature   ::=  AlgorithmIdentifier
+     */
+    MBEDTLS_ASN1_CHK_ADD( len,
+                          mbedtls_asn1_write_algorithm_identifier( &c, buf,
+                                    tpl->sig_oid, strlen( tpl->sig_oid ), 0 ) );
+
+    return( x509write_crt_template_copy( &tpl->issuer, &tpl->issuer_len,
+                                         buf + size, len ) );
+}
+
+int mbedtls_x509write_crt_template_setup( mbedtls_x509write_crt_template *tpl,
+                                          const mbedtls_x509write_cert *ctx )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    unsigned char *buf;
+    size_t size;
+
+    if( ctx->issuer_key == NULL ||
+        mbedtls_md_info_from_type( ctx->md_alg ) == NULL )
+        return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+
+    mbedtls_x509write_crt_template_free( tpl );
+
+    if( ( ret = x509write_crt_sig_oid( ctx->issuer_key, ctx->md_alg,
+                                       &tpl->sig_oid,
+                                       &tpl->sig_oid_len ) ) != 0 )
+    {
+        return( ret );
+    }
+
+    size = x509write_crt_list_size( ctx->issuer ) +
+           x509write_crt_list_size( ctx->extensions ) +
+           tpl->sig_oid_len + 32;
+    if( ( buf = mbedtls_calloc( 1, size ) ) == NULL )
+        return( MBEDTLS_ERR_X509_ALLOC_FAILED );
+
+    tpl->version = ctx->version;
+    tpl->md_alg = ctx->md_alg;
+    tpl->issuer_key = ctx->issuer_key;
+
+    ret = x509write_crt_template_encode( tpl, ctx, buf, size );
+    if( ret < 0 )
+        mbedtls_x509write_crt_template_free( tpl );
+
+    mbedtls_free( buf );
+
+    return( ret < 0 ? ret : 0 );
+}
+
+/*
+ * Write the TBSCertificate of an item at the end of its buffer
+ */
+static int x509write_crt_tbs( const mbedtls_x509write_crt_template *tpl,
+                              const mbedtls_x509write_crt_item *item,
+                              unsigned char **tbs )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    unsigned char *buf = item->buf, *c = item->buf + item->size;
+    char not_before[MBEDTLS_X509_RFC5280_UTC_TIME_LEN + 1];
+    char not_after[MBEDTLS_X509_RFC5280_UTC_TIME_LEN + 1];
+    mbedtls_asn1_named_data *subject = NULL;
+    size_t sub_len = 0, pub_len = 0, len = 0;
+
+    if( strlen( item->not_before ) != MBEDTLS_X509_RFC5280_UTC_TIME_LEN - 1 ||
+        strlen( item->not_after )  != MBEDTLS_X509_RFC5280_UTC_TIME_LEN - 1 )
+    {
+        return( MBEDTLS_ERR_X509_BAD_INPUT_DATA );
+    }
+    memcpy( not_before, item->not_before,
+            MBEDTLS_X509_RFC5280_UTC_TIME_LEN - 1 );
+    not_before[MBEDTLS_X509_RFC5280_UTC_TIME_LEN - 1] = 'Z';
+    memcpy( not_after, item->not_after,
+            MBEDTLS_X509_RFC5280_UTC_TIME_LEN - 1 );
+    not_after[MBEDTLS_X509_RFC5280_UTC_TIME_LEN - 1] = 'Z';
+
+    /*
+     *  Extensions, from the template
+     */
+    if( tpl->extensions_len > 0 )
+    {
+        if( tpl->extensions_len > (size_t)( c - buf ) )
+            return( MBEDTLS_ERR_ASN1_BUF_TOO_SMALL );
+
+        c -= tpl->extensions_len;
+        memcpy( c, tpl->extensions, tpl->extensions_len );
+        len += tpl->extensions_len;
+    }
+
+    /*
+     *  SubjectPublicKeyInfo
+     */
+    MBEDTLS_ASN1_CHK_ADD( pub_len,
+                          mbedtls_pk_write_pubkey_der( item->subject_key,
+                                                       buf, c - buf ) );
+    c -= pub_len;
+    len += pub_len;
+
+    /*
+     *  Subject  ::=  Name
+     */
+    if( ( ret = mbedtls_x509_string_to_names( &subject,
+                                              item->subject_name ) ) != 0 )
+        return( ret );
+
+    ret = mbedtls_x509_write_names( &c, buf, subject );
+    mbedtls_asn1_free_named_data_list( &subject );
+    if( ret < 0 )
+        return( ret );
+    len += (size_t) ret;
+
+    /*
+     *  Validity ::= SEQUENCE {
+     *       notBefore      Time,
+     *       notAfter       Time }
+     */
+    MBEDTLS_ASN1_CHK_ADD( sub_len,
+                          x509_write_time( &c, buf, not_after,
+                                        MBEDTLS_X509_RFC5280_UTC_TIME_LEN ) );
+
+    MBEDTLS_ASN1_CHK_ADD( sub_len,
+                          x509_write_time( &c, buf, not_before,
+                                        MBEDTLS_X509_RFC5280_UTC_TIME_LEN ) );
+
+    len += sub_len;
+    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_len( &c, buf, sub_len ) );
+    MBEDTLS_ASN1_CHK_ADD( len,
+                          mbedtls_asn1_write_tag( &c, buf,
+                                                  MBEDTLS_ASN1_CONSTRUCTED |
+                                                  MBEDTLS_ASN1_SEQUENCE ) );
+
+    /*
+     *  Issuer and Signature, from the template
+     */
+    if( tpl->issuer_len > (size_t)( c - buf ) )
+        return( MBEDTLS_ERR_ASN1_BUF_TOO_SMALL );
+
+    c -= tpl->issuer_len;
+    memcpy( c, tpl->issuer, tpl->issuer_len );
+    len += tpl->issuer_len;
+
+    /*
+     *  Serial   ::=  INTEGER
+     */
+    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_mpi( &c, buf,
+                                                       item->serial ) );
+
+    /*
+     *  Version  ::=  INTEGER  {  v1(0), v2(1), v3(2)  }
+     */
+
+    /* Can be omitted for v1 */
+    if( tpl->version != MBEDTLS_X509_CRT_VERSION_1 )
+    {
+        sub_len = 0;
+        MBEDTLS_ASN1_CHK_ADD( sub_len,
+                              mbedtls_asn1_write_int( &c, buf, tpl->version ) );
+        len += sub_len;
+        MBEDTLS_ASN1_CHK_ADD( len,
+                              mbedtls_asn1_write_len( &c, buf, sub_len ) );
+        MBEDTLS_ASN1_CHK_ADD( len,
+                              mbedtls_asn1_write_tag( &c, buf,
+                                               MBEDTLS_ASN1_CONTEXT_SPECIFIC |
+                                               MBEDTLS_ASN1_CONSTRUCTED | 0 ) );
+    }
+
+    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_len( &c, buf, len ) );
+    MBEDTLS_ASN1_CHK_ADD( len,
+                mbedtls_asn1_write_tag( &c, buf, MBEDTLS_ASN1_CONSTRUCTED |
+                                                     MBEDTLS_ASN1_SEQUENCE ) );
+
+    *tbs = c;
+
+    return( (int) len );
+}
+
+int mbedtls_x509write_crt_issue( const mbedtls_x509write_crt_template *tpl,
+                                 mbedtls_x509write_crt_item *item,
+                                 int (*f_rng)(void *, unsigned char *, size_t),
+                                 void *p_rng )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    unsigned char *c;
+    unsigned char hash[64];
+    unsigned char sig[MBEDTLS_PK_SIGNATURE_MAX_SIZE];
+    size_t len, sig_len;
+
+    if( ( ret = x509write_crt_tbs( tpl, item, &c ) ) < 0 )
+        goto exit;
+    len = (size_t) ret;
+
+    /*
+     * Make signature
+     */
+    if( ( ret = mbedtls_md( mbedtls_md_info_from_type( tpl->md_alg ), c,
+                            len, hash ) ) != 0 )
+        goto exit;
+
+    if( ( ret = mbedtls_pk_sign( tpl->issuer_key, tpl->md_alg,
+                                 hash, 0, sig, &sig_len,
+                                 f_rng, p_rng ) ) != 0 )
+        goto exit;
+
+    ret = x509write_crt_signed( item->buf, item->size, c, len,
+                                tpl->sig_oid, tpl->sig_oid_len,
+                                sig, sig_len );
+
+exit:
+    item->ret = ret;
+
+    return( ret );
+}
+
+#if defined(MBEDTLS_ECDSA_BATCH_SIGN)
+/*
+ * A TBSCertificate waiting for its signature
+ */
+typedef struct
+{
+    mbedtls_x509write_crt_item *item;
+    unsigned char *tbs;
+    size_t len;
+}
+x509write_crt_unsigned;
+
+/*
+ * Convert a signature to ASN.1, as ecdsa_signature_to_asn1() does
+ */
+static int x509write_crt_ecdsa_sig( const mbedtls_mpi *r, const mbedtls_mpi *s,
+                                    unsigned char *sig, size_t *slen )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    unsigned char buf[MBEDTLS_ECDSA_MAX_LEN];
+    unsigned char *p = buf + sizeof( buf );
+    size_t len = 0;
+
+    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_mpi( &p, buf, s ) );
+    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_mpi( &p, buf, r ) );
+
+    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_len( &p, buf, len ) );
+    MBEDTLS_ASN1_CHK_ADD( len, mbedtls_asn1_write_tag( &p, buf,
+                                       MBEDTLS_ASN1_CONSTRUCTED |
+                                       MBEDTLS_ASN1_SEQUENCE ) );
+
+    memcpy( sig, p, len );
+    *slen = len;
+
+    return( 0 );
+}
+
+/*
+ * Issue certificates with an ECDSA key, signing them all at once
+ */
+static void x509write_crt_issue_ecdsa( const mbedtls_x509write_crt_template *tpl,
+                                       mbedtls_x509write_crt_item *items,
+                                       size_t count,
+                                       int (*f_rng)(void *, unsigned char *, size_t),
+                                       void *p_rng )
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_ecp_keypair *ec = mbedtls_pk_ec( *tpl->issuer_key );
+    const mbedtls_md_info_t *md_info = mbedtls_md_info_from_type( tpl->md_alg );
+    size_t hlen = mbedtls_md_get_size( md_info );
+    x509write_crt_unsigned *todo;
+    unsigned char *hashes;
+    mbedtls_mpi *r, *s;
+    unsigned char sig[MBEDTLS_ECDSA_MAX_LEN];
+    size_t i, n = 0, sig_len;
+
+    todo = mbedtls_calloc( count, sizeof( x509write_crt_unsigned ) );
+    hashes = mbedtls_calloc( count, hlen );
+    r = mbedtls_calloc( count, sizeof( mbedtls_mpi ) );
+    s = mbedtls_calloc( count, sizeof( mbedtls_mpi ) );
+    if( todo == NULL || hashes == NULL || r == NULL || s == NULL )
+    {
+        for( i = 0; i < count; i++ )
+            items[i].ret = MBEDTLS_ERR_X509_ALLOC_FAILED;
+        goto cleanup;
+    }
+
+    for( i = 0; i < count; i++ )
+    {
+        mbedtls_mpi_init( &r[i] );
+        mbedtls_mpi_init( &s[i] );
+    }
+
+    for( i = 0; i < count; i++ )
+    {
+        if( ( ret = x509write_crt_tbs( tpl, &items[i], &todo[n].tbs ) ) < 0 )
+        {
+            items[i].ret = ret;
+            continue;
+        }
+        todo[n].len = (size_t) ret;
+
+        if( ( ret = mbedtls_md( md_info, todo[n].tbs, todo[n].len,
+                                hashes + n * hlen ) ) != 0 )
+        {
+            items[i].ret = ret;
+            continue;
+        }
+
+        todo[n++].item = &items[i];
+    }
+
+    if( n > 0 &&
+        ( ret = mbedtls_ecdsa_sign_batch( &ec->grp, r, s, &ec->d,
+                                          hashes, hlen, n,
+                                          f_rng, p_rng ) ) != 0 )
+    {
+        for( i = 0; i < n; i++ )
+            todo[i].item->ret = ret;
+        goto cleanup;
+    }
+
+    for( i = 0; i < n; i++ )
+    {
+        mbedtls_x509write_crt_item *item = todo[i].item;
+
+        if( ( ret = x509write_crt_ecdsa_sig( &r[i], &s[i],
+                                             sig, &sig_len ) ) == 0 )
+        {
+            ret = x509write_crt_signed( item->buf, item->size,
+                                        todo[i].tbs, todo[i].len,
+                                        tpl->sig_oid, tpl->sig_oid_len,
+                                        sig, sig_len );
+        }
+
+        item->ret = ret;
+    }
+
+cleanup:
+    if( r != NULL && s != NULL )
+    {
+        for( i = 0; i < count; i++ )
+        {
+            mbedtls_mpi_free( &r[i] );
+            mbedtls_mpi_free( &s[i] );
+        }
+    }
+    mbedtls_free( todo );
+    mbedtls_free( hashes );
+    mbedtls_free( r );
+    mbedtls_free( s );
+}
+#endif /* MBEDTLS_ECDSA_BATCH_SIGN */
+
+/*
+ * Issue a range of certificates on the current thread
+ */
+static void x509write_crt_issue_range( const mbedtls_x509write_crt_template *tpl,
+                                       mbedtls_x509write_crt_item *items,
+                                       size_t count,
+                                       int (*f_rng)(void *, unsigned char *, size_t),
+                                       void *p_rng )
+{
+    size_t i;
+
+#if defined(MBEDTLS_ECDSA_BATCH_SIGN)
+    if( mbedtls_pk_get_type( tpl->issuer_key ) == MBEDTLS_PK_ECKEY ||
+        mbedtls_pk_get_type( tpl->issuer_key ) == MBEDTLS_PK_ECDSA )
+    {
+        x509write_crt_issue_ecdsa( tpl, items, count, f_rng, p_rng );
+        return;
+    }
+#endif /* MBEDTLS_ECDSA_BATCH_SIGN */
+
+    for( i = 0; i < count; i++ )
+        (void) mbedtls_x509write_crt_issue( tpl, &items[i], f_rng, p_rng );
+}
+
+#if defined(MBEDTLS_THREADING_PTHREAD)
+/*
+ * A range of certificates to issue on a worker thread
+ */
+typedef struct
+{
+    const mbedtls_x509write_crt_template *tpl;
+    mbedtls_x509write_crt_item *items;
+    size_t count;
+    int (*f_rng)(void *, unsigned char *, size_t);
+    void *p_rng;
+}
+x509write_crt_range;
+
+static void *x509write_crt_issue_worker( void *arg )
+{
+    x509write_crt_range *range = (x509write_crt_range *) arg;
+
+    x509write_crt_issue_range( range->tpl, range->items, range->count,
+                               range->f_rng, range->p_rng );
+
+    return( NULL );
+}
+
+/*
+ * Compute what the issuer key would otherwise compute and keep on its first
+ * use, so that the workers only read it: for an EC key, the table of
+ * multiples of the base point that mbedtls_ecp_mul() stores in the group.
+ * (RSA keys protect their blinding values with their own mutex.)
+ */
+static int x509write_crt_prepare_key( const mbedtls_x509write_crt_template *tpl,
+                                      int (*f_rng)(void *, unsigned char *, size_t),
+                                      void *p_rng )
+{
+#if defined(MBEDTLS_ECP_C) && !defined(MBEDTLS_ECP_ALT)
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_ecp_keypair *ec;
+    mbedtls_ecp_point R;
+    mbedtls_mpi one;
+
+    if( ! mbedtls_pk_can_do( tpl->issuer_key, MBEDTLS_PK_ECKEY ) )
+        return( 0 );
+
+    ec = mbedtls_pk_ec( *tpl->issuer_key );
+
+    mbedtls_ecp_point_init( &R );
+    mbedtls_mpi_init( &one );
+
+    MBEDTLS_MPI_CHK( mbedtls_mpi_lset( &one, 1 ) );
+    MBEDTLS_MPI_CHK( mbedtls_ecp_mul( &ec->grp, &R, &one, &ec->grp.G,
+                                      f_rng, p_rng ) );
+
+cleanup:
+    mbedtls_ecp_point_free( &R );
+    mbedtls_mpi_free( &one );
+
+    return( ret );
+#else
+    (void) tpl;
+    (void) f_rng;
+    (void) p_rng;
+
+    return( 0 );
+#endif /* MBEDTLS_ECP_C && !MBEDTLS_ECP_ALT */
+}
+#endif /* MBEDTLS_THREADING_PTHREAD */
+
+int mbedtls_x509write_crt_issue_batch( const mbedtls_x509write_crt_template *tpl,
+                                       mbedtls_x509write_crt_item *items,
+                                       size_t count, int workers,
+                                       int (*f_rng)(void *, unsigned char *, size_t),
+                                       void *p_rng )
+{
+    size_t i;
+#if defined(MBEDTLS_THREADING_PTHREAD)
+    x509write_crt_range *ranges = NULL;
+    pthread_t *threads = NULL;
+    size_t n, k, started = 0;
+#endif
+
+    if( count == 0 )
+        return( 0 );
+
+#if defined(MBEDTLS_THREADING_PTHREAD)
+    n = workers > 1 ? (size_t) workers : 1;
+    if( n > count )
+        n = count;
+
+    /* The issuer key must be ready before it is used concurrently; if it
+     * can't be prepared, issue everything on the calling thread */
+    if( n > 1 && x509write_crt_prepare_key( tpl, f_rng, p_rng ) != 0 )
+        n = 1;
+
+    if( n > 1 )
+    {
+        ranges = mbedtls_calloc( n, sizeof( x509write_crt_range ) );
+        threads = mbedtls_calloc( n - 1, sizeof( pthread_t ) );
+        if( ranges == NULL || threads == NULL )
+            n = 1;
+    }
+
+    if( n > 1 )
+    {
+        /* The calling thread is one of the workers */
+        for( k = 0; k < n; k++ )
+        {
+            ranges[k].tpl = tpl;
+            ranges[k].items = items + count * k / n;
+            ranges[k].count = count * ( k + 1 ) / n - count * k / n;
+            ranges[k].f_rng = f_rng;
+            ranges[k].p_rng = p_rng;
+        }
+
+        for( k = 1; k < n; k++ )
+        {
+            if( pthread_create( &threads[started], NULL,
+                                x509write_crt_issue_worker, &ranges[k] ) == 0 )
+                started++;
+            else
+                (void) x509write_crt_issue_worker( &ranges[k] );
+        }
+
+        (void) x509write_crt_issue_worker( &ranges[0] );
+
+        for( k = 0; k < started; k++ )
+            (void) pthread_join( threads[k], NULL );
+    }
+    else
+        x509write_crt_issue_range( tpl, items, count, f_rng, p_rng );
+
+    mbedtls_free( ranges );
+    mbedtls_free( threads );
+#else
+    (void) workers;
+
+    x509write_crt_issue_range( tpl, items, count, f_rng, p_rng );
+#endif /* MBEDTLS_THREADING_PTHREAD */
+
+    for( i = 0; i < count; i++ )
+    {
+        if( items[i].ret < 0 )
+            return( items[i].ret );
+    }
+
+    return( 0 );
+}
+#endif /* MBEDTLS_X509_CRT_WRITE_TEMPLATE */
+
 #endif /* MBEDTLS_X509_CRT_WRITE_C */
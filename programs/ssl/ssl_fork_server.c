@@ -78,6 +78,12 @@ int main( void )
 #include <unistd.h>
 #endif
 
+#if defined(MBEDTLS_X509_CRT_STORE)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #define HTTP_RESPONSE \
     "HTTP/1.0 200 OK\r\nContent-Type: text/html\r\n\r\n" \
     "<h2>mbed TLS Test Server</h2>\r\n" \
@@ -96,7 +102,40 @@ static void my_debug( void *ctx, int level,
     fflush(  (FILE *) ctx  );
 }
 
-int main( void )
+#if defined(MBEDTLS_X509_CRT_STORE)
+/*
+ * Map a trust store written by programs/x509/cert_store read-only: the
+ * pages are shared by all the forked children and nothing is parsed but
+ * what mbedtls_x509_crt_parse_store() needs.
+ */
+static unsigned char *map_store( const char *path, size_t *len )
+{
+    struct stat sb;
+    void *p;
+    int fd = open( path, O_RDONLY );
+
+    if( fd < 0 )
+        return( NULL );
+
+    if( fstat( fd, &sb ) != 0 || sb.st_size <= 0 )
+    {
+        close( fd );
+        return( NULL );
+    }
+
+    p = mmap( NULL, (size_t) sb.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+    close( fd );
+
+    if( p == MAP_FAILED )
+        return( NULL );
+
+    *len = (size_t) sb.st_size;
+
+    return( (unsigned char *) p );
+}
+#endif /* MBEDTLS_X509_CRT_STORE */
+
+int main( int argc, char *argv[] )
 {
     int ret = 1, len, cnt = 0, pid;
     int exit_code = MBEDTLS_EXIT_FAILURE;
@@ -110,6 +149,11 @@ int main( void )
     mbedtls_ssl_config conf;
     mbedtls_x509_crt srvcert;
     mbedtls_pk_context pkey;
+#if defined(MBEDTLS_X509_CRT_STORE)
+    mbedtls_x509_crt cacert;
+    unsigned char *store = NULL;
+    size_t store_len = 0;
+#endif
 
     mbedtls_net_init( &listen_fd );
     mbedtls_net_init( &client_fd );
@@ -119,6 +163,12 @@ int main( void )
     mbedtls_pk_init( &pkey );
     mbedtls_x509_crt_init( &srvcert );
     mbedtls_ctr_drbg_init( &ctr_drbg );
+#if defined(MBEDTLS_X509_CRT_STORE)
+    mbedtls_x509_crt_init( &cacert );
+#else
+    ((void) argc);
+    ((void) argv);
+#endif
 
     signal( SIGCHLD, SIG_IGN );
 
@@ -148,6 +198,8 @@ int main( void )
      * This demonstration program uses embedded test certificates.
      * Instead, you may want to use mbedtls_x509_crt_parse_file() to read the
      * server and CA certificates, as well as mbedtls_pk_parse_keyfile().
+     * With MBEDTLS_X509_CRT_STORE, the CA certificates can instead come from
+     * a trust store file given as the first argument (see step 1a).
      */
     ret = mbedtls_x509_crt_parse( &srvcert, (const unsigned char *) mbedtls_test_srv_crt,
                           mbedtls_test_srv_crt_len );
@@ -175,6 +227,32 @@ int main( void )
 
     mbedtls_printf( " ok\n" );
 
+#if defined(MBEDTLS_X509_CRT_STORE)
+    /*
+     * 1a. Optionally use a trust store given on the command line
+     */
+    if( argc > 1 )
+    {
+        mbedtls_printf( "  . Mapping the trust store %s...", argv[1] );
+        fflush( stdout );
+
+        if( ( store = map_store( argv[1], &store_len ) ) == NULL )
+        {
+            mbedtls_printf( " failed!  could not map %s\n\n", argv[1] );
+            goto exit;
+        }
+
+        if( ( ret = mbedtls_x509_crt_parse_store( &cacert, store,
+                                                  store_len ) ) != 0 )
+        {
+            mbedtls_printf( " failed!  mbedtls_x509_crt_parse_store returned %d\n\n", ret );
+            goto exit;
+        }
+
+        mbedtls_printf( " ok\n" );
+    }
+#endif /* MBEDTLS_X509_CRT_STORE */
+
     /*
      * 1b. Prepare SSL configuration
      */
@@ -193,7 +271,14 @@ int main( void )
     mbedtls_ssl_conf_rng( &conf, mbedtls_ctr_drbg_random, &ctr_drbg );
     mbedtls_ssl_conf_dbg( &conf, my_debug, stdout );
 
-    mbedtls_ssl_conf_ca_chain( &conf, srvcert.next, NULL );
+#if defined(MBEDTLS_X509_CRT_STORE)
+    if( store != NULL )
+        mbedtls_ssl_conf_ca_chain( &conf, &cacert, NULL );
+    else
+#endif
+    {
+        mbedtls_ssl_conf_ca_chain( &conf, srvcert.next, NULL );
+    }
     if( ( ret = mbedtls_ssl_conf_own_cert( &conf, &srvcert, &pkey ) ) != 0 )
     {
         mbedtls_printf( " failed!  mbedtls_ssl_conf_own_cert returned %d\n\n", ret );
@@ -404,6 +489,12 @@ exit:
     mbedtls_net_free( &listen_fd );
 
     mbedtls_x509_crt_free( &srvcert );
+#if defined(MBEDTLS_X509_CRT_STORE)
+    /* The certificates point into the store: free them first */
+    mbedtls_x509_crt_free( &cacert );
+    if( store != NULL )
+        munmap( store, store_len );
+#endif
     mbedtls_pk_free( &pkey );
     mbedtls_ssl_free( &ssl );
     mbedtls_ssl_config_free( &conf );
@@ -69,6 +69,7 @@ int main( void )
 #include "mbedtls/ctr_drbg.h"
 #include "mbedtls/hmac_drbg.h"
 
+#include "mbedtls/bignum.h"
 #include "mbedtls/rsa.h"
 #include "mbedtls/dhm.h"
 #include "mbedtls/ecdsa.h"
@@ -102,7 +103,7 @@ int main( void )
     "aes_cbc, aes_gcm, aes_ccm, aes_xts, chachapoly,\n"                 \
     "aes_cmac, des3_cmac, poly1305\n"                                   \
     "havege, ctr_drbg, hmac_drbg\n"                                     \
-    "rsa, dhm, ecdsa, ecdh.\n"
+    "mpi, rsa, dhm, ecp, ecdsa, ecdh.\n"
 
 #if defined(MBEDTLS_ERROR_C)
 #define PRINT_ERROR                                                     \
@@ -276,7 +277,7 @@ typedef struct {
          aria, camellia, blowfish, chacha20,
          poly1305,
          havege, ctr_drbg, hmac_drbg,
-         rsa, dhm, ecdsa, ecdh;
+         mpi, rsa, dhm, ecp, ecdsa, ecdh;
 } todo_list;
 
 
@@ -348,10 +349,14 @@ int main( int argc, char *argv[] )
                 todo.ctr_drbg = 1;
             else if( strcmp( argv[i], "hmac_drbg" ) == 0 )
                 todo.hmac_drbg = 1;
+            else if( strcmp( argv[i], "mpi" ) == 0 )
+                todo.mpi = 1;
             else if( strcmp( argv[i], "rsa" ) == 0 )
                 todo.rsa = 1;
             else if( strcmp( argv[i], "dhm" ) == 0 )
                 todo.dhm = 1;
+            else if( strcmp( argv[i], "ecp" ) == 0 )
+                todo.ecp = 1;
             else if( strcmp( argv[i], "ecdsa" ) == 0 )
                 todo.ecdsa = 1;
             else if( strcmp( argv[i], "ecdh" ) == 0 )
@@ -756,6 +761,41 @@ int main( int argc, char *argv[] )
     }
 #endif
 
+#if defined(MBEDTLS_BIGNUM_C)
+    if( todo.mpi )
+    {
+        int bits;
+        mbedtls_mpi A, B, N, X;
+
+        mbedtls_mpi_init( &A ); mbedtls_mpi_init( &B );
+        mbedtls_mpi_init( &N ); mbedtls_mpi_init( &X );
+
+        for( bits = 2048; bits <= 8192; bits *= 2 )
+        {
+            if( mbedtls_mpi_fill_random( &A, bits / 8, myrand, NULL ) != 0 ||
+                mbedtls_mpi_fill_random( &B, bits / 8, myrand, NULL ) != 0 ||
+                mbedtls_mpi_fill_random( &N, bits / 8, myrand, NULL ) != 0 ||
+                mbedtls_mpi_set_bit( &N, 0, 1 ) != 0 ||
+                mbedtls_mpi_set_bit( &N, bits - 1, 1 ) != 0 ||
+                mbedtls_mpi_mod_mpi( &A, &A, &N ) != 0 )
+            {
+                mbedtls_exit( 1 );
+            }
+
+            mbedtls_snprintf( title, sizeof( title ), "MPI-%d", bits );
+
+            TIME_PUBLIC( title, "    mul",
+                    ret = mbedtls_mpi_mul_mpi( &X, &A, &B ) );
+
+            TIME_PUBLIC( title, "exp_mod",
+                    ret = mbedtls_mpi_exp_mod( &X, &A, &B, &N, NULL ) );
+        }
+
+        mbedtls_mpi_free( &A ); mbedtls_mpi_free( &B );
+        mbedtls_mpi_free( &N ); mbedtls_mpi_free( &X );
+    }
+#endif
+
 #if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_GENPRIME)
     if( todo.rsa )
     {
@@ -836,6 +876,58 @@ int main( int argc, char *argv[] )
     }
 #endif
 
+#if defined(MBEDTLS_ECP_C)
+    if( todo.ecp )
+    {
+        mbedtls_ecp_group grp;
+        mbedtls_ecp_point P, Q, R;
+        mbedtls_mpi m, n;
+        const mbedtls_ecp_curve_info *curve_info;
+
+        for( curve_info = mbedtls_ecp_curve_list();
+             curve_info->grp_id != MBEDTLS_ECP_DP_NONE;
+             curve_info++ )
+        {
+            mbedtls_ecp_group_init( &grp );
+            mbedtls_ecp_point_init( &P );
+            mbedtls_ecp_point_init( &Q );
+            mbedtls_ecp_point_init( &R );
+            mbedtls_mpi_init( &m );
+            mbedtls_mpi_init( &n );
+
+            if( mbedtls_ecp_group_load( &grp, curve_info->grp_id ) != 0 )
+                mbedtls_exit( 1 );
+
+            if( mbedtls_ecp_get_type( &grp ) !=
+                MBEDTLS_ECP_TYPE_SHORT_WEIERSTRASS )
+            {
+                mbedtls_ecp_group_free( &grp );
+                continue;
+            }
+
+            if( mbedtls_ecp_gen_keypair( &grp, &m, &P, myrand, NULL ) != 0 ||
+                mbedtls_ecp_gen_keypair( &grp, &n, &Q, myrand, NULL ) != 0 )
+                mbedtls_exit( 1 );
+
+            /* Multiplication of a point other than the generator, as in
+             * ECDH, and linear combination, as in ECDSA verification */
+            mbedtls_snprintf( title, sizeof( title ), "ECP-%s",
+                                              curve_info->name );
+            TIME_PUBLIC( title, "mul",
+                    ret = mbedtls_ecp_mul( &grp, &R, &m, &Q, myrand, NULL ) );
+            TIME_PUBLIC( title, "muladd",
+                    ret = mbedtls_ecp_muladd( &grp, &R, &m, &grp.G, &n, &Q ) );
+
+            mbedtls_ecp_group_free( &grp );
+            mbedtls_ecp_point_free( &P );
+            mbedtls_ecp_point_free( &Q );
+            mbedtls_ecp_point_free( &R );
+            mbedtls_mpi_free( &m );
+            mbedtls_mpi_free( &n );
+        }
+    }
+#endif
+
 #if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_SHA256_C)
     if( todo.ecdsa )
     {
@@ -160,6 +160,14 @@ int query_config( const char *config )
     }
 #endif /* MBEDTLS_HAVE_SSE2 */
 
+#if defined(MBEDTLS_BIGNUM_ADX)
+    if( strcmp( "MBEDTLS_BIGNUM_ADX", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_BIGNUM_ADX );
+        return( 0 );
+    }
+#endif /* MBEDTLS_BIGNUM_ADX */
+
 #if defined(MBEDTLS_HAVE_TIME)
     if( strcmp( "MBEDTLS_HAVE_TIME", config ) == 0 )
     {
@@ -984,6 +992,30 @@ int query_config( const char *config )
     }
 #endif /* MBEDTLS_ECP_NIST_OPTIM */
 
+#if defined(MBEDTLS_ECP_GLV_OPTIM)
+    if( strcmp( "MBEDTLS_ECP_GLV_OPTIM", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_ECP_GLV_OPTIM );
+        return( 0 );
+    }
+#endif /* MBEDTLS_ECP_GLV_OPTIM */
+
+#if defined(MBEDTLS_ECP_MONT_FIELD_OPTIM)
+    if( strcmp( "MBEDTLS_ECP_MONT_FIELD_OPTIM", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_ECP_MONT_FIELD_OPTIM );
+        return( 0 );
+    }
+#endif /* MBEDTLS_ECP_MONT_FIELD_OPTIM */
+
+#if defined(MBEDTLS_ECP_FIXED_FIELD_OPTIM)
+    if( strcmp( "MBEDTLS_ECP_FIXED_FIELD_OPTIM", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_ECP_FIXED_FIELD_OPTIM );
+        return( 0 );
+    }
+#endif /* MBEDTLS_ECP_FIXED_FIELD_OPTIM */
+
 #if defined(MBEDTLS_ECP_NO_INTERNAL_RNG)
     if( strcmp( "MBEDTLS_ECP_NO_INTERNAL_RNG", config ) == 0 )
     {
@@ -1000,6 +1032,22 @@ int query_config( const char *config )
     }
 #endif /* MBEDTLS_ECP_RESTARTABLE */
 
+#if defined(MBEDTLS_ECP_SHARED_GROUPS)
+    if( strcmp( "MBEDTLS_ECP_SHARED_GROUPS", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_ECP_SHARED_GROUPS );
+        return( 0 );
+    }
+#endif /* MBEDTLS_ECP_SHARED_GROUPS */
+
+#if defined(MBEDTLS_ECP_KEY_PRECOMP)
+    if( strcmp( "MBEDTLS_ECP_KEY_PRECOMP", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_ECP_KEY_PRECOMP );
+        return( 0 );
+    }
+#endif /* MBEDTLS_ECP_KEY_PRECOMP */
+
 #if defined(MBEDTLS_ECDH_LEGACY_CONTEXT)
     if( strcmp( "MBEDTLS_ECDH_LEGACY_CONTEXT", config ) == 0 )
     {
@@ -1008,6 +1056,22 @@ int query_config( const char *config )
     }
 #endif /* MBEDTLS_ECDH_LEGACY_CONTEXT */
 
+#if defined(MBEDTLS_ECDSA_BATCH_SIGN)
+    if( strcmp( "MBEDTLS_ECDSA_BATCH_SIGN", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_ECDSA_BATCH_SIGN );
+        return( 0 );
+    }
+#endif /* MBEDTLS_ECDSA_BATCH_SIGN */
+
+#if defined(MBEDTLS_ECDSA_BATCH_VERIFY)
+    if( strcmp( "MBEDTLS_ECDSA_BATCH_VERIFY", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_ECDSA_BATCH_VERIFY );
+        return( 0 );
+    }
+#endif /* MBEDTLS_ECDSA_BATCH_VERIFY */
+
 #if defined(MBEDTLS_ECDSA_DETERMINISTIC)
     if( strcmp( "MBEDTLS_ECDSA_DETERMINISTIC", config ) == 0 )
     {
@@ -1016,6 +1080,14 @@ int query_config( const char *config )
     }
 #endif /* MBEDTLS_ECDSA_DETERMINISTIC */
 
+#if defined(MBEDTLS_ECDSA_NONCE_POOL)
+    if( strcmp( "MBEDTLS_ECDSA_NONCE_POOL", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_ECDSA_NONCE_POOL );
+        return( 0 );
+    }
+#endif /* MBEDTLS_ECDSA_NONCE_POOL */
+
 #if defined(MBEDTLS_KEY_EXCHANGE_PSK_ENABLED)
     if( strcmp( "MBEDTLS_KEY_EXCHANGE_PSK_ENABLED", config ) == 0 )
     {
@@ -1120,6 +1192,14 @@ int query_config( const char *config )
     }
 #endif /* MBEDTLS_ERROR_STRERROR_DUMMY */
 
+#if defined(MBEDTLS_DHM_FIXED_BASE)
+    if( strcmp( "MBEDTLS_DHM_FIXED_BASE", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_DHM_FIXED_BASE );
+        return( 0 );
+    }
+#endif /* MBEDTLS_DHM_FIXED_BASE */
+
 #if defined(MBEDTLS_GENPRIME)
     if( strcmp( "MBEDTLS_GENPRIME", config ) == 0 )
     {
@@ -1152,6 +1232,14 @@ int query_config( const char *config )
     }
 #endif /* MBEDTLS_NO_PLATFORM_ENTROPY */
 
+#if defined(MBEDTLS_OID_HASH_LOOKUP)
+    if( strcmp( "MBEDTLS_OID_HASH_LOOKUP", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_OID_HASH_LOOKUP );
+        return( 0 );
+    }
+#endif /* MBEDTLS_OID_HASH_LOOKUP */
+
 #if defined(MBEDTLS_ENTROPY_FORCE_SHA256)
     if( strcmp( "MBEDTLS_ENTROPY_FORCE_SHA256", config ) == 0 )
     {
@@ -1248,6 +1336,14 @@ int query_config( const char *config )
     }
 #endif /* MBEDTLS_RSA_NO_CRT */
 
+#if defined(MBEDTLS_RSA_GEN_KEY_PARALLEL)
+    if( strcmp( "MBEDTLS_RSA_GEN_KEY_PARALLEL", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_RSA_GEN_KEY_PARALLEL );
+        return( 0 );
+    }
+#endif /* MBEDTLS_RSA_GEN_KEY_PARALLEL */
+
 #if defined(MBEDTLS_SELF_TEST)
     if( strcmp( "MBEDTLS_SELF_TEST", config ) == 0 )
     {
@@ -1624,6 +1720,54 @@ int query_config( const char *config )
     }
 #endif /* MBEDTLS_X509_TRUSTED_CERTIFICATE_CALLBACK */
 
+#if defined(MBEDTLS_X509_CA_INDEX)
+    if( strcmp( "MBEDTLS_X509_CA_INDEX", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_X509_CA_INDEX );
+        return( 0 );
+    }
+#endif /* MBEDTLS_X509_CA_INDEX */
+
+#if defined(MBEDTLS_X509_CRL_SERIAL_INDEX)
+    if( strcmp( "MBEDTLS_X509_CRL_SERIAL_INDEX", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_X509_CRL_SERIAL_INDEX );
+        return( 0 );
+    }
+#endif /* MBEDTLS_X509_CRL_SERIAL_INDEX */
+
+#if defined(MBEDTLS_X509_CRT_FRAME_PARSING)
+    if( strcmp( "MBEDTLS_X509_CRT_FRAME_PARSING", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_X509_CRT_FRAME_PARSING );
+        return( 0 );
+    }
+#endif /* MBEDTLS_X509_CRT_FRAME_PARSING */
+
+#if defined(MBEDTLS_X509_CRT_PARSE_PATH_DEDUP)
+    if( strcmp( "MBEDTLS_X509_CRT_PARSE_PATH_DEDUP", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_X509_CRT_PARSE_PATH_DEDUP );
+        return( 0 );
+    }
+#endif /* MBEDTLS_X509_CRT_PARSE_PATH_DEDUP */
+
+#if defined(MBEDTLS_X509_CRT_STORE)
+    if( strcmp( "MBEDTLS_X509_CRT_STORE", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_X509_CRT_STORE );
+        return( 0 );
+    }
+#endif /* MBEDTLS_X509_CRT_STORE */
+
+#if defined(MBEDTLS_X509_CRT_WRITE_TEMPLATE)
+    if( strcmp( "MBEDTLS_X509_CRT_WRITE_TEMPLATE", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_X509_CRT_WRITE_TEMPLATE );
+        return( 0 );
+    }
+#endif /* MBEDTLS_X509_CRT_WRITE_TEMPLATE */
+
 #if defined(MBEDTLS_X509_CHECK_KEY_USAGE)
     if( strcmp( "MBEDTLS_X509_CHECK_KEY_USAGE", config ) == 0 )
     {
@@ -2208,6 +2352,14 @@ int query_config( const char *config )
     }
 #endif /* MBEDTLS_X509_CRT_PARSE_C */
 
+#if defined(MBEDTLS_X509_CRT_CACHE_C)
+    if( strcmp( "MBEDTLS_X509_CRT_CACHE_C", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_X509_CRT_CACHE_C );
+        return( 0 );
+    }
+#endif /* MBEDTLS_X509_CRT_CACHE_C */
+
 #if defined(MBEDTLS_X509_CRL_PARSE_C)
     if( strcmp( "MBEDTLS_X509_CRL_PARSE_C", config ) == 0 )
     {
@@ -2712,6 +2864,22 @@ int query_config( const char *config )
     }
 #endif /* MBEDTLS_X509_MAX_FILE_PATH_LEN */
 
+#if defined(MBEDTLS_X509_CRT_CACHE_DEFAULT_TIMEOUT)
+    if( strcmp( "MBEDTLS_X509_CRT_CACHE_DEFAULT_TIMEOUT", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_X509_CRT_CACHE_DEFAULT_TIMEOUT );
+        return( 0 );
+    }
+#endif /* MBEDTLS_X509_CRT_CACHE_DEFAULT_TIMEOUT */
+
+#if defined(MBEDTLS_X509_CRT_CACHE_DEFAULT_MAX_ENTRIES)
+    if( strcmp( "MBEDTLS_X509_CRT_CACHE_DEFAULT_MAX_ENTRIES", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_X509_CRT_CACHE_DEFAULT_MAX_ENTRIES );
+        return( 0 );
+    }
+#endif /* MBEDTLS_X509_CRT_CACHE_DEFAULT_MAX_ENTRIES */
+
 #if defined(MBEDTLS_TLS_DEFAULT_ALLOW_SHA1_IN_CERTIFICATES)
     if( strcmp( "MBEDTLS_TLS_DEFAULT_ALLOW_SHA1_IN_CERTIFICATES", config ) == 0 )
     {
@@ -0,0 +1,380 @@
+/*
+ *  Trust store writing and dumping program
+ *
+ *  Copyright The Mbed TLS Contributors
+ *  SPDX-License-Identifier: Apache-2.0
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *  not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *  WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#define mbedtls_calloc          calloc
+#define mbedtls_free            free
+#define mbedtls_printf          printf
+#define mbedtls_snprintf        snprintf
+#define mbedtls_exit            exit
+#define MBEDTLS_EXIT_SUCCESS    EXIT_SUCCESS
+#define MBEDTLS_EXIT_FAILURE    EXIT_FAILURE
+#endif /* MBEDTLS_PLATFORM_C */
+
+#if !defined(MBEDTLS_X509_CRT_STORE) || !defined(MBEDTLS_FS_IO)
+int main( void )
+{
+    mbedtls_printf("MBEDTLS_X509_CRT_STORE and/or MBEDTLS_FS_IO not defined.\n");
+    mbedtls_exit( 0 );
+}
+#else
+
+#include "mbedtls/x509_crt.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MODE_NONE               0
+#define MODE_WRITE              1
+#define MODE_INFO               2
+
+#define DFL_MODE                MODE_NONE
+#define DFL_CA_FILE             ""
+#define DFL_CA_PATH             ""
+#define DFL_FILENAME            "ca.store"
+
+#define USAGE \
+    "\n usage: cert_store param=<>...\n"                    \
+    "\n acceptable parameters:\n"                           \
+    "    mode=write|info     default: none\n"               \
+    "    ca_file=%%s          The certificates to store (mode=write)\n" \
+    "                        default: \"\" (none)\n"        \
+    "    ca_path=%%s          A directory of certificates to store\n" \
+    "                        (mode=write), added after ca_file\n"     \
+    "                        default: \"\" (none)\n"        \
+    "    filename=%%s         The trust store to write or dump\n" \
+    "                        default: ca.store\n"           \
+    "\n"
+
+
+/*
+ * global options
+ */
+struct options
+{
+    int mode;                   /* write or dump a store                */
+    const char *ca_file;        /* the file with the certificates       */
+    const char *ca_path;        /* the directory with the certificates  */
+    const char *filename;       /* filename of the trust store          */
+} opt;
+
+/*
+ * Read a whole file into a new buffer
+ */
+static int load_file( const char *path, unsigned char **buf, size_t *n )
+{
+    FILE *f;
+    long size;
+
+    if( ( f = fopen( path, "rb" ) ) == NULL )
+        return( -1 );
+
+    if( fseek( f, 0, SEEK_END ) != 0 || ( size = ftell( f ) ) < 0 ||
+        fseek( f, 0, SEEK_SET ) != 0 )
+    {
+        fclose( f );
+        return( -1 );
+    }
+
+    *n = (size_t) size;
+    if( ( *buf = mbedtls_calloc( 1, *n + 1 ) ) == NULL )
+    {
+        fclose( f );
+        return( -1 );
+    }
+
+    if( fread( *buf, 1, *n, f ) != *n )
+    {
+        fclose( f );
+        mbedtls_free( *buf );
+        *buf = NULL;
+        return( -1 );
+    }
+
+    fclose( f );
+
+    return( 0 );
+}
+
+static int write_store( void )
+{
+    int ret = 1, skipped = 0;
+    mbedtls_x509_crt chain;
+    unsigned char *buf = NULL;
+    size_t len = 0;
+    char tmp_name[1024];
+    FILE *f;
+
+    mbedtls_x509_crt_init( &chain );
+
+    mbedtls_printf( "  . Loading the certificates ..." );
+    fflush( stdout );
+
+    if( strlen( opt.ca_file ) &&
+        ( ret = mbedtls_x509_crt_parse_file( &chain, opt.ca_file ) ) < 0 )
+    {
+        mbedtls_printf( " failed\n  !  mbedtls_x509_crt_parse_file returned -0x%04x\n\n",
+                        (unsigned int) -ret );
+        goto exit;
+    }
+    skipped += ret > 0 ? ret : 0;
+    ret = 0;
+
+    if( strlen( opt.ca_path ) &&
+        ( ret = mbedtls_x509_crt_parse_path( &chain, opt.ca_path ) ) < 0 )
+    {
+        mbedtls_printf( " failed\n  !  mbedtls_x509_crt_parse_path returned -0x%04x\n\n",
+                        (unsigned int) -ret );
+        goto exit;
+    }
+    skipped += ret > 0 ? ret : 0;
+
+    mbedtls_printf( " ok (%d skipped)\n", skipped );
+
+    mbedtls_printf( "  . Writing the trust store ..." );
+    fflush( stdout );
+
+    ret = mbedtls_x509_crt_store_write( &chain, NULL, 0, &len );
+    if( ret == MBEDTLS_ERR_X509_BUFFER_TOO_SMALL )
+    {
+        if( ( buf = mbedtls_calloc( 1, len ) ) == NULL )
+        {
+            mbedtls_printf( " failed\n  !  allocation of %u bytes failed\n\n",
+                            (unsigned int) len );
+            ret = 1;
+            goto exit;
+        }
+
+        ret = mbedtls_x509_crt_store_write( &chain, buf, len, &len );
+    }
+
+    if( ret != 0 )
+    {
+        mbedtls_printf( " failed\n  !  mbedtls_x509_crt_store_write returned -0x%04x\n\n",
+                        (unsigned int) -ret );
+        goto exit;
+    }
+
+    /*
+     * Running servers may have the store mapped, so write a new file and
+     * rename it over the old one rather than rewrite it in place
+     */
+    if( (size_t) mbedtls_snprintf( tmp_name, sizeof( tmp_name ), "%s.tmp",
+                                   opt.filename ) >= sizeof( tmp_name ) )
+    {
+        mbedtls_printf( " failed\n  !  filename too long\n\n" );
+        ret = 1;
+        goto exit;
+    }
+
+    if( ( f = fopen( tmp_name, "wb" ) ) == NULL )
+    {
+        mbedtls_printf( " failed\n  !  could not open %s\n\n", tmp_name );
+        ret = 1;
+        goto exit;
+    }
+
+    if( fwrite( buf, 1, len, f ) != len )
+    {
+        fclose( f );
+        remove( tmp_name );
+        mbedtls_printf( " failed\n  !  could not write %s\n\n", tmp_name );
+        ret = 1;
+        goto exit;
+    }
+
+    if( fclose( f ) != 0 )
+    {
+        remove( tmp_name );
+        mbedtls_printf( " failed\n  !  could not write %s\n\n", tmp_name );
+        ret = 1;
+        goto exit;
+    }
+
+#if defined(_WIN32)
+    /* rename() doesn't replace an existing file on Windows */
+    remove( opt.filename );
+#endif
+    if( rename( tmp_name, opt.filename ) != 0 )
+    {
+        remove( tmp_name );
+        mbedtls_printf( " failed\n  !  could not rename %s to %s\n\n",
+                        tmp_name, opt.filename );
+        ret = 1;
+        goto exit;
+    }
+
+    mbedtls_printf( " ok (%u bytes)\n", (unsigned int) len );
+
+exit:
+    mbedtls_x509_crt_free( &chain );
+    mbedtls_free( buf );
+
+    return( ret );
+}
+
+static int dump_store( void )
+{
+    int ret = 1;
+    mbedtls_x509_crt chain, *cur;
+    mbedtls_x509_crt_store_entry entry;
+    unsigned char *buf = NULL;
+    char name[256];
+    size_t len, count, i;
+
+    mbedtls_x509_crt_init( &chain );
+
+    mbedtls_printf( "  . Loading the trust store ..." );
+    fflush( stdout );
+
+    if( load_file( opt.filename, &buf, &len ) != 0 )
+    {
+        mbedtls_printf( " failed\n  !  could not read %s\n\n", opt.filename );
+        goto exit;
+    }
+
+    if( ( ret = mbedtls_x509_crt_store_check( buf, len, &count ) ) != 0 )
+    {
+        mbedtls_printf( " failed\n  !  mbedtls_x509_crt_store_check returned -0x%04x\n\n",
+                        (unsigned int) -ret );
+        goto exit;
+    }
+
+    if( ( ret = mbedtls_x509_crt_parse_store( &chain, buf, len ) ) != 0 )
+    {
+        mbedtls_printf( " failed\n  !  mbedtls_x509_crt_parse_store returned -0x%04x\n\n",
+                        (unsigned int) -ret );
+        goto exit;
+    }
+
+    mbedtls_printf( " ok (%u certificates)\n", (unsigned int) count );
+
+    for( i = 0, cur = &chain; i < count && cur != NULL; i++, cur = cur->next )
+    {
+        (void) mbedtls_x509_crt_store_get( buf, len, i, &entry );
+
+#if defined(MBEDTLS_X509_CRT_FRAME_PARSING)
+        if( ( ret = mbedtls_x509_crt_frame_decode( cur ) ) != 0 )
+        {
+            mbedtls_printf( "  !  mbedtls_x509_crt_frame_decode returned -0x%04x\n\n",
+                            (unsigned int) -ret );
+            goto exit;
+        }
+#endif
+
+        ret = mbedtls_x509_dn_gets( name, sizeof( name ), &cur->subject );
+        if( ret < 0 )
+            mbedtls_snprintf( name, sizeof( name ), "(name too long)" );
+
+        mbedtls_printf( "  %4u  hash %08lx  %-8s %5u bits  %s  %s\n",
+                        (unsigned int) i, (unsigned long) entry.subject_hash,
+                        mbedtls_pk_get_name( &cur->pk ),
+                        (unsigned int) entry.pk_bits,
+                        entry.ca_istrue ? "CA  " : "leaf", name );
+    }
+
+    ret = 0;
+
+exit:
+    mbedtls_x509_crt_free( &chain );
+    mbedtls_free( buf );
+
+    return( ret );
+}
+
+int main( int argc, char *argv[] )
+{
+    int ret = 1;
+    int exit_code = MBEDTLS_EXIT_FAILURE;
+    int i;
+    char *p, *q;
+
+    if( argc == 0 )
+    {
+    usage:
+        mbedtls_printf( USAGE );
+        goto exit;
+    }
+
+    opt.mode                = DFL_MODE;
+    opt.ca_file             = DFL_CA_FILE;
+    opt.ca_path             = DFL_CA_PATH;
+    opt.filename            = DFL_FILENAME;
+
+    for( i = 1; i < argc; i++ )
+    {
+        p = argv[i];
+        if( ( q = strchr( p, '=' ) ) == NULL )
+            goto usage;
+        *q++ = '\0';
+
+        if( strcmp( p, "mode" ) == 0 )
+        {
+            if( strcmp( q, "write" ) == 0 )
+                opt.mode = MODE_WRITE;
+            else if( strcmp( q, "info" ) == 0 )
+                opt.mode = MODE_INFO;
+            else
+                goto usage;
+        }
+        else if( strcmp( p, "ca_file" ) == 0 )
+            opt.ca_file = q;
+        else if( strcmp( p, "ca_path" ) == 0 )
+            opt.ca_path = q;
+        else if( strcmp( p, "filename" ) == 0 )
+            opt.filename = q;
+        else
+            goto usage;
+    }
+
+    if( opt.mode == MODE_WRITE )
+    {
+        if( strlen( opt.ca_file ) == 0 && strlen( opt.ca_path ) == 0 )
+            goto usage;
+
+        ret = write_store();
+    }
+    else if( opt.mode == MODE_INFO )
+        ret = dump_store();
+    else
+        goto usage;
+
+    if( ret == 0 )
+        exit_code = MBEDTLS_EXIT_SUCCESS;
+
+exit:
+#if defined(_WIN32)
+    mbedtls_printf( "  + Press Enter to exit this program.\n" );
+    fflush( stdout ); getchar();
+#endif
+
+    mbedtls_exit( exit_code );
+}
+#endif /* MBEDTLS_X509_CRT_STORE && MBEDTLS_FS_IO */
@@ -0,0 +1,274 @@
+#!/usr/bin/env python3
+
+"""Generate library/oid_hash.h,
+which is included by library/oid.c when MBEDTLS_OID_HASH_LOOKUP is enabled.
+
+For each descriptor table of library/oid.c that is searched by OID, the
+generated file contains a minimal perfect hash built with the "hash and
+displace" method: the FNV-1a hash of an OID selects a displacement, and the
+displaced hash selects the only table entry that can hold that OID.
+
+Table entries are referred to through an enumeration that repeats the
+preprocessor conditions of the table, so the generated file is valid for
+every configuration.
+
+An argument passed to this script will modify the output directory where the
+file is written:
+* by default (no arguments passed): writes to library/
+* OUTPUT_FILE_DIR passed: writes to OUTPUT_FILE_DIR/
+"""
+
+# Copyright The Mbed TLS Contributors
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may
+# not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import os
+import re
+import sys
+
+OUTPUT_HEADER = '''\
+/* Automatically generated by generate_oid_hash.py. DO NOT EDIT. */
+
+/*
+ * Perfect hash tables for the OID lookups of oid.c
+ *
+ * For a table LIST of n entries, the slot of an OID is
+ *   h    = FNV-1a( OID )
+ *   d    = mbedtls_LIST_hash_disp[h % nb]
+ *   slot = ( ( ( h XOR d ) * 0x01000193 ) >> 16 ) % n
+ * and mbedtls_LIST_hash_slot[slot] is the index of the only entry of LIST
+ * that can match, or MBEDTLS_OID_HASH_NONE.
+ */
+
+#define MBEDTLS_OID_HASH_NONE   0xFF
+'''
+
+FNV_OFFSET = 0x811c9dc5
+FNV_PRIME = 0x01000193
+
+def fnv1a(data):
+    """32-bit FNV-1a hash, as computed by oid_hash() in oid.c."""
+    h = FNV_OFFSET
+    for byte in data:
+        h = ((h ^ byte) * FNV_PRIME) & 0xffffffff
+    return h
+
+def displace(h, disp, n):
+    """Slot of a hash for a displacement, as computed by oid.c."""
+    return ((((h ^ disp) * FNV_PRIME) & 0xffffffff) >> 16) % n
+
+class OidMacros:
+    """The OID string macros of oid.h, as byte strings."""
+
+    _define_re = re.compile(r'^#define\s+(MBEDTLS_OID_\w+)\s+'
+                            r'(.*?)\s*(?:/\*.*)?$')
+    _token_re = re.compile(r'"((?:[^"\\]|\\.)*)"|(\w+)')
+
+    def __init__(self, header_file_name):
+        self.definitions = {}
+        with open(header_file_name) as header_file:
+            text = re.sub(r'\\\n', ' ', header_file.read())
+            for line in text.split('\n'):
+                match = self._define_re.match(line)
+                if match:
+                    self.definitions[match.group(1)] = match.group(2)
+
+    @staticmethod
+    def _unescape(literal):
+        value = bytearray()
+        i = 0
+        while i < len(literal):
+            if literal[i] != '\\':
+                value.append(ord(literal[i]))
+                i += 1
+            elif literal[i + 1] == 'x':
+                j = i + 2
+                while j < len(literal) and \
+                      literal[j] in '0123456789abcdefABCDEF':
+                    j += 1
+                value.append(int(literal[i + 2:j], 16))
+                i = j
+            elif literal[i + 1] in '01234567':
+                j = i + 1
+                while j < len(literal) and j < i + 4 and \
+                      literal[j] in '01234567':
+                    j += 1
+                value.append(int(literal[i + 1:j], 8))
+                i = j
+            else:
+                value.append(ord(literal[i + 1]))
+                i += 2
+        return bytes(value)
+
+    def value(self, name):
+        """Expand a macro made of string literals and other OID macros."""
+        expansion = self.definitions[name]
+        value = b''
+        for match in self._token_re.finditer(expansion):
+            if match.group(1) is not None:
+                value += self._unescape(match.group(1))
+            else:
+                value += self.value(match.group(2))
+        return value
+
+class OidTable:
+    """A descriptor table of oid.c and the conditions of its entries."""
+
+    def __init__(self, name, conditions):
+        self.name = name
+        self.conditions = conditions
+        self.entries = []
+
+    def add_entry(self, macro, conditions):
+        self.entries.append((macro, conditions))
+
+    def enum_name(self, macro):
+        return (self.name + '_' + macro[len('MBEDTLS_OID_'):]).upper()
+
+    def build_hash(self, macros):
+        """Find the displacements of a minimal perfect hash of the table."""
+        hashes = [fnv1a(macros.value(macro)) for macro, _ in self.entries]
+        values = [macros.value(macro) for macro, _ in self.entries]
+        if len(set(values)) != len(values):
+            raise Exception('Duplicate OID in ' + self.name)
+        if len(values) >= 0xFF:
+            raise Exception('Too many entries in ' + self.name)
+        n = len(hashes)
+        for nb in range((n + 1) // 2, n + 1):
+            buckets = [[] for _ in range(nb)]
+            for i, h in enumerate(hashes):
+                buckets[h % nb].append(i)
+            disp = [0] * nb
+            slots = [None] * n
+            order = sorted(range(nb), key=lambda b: -len(buckets[b]))
+            for b in order:
+                for d in range(256):
+                    wanted = [displace(hashes[i], d, n) for i in buckets[b]]
+                    if len(set(wanted)) == len(wanted) and \
+                       all(slots[s] is None for s in wanted):
+                        break
+                else:
+                    break
+                disp[b] = d
+                for i, s in zip(buckets[b], wanted):
+                    slots[s] = i
+            else:
+                return disp, slots
+        raise Exception('No perfect hash for ' + self.name)
+
+    @staticmethod
+    def _open(conditions):
+        return ''.join('#if ' + c + '\n' for c in conditions)
+
+    @staticmethod
+    def _close(conditions):
+        return ''.join('#endif /* ' + c + ' */\n'
+                       for c in reversed(conditions))
+
+    def write(self, output_file, macros):
+        disp, slots = self.build_hash(macros)
+        out = ['\n', self._open(self.conditions)]
+        out.append('enum\n{\n')
+        for macro, conditions in self.entries:
+            if conditions:
+                out.append('#if ' + ' && '.join(conditions) + '\n')
+                out.append('    %s,\n' % self.enum_name(macro))
+                out.append('#endif\n')
+            else:
+                out.append('    %s,\n' % self.enum_name(macro))
+        out.append('    %s_END\n};\n\n' % self.name.upper())
+        out.append('static const unsigned char mbedtls_%s_hash_disp[%d] =\n{\n'
+                   % (self.name, len(disp)))
+        for i in range(0, len(disp), 12):
+            out.append('    ' +
+                       ' '.join('%3d,' % d for d in disp[i:i + 12]) + '\n')
+        out.append('};\n\n')
+        out.append('static const unsigned char mbedtls_%s_hash_slot[%d] =\n{\n'
+                   % (self.name, len(slots)))
+        for i in slots:
+            macro, conditions = self.entries[i]
+            if conditions:
+                out.append('#if ' + ' && '.join(conditions) + '\n')
+                out.append('    %s,\n' % self.enum_name(macro))
+                out.append('#else\n    MBEDTLS_OID_HASH_NONE,\n#endif\n')
+            else:
+                out.append('    %s,\n' % self.enum_name(macro))
+        out.append('};\n')
+        out.append(self._close(self.conditions))
+        output_file.write(''.join(out))
+
+def read_tables(source_file_name):
+    """Read the tables of oid.c that are searched by OID, in order."""
+    table_re = re.compile(r'^static const \w+ (\w+)\[\] =')
+    lookup_re = re.compile(r'^FN_OID_TYPED_FROM_ASN1\(\s*\w+\s*,'
+                           r'\s*\w+\s*,\s*(\w+)\s*\)')
+    entry_re = re.compile(r'ADD_LEN\(\s*(MBEDTLS_OID_\w+)\s*\)')
+    if_re = re.compile(r'^#if\s+(.*?)\s*$')
+    tables = {}
+    searched = []
+    conditions = []
+    table = None
+    with open(source_file_name) as source_file:
+        for line in source_file:
+            match = if_re.match(line)
+            if match:
+                conditions.append(match.group(1))
+                continue
+            if line.startswith('#endif'):
+                conditions.pop()
+                continue
+            if line.startswith('#el'):
+                if table is not None:
+                    raise Exception('#else is not supported in ' + table.name)
+                conditions[-1] = '!( ' + conditions[-1] + ' )'
+                continue
+            match = table_re.match(line)
+            if match:
+                # The outermost condition is MBEDTLS_OID_C, which guards the
+                # inclusion of the generated file.
+                outer = conditions[1:]
+                table = OidTable(match.group(1), outer)
+                tables[table.name] = table
+                continue
+            if table is not None:
+                if line.startswith('};'):
+                    table = None
+                    continue
+                match = entry_re.search(line)
+                if match:
+                    table.add_entry(match.group(1),
+                                    conditions[len(table.conditions) + 1:])
+                continue
+            match = lookup_re.match(line)
+            if match:
+                searched.append(tables[match.group(1)])
+    return searched
+
+def generate_oid_hash(header_file_name, source_file_name, output_file_name):
+    macros = OidMacros(header_file_name)
+    tables = read_tables(source_file_name)
+    temp_file_name = output_file_name + '.tmp'
+    with open(temp_file_name, 'w') as output_file:
+        output_file.write(OUTPUT_HEADER)
+        for table in tables:
+            table.write(output_file, macros)
+    os.rename(temp_file_name, output_file_name)
+
+if __name__ == '__main__':
+    if not os.path.isdir('library') and os.path.isdir('../library'):
+        os.chdir('..')
+    # Allow to change the directory where oid_hash.h is written to.
+    OUTPUT_FILE_DIR = sys.argv[1] if len(sys.argv) == 2 else 'library'
+    generate_oid_hash('include/mbedtls/oid.h', 'library/oid.c',
+                      OUTPUT_FILE_DIR + '/oid_hash.h')
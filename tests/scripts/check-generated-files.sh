@@ -104,4 +104,5 @@ check()
 check scripts/generate_errors.pl library/error.c
 check scripts/generate_query_config.pl programs/test/query_config.c
 check scripts/generate_features.pl library/version_features.c
+check scripts/generate_oid_hash.py library/oid_hash.h
 check scripts/generate_visualc_files.pl visualc/VS2010